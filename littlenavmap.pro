@@ -259,6 +259,7 @@ message(-----------------------------------)
 
 SOURCES += \
   src/airspace/airspacecontroller.cpp \
+  src/airspace/airspacegeometrycache.cpp \
   src/airspace/airspacetoolbarhandler.cpp \
   src/app/commandline.cpp \
   src/app/dataexchange.cpp \
@@ -273,6 +274,7 @@ SOURCES += \
   src/common/elevationprovider.cpp \
   src/common/filecheck.cpp \
   src/common/formatter.cpp \
+  src/common/globetiles.cpp \
   src/common/fueltool.cpp \
   src/common/htmlinfobuilder.cpp \
   src/common/jsoninfobuilder.cpp \
@@ -328,6 +330,7 @@ SOURCES += \
   src/mapgui/aprongeometrycache.cpp \
   src/mapgui/imageexportdialog.cpp \
   src/mapgui/mapairporthandler.cpp \
+  src/mapgui/mapbenchmark.cpp \
   src/mapgui/mapcontextmenu.cpp \
   src/mapgui/mapdetailhandler.cpp \
   src/mapgui/mapfunctions.cpp \
@@ -335,7 +338,9 @@ SOURCES += \
   src/mapgui/maplayersettings.cpp \
   src/mapgui/mapmarkhandler.cpp \
   src/mapgui/mappaintwidget.cpp \
+  src/mapgui/mapprefetch.cpp \
   src/mapgui/mapscale.cpp \
+  src/mapgui/mapscreengrid.cpp \
   src/mapgui/mapscreenindex.cpp \
   src/mapgui/mapthemehandler.cpp \
   src/mapgui/maptooltip.cpp \
@@ -359,6 +364,7 @@ SOURCES += \
   src/mappainter/mappainterweather.cpp \
   src/mappainter/mappainterwind.cpp \
   src/mappainter/mappaintlayer.cpp \
+  src/mappainter/mappaintprofile.cpp \
   src/online/onlinedatacontroller.cpp \
   src/options/optiondata.cpp \
   src/options/optionsdialog.cpp \
@@ -386,6 +392,8 @@ SOURCES += \
   src/route/flightplanentrybuilder.cpp \
   src/route/parkingdialog.cpp \
   src/route/route.cpp \
+  src/route/routealternatives.cpp \
+  src/route/routealternativesdialog.cpp \
   src/route/routealtitude.cpp \
   src/route/routealtitudeleg.cpp \
   src/route/routecalcdialog.cpp \
@@ -395,6 +403,7 @@ SOURCES += \
   src/route/routeflags.cpp \
   src/route/routelabel.cpp \
   src/route/routeleg.cpp \
+  src/route/routesegmentindex.cpp \
   src/route/runwayselectiondialog.cpp \
   src/route/userwaypointdialog.cpp \
   src/routeexport/fetchroutedialog.cpp \
@@ -405,6 +414,7 @@ SOURCES += \
   src/routeexport/routeexportformat.cpp \
   src/routeexport/routemultiexportdialog.cpp \
   src/routeexport/simbriefhandler.cpp \
+  src/routestring/routestringbatch.cpp \
   src/routestring/routestringdialog.cpp \
   src/routestring/routestringreader.cpp \
   src/routestring/routestringtypes.cpp \
@@ -423,7 +433,6 @@ SOURCES += \
   src/search/proceduresearch.cpp \
   src/search/querybuilder.cpp \
   src/search/randomdepartureairportpickingbycriteria.cpp \
-  src/search/randomdestinationairportpickingbycriteria.cpp \
   src/search/searchbasetable.cpp \
   src/search/searchcontroller.cpp \
   src/search/sqlcontroller.cpp \
@@ -442,8 +451,13 @@ SOURCES += \
   src/web/requesthandler.cpp \
   src/web/webapp.cpp \
   src/web/webcontroller.cpp \
+  src/web/webeventstream.cpp \
+  src/web/webfeaturequery.cpp \
   src/web/webflags.cpp \
   src/web/webmapcontroller.cpp \
+  src/web/webrenderpool.cpp \
+  src/web/webresponsecache.cpp \
+  src/web/websnapshot.cpp \
   src/web/webtools.cpp \
   src/webapi/abstractactionscontroller.cpp \
   src/webapi/abstractlnmactionscontroller.cpp \
@@ -456,6 +470,7 @@ SOURCES += \
 
 HEADERS  += \
   src/airspace/airspacecontroller.h \
+  src/airspace/airspacegeometrycache.h \
   src/airspace/airspacetoolbarhandler.h \
   src/app/commandline.h \
   src/app/dataexchange.h \
@@ -470,6 +485,7 @@ HEADERS  += \
   src/common/elevationprovider.h \
   src/common/filecheck.h \
   src/common/formatter.h \
+  src/common/globetiles.h \
   src/common/fueltool.h \
   src/common/htmlinfobuilder.h \
   src/common/htmlinfobuilderflags.h \
@@ -526,6 +542,7 @@ HEADERS  += \
   src/mapgui/aprongeometrycache.h \
   src/mapgui/imageexportdialog.h \
   src/mapgui/mapairporthandler.h \
+  src/mapgui/mapbenchmark.h \
   src/mapgui/mapcontextmenu.h \
   src/mapgui/mapdetailhandler.h \
   src/mapgui/mapfunctions.h \
@@ -533,7 +550,9 @@ HEADERS  += \
   src/mapgui/maplayersettings.h \
   src/mapgui/mapmarkhandler.h \
   src/mapgui/mappaintwidget.h \
+  src/mapgui/mapprefetch.h \
   src/mapgui/mapscale.h \
+  src/mapgui/mapscreengrid.h \
   src/mapgui/mapscreenindex.h \
   src/mapgui/mapthemehandler.h \
   src/mapgui/maptooltip.h \
@@ -557,6 +576,7 @@ HEADERS  += \
   src/mappainter/mappainterweather.h \
   src/mappainter/mappainterwind.h \
   src/mappainter/mappaintlayer.h \
+  src/mappainter/mappaintprofile.h \
   src/online/onlinedatacontroller.h \
   src/options/optiondata.h \
   src/options/optionsdialog.h \
@@ -584,6 +604,8 @@ HEADERS  += \
   src/route/flightplanentrybuilder.h \
   src/route/parkingdialog.h \
   src/route/route.h \
+  src/route/routealternatives.h \
+  src/route/routealternativesdialog.h \
   src/route/routealtitude.h \
   src/route/routealtitudeleg.h \
   src/route/routecalcdialog.h \
@@ -593,6 +615,7 @@ HEADERS  += \
   src/route/routeflags.h \
   src/route/routelabel.h \
   src/route/routeleg.h \
+  src/route/routesegmentindex.h \
   src/route/runwayselectiondialog.h \
   src/route/userwaypointdialog.h \
   src/routeexport/fetchroutedialog.h \
@@ -603,6 +626,7 @@ HEADERS  += \
   src/routeexport/routeexportformat.h \
   src/routeexport/routemultiexportdialog.h \
   src/routeexport/simbriefhandler.h \
+  src/routestring/routestringbatch.h \
   src/routestring/routestringdialog.h \
   src/routestring/routestringreader.h \
   src/routestring/routestringtypes.h \
@@ -621,7 +645,6 @@ HEADERS  += \
   src/search/proceduresearch.h \
   src/search/querybuilder.h \
   src/search/randomdepartureairportpickingbycriteria.h \
-  src/search/randomdestinationairportpickingbycriteria.h \
   src/search/searchbasetable.h \
   src/search/searchcontroller.h \
   src/search/sqlcontroller.h \
@@ -640,8 +663,13 @@ HEADERS  += \
   src/web/requesthandler.h \
   src/web/webapp.h \
   src/web/webcontroller.h \
+  src/web/webeventstream.h \
+  src/web/webfeaturequery.h \
   src/web/webflags.h \
   src/web/webmapcontroller.h \
+  src/web/webrenderpool.h \
+  src/web/webresponsecache.h \
+  src/web/websnapshot.h \
   src/web/webtools.h \
   src/webapi/abstractactionscontroller.h \
   src/webapi/abstractlnmactionscontroller.h \
@@ -677,6 +705,7 @@ FORMS += \
   src/print/printdialog.ui \
   src/route/customproceduredialog.ui \
   src/route/parkingdialog.ui \
+  src/route/routealternativesdialog.ui \
   src/route/routecalcdialog.ui \
   src/route/runwayselectiondialog.ui \
   src/route/userwaypointdialog.ui \
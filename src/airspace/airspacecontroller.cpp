@@ -225,6 +225,20 @@ const atools::geo::LineString *AirspaceController::getAirspaceGeometry(map::MapA
   return nullptr;
 }
 
+const QVector<QPolygonF> *AirspaceController::getAirspaceScreenPolygons(map::MapAirspaceId id,
+                                                                       const Marble::ViewportParams *viewport)
+{
+  if((id.src & map::AIRSPACE_SRC_USER) && loadingUserAirspaces)
+    // Avoid deadlock while loading user airspaces
+    return nullptr;
+
+  AirspaceQuery *query = queries.value(id.src);
+  if(query != nullptr)
+    return query->getAirspaceScreenPolygonsById(id.id, viewport);
+
+  return nullptr;
+}
+
 void AirspaceController::restoreState()
 {
   Ui::MainWindow *ui = NavApp::getMainUi();
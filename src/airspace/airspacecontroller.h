@@ -22,6 +22,7 @@
 #include "fs/fspaths.h"
 
 #include <QObject>
+#include <QPolygonF>
 
 namespace atools {
 namespace fs {
@@ -38,6 +39,7 @@ class SqlRecord;
 
 namespace Marble {
 class GeoDataLatLonBox;
+class ViewportParams;
 }
 
 class AirspaceQuery;
@@ -86,6 +88,10 @@ public:
   /* Get Geometry for any airspace and source database */
   const atools::geo::LineString *getAirspaceGeometry(map::MapAirspaceId id);
 
+  /* Get simplified screen polygons for any airspace in the given viewport. Used for drawing and screen index.
+   * Polygons are cached until the view changes. */
+  const QVector<QPolygonF> *getAirspaceScreenPolygons(map::MapAirspaceId id, const Marble::ViewportParams *viewport);
+
   /* Read and write widget states, source and airspace selection */
   void restoreState();
   void saveState();
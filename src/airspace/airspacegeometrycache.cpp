@@ -0,0 +1,244 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "airspace/airspacegeometrycache.h"
+
+#include "common/constants.h"
+#include "geo/linestring.h"
+#include "settings/settings.h"
+
+#include <marble/GeoDataLinearRing.h>
+#include <marble/ViewportParams.h>
+
+#include <QStringBuilder>
+#include <QtMath>
+
+using atools::geo::LineString;
+using atools::geo::Pos;
+
+namespace  {
+/* Tolerance for level 1 in degree. About 100 meters. Tolerance doubles with each level. */
+const float LOD_MIN_TOLERANCE_DEG = 0.001f;
+const int LOD_MAX_LEVEL = 14;
+
+/* Do not simplify boundaries with fewer points */
+const int LOD_MIN_POINTS = 16;
+
+/* Allowed deviation of simplified geometry in pixel */
+const double LOD_TOLERANCE_PIXEL = 0.5;
+
+/* Drop all screen caches if more viewports are used. Avoids growing if viewports are created and deleted. */
+const int MAX_VIEWPORTS = 16;
+
+float toleranceForLevel(int level)
+{
+  return LOD_MIN_TOLERANCE_DEG * static_cast<float>(1 << (level - 1));
+}
+
+/* Squared distance of point p to segment a-b in the plane */
+double distanceSquared(const QPointF& p, const QPointF& a, const QPointF& b)
+{
+  double dx = b.x() - a.x(), dy = b.y() - a.y();
+  double lenSq = dx * dx + dy * dy;
+  double t = 0.;
+  if(lenSq > 0.)
+    t = std::max(0., std::min(1., ((p.x() - a.x()) * dx + (p.y() - a.y()) * dy) / lenSq));
+
+  double px = a.x() + t * dx - p.x(), py = a.y() + t * dy - p.y();
+  return px * px + py * py;
+}
+
+}
+
+AirspaceGeometryCache::AirspaceGeometryCache()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  lodCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceLineLodCache", 10000).toInt());
+  screenCacheCost = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY % "AirspaceScreenPolygonCache", 2000).toInt();
+}
+
+AirspaceGeometryCache::~AirspaceGeometryCache()
+{
+  clear();
+}
+
+int AirspaceGeometryCache::lodLevel(const Marble::ViewportParams *viewport)
+{
+  if(viewport == nullptr || viewport->radius() <= 0)
+    return 0;
+
+  // Degree per pixel at the equator - radius is the earth radius in pixel
+  double toleranceDeg = LOD_TOLERANCE_PIXEL * (180. / M_PI) / viewport->radius();
+  if(toleranceDeg < LOD_MIN_TOLERANCE_DEG)
+    return 0;
+
+  // Round down to use a tolerance not larger than requested
+  int level = 1 + static_cast<int>(std::floor(std::log2(toleranceDeg / LOD_MIN_TOLERANCE_DEG)));
+  return std::min(level, LOD_MAX_LEVEL);
+}
+
+const LineString *AirspaceGeometryCache::getGeometry(int airspaceId, int level, const LineString& geometry)
+{
+  if(level <= 0 || geometry.size() < LOD_MIN_POINTS)
+    return &geometry;
+
+  quint64 key = lodKey(airspaceId, level);
+  LineString *lines = lodCache.object(key);
+  if(lines == nullptr)
+  {
+    lines = new LineString;
+    simplify(*lines, geometry, toleranceForLevel(level));
+
+    // Keep full geometry if boundary collapses - airspace is smaller than a few pixels
+    if(lines->size() < 4)
+      *lines = geometry;
+
+    lodCache.insert(key, lines);
+  }
+  return lines;
+}
+
+const QVector<QPolygonF> *AirspaceGeometryCache::getScreenPolygons(int airspaceId, const Marble::ViewportParams *viewport,
+                                                                    const LineString& geometry)
+{
+  ViewportKey key;
+  key.projection = viewport->projection();
+  key.radius = viewport->radius();
+  key.centerLon = viewport->centerLongitude();
+  key.centerLat = viewport->centerLatitude();
+  key.size = viewport->size();
+
+  ScreenCache *screenCache = screenCaches.value(viewport);
+  if(screenCache == nullptr)
+  {
+    if(screenCaches.size() >= MAX_VIEWPORTS)
+    {
+      qDeleteAll(screenCaches);
+      screenCaches.clear();
+    }
+
+    screenCache = new ScreenCache;
+    screenCache->polygons.setMaxCost(screenCacheCost);
+    screenCaches.insert(viewport, screenCache);
+  }
+
+  // Projection is only valid for one view - this also catches a new viewport at the address of a deleted one
+  if(key != screenCache->key)
+  {
+    screenCache->polygons.clear();
+    screenCache->key = key;
+  }
+
+  QVector<QPolygonF> *polygons = screenCache->polygons.object(airspaceId);
+  if(polygons == nullptr)
+  {
+    Marble::GeoDataLinearRing linearRing;
+    linearRing.setTessellate(true);
+    for(const Pos& pos : geometry)
+      linearRing.append(Marble::GeoDataCoordinates(pos.getLonX(), pos.getLatY(), 0, Marble::GeoDataCoordinates::Degree));
+
+    QVector<QPolygonF *> screenPolygons;
+    viewport->screenCoordinates(linearRing, screenPolygons);
+
+    // Copy polygons and delete pointers
+    polygons = new QVector<QPolygonF>;
+    for(const QPolygonF *poly : screenPolygons)
+      polygons->append(*poly);
+    qDeleteAll(screenPolygons);
+
+    screenCache->polygons.insert(airspaceId, polygons);
+  }
+  return polygons;
+}
+
+void AirspaceGeometryCache::clear()
+{
+  lodCache.clear();
+  qDeleteAll(screenCaches);
+  screenCaches.clear();
+}
+
+void AirspaceGeometryCache::simplify(LineString& result, const LineString& geometry, float toleranceDeg)
+{
+  result.clear();
+  int size = geometry.size();
+  if(size < 3 || !(toleranceDeg > 0.f))
+  {
+    result = geometry;
+    return;
+  }
+
+  // Project to plane using cosine of average latitude to scale longitudes ========================
+  double latSum = 0.;
+  for(const Pos& pos : geometry)
+    latSum += pos.getLatY();
+  double lonScale = std::max(std::cos(qDegreesToRadians(latSum / size)), 0.1);
+
+  QVector<QPointF> points;
+  points.reserve(size);
+  double lon = geometry.at(0).getLonX();
+  for(int i = 0; i < size; i++)
+  {
+    if(i > 0)
+    {
+      // Unwrap longitude to avoid jumps at the anti-meridian
+      double diff = geometry.at(i).getLonX() - geometry.at(i - 1).getLonX();
+      if(diff > 180.)
+        diff -= 360.;
+      else if(diff < -180.)
+        diff += 360.;
+      lon += diff;
+    }
+    points.append(QPointF(lon * lonScale, geometry.at(i).getLatY()));
+  }
+
+  // Douglas-Peucker using a stack instead of recursion ========================
+  double toleranceSq = static_cast<double>(toleranceDeg) * static_cast<double>(toleranceDeg);
+  QVector<bool> keep(size, false);
+  keep[0] = keep[size - 1] = true;
+
+  QVector<std::pair<int, int> > stack;
+  stack.append(std::make_pair(0, size - 1));
+  while(!stack.isEmpty())
+  {
+    std::pair<int, int> range = stack.takeLast();
+    double maxDistSq = -1.;
+    int maxIndex = -1;
+    for(int i = range.first + 1; i < range.second; i++)
+    {
+      double distSq = distanceSquared(points.at(i), points.at(range.first), points.at(range.second));
+      if(distSq > maxDistSq)
+      {
+        maxDistSq = distSq;
+        maxIndex = i;
+      }
+    }
+
+    if(maxIndex != -1 && maxDistSq > toleranceSq)
+    {
+      keep[maxIndex] = true;
+      stack.append(std::make_pair(range.first, maxIndex));
+      stack.append(std::make_pair(maxIndex, range.second));
+    }
+  }
+
+  for(int i = 0; i < size; i++)
+  {
+    if(keep.at(i))
+      result.append(geometry.at(i));
+  }
+}
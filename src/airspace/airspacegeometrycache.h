@@ -0,0 +1,112 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_AIRSPACEGEOMETRYCACHE_H
+#define LNM_AIRSPACEGEOMETRYCACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QPolygonF>
+#include <QSize>
+
+namespace atools {
+namespace geo {
+class LineString;
+}
+}
+
+namespace Marble {
+class ViewportParams;
+}
+
+/*
+ * Level of detail cache for airspace geometry owned by an airspace query.
+ *
+ * Keeps Douglas-Peucker simplified copies of the airspace boundaries for power of two tolerance levels and the
+ * projected screen polygons for the last view of each viewport instance. Polygons are shared between map painting and
+ * the screen index and are rebuilt only if the view changes. Map widgets painting alternately like the main and the
+ * web map do not invalidate each other's polygons.
+ *
+ * Pointers returned from this cache might be deleted on the next call and should not be kept.
+ */
+class AirspaceGeometryCache
+{
+public:
+  AirspaceGeometryCache();
+  ~AirspaceGeometryCache();
+
+  AirspaceGeometryCache(const AirspaceGeometryCache& other) = delete;
+  AirspaceGeometryCache& operator=(const AirspaceGeometryCache& other) = delete;
+
+  /* Level of detail for the viewport. 0 means full resolution. */
+  static int lodLevel(const Marble::ViewportParams *viewport);
+
+  /* Get simplified geometry for airspace id and level. geometry is the full resolution boundary
+   * which is returned as is for level 0 or if it has only a few points. */
+  const atools::geo::LineString *getGeometry(int airspaceId, int level, const atools::geo::LineString& geometry);
+
+  /* Get screen polygons for the airspace in the given viewport. Polygons are not clipped to the screen. */
+  const QVector<QPolygonF> *getScreenPolygons(int airspaceId, const Marble::ViewportParams *viewport,
+                                              const atools::geo::LineString& geometry);
+
+  void clear();
+
+  /* Simplify ring or line using Douglas-Peucker with the tolerance given in degree.
+   * Longitudes are scaled by the cosine of the average latitude and unwrapped at the anti-meridian. */
+  static void simplify(atools::geo::LineString& result, const atools::geo::LineString& geometry, float toleranceDeg);
+
+private:
+  /* Parameters defining the projection of the viewport */
+  struct ViewportKey
+  {
+    int projection = -1, radius = 0;
+    double centerLon = 0., centerLat = 0.;
+    QSize size;
+
+    bool operator==(const ViewportKey& other) const
+    {
+      return projection == other.projection && radius == other.radius && centerLon == other.centerLon &&
+             centerLat == other.centerLat && size == other.size;
+    }
+
+    bool operator!=(const ViewportKey& other) const
+    {
+      return !operator==(other);
+    }
+  };
+
+  static quint64 lodKey(int airspaceId, int level)
+  {
+    return (static_cast<quint64>(static_cast<quint32>(airspaceId)) << 8) | static_cast<quint64>(level);
+  }
+
+  /* Projected polygons by airspace id for the view in key */
+  struct ScreenCache
+  {
+    ViewportKey key;
+    QCache<int, QVector<QPolygonF> > polygons;
+  };
+
+  /* Simplified geometry by id and level */
+  QCache<quint64, atools::geo::LineString> lodCache;
+
+  /* One screen polygon cache per viewport instance. Pointer is used as key only and never dereferenced. */
+  QHash<const Marble::ViewportParams *, ScreenCache *> screenCaches;
+  int screenCacheCost = 2000;
+};
+
+#endif // LNM_AIRSPACEGEOMETRYCACHE_H
@@ -91,6 +91,39 @@ CommandLine::CommandLine()
                                                    "The code is not checked for existence or validity and "
                                                    "is saved for the next startup."), "language");
   parser->addOption(*languageOpt);
+
+  mapBenchmarkOpt = new QCommandLineOption(lnm::STARTUP_MAP_BENCHMARK,
+                                           QObject::tr("Render scripted map views offscreen after startup, save frame times and "
+                                                       "query counts to the CSV file <%1> and exit. "
+                                                       "Uses the flight plan given by option -f for the route sequence. "
+                                                       "Add \"-platform offscreen\" to run without display.").arg(lnm::STARTUP_MAP_BENCHMARK),
+                                           lnm::STARTUP_MAP_BENCHMARK);
+  parser->addOption(*mapBenchmarkOpt);
+
+  routeStringBatchOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_STRING_BATCH,
+                                               QObject::tr("Read flight plan route descriptions line by line from the text file <%1>, "
+                                                           "save a flight plan for each into the directory given by option "
+                                                           "--%2 and exit. Empty lines and lines starting with \"#\" are ignored. "
+                                                           "Errors are printed to the log and to a CSV report in the output directory. "
+                                                           "Add \"-platform offscreen\" to run without display.").
+                                               arg(lnm::STARTUP_ROUTE_STRING_BATCH).arg(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT),
+                                               lnm::STARTUP_ROUTE_STRING_BATCH);
+  parser->addOption(*routeStringBatchOpt);
+
+  routeStringBatchOutputOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT,
+                                                     QObject::tr("Save flight plans from option --%1 into directory <%2>. "
+                                                                 "Missing directories are created. Existing files are overwritten.").
+                                                     arg(lnm::STARTUP_ROUTE_STRING_BATCH).arg(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT),
+                                                     lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT);
+  parser->addOption(*routeStringBatchOutputOpt);
+
+  routeStringBatchFormatOpt = new QCommandLineOption(lnm::STARTUP_ROUTE_STRING_BATCH_FORMAT,
+                                                     QObject::tr("File format <%1> for flight plans from option --%2. "
+                                                                 "One of \"lnmpln\" (default), \"pln\" (FSX and P3D), \"msfs\", "
+                                                                 "\"fms11\", \"fms3\" or \"fgfp\".").
+                                                     arg(lnm::STARTUP_ROUTE_STRING_BATCH_FORMAT).arg(lnm::STARTUP_ROUTE_STRING_BATCH),
+                                                     lnm::STARTUP_ROUTE_STRING_BATCH_FORMAT);
+  parser->addOption(*routeStringBatchFormatOpt);
 }
 
 CommandLine::~CommandLine()
@@ -105,6 +138,10 @@ CommandLine::~CommandLine()
   delete performanceOpt;
   delete layoutOpt;
   delete languageOpt;
+  delete mapBenchmarkOpt;
+  delete routeStringBatchOpt;
+  delete routeStringBatchOutputOpt;
+  delete routeStringBatchFormatOpt;
 }
 
 void CommandLine::process()
@@ -142,6 +179,23 @@ void CommandLine::process()
   if(parser->isSet(*layoutOpt) && !parser->value(*layoutOpt).isEmpty())
     NavApp::addStartupOptionStr(lnm::STARTUP_LAYOUT, parser->value(*layoutOpt));
 
+  if(parser->isSet(*mapBenchmarkOpt) && !parser->value(*mapBenchmarkOpt).isEmpty())
+    NavApp::addStartupOptionStr(lnm::STARTUP_MAP_BENCHMARK, parser->value(*mapBenchmarkOpt));
+
+  // Batch route description conversion
+  if(parser->isSet(*routeStringBatchOpt) && !parser->isSet(*routeStringBatchOutputOpt))
+    qWarning() << QObject::tr("Option --%1 requires option --%2").
+      arg(lnm::STARTUP_ROUTE_STRING_BATCH).arg(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT);
+
+  if(parser->isSet(*routeStringBatchOpt) && !parser->value(*routeStringBatchOpt).isEmpty())
+    NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH, parser->value(*routeStringBatchOpt));
+
+  if(parser->isSet(*routeStringBatchOutputOpt) && !parser->value(*routeStringBatchOutputOpt).isEmpty())
+    NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT, parser->value(*routeStringBatchOutputOpt));
+
+  if(parser->isSet(*routeStringBatchFormatOpt) && !parser->value(*routeStringBatchFormatOpt).isEmpty())
+    NavApp::addStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH_FORMAT, parser->value(*routeStringBatchFormatOpt));
+
   // Other arguments without option
   if(!parser->positionalArguments().isEmpty())
     NavApp::addStartupOptionStrList(lnm::STARTUP_OTHER_ARGUMENTS, parser->positionalArguments());
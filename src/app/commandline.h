@@ -62,7 +62,8 @@ private:
 
   QCommandLineOption *settingsDirOpt = nullptr, *settingsPathOpt = nullptr, *logPathOpt = nullptr, *cachePathOpt = nullptr,
                      *flightplanOpt = nullptr, *flightplanDescrOpt = nullptr, *performanceOpt,
-                     *layoutOpt = nullptr, *languageOpt = nullptr;
+                     *layoutOpt = nullptr, *languageOpt = nullptr, *mapBenchmarkOpt = nullptr,
+                     *routeStringBatchOpt = nullptr, *routeStringBatchOutputOpt = nullptr, *routeStringBatchFormatOpt = nullptr;
 };
 
 #endif // LNM_COMMANDLINE_H
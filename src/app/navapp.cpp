@@ -172,7 +172,8 @@ void NavApp::init(MainWindow *mainWindowParam)
   // Clear temporary userpoints
   userdataController->clearTemporary();
 
-  onlinedataController = new OnlinedataController(databaseManager->getOnlinedataManager(), mainWindow);
+  onlinedataController = new OnlinedataController(databaseManager->getOnlinedataManager(),
+                                                   databaseManager->getOnlinedataManagerStaging(), mainWindow);
 
   trackController = new TrackController(databaseManager->getTrackManager(), mainWindow);
 
@@ -570,7 +571,10 @@ const atools::geo::Pos& NavApp::getUserAircraftPos()
 void NavApp::updateAllMaps()
 {
   if(mainWindow->getMapWidget() != nullptr)
+  {
+    mainWindow->getMapWidget()->invalidateStaticLayer();
     mainWindow->getMapWidget()->update();
+  }
 
   if(mainWindow->getProfileWidget() != nullptr)
     mainWindow->getProfileWidget()->update();
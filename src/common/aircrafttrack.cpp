@@ -28,6 +28,9 @@
 #include <QDateTime>
 #include <QFile>
 
+#include <cmath>
+#include <limits>
+
 quint16 AircraftTrack::version = 0;
 
 /* Insert an invalid position as an break indicator if aircraft jumps too far on ground. */
@@ -36,6 +39,12 @@ static const float MAX_POINT_DISTANCE_NM = 5.f;
 /* Number of entries to remove at once */
 static const int PRUNE_TRACK_ENTRIES = 200;
 
+/* Initial size of ring buffer */
+static const int MIN_RING_BUFFER_SIZE = 1024;
+
+/* Maximum number of simplification levels kept in the cache */
+static const int MAX_LINE_STRING_CACHE_LEVELS = 8;
+
 /* Minimum time difference between recordings */
 static const int MIN_POSITION_TIME_DIFF_MS = 1000;
 static const int MIN_POSITION_TIME_DIFF_GROUND_MS = 250;
@@ -112,7 +121,6 @@ AircraftTrack::~AircraftTrack()
 }
 
 AircraftTrack::AircraftTrack(const AircraftTrack& other)
-  : QList<at::AircraftTrackPos>(other)
 {
   lastUserAircraft = new atools::fs::sc::SimConnectUserAircraft;
   this->operator=(other);
@@ -120,8 +128,20 @@ AircraftTrack::AircraftTrack(const AircraftTrack& other)
 
 AircraftTrack& AircraftTrack::operator=(const AircraftTrack& other)
 {
-  clear();
-  append(other);
+  if(this == &other)
+    return *this;
+
+  // Copy under lock of other to avoid locking both at the same time
+  other.mutex.lock();
+  QVector<at::AircraftTrackPos> otherRing = other.ring;
+  int otherHead = other.head, otherNumEntries = other.numEntries;
+  other.mutex.unlock();
+
+  QMutexLocker locker(&mutex);
+  ring = otherRing;
+  head = otherHead;
+  numEntries = otherNumEntries;
+  lineStringCache.clear();
   maxTrackEntries = other.maxTrackEntries;
   *lastUserAircraft = *other.lastUserAircraft;
   return *this;
@@ -146,7 +166,7 @@ void AircraftTrack::saveState(const QString& suffix, int numBackupFiles)
 
 void AircraftTrack::restoreState(const QString& suffix)
 {
-  clear();
+  clearTrack();
 
   QFile trackFile(atools::settings::Settings::getConfigFilename(suffix));
   if(trackFile.exists())
@@ -164,24 +184,84 @@ void AircraftTrack::restoreState(const QString& suffix)
 
 void AircraftTrack::clearTrack()
 {
+  QMutexLocker locker(&mutex);
   clear();
 }
 
+void AircraftTrack::clear()
+{
+  ring.clear();
+  head = numEntries = 0;
+  lineStringCache.clear();
+}
+
+void AircraftTrack::append(const at::AircraftTrackPos& trackPos)
+{
+  if(numEntries == ring.size())
+  {
+    // Buffer full - copy entries in order into a larger buffer
+    // Size does not exceed the maximum number of entries unless needed when loading larger tracks
+    int newSize = std::max(std::min(ring.size() * 2, maxTrackEntries + 2), std::max(numEntries + 1, MIN_RING_BUFFER_SIZE));
+    QVector<at::AircraftTrackPos> newRing;
+    newRing.reserve(newSize);
+    for(int i = 0; i < numEntries; i++)
+      newRing.append(entry(i));
+    newRing.resize(newSize);
+
+    ring.swap(newRing);
+    head = 0;
+  }
+
+  int index = head + numEntries;
+  ring[index >= ring.size() ? index - ring.size() : index] = trackPos;
+  numEntries++;
+}
+
+bool AircraftTrack::prune()
+{
+  if(numEntries > maxTrackEntries)
+  {
+    // Remove in chunks to avoid rebuilding the line string caches on every new position
+    int num = std::min(numEntries, std::max(PRUNE_TRACK_ENTRIES, numEntries - maxTrackEntries));
+
+    // Remove invalid segments
+    while(num < numEntries && !entry(num).isValid())
+      num++;
+
+    head = (head + num) % ring.size();
+    numEntries -= num;
+
+    if(numEntries == 0)
+      head = 0;
+
+    lineStringCache.clear();
+    return true;
+  }
+  return false;
+}
+
 void AircraftTrack::saveToStream(QDataStream& out)
 {
+  QMutexLocker locker(&mutex);
   out.setVersion(QDataStream::Qt_5_5);
 
+  // Same format as QList stream operator which was used in earlier versions
 #ifdef DEBUG_SAVE_TRACK_OLD
   out.setFloatingPointPrecision(QDataStream::SinglePrecision);
-  out << FILE_MAGIC_NUMBER << FILE_VERSION_64BIT_TS << *this;
+  out << FILE_MAGIC_NUMBER << FILE_VERSION_64BIT_TS << static_cast<quint32>(numEntries);
 #else
   out.setFloatingPointPrecision(QDataStream::DoublePrecision);
-  out << FILE_MAGIC_NUMBER << FILE_VERSION_64BIT_COORDS << *this;
+  out << FILE_MAGIC_NUMBER << FILE_VERSION_64BIT_COORDS << static_cast<quint32>(numEntries);
 #endif
+
+  for(int i = 0; i < numEntries; i++)
+    out << entry(i);
 }
 
 bool AircraftTrack::readFromStream(QDataStream& in)
 {
+  QMutexLocker locker(&mutex);
+
   bool retval = false;
   clear();
 
@@ -196,18 +276,36 @@ bool AircraftTrack::readFromStream(QDataStream& in)
     {
       // Read old float coordinates
       in.setFloatingPointPrecision(QDataStream::SinglePrecision);
-      in >> *this;
       retval = true;
     }
     else if(AircraftTrack::version == FILE_VERSION_64BIT_COORDS)
     {
       // Read new double coordinates
       in.setFloatingPointPrecision(QDataStream::DoublePrecision);
-      in >> *this;
       retval = true;
     }
     else
       qWarning() << "Cannot read track. Invalid version number:" << AircraftTrack::version;
+
+    if(retval)
+    {
+      // Read list in the format of the QList stream operator
+      quint32 num;
+      in >> num;
+      for(quint32 i = 0; i < num; i++)
+      {
+        at::AircraftTrackPos trackPos;
+        in >> trackPos;
+
+        if(in.status() != QDataStream::Ok)
+        {
+          qWarning() << "Cannot read track. Stream error at entry" << i;
+          clear();
+          break;
+        }
+        append(trackPos);
+      }
+    }
   }
   else
     qWarning() << "Cannot read track. Invalid magic number:" << magic;
@@ -230,6 +328,8 @@ bool AircraftTrack::appendTrackPos(const atools::fs::sc::SimConnectUserAircraft&
     return false;
   }
 
+  QMutexLocker locker(&mutex);
+
   bool pruned = false;
   const QDateTime timestamp = userAircraft.getZuluTime();
   atools::geo::PosD posD = userAircraft.getPositionD();
@@ -244,7 +344,7 @@ bool AircraftTrack::appendTrackPos(const atools::fs::sc::SimConnectUserAircraft&
     qint64 epsilonTime = onGround ? MIN_POSITION_TIME_DIFF_GROUND_MS : MIN_POSITION_TIME_DIFF_MS;
 
     qint64 timeMs = timestamp.toMSecsSinceEpoch();
-    const at::AircraftTrackPos& last = constLast();
+    const at::AircraftTrackPos last = entry(numEntries - 1);
     qint64 lastTimeMs = last.getTimestampMs();
 
     atools::geo::Pos pos = posD.asPos();
@@ -254,6 +354,8 @@ bool AircraftTrack::appendTrackPos(const atools::fs::sc::SimConnectUserAircraft&
       bool aircraftChanged = lastValid && lastUserAircraft->hasAircraftChanged(userAircraft);
       bool jumped = !isEmpty() && pos.distanceMeterTo(last.getPos()) > atools::geo::nmToMeter(MAX_POINT_DISTANCE_NM);
 
+      pruned = prune();
+
       // Points where the track is interrupted (new flight) are indicated by invalid coordinates.
       // Warping at altitude does not interrupt a track.
       if(allowSplit && jumped && (last.isOnGround() || onGround || aircraftChanged))
@@ -268,20 +370,7 @@ bool AircraftTrack::appendTrackPos(const atools::fs::sc::SimConnectUserAircraft&
         append(at::AircraftTrackPos(posD, timestamp.toMSecsSinceEpoch(), onGround));
       }
       else
-      {
-        if(size() > maxTrackEntries)
-        {
-          for(int i = 0; i < PRUNE_TRACK_ENTRIES; i++)
-            removeFirst();
-
-          // Remove invalid segments
-          while(!isEmpty() && !constFirst().isValid())
-            removeFirst();
-
-          pruned = true;
-        }
         append(at::AircraftTrackPos(posD, timestamp.toMSecsSinceEpoch(), onGround));
-      }
 
       *lastUserAircraft = userAircraft;
     }
@@ -291,51 +380,94 @@ bool AircraftTrack::appendTrackPos(const atools::fs::sc::SimConnectUserAircraft&
 
 float AircraftTrack::getMaxAltitude() const
 {
+  QMutexLocker locker(&mutex);
   double maxAlt = 0.;
-  for(const at::AircraftTrackPos& trackPos : *this)
-    maxAlt = std::max(maxAlt, trackPos.getPosD().getAltitude());
+  for(int i = 0; i < numEntries; i++)
+    maxAlt = std::max(maxAlt, entry(i).getPosD().getAltitude());
   return static_cast<float>(maxAlt);
 }
 
-QVector<atools::geo::LineString> AircraftTrack::getLineStrings() const
+QVector<atools::geo::LineString> AircraftTrack::getLineStrings(float toleranceDeg) const
 {
-  QVector<atools::geo::LineString> linestrings;
+  QMutexLocker locker(&mutex);
 
-  if(!isEmpty())
+  if(isEmpty())
+    return QVector<atools::geo::LineString>();
+
+  // Round tolerance up to the next power of two to get a limited number of levels
+  int level = std::numeric_limits<int>::min();
+  if(toleranceDeg > 0.f)
   {
-    atools::geo::LineString line;
-    linestrings.reserve(size());
+    level = static_cast<int>(std::ceil(std::log2(toleranceDeg)));
+    toleranceDeg = std::ldexp(1.f, level);
+  }
+
+  if(!lineStringCache.contains(level) && lineStringCache.size() >= MAX_LINE_STRING_CACHE_LEVELS)
+    lineStringCache.clear();
 
-    for(const at::AircraftTrackPos& trackPos : *this)
+  LineStringCache& cache = lineStringCache[level];
+  updateLineStringCache(cache, toleranceDeg);
+
+  // Copy is cheap since vector and lines are implicitly shared
+  QVector<atools::geo::LineString> linestrings = cache.lines;
+
+  // Omit open line if empty
+  if(!linestrings.isEmpty() && linestrings.constLast().isEmpty())
+    linestrings.removeLast();
+
+  return linestrings;
+}
+
+void AircraftTrack::updateLineStringCache(LineStringCache& cache, float toleranceDeg) const
+{
+  if(cache.lines.isEmpty())
+    // Start with an open line
+    cache.lines.append(atools::geo::LineString());
+
+  for(int i = cache.numProcessed; i < numEntries; i++)
+  {
+    const at::AircraftTrackPos& trackPos = entry(i);
+
+    if(!trackPos.isValid())
     {
-      if(!trackPos.isValid())
+      // An invalid position shows a break in the lines - close line and start a new one
+      cache.lines.append(atools::geo::LineString());
+      cache.lastTemporary = false;
+    }
+    else
+    {
+      atools::geo::LineString& line = cache.lines.last();
+      atools::geo::Pos pos = trackPos.getPos();
+
+      if(toleranceDeg > 0.f && !line.isEmpty())
       {
-        // An invalid position shows a break in the lines - add line and start a new one
-        linestrings.append(line);
-        line.clear();
+        // Replace last position if it was not far enough from the one before
+        if(cache.lastTemporary)
+          line.removeLast();
+
+        const atools::geo::Pos& lastPos = line.constLast();
+        cache.lastTemporary = std::abs(pos.getLonX() - lastPos.getLonX()) < toleranceDeg &&
+                              std::abs(pos.getLatY() - lastPos.getLatY()) < toleranceDeg;
       }
-      else
-        line.append(trackPos.getPos());
+      line.append(pos);
     }
-
-    // Add rest
-    if(!line.isEmpty())
-      linestrings.append(line);
   }
-  return linestrings;
+
+  cache.numProcessed = numEntries;
 }
 
 QVector<QVector<atools::geo::PosD> > AircraftTrack::getPositionsD() const
 {
+  QMutexLocker locker(&mutex);
   QVector<QVector<atools::geo::PosD> > linestrings;
 
   if(!isEmpty())
   {
     QVector<atools::geo::PosD> line;
-    linestrings.reserve(size());
 
-    for(const at::AircraftTrackPos& trackPos : *this)
+    for(int i = 0; i < numEntries; i++)
     {
+      const at::AircraftTrackPos& trackPos = entry(i);
       if(!trackPos.isValid())
       {
         // An invalid position shows a break in the lines - add line and start a new one
@@ -355,15 +487,16 @@ QVector<QVector<atools::geo::PosD> > AircraftTrack::getPositionsD() const
 
 QVector<QVector<qint64> > AircraftTrack::getTimestampsMs() const
 {
+  QMutexLocker locker(&mutex);
   QVector<QVector<qint64> > timestamps;
 
   if(!isEmpty())
   {
     QVector<qint64> times;
-    timestamps.reserve(size());
 
-    for(const at::AircraftTrackPos& trackPos : *this)
+    for(int i = 0; i < numEntries; i++)
     {
+      const at::AircraftTrackPos& trackPos = entry(i);
       if(!trackPos.isValid())
       {
         // An invalid position shows a break in the lines - start a new list
@@ -19,6 +19,10 @@
 #define LITTLENAVMAP_AIRCRAFTTRACK_H
 
 #include "geo/pos.h"
+#include "geo/linestring.h"
+
+#include <QHash>
+#include <QMutex>
 
 namespace atools {
 namespace fs {
@@ -26,9 +30,6 @@ namespace sc {
 class SimConnectUserAircraft;
 }
 }
-namespace geo {
-class LineString;
-}
 }
 
 namespace at {
@@ -104,9 +105,12 @@ Q_DECLARE_METATYPE(at::AircraftTrackPos);
  *
  * Points where the track is interrupted (new flight) are indicated by invalid coordinates.
  * Warping at altitude does not interrupt a track.
+ *
+ * Positions are kept in a ring buffer which avoids moving memory when pruning old entries.
+ * Line strings are cached per simplification level and extended incrementally when new positions are appended.
+ * Caches are invalidated only when the track is pruned, cleared or loaded.
  */
-class AircraftTrack :
-  private QList<at::AircraftTrackPos>
+class AircraftTrack
 {
 public:
   AircraftTrack();
@@ -134,7 +138,16 @@ public:
 
   /* Copies the coordinates from the structs to a list of linestrings.
    * More than one linestring might be returned if the trail is interrupted. */
-  QVector<atools::geo::LineString> getLineStrings() const;
+  QVector<atools::geo::LineString> getLineStrings() const
+  {
+    return getLineStrings(0.f);
+  }
+
+  /* As above but skips points which are closer than toleranceDeg to the last point in latitude and longitude.
+   * Tolerance is rounded up to the next power of two and the result is cached for this level.
+   * Last point of the track is always included. Use a tolerance of about one pixel for drawing.
+   * Thread safe. */
+  QVector<atools::geo::LineString> getLineStrings(float toleranceDeg) const;
 
   /* Accurate positions for drawing */
   QVector<QVector<atools::geo::PosD> > getPositionsD() const;
@@ -142,10 +155,17 @@ public:
   /* Same size as getLineStrings() but returns the timestamps in milliseconds since Epoch UTC for each position */
   QVector<QVector<qint64> > getTimestampsMs() const;
 
-  /* Pull only needed methods of the base class into public space */
-  using QList::isEmpty;
+  bool isEmpty() const
+  {
+    return numEntries == 0;
+  }
+
+  int size() const
+  {
+    return numEntries;
+  }
 
-  /* Track will be pruned if it contains more track entries than this value. Default is 20000. */
+  /* Track will be pruned if it contains more track entries than this value. Default is 50000. */
   void setMaxTrackEntries(int value)
   {
     maxTrackEntries = value;
@@ -159,8 +179,42 @@ public:
 private:
   friend QDataStream& at::operator>>(QDataStream& dataStream, at::AircraftTrackPos& trackPos);
 
+  /* Line strings for one simplification level */
+  struct LineStringCache
+  {
+    QVector<atools::geo::LineString> lines;
+    int numProcessed = 0; /* Number of track entries already added to lines */
+    bool lastTemporary = false; /* Last point of last line is not a simplified point and will be replaced */
+  };
+
+  /* Access entry by logical index where 0 is the oldest position */
+  const at::AircraftTrackPos& entry(int index) const
+  {
+    index += head;
+    return ring.at(index >= ring.size() ? index - ring.size() : index);
+  }
+
+  void clear();
+  void append(const at::AircraftTrackPos& trackPos);
+
+  /* Removes entries from the start if size exceeds maxTrackEntries. Returns true if pruned. */
+  bool prune();
+
+  /* Adds all entries not yet processed to the cache */
+  void updateLineStringCache(LineStringCache& cache, float toleranceDeg) const;
+
+  /* Ring buffer. Entries numEntries from head are valid. Grows as needed. */
+  QVector<at::AircraftTrackPos> ring;
+  int head = 0, numEntries = 0;
+
+  /* Line strings by simplification level. Level is exponent to base two of tolerance. INT_MIN is unsimplified. */
+  mutable QHash<int, LineStringCache> lineStringCache;
+
+  /* Protects ring buffer changes and the line string cache since the track is also read by the web server */
+  mutable QMutex mutex;
+
   /* Maximum number of track points. If exceeded entries will be removed from beginning of the list */
-  int maxTrackEntries = 20000;
+  int maxTrackEntries = 50000;
 
   atools::fs::sc::SimConnectUserAircraft *lastUserAircraft;
 
@@ -271,6 +271,7 @@ const QLatin1String AIRSPACE_CONTROLLER_WIDGETS("AirspaceController/Widget");
 const QLatin1String SETTINGS_INFOQUERY("Settings/InfoQuery");
 const QLatin1String SETTINGS_MAPQUERY("Settings/MapQuery1");
 const QLatin1String SETTINGS_DATABASE("Settings/Database");
+const QLatin1String SETTINGS_ROUTE_CALC("Settings/RouteCalc");
 
 const QLatin1String APPROACHTREE_WIDGET("ApproachTree/Widget");
 const QLatin1String APPROACHTREE_SELECTED_WIDGET("ApproachTree/WidgetSelected");
@@ -291,6 +292,7 @@ const QLatin1String TIME_DIALOG("Map/TimeDialog");
 /* Flightplan export dialog for online formats */
 const QLatin1String FLIGHTPLAN_ONLINE_EXPORT("Route/FlightplanOnlineExport");
 const QLatin1String ROUTE_PARKING_DIALOG("Route/ParkingDialog");
+const QLatin1String ROUTE_ALTERNATIVES_DIALOG("Route/RouteAlternativesDialog");
 
 const QLatin1String LOGDATA_EDIT_ADD_DIALOG("LogdataDialog/Widget");
 const QLatin1String LOGDATA_STATS_DIALOG("LogdataStatsDialog/Widget");
@@ -353,6 +355,7 @@ const QLatin1String OPTIONS_WEATHER_DEBUG("Options/WeatherDebug");
 const QLatin1String OPTIONS_MAP_JUMP_BACK_DEBUG("Options/MapJumpBackDebug");
 const QLatin1String OPTIONS_PROFILE_JUMP_BACK_DEBUG("Options/ProfileJumpBackDebug");
 const QLatin1String OPTIONS_MAP_LAYER_DEBUG("Options/MapLayerDebug");
+const QLatin1String OPTIONS_MAP_PROFILE("Options/MapProfile");
 
 const QLatin1String OPTIONS_ONLINE_NETWORK_DEBUG("Options/OnlineNetworkDebug");
 const QLatin1String OPTIONS_ONLINE_NETWORK_MAX_SHADOW_DIST_NM("Options/MaxShadowDistNm");
@@ -363,6 +366,9 @@ const QLatin1String OPTIONS_ONLINE_NETWORK_MAX_SHADOW_HDG_DIFF_DEG("Options/MaxS
 const QLatin1String OPTIONS_TRACK_DEBUG("Options/TrackDebug");
 const QLatin1String OPTIONS_WIND_DEBUG("Options/WindDebug");
 const QLatin1String OPTIONS_WEBSERVER_DEBUG("Options/WebserverDebug");
+const QLatin1String OPTIONS_WEBSERVER_RENDER_CONTEXTS("Options/WebserverRenderContexts");
+const QLatin1String OPTIONS_WEBSERVER_STREAM_INTERVAL("Options/WebserverStreamIntervalMs");
+const QLatin1String OPTIONS_WEBSERVER_STREAM_MAX_CLIENTS("Options/WebserverStreamMaxClients");
 const QLatin1String OPTIONS_STORAGE_DEBUG("Options/StorageDebug");
 const QLatin1String OPTIONS_VERSION("Options/Version");
 const QLatin1String OPTIONS_NO_USER_AGENT("Options/NoUserAgent");
@@ -442,6 +448,10 @@ const QLatin1String STARTUP_FLIGHTPLAN("flight-plan");
 const QLatin1String STARTUP_FLIGHTPLAN_DESCR("flight-plan-descr");
 const QLatin1String STARTUP_AIRCRAFT_PERF("aircraft-perf");
 const QLatin1String STARTUP_LAYOUT("layout");
+const QLatin1String STARTUP_MAP_BENCHMARK("map-benchmark");
+const QLatin1String STARTUP_ROUTE_STRING_BATCH("route-string-batch");
+const QLatin1String STARTUP_ROUTE_STRING_BATCH_OUTPUT("route-string-batch-output");
+const QLatin1String STARTUP_ROUTE_STRING_BATCH_FORMAT("route-string-batch-format");
 
 /* Not used as long options */
 const QLatin1String STARTUP_OTHER_ARGUMENTS("others"); /* Positional arguments not found after option - string list */
@@ -454,6 +464,8 @@ const QLatin1String PROFILE_TRACK_SUFFIX("_profile.track");
 const QLatin1String LOGBOOK_TRACK_SUFFIX(".logbooktrack");
 const QLatin1String MAPSTYLE_INI_SUFFIX("_mapstyle.ini");
 const QLatin1String NIGHTSTYLE_INI_SUFFIX("_nightstyle.ini");
+const QLatin1String MAP_PROFILE_CSV_SUFFIX("_mapprofile.csv");
+const QLatin1String MAP_PROFILE_JSON_SUFFIX("_mapprofile.json");
 
 /*
  * Supported language for the online help system. Will be determined by presence of the file
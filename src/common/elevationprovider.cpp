@@ -18,6 +18,7 @@
 #include "common/elevationprovider.h"
 
 #include "common/constants.h"
+#include "common/globetiles.h"
 #include "geo/calculations.h"
 #include "app/navapp.h"
 #include "fs/common/globereader.h"
@@ -53,6 +54,7 @@ ElevationProvider::ElevationProvider(QObject *parent)
 
 ElevationProvider::~ElevationProvider()
 {
+  delete globeTiles;
   delete globeReader;
 }
 
@@ -64,17 +66,23 @@ void ElevationProvider::marbleUpdateAvailable()
 
 float ElevationProvider::getElevationMeter(const atools::geo::Pos& pos, float sampleRadiusMeter)
 {
-  if(isGlobeOfflineProvider())
+  float elevation = 0.f;
+
+  // Read lock allows concurrent reading and is only blocked when changing options
+  QReadLocker tilesLocker(&tilesLock);
+  if(globeTiles != nullptr)
+    elevation = globeTiles->getElevation(pos, sampleRadiusMeter);
+  else if(isGlobeOfflineProvider())
   {
+    // Fallback to serialized reader
     QMutexLocker locker(&mutex);
-    float elevation = globeReader->getElevation(pos, sampleRadiusMeter);
-    if(!(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID))
-      return 0.f;
-    else
-      return elevation;
+    elevation = globeReader->getElevation(pos, sampleRadiusMeter);
   }
-  else
+
+  if(!(elevation > atools::fs::common::OCEAN && elevation < atools::fs::common::INVALID))
     return 0.f;
+  else
+    return elevation;
 }
 
 float ElevationProvider::getElevationFt(const atools::geo::Pos& pos, float sampleRadiusMeter)
@@ -87,76 +95,117 @@ void ElevationProvider::getElevations(atools::geo::LineString& elevations, const
   if(!line.isValid())
     return;
 
+  getElevations(elevations, LineString(line.getPos1(), line.getPos2()), sampleRadiusMeter);
+}
+
+void ElevationProvider::getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& lineString,
+                                      float sampleRadiusMeter)
+{
+  if(lineString.size() < 2)
+    return;
+
+  // Read lock allows concurrent reading and is only blocked when changing options
+  QReadLocker tilesLocker(&tilesLock);
+  if(globeTiles != nullptr)
+  {
+    LineString temp;
+    globeTiles->getElevations(temp, lineString, sampleRadiusMeter);
+    correctElevations(temp);
+    elevations.append(temp);
+    return;
+  }
+
+  // Fallback to serialized reader or online data
   QMutexLocker locker(&mutex);
+  LineString temp;
+  for(int i = 0; i < lineString.size() - 1; i++)
+  {
+    const Line line(lineString.at(i), lineString.at(i + 1));
+    if(!line.isValid())
+      continue;
+
+    LineString segment;
+    if(isGlobeOfflineProvider())
+      globeReader->getElevations(segment, LineString(line.getPos1(), line.getPos2()), sampleRadiusMeter);
+    else if(marbleModel != nullptr)
+      marbleElevations(segment, line);
+
+    // Avoid duplicates at segment joints
+    if(!temp.isEmpty() && !segment.isEmpty() && temp.constLast().almostEqual(segment.constFirst(), Pos::POS_EPSILON_10M))
+      segment.removeFirst();
+    temp.append(segment);
+  }
+
+  correctElevations(temp);
+  elevations.append(temp);
+}
 
-  if(isGlobeOfflineProvider())
+void ElevationProvider::correctElevations(atools::geo::LineString& elevations)
+{
+  for(Pos& pos : elevations)
   {
-    globeReader->getElevations(elevations, LineString(line.getPos1(), line.getPos2()), sampleRadiusMeter);
-    for(Pos& pos : elevations)
-    {
-      float alt = pos.getAltitude();
-      if(!(alt > atools::fs::common::OCEAN && alt < atools::fs::common::INVALID))
-        // Reset all invalid and ocean indicators to 0
-        pos.setAltitude(0.f);
-    }
+    float alt = pos.getAltitude();
+    if(!(alt > atools::fs::common::OCEAN && alt < atools::fs::common::INVALID))
+      // Reset all invalid and ocean indicators to 0
+      pos.setAltitude(0.f);
+    else
+      // Limit ground altitude
+      pos.setAltitude(std::min(alt, ALTITUDE_LIMIT_METER));
   }
-  else if(marbleModel != nullptr)
+}
+
+void ElevationProvider::marbleElevations(atools::geo::LineString& elevations, const atools::geo::Line& line)
+{
+  // Get altitude points for the line segment
+  // The might not be complete and will be more complete on further iterations when we get a signal
+  // from the elevation model
+  QVector<GeoDataCoordinates> temp = marbleModel->heightProfile(line.getPos1().getLonX(), line.getPos1().getLatY(),
+                                                                line.getPos2().getLonX(), line.getPos2().getLatY());
+
+  // Limit long legs to a maximum of 2000 points - minimum of 1000 points
+  int divisor = 1;
+  while(temp.size() / divisor > 2000)
+    divisor++;
+
+  int i = 0;
+  Pos lastDropped;
+  for(const GeoDataCoordinates& c : temp)
   {
-    // Get altitude points for the line segment
-    // The might not be complete and will be more complete on further iterations when we get a signal
-    // from the elevation model
-    QVector<GeoDataCoordinates> temp = marbleModel->heightProfile(line.getPos1().getLonX(), line.getPos1().getLatY(),
-                                                                  line.getPos2().getLonX(), line.getPos2().getLatY());
-
-    // Limit long legs to a maximum of 2000 points - minimum of 1000 points
-    int divisor = 1;
-    while(temp.size() / divisor > 2000)
-      divisor++;
-
-    int i = 0;
-    Pos lastDropped;
-    for(const GeoDataCoordinates& c : temp)
-    {
-      if((i++ % divisor) != 0)
-        continue;
+    if((i++ % divisor) != 0)
+      continue;
 
-      Pos pos(c.longitude(), c.latitude(), c.altitude());
-      pos.toDeg();
+    Pos pos(c.longitude(), c.latitude(), c.altitude());
+    pos.toDeg();
 
-      if(!elevations.isEmpty())
+    if(!elevations.isEmpty())
+    {
+      if(atools::almostEqual(elevations.constLast().getAltitude(), pos.getAltitude(), SAME_ONLINE_ELEVATION_EPSILON))
       {
-        if(atools::almostEqual(elevations.constLast().getAltitude(), pos.getAltitude(), SAME_ONLINE_ELEVATION_EPSILON))
-        {
-          // Drop points with similar altitude
-          lastDropped = pos;
-          continue;
-        }
-        else if(lastDropped.isValid())
-        {
-          // Add last point of a stretch with similar altitude
-          elevations.append(lastDropped);
-          lastDropped = Pos();
-        }
+        // Drop points with similar altitude
+        lastDropped = pos;
+        continue;
+      }
+      else if(lastDropped.isValid())
+      {
+        // Add last point of a stretch with similar altitude
+        elevations.append(lastDropped);
+        lastDropped = Pos();
       }
-      elevations.append(pos);
-    }
-
-    if(elevations.isEmpty())
-    {
-      // Workaround for invalid geometry data - add void
-      elevations.append(line.getPos1());
-      elevations.append(line.getPos2());
     }
+    elevations.append(pos);
   }
 
-  for(Pos& pos : elevations)
-    // Limit ground altitude
-    pos.setAltitude(std::min(pos.getAltitude(), ALTITUDE_LIMIT_METER));
+  if(elevations.isEmpty())
+  {
+    // Workaround for invalid geometry data - add void
+    elevations.append(line.getPos1());
+    elevations.append(line.getPos2());
+  }
 }
 
 bool ElevationProvider::isGlobeOfflineProvider() const
 {
-  return globeReader != nullptr && globeReader->isValid();
+  return (globeTiles != nullptr && globeTiles->isValid()) || (globeReader != nullptr && globeReader->isValid());
 }
 
 bool ElevationProvider::isGlobeDirValid()
@@ -193,38 +242,44 @@ void ElevationProvider::updateReader(bool startup)
 
   {
     // Make sure to wait for other methods to finish before changing the reader
+    QWriteLocker tilesLocker(&tilesLock);
     QMutexLocker locker(&mutex);
 
+    delete globeTiles;
+    globeTiles = nullptr;
+    delete globeReader;
+    globeReader = nullptr;
+
     if(useOffline)
     {
       if(!GlobeReader::isDirValid(path))
-      {
         warnWrongGlobePath = true;
-        delete globeReader;
-        globeReader = nullptr;
-      }
       else
       {
-        delete globeReader;
-        globeReader = new GlobeReader(path);
+        // Try memory mapped files first which allow concurrent access
+        globeTiles = new GlobeTiles(path);
+        if(globeTiles->open())
+          qDebug() << Q_FUNC_INFO << "Mapped GLOBE files";
+        else
+        {
+          delete globeTiles;
+          globeTiles = nullptr;
 
-        qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
+          globeReader = new GlobeReader(path);
 
-        if(!globeReader->openFiles())
-        {
-          delete globeReader;
-          globeReader = nullptr;
-          warnOpenFiles = true;
+          qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
+
+          if(!globeReader->openFiles())
+          {
+            delete globeReader;
+            globeReader = nullptr;
+            warnOpenFiles = true;
+          }
+          else
+            qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
         }
-        else
-          qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
       }
     }
-    else
-    {
-      delete globeReader;
-      globeReader = nullptr;
-    }
   }
 
   // Show this warning at startup and when changing options
@@ -20,6 +20,7 @@
 
 #include <QMutex>
 #include <QObject>
+#include <QReadWriteLock>
 
 namespace Marble {
 class ElevationModel;
@@ -39,10 +40,15 @@ class Line;
 }
 }
 
+class GlobeTiles;
+
 /*
  * Wraps the slow Marble online elevation provider and the fast offline GLOBE data provider.
  * Use GLOBE data if all paramters are set properly in settings.
  *
+ * GLOBE files are memory mapped if possible which allows concurrent reading from all threads.
+ * Falls back to the serialized GlobeReader if mapping fails.
+ *
  * Class is thread safe.
  */
 class ElevationProvider :
@@ -67,6 +73,9 @@ public:
    * "sampleRadiusMeter" defines a rectangle where five points are sampled for each pos and the maximum is used.*/
   void getElevations(atools::geo::LineString& elevations, const atools::geo::Line& line, float sampleRadiusMeter = 0.f);
 
+  /* As above but for all segments of a line string in one call. Elevations are appended. */
+  void getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& lineString, float sampleRadiusMeter = 0.f);
+
   /* true if the data is provided from the fast offline source */
   bool isGlobeOfflineProvider() const;
 
@@ -94,8 +103,18 @@ signals:
 private:
   void marbleUpdateAvailable();
   void updateReader(bool startup);
+  void marbleElevations(atools::geo::LineString& elevations, const atools::geo::Line& line);
+
+  /* Reset invalid and ocean indicators and limit altitude */
+  static void correctElevations(atools::geo::LineString& elevations);
 
   const Marble::ElevationModel *marbleModel = nullptr;
+
+  /* Memory mapped GLOBE files. Read concurrently under read lock which is only locked for writing when changing options. */
+  GlobeTiles *globeTiles = nullptr;
+  mutable QReadWriteLock tilesLock;
+
+  /* Fallback if files cannot be mapped */
   atools::fs::common::GlobeReader *globeReader = nullptr;
 
   /* Need to synchronize here since it is called from profile widget thread */
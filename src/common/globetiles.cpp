@@ -0,0 +1,189 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "common/globetiles.h"
+
+#include "atools.h"
+#include "fs/common/globereader.h"
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "geo/pos.h"
+
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+
+using atools::geo::Pos;
+using atools::geo::LineString;
+
+/* Layout of the GLOBE data set. Four rows of four tiles from "a10g" at the north west to "p10g" at the south east.
+ * Each tile covers 90 degree longitude and 40 or 50 degree latitude with 30 arc second cells as 16 bit little endian values. */
+static const int NUM_TILES = 16;
+static const int TILE_COLUMNS = 10800;
+static const int CELLS_PER_DEGREE = 120;
+static const int TILE_ROWS[4] = {4800, 6000, 6000, 4800};
+static const double TILE_NORTH[4] = {90., 50., 0., -50.};
+
+/* Sample distance along lines */
+static const float SAMPLE_DISTANCE_METER = 500.f;
+
+GlobeTiles::GlobeTiles(const QString& pathParam)
+  : path(pathParam)
+{
+}
+
+GlobeTiles::~GlobeTiles()
+{
+  close();
+}
+
+bool GlobeTiles::open()
+{
+  close();
+
+  // Files can be lower or upper case depending on source
+  QDir dir(path);
+  QStringList files = dir.entryList({"?10g"}, QDir::Files);
+
+  tiles.resize(NUM_TILES);
+  for(int i = 0; i < NUM_TILES; i++)
+  {
+    QString name = QString(QChar('a' + i)) + "10g";
+    QString filename;
+    for(const QString& file : files)
+    {
+      if(file.compare(name, Qt::CaseInsensitive) == 0)
+        filename = dir.filePath(file);
+    }
+
+    Tile& tile = tiles[i];
+    tile.rows = TILE_ROWS[i / 4];
+
+    if(filename.isEmpty())
+    {
+      qWarning() << Q_FUNC_INFO << "GLOBE file" << name << "not found in" << path;
+      close();
+      return false;
+    }
+
+    tile.file = new QFile(filename);
+    qint64 size = static_cast<qint64>(tile.rows) * TILE_COLUMNS * 2;
+    if(!tile.file->open(QIODevice::ReadOnly) || tile.file->size() < size)
+    {
+      qWarning() << Q_FUNC_INFO << "Cannot open GLOBE file" << filename << tile.file->errorString();
+      close();
+      return false;
+    }
+
+    tile.data = tile.file->map(0, size);
+    if(tile.data == nullptr)
+    {
+      // Happens on 32 bit systems which cannot map all files
+      qWarning() << Q_FUNC_INFO << "Cannot map GLOBE file" << filename << tile.file->errorString();
+      close();
+      return false;
+    }
+  }
+
+  valid = true;
+  return true;
+}
+
+void GlobeTiles::close()
+{
+  valid = false;
+  for(Tile& tile : tiles)
+  {
+    if(tile.file != nullptr)
+    {
+      if(tile.data != nullptr)
+        tile.file->unmap(const_cast<uchar *>(tile.data));
+      tile.file->close();
+      delete tile.file;
+    }
+  }
+  tiles.clear();
+}
+
+float GlobeTiles::elevationAt(double lonx, double laty) const
+{
+  int tileCol = atools::minmax(0, 3, static_cast<int>((lonx + 180.) / 90.));
+  int tileRow = laty >= 50. ? 0 : (laty >= 0. ? 1 : (laty >= -50. ? 2 : 3));
+  const Tile& tile = tiles.at(tileRow * 4 + tileCol);
+
+  int col = atools::minmax(0, TILE_COLUMNS - 1, static_cast<int>((lonx + 180. - tileCol * 90.) * CELLS_PER_DEGREE));
+  int row = atools::minmax(0, tile.rows - 1, static_cast<int>((TILE_NORTH[tileRow] - laty) * CELLS_PER_DEGREE));
+
+  return qFromLittleEndian<qint16>(tile.data + (static_cast<qint64>(row) * TILE_COLUMNS + col) * 2);
+}
+
+float GlobeTiles::getElevation(const Pos& pos, float sampleRadiusMeter) const
+{
+  if(!valid || !pos.isValid())
+    return atools::fs::common::INVALID;
+
+  float elevation = elevationAt(pos.getLonX(), pos.getLatY());
+  if(sampleRadiusMeter > 0.f)
+  {
+    // Sample four more points around the center and use maximum
+    for(float angle : {0.f, 90.f, 180.f, 270.f})
+    {
+      Pos sample = pos.endpoint(sampleRadiusMeter, angle);
+      float sampleElevation = elevationAt(sample.getLonX(), sample.getLatY());
+      if(sampleElevation < atools::fs::common::INVALID)
+        elevation = std::max(elevation, sampleElevation);
+    }
+  }
+  return elevation;
+}
+
+void GlobeTiles::getElevations(LineString& elevations, const LineString& lineString, float sampleRadiusMeter) const
+{
+  if(!valid)
+    return;
+
+  Pos lastDropped;
+  for(int i = 0; i < lineString.size() - 1; i++)
+  {
+    const Pos& p1 = lineString.at(i), & p2 = lineString.at(i + 1);
+    float distance = p1.distanceMeterTo(p2);
+    int numSamples = std::max(static_cast<int>(distance / SAMPLE_DISTANCE_METER), 1);
+
+    // Start with second segment point for all but the first segment since it is already in the list
+    for(int j = i == 0 ? 0 : 1; j <= numSamples; j++)
+    {
+      Pos pos = j == 0 ? p1 : (j == numSamples ? p2 : p1.interpolate(p2, static_cast<float>(j) / numSamples));
+      pos.setAltitude(getElevation(pos, sampleRadiusMeter));
+
+      bool last = i == lineString.size() - 2 && j == numSamples;
+      if(!elevations.isEmpty() && !last &&
+         atools::almostEqual(elevations.constLast().getAltitude(), pos.getAltitude()))
+      {
+        // Drop points with same elevation
+        lastDropped = pos;
+        continue;
+      }
+      else if(lastDropped.isValid())
+      {
+        // Add last point of a stretch with same elevation
+        elevations.append(lastDropped);
+        lastDropped = Pos();
+      }
+      elevations.append(pos);
+    }
+  }
+}
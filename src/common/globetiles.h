@@ -0,0 +1,81 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_GLOBETILES_H
+#define LNM_GLOBETILES_H
+
+#include <QVector>
+
+class QFile;
+
+namespace atools {
+namespace geo {
+class Pos;
+class LineString;
+}
+}
+
+/*
+ * Read only access to the sixteen GLOBE elevation files which are memory mapped on opening.
+ * All read methods are const and can be called concurrently from any thread without locking once open() returned true.
+ *
+ * Returns atools::fs::common::OCEAN for ocean and atools::fs::common::INVALID for missing data like GlobeReader.
+ */
+class GlobeTiles
+{
+public:
+  explicit GlobeTiles(const QString& pathParam);
+  ~GlobeTiles();
+
+  GlobeTiles(const GlobeTiles& other) = delete;
+  GlobeTiles& operator=(const GlobeTiles& other) = delete;
+
+  /* Open and memory map all files. Returns false if a file is missing or cannot be mapped. */
+  bool open();
+
+  bool isValid() const
+  {
+    return valid;
+  }
+
+  /* Elevation in meter. "sampleRadiusMeter" defines a rectangle where five points are sampled and the maximum is used. */
+  float getElevation(const atools::geo::Pos& pos, float sampleRadiusMeter = 0.f) const;
+
+  /* Get elevations along all great circle segments of lineString. Creates a point every 500 meters and deletes
+   * consecutive ones with same elevation. Elevations are appended. */
+  void getElevations(atools::geo::LineString& elevations, const atools::geo::LineString& lineString,
+                     float sampleRadiusMeter = 0.f) const;
+
+private:
+  /* Elevation in meter or raw GLOBE indicator for the cell containing the coordinates */
+  float elevationAt(double lonx, double laty) const;
+
+  void close();
+
+  struct Tile
+  {
+    QFile *file = nullptr;
+    const uchar *data = nullptr;
+    int rows = 0;
+  };
+
+  QString path;
+  QVector<Tile> tiles;
+  bool valid = false;
+};
+
+#endif // LNM_GLOBETILES_H
@@ -84,6 +84,13 @@ namespace InfoBuilderTypes {
         const int zoomWeb;
         const qreal distanceUi;
         const qreal distanceWeb;
+        const QString unitDist;
+        const QString unitShortDist;
+        const QString unitAlt;
+        const QString unitSpeed;
+        const QString unitVertSpeed;
+        const QString unitWeight;
+        const QString unitVol;
     };
 
     /**
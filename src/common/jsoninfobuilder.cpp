@@ -327,120 +327,112 @@ QByteArray JsonInfoBuilder::uiinfo(UiInfoData uiInfoData) const
            { "zoom_web", data.zoomWeb},
            { "distance_ui", data.distanceUi},
            { "distance_web", data.distanceWeb},
+           { "units", {
+                 { "distance", qUtf8Printable(data.unitDist) },
+                 { "short_distance", qUtf8Printable(data.unitShortDist) },
+                 { "altitude", qUtf8Printable(data.unitAlt) },
+                 { "speed", qUtf8Printable(data.unitSpeed) },
+                 { "vertical_speed", qUtf8Printable(data.unitVertSpeed) },
+                 { "weight", qUtf8Printable(data.unitWeight) },
+                 { "volume", qUtf8Printable(data.unitVol) },
+             }},
        };
 
     return json.dump().data();
 }
 
-QByteArray JsonInfoBuilder::features(MapFeaturesData mapFeaturesData) const
+template<typename TYPE, typename TEXTFUNC>
+void JsonInfoBuilder::writeFeatures(QByteArray& out, const char *key, const QList<TYPE>& objects, map::MapType type,
+                                    const char *textKey, TEXTFUNC textFunc) const
 {
+    out.append('"').append(key).append("\":{\"count\":").append(QByteArray::number(objects.size())).append(",\"result\":[");
+
+    for(int i = 0; i < objects.size(); i++)
+    {
+        const TYPE& obj = objects.at(i);
+        if(i > 0)
+            out.append(',');
+
+        out.append("{\"object_id\":").append(QByteArray::number(obj.id));
+        out.append(",\"type_id\":").append(QByteArray::number(static_cast<qint64>(type)));
+        out.append(",\"ident\":");
+        writeString(out, obj.ident);
+        out.append(",\"").append(textKey).append("\":");
+        writeString(out, textFunc(obj));
+
+        // Same as coordinatesToJSON(getCoordinates(pos)) - zero for invalid
+        const atools::geo::Pos& pos = obj.position;
+        out.append(",\"position\":{\"lat\":").append(QByteArray::number(pos.isValid() ? pos.getLatY() : 0.f, 'g', 9));
+        out.append(",\"lon\":").append(QByteArray::number(pos.isValid() ? pos.getLonX() : 0.f, 'g', 9)).append('}');
+        out.append(",\"elevation\":").append(QByteArray::number(obj.getAltitude(), 'g', 9)).append('}');
+    }
+    out.append("]}");
+}
 
-    MapFeaturesData data = mapFeaturesData;
-
-    JSON json;
-
-       json = {
-           { "airports", JSON::object() },
-           { "ndbs", JSON::object() },
-           { "vors", JSON::object() },
-           { "markers", JSON::object() },
-           { "waypoints", JSON::object() },
-       };
-
-       json["airports"].push_back({ "count", data.airports.count() });
-       json["airports"].push_back({ "result", JSON::array() });
-
-       json["ndbs"].push_back({ "count", data.ndbs.count() });
-       json["ndbs"].push_back({ "result", JSON::array() });
-
-       json["vors"].push_back({ "count", data.vors.count() });
-       json["vors"].push_back({ "result", JSON::array() });
-
-       json["markers"].push_back({ "count", data.markers.count() });
-       json["markers"].push_back({ "result", JSON::array() });
-
-       json["waypoints"].push_back({ "count", data.waypoints.count() });
-       json["waypoints"].push_back({ "result", JSON::array() });
-
-
-
-       for(int i = 0; i < data.airports.count(); ++i){
-
-           map::MapAirport airport =  data.airports[i];
-
-           json["airports"]["result"][i]["object_id"] = airport.id;
-           json["airports"]["result"][i]["type_id"] = map::AIRPORT;
-           json["airports"]["result"][i]["ident"] = qUtf8Printable(airport.ident);
-           json["airports"]["result"][i]["name"] = qUtf8Printable(airport.name);
-           json["airports"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(airport.position));
-           json["airports"]["result"][i]["elevation"] =  airport.getAltitude();
-
-//           JSON airportJson;
-
-//           airportJson = {
-//               { "ident", qUtf8Printable(airport.ident) },
-//               { "name", qUtf8Printable(airport.name)},
-//               { "position", coordinatesToJSON(getCoordinates(airport.position))},
-//               { "elevation", airport.getPosition().getAltitude() },
-//           };
-
-//           json["airports"]["result"].push_back(airportJson);
-       }
-
-       for(int i = 0; i < data.ndbs.count(); ++i){
-
-           map::MapNdb ndb =  data.ndbs[i];
-
-           json["ndbs"]["result"][i]["object_id"] = ndb.id;
-           json["ndbs"]["result"][i]["type_id"] = map::NDB;
-           json["ndbs"]["result"][i]["ident"] = qUtf8Printable(ndb.ident);
-           json["ndbs"]["result"][i]["name"] = qUtf8Printable(ndb.name);
-           json["ndbs"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(ndb.position));
-           json["ndbs"]["result"][i]["elevation"] =  ndb.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.vors.count(); ++i){
-
-           map::MapVor vor =  data.vors[i];
-
-           json["vors"]["result"][i]["object_id"] = vor.id;
-           json["vors"]["result"][i]["type_id"] = map::VOR;
-           json["vors"]["result"][i]["ident"] = qUtf8Printable(vor.ident);
-           json["vors"]["result"][i]["name"] = qUtf8Printable(vor.name);
-           json["vors"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(vor.position));
-           json["vors"]["result"][i]["elevation"] =  vor.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.markers.count(); ++i){
-
-           map::MapMarker marker =  data.markers[i];
-
-           json["markers"]["result"][i]["object_id"] = marker.id;
-           json["markers"]["result"][i]["type_id"] = map::MARKER;
-           json["markers"]["result"][i]["ident"] = qUtf8Printable(marker.ident);
-           json["markers"]["result"][i]["type"] = qUtf8Printable(marker.type);
-           json["markers"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(marker.position));
-           json["markers"]["result"][i]["elevation"] =  marker.getAltitude();
-
-       }
-
-       for(int i = 0; i < data.waypoints.count(); ++i){
-
-           map::MapWaypoint waypoint =  data.waypoints[i];
-
-           json["waypoints"]["result"][i]["object_id"] = waypoint.id;
-           json["waypoints"]["result"][i]["type_id"] = map::WAYPOINT;
-           json["waypoints"]["result"][i]["ident"] = qUtf8Printable(waypoint.ident);
-           json["waypoints"]["result"][i]["type"] = qUtf8Printable(waypoint.type);
-           json["waypoints"]["result"][i]["position"] = coordinatesToJSON(getCoordinates(waypoint.position));
-           json["waypoints"]["result"][i]["elevation"] =  waypoint.getAltitude();
-
-       }
-
-    return json.dump().data();
+void JsonInfoBuilder::writeString(QByteArray& out, const QString& str)
+{
+    out.append('"');
+    for(char c : str.toUtf8())
+    {
+        switch(c)
+        {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                    // Other control characters
+                    out.append(QString("\\u%1").arg(static_cast<int>(c), 4, 16, QChar('0')).toLatin1());
+                else
+                    out.append(c);
+        }
+    }
+    out.append('"');
+}
 
+QByteArray JsonInfoBuilder::features(MapFeaturesData mapFeaturesData) const
+{
+    // Write directly into the buffer instead of building a JSON document first.
+    // Result is equal to feature() but not sorted by key.
+    QByteArray out;
+    out.reserve(256 + (mapFeaturesData.airports.size() + mapFeaturesData.ndbs.size() + mapFeaturesData.vors.size() +
+                       mapFeaturesData.markers.size() + mapFeaturesData.waypoints.size()) * 160);
+
+    out.append('{');
+    writeFeatures(out, "airports", mapFeaturesData.airports, map::AIRPORT, "name", [](const map::MapAirport& obj) {
+        return obj.name;
+    });
+    out.append(',');
+    writeFeatures(out, "ndbs", mapFeaturesData.ndbs, map::NDB, "name", [](const map::MapNdb& obj) {
+        return obj.name;
+    });
+    out.append(',');
+    writeFeatures(out, "vors", mapFeaturesData.vors, map::VOR, "name", [](const map::MapVor& obj) {
+        return obj.name;
+    });
+    out.append(',');
+    writeFeatures(out, "markers", mapFeaturesData.markers, map::MARKER, "type", [](const map::MapMarker& obj) {
+        return obj.type;
+    });
+    out.append(',');
+    writeFeatures(out, "waypoints", mapFeaturesData.waypoints, map::WAYPOINT, "type", [](const map::MapWaypoint& obj) {
+        return obj.type;
+    });
+    out.append('}');
+
+    return out;
 }
 
 QByteArray JsonInfoBuilder::feature(MapFeaturesData mapFeaturesData) const
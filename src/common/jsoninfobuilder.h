@@ -19,6 +19,7 @@
 #define JSONINFOBUILDER_H
 
 #include "common/abstractinfobuilder.h"
+#include "common/mapflags.h"
 
 // Use JSON library
 #include "json/nlohmann/json.hpp"
@@ -46,6 +47,14 @@ public:
 
 private:
   JSON coordinatesToJSON(QMap<QString,float> map) const;
+
+  /* Append "key":{"count":n,"result":[...]} for the map objects to out */
+  template<typename TYPE, typename TEXTFUNC>
+  void writeFeatures(QByteArray& out, const char *key, const QList<TYPE>& objects, map::MapType type,
+                     const char *textKey, TEXTFUNC textFunc) const;
+
+  /* Append quoted and escaped UTF-8 string */
+  static void writeString(QByteArray& out, const QString& str);
 };
 
 #endif // JSONINFOBUILDER_H
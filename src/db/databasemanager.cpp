@@ -128,17 +128,28 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_TRACK);
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_LOGBOOK);
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_ONLINE);
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_ONLINE_STAGING);
 
     // Airspace databases
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_USER_AIRSPACE);
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_SIM_AIRSPACE);
     SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_NAV_AIRSPACE);
 
+    // Web API databases
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_SIM_WEB);
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_NAV_WEB);
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_TRACK_WEB);
+
+    // Route network loading databases
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_NAV_ROUTE);
+    SqlDatabase::addDatabase(dbtools::DATABASE_TYPE, dbtools::DATABASE_NAME_TRACK_ROUTE);
+
     // Variable databases (user can edit or program downloads data)
     databaseUser = new SqlDatabase(dbtools::DATABASE_NAME_USER);
     databaseTrack = new SqlDatabase(dbtools::DATABASE_NAME_TRACK);
     databaseLogbook = new SqlDatabase(dbtools::DATABASE_NAME_LOGBOOK);
     databaseOnline = new SqlDatabase(dbtools::DATABASE_NAME_ONLINE);
+    databaseOnlineStaging = new SqlDatabase(dbtools::DATABASE_NAME_ONLINE_STAGING);
 
     // Airspace databases
     databaseUserAirspace = new SqlDatabase(dbtools::DATABASE_NAME_USER_AIRSPACE);
@@ -147,6 +158,15 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     databaseSimAirspace = new SqlDatabase(dbtools::DATABASE_NAME_SIM_AIRSPACE);
     databaseNavAirspace = new SqlDatabase(dbtools::DATABASE_NAME_NAV_AIRSPACE);
 
+    // ... as duplicate connections to sim, nav and track databases following the nav switch for web API threads
+    databaseSimWeb = new SqlDatabase(dbtools::DATABASE_NAME_SIM_WEB);
+    databaseNavWeb = new SqlDatabase(dbtools::DATABASE_NAME_NAV_WEB);
+    databaseTrackWeb = new SqlDatabase(dbtools::DATABASE_NAME_TRACK_WEB);
+
+    // ... as duplicate connections to nav and track databases for loading the route network in background
+    databaseNavRoute = new SqlDatabase(dbtools::DATABASE_NAME_NAV_ROUTE);
+    databaseTrackRoute = new SqlDatabase(dbtools::DATABASE_NAME_TRACK_ROUTE);
+
     // Open user point database =================================
     openWriteableDatabase(databaseUser, "userdata", "user", true /* backup */);
     userdataManager = new atools::fs::userdata::UserdataManager(databaseUser);
@@ -179,6 +199,14 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     trackManager->createSchema(false /* verboseLogging */);
     // trackManager->initQueries();
 
+    // Read only connection for web API threads - no exclusive lock since tracks are written in the main thread
+    dbtools::openDatabaseFileExt(databaseTrackWeb, databaseTrack->databaseName(), true /* readonly */,
+                                 false /* createSchema */, false /* exclusive */, false /* auto transactions */);
+
+    // Same for route network loading thread
+    dbtools::openDatabaseFileExt(databaseTrackRoute, databaseTrack->databaseName(), true /* readonly */,
+                                 false /* createSchema */, false /* exclusive */, false /* auto transactions */);
+
     // Open online network database ==============================
     atools::settings::Settings& settings = atools::settings::Settings::instance();
     bool verbose = settings.getAndStoreValue(lnm::OPTIONS_WHAZZUP_PARSER_DEBUG, false).toBool();
@@ -188,6 +216,12 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     onlinedataManager->createSchema();
     onlinedataManager->initQueries();
 
+    // Files are parsed into the staging database in background and then copied into the database above
+    openWriteableDatabase(databaseOnlineStaging, "onlinedata_staging", "online network staging", false /* backup */);
+    onlinedataManagerStaging = new atools::fs::online::OnlinedataManager(databaseOnlineStaging, verbose);
+    onlinedataManagerStaging->createSchema();
+    onlinedataManagerStaging->initQueries();
+
     if(migrate::getOptionsVersion().isValid() && migrate::getOptionsVersion() <= atools::util::Version("2.8.1.beta"))
     {
       qDebug() << Q_FUNC_INFO << "Cleaning undo/redo in logbook and userdata";
@@ -246,6 +280,7 @@ DatabaseManager::~DatabaseManager()
   qDebug() << Q_FUNC_INFO << "delete onlinedataManager";
 #endif
   delete onlinedataManager;
+  delete onlinedataManagerStaging;
 
   closeAllDatabases();
   closeUserDatabase();
@@ -271,6 +306,7 @@ DatabaseManager::~DatabaseManager()
 
   qDebug() << Q_FUNC_INFO << "delete databaseOnline";
   delete databaseOnline;
+  delete databaseOnlineStaging;
 
   qDebug() << Q_FUNC_INFO << "delete databaseUserAirspace";
   delete databaseUserAirspace;
@@ -281,6 +317,15 @@ DatabaseManager::~DatabaseManager()
   qDebug() << Q_FUNC_INFO << "delete databaseNavAirspace";
   delete databaseNavAirspace;
 
+  qDebug() << Q_FUNC_INFO << "delete web databases";
+  delete databaseSimWeb;
+  delete databaseNavWeb;
+  delete databaseTrackWeb;
+
+  qDebug() << Q_FUNC_INFO << "delete route databases";
+  delete databaseNavRoute;
+  delete databaseTrackRoute;
+
   qDebug() << Q_FUNC_INFO << "delete languageIndex";
   delete languageIndex;
 
@@ -297,6 +342,11 @@ DatabaseManager::~DatabaseManager()
   SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_USER_AIRSPACE);
   SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_SIM_AIRSPACE);
   SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_NAV_AIRSPACE);
+  SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_SIM_WEB);
+  SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_NAV_WEB);
+  SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_TRACK_WEB);
+  SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_NAV_ROUTE);
+  SqlDatabase::removeDatabase(dbtools::DATABASE_NAME_TRACK_ROUTE);
 }
 
 bool DatabaseManager::checkIncompatibleDatabases(bool *databasesErased)
@@ -1073,6 +1123,8 @@ void DatabaseManager::closeUserDatabase()
 
 void DatabaseManager::closeTrackDatabase()
 {
+  dbtools::closeDatabaseFile(databaseTrackWeb);
+  dbtools::closeDatabaseFile(databaseTrackRoute);
   dbtools::closeDatabaseFile(databaseTrack);
 }
 
@@ -1089,6 +1141,7 @@ void DatabaseManager::closeLogDatabase()
 void DatabaseManager::closeOnlineDatabase()
 {
   dbtools::closeDatabaseFile(databaseOnline);
+  dbtools::closeDatabaseFile(databaseOnlineStaging);
 }
 
 void DatabaseManager::clearLanguageIndex()
@@ -1137,6 +1190,13 @@ void DatabaseManager::openAllDatabases()
 
   dbtools::openDatabaseFile(databaseSimAirspace, simAirspaceDbFile, true /* readonly */, true /* createSchema */);
   dbtools::openDatabaseFile(databaseNavAirspace, navAirspaceDbFile, true /* readonly */, true /* createSchema */);
+
+  // Web databases follow the switch
+  dbtools::openDatabaseFile(databaseSimWeb, simDbFile, true /* readonly */, true /* createSchema */);
+  dbtools::openDatabaseFile(databaseNavWeb, navDbFile, true /* readonly */, true /* createSchema */);
+
+  // Route network is loaded from the same nav database as the main connection
+  dbtools::openDatabaseFile(databaseNavRoute, navDbFile, true /* readonly */, true /* createSchema */);
 }
 
 void DatabaseManager::closeAllDatabases()
@@ -1145,6 +1205,9 @@ void DatabaseManager::closeAllDatabases()
   dbtools::closeDatabaseFile(databaseNav);
   dbtools::closeDatabaseFile(databaseSimAirspace);
   dbtools::closeDatabaseFile(databaseNavAirspace);
+  dbtools::closeDatabaseFile(databaseSimWeb);
+  dbtools::closeDatabaseFile(databaseNavWeb);
+  dbtools::closeDatabaseFile(databaseNavRoute);
 }
 
 void DatabaseManager::checkForChangedNavAndSimDatabases()
@@ -161,6 +161,33 @@ public:
     return databaseNavAirspace;
   }
 
+  /* Duplicate connections for web API threads. Sim and nav follow the nav switch. */
+  atools::sql::SqlDatabase *getDatabaseSimWeb()
+  {
+    return databaseSimWeb;
+  }
+
+  atools::sql::SqlDatabase *getDatabaseNavWeb()
+  {
+    return databaseNavWeb;
+  }
+
+  atools::sql::SqlDatabase *getDatabaseTrackWeb()
+  {
+    return databaseTrackWeb;
+  }
+
+  /* Duplicate connections for loading the route network in a background thread. Nav follows the nav switch. */
+  atools::sql::SqlDatabase *getDatabaseNavRoute()
+  {
+    return databaseNavRoute;
+  }
+
+  atools::sql::SqlDatabase *getDatabaseTrackRoute()
+  {
+    return databaseTrackRoute;
+  }
+
   /*
    * Insert actions for switching between installed flight simulators.
    * Actions have to be freed by the caller and are connected to switchSim
@@ -226,6 +253,12 @@ public:
     return onlinedataManager;
   }
 
+  /* Used to parse online network files in background */
+  atools::fs::online::OnlinedataManager *getOnlinedataManagerStaging() const
+  {
+    return onlinedataManagerStaging;
+  }
+
   atools::sql::SqlDatabase *getDatabaseUser() const
   {
     return databaseUser;
@@ -371,7 +404,13 @@ private:
   *databaseUserAirspace = nullptr /* Database for user airspaces */,
   *databaseSimAirspace = nullptr /* Airspace database from simulator independent from nav switch */,
   *databaseNavAirspace = nullptr /* Airspace database from navdata independent from nav switch */,
-  *databaseOnline = nullptr /* Database for network online data */;
+  *databaseSimWeb = nullptr /* Sim database for web API threads */,
+  *databaseNavWeb = nullptr /* Nav database for web API threads */,
+  *databaseTrackWeb = nullptr /* Track database for web API threads */,
+  *databaseNavRoute = nullptr /* Nav database for route network loading thread */,
+  *databaseTrackRoute = nullptr /* Track database for route network loading thread */,
+  *databaseOnline = nullptr /* Database for network online data */,
+  *databaseOnlineStaging = nullptr /* Network online data parsed in background */;
 
   bool showingDatabaseChangeWarning = false;
 
@@ -407,7 +446,7 @@ private:
   TrackManager *trackManager = nullptr;
   atools::fs::userdata::UserdataManager *userdataManager = nullptr;
   atools::fs::userdata::LogdataManager *logdataManager = nullptr;
-  atools::fs::online::OnlinedataManager *onlinedataManager = nullptr;
+  atools::fs::online::OnlinedataManager *onlinedataManager = nullptr, *onlinedataManagerStaging = nullptr;
 
   /* MSFS translations from table "translation" */
   atools::fs::scenery::LanguageJson *languageIndex = nullptr;
@@ -57,6 +57,13 @@ void openDatabaseFileExt(atools::sql::SqlDatabase *db, const QString& file, bool
 
   if(!readonly)
     databasePragmas.append("PRAGMA busy_timeout=2000");
+  else
+  {
+    // Map read-only databases into memory which avoids copying pages into the cache of each connection
+    qint64 mmapSizeMb = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "MmapSizeMb", 256).toLongLong();
+    if(mmapSizeMb > 0)
+      databasePragmas.append(QString("PRAGMA mmap_size=%1").arg(mmapSizeMb * 1024 * 1024));
+  }
 
   qDebug() << Q_FUNC_INFO << "Opening database" << file;
   db->setDatabaseName(file);
@@ -48,9 +48,19 @@ const QString DATABASE_NAME_USER_AIRSPACE = "LNMDBUSERAS";
 const QString DATABASE_NAME_SIM_AIRSPACE = "LNMDBSIMAS";
 const QString DATABASE_NAME_NAV_AIRSPACE = "LNMDBNAVAS";
 
+/* Duplicate connections to sim, nav and track databases used by web API threads */
+const QString DATABASE_NAME_SIM_WEB = "LNMDBSIMWEB";
+const QString DATABASE_NAME_NAV_WEB = "LNMDBNAVWEB";
+const QString DATABASE_NAME_TRACK_WEB = "LNMDBTRACKWEB";
+const QString DATABASE_NAME_NAV_ROUTE = "LNMDBNAVROUTE";
+const QString DATABASE_NAME_TRACK_ROUTE = "LNMDBTRACKROUTE";
+
 /* Network online player data */
 const QString DATABASE_NAME_ONLINE = "LNMDBONLINE";
 
+/* Network online data which is parsed in background before copying it to the database above */
+const QString DATABASE_NAME_ONLINE_STAGING = "LNMDBONLINESTAGING";
+
 /* Temporary database used for database checking, copying and preparation */
 const QString DATABASE_NAME_TEMP = "LNMTEMPDB";
 
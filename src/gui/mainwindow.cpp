@@ -50,6 +50,7 @@
 #include "logging/logginghandler.h"
 #include "mapgui/imageexportdialog.h"
 #include "mapgui/mapairporthandler.h"
+#include "mapgui/mapbenchmark.h"
 #include "mapgui/mapdetailhandler.h"
 #include "mapgui/mapmarkhandler.h"
 #include "mapgui/mapthemehandler.h"
@@ -65,6 +66,7 @@
 #include "route/routecontroller.h"
 #include "routeexport/routeexport.h"
 #include "routeexport/simbriefhandler.h"
+#include "routestring/routestringbatch.h"
 #include "routestring/routestringdialog.h"
 #include "routestring/routestringwriter.h"
 #include "search/airportsearch.h"
@@ -671,6 +673,7 @@ void MainWindow::debugActionTriggered8()
 
 void MainWindow::updateMap() const
 {
+  mapWidget->invalidateStaticLayer();
   mapWidget->update();
 }
 
@@ -1056,6 +1059,9 @@ void MainWindow::connectAllSlots()
   // Updated manually in dialog
   // connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getWebController(), &WebController::optionsChanged);
 
+  // Invalidate cached web server responses
+  connect(optionsDialog, &OptionsDialog::optionsChanged, NavApp::getWebController(), &WebController::stateChanged);
+
   // Style handler ===================================================================
   // Save complete state due to crashes in Qt
   AircraftPerfController *perfController = NavApp::getAircraftPerfController();
@@ -1067,6 +1073,7 @@ void MainWindow::connectAllSlots()
   connect(styleHandler, &StyleHandler::styleChanged, searchController, &SearchController::styleChanged);
   connect(styleHandler, &StyleHandler::styleChanged, mapWidget, &MapPaintWidget::styleChanged);
   connect(styleHandler, &StyleHandler::styleChanged, profileWidget, &ProfileWidget::styleChanged);
+  connect(styleHandler, &StyleHandler::styleChanged, NavApp::getWebController(), &WebController::stateChanged);
   connect(styleHandler, &StyleHandler::styleChanged, perfController, &AircraftPerfController::optionsChanged);
   connect(styleHandler, &StyleHandler::styleChanged, infoController, &InfoController::styleChanged);
   connect(styleHandler, &StyleHandler::styleChanged, optionsDialog, &OptionsDialog::styleChanged);
@@ -1253,6 +1260,7 @@ void MainWindow::connectAllSlots()
 
   // Update search
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, clientSearch, &OnlineClientSearch::refreshData);
+  connect(onlinedataController, &OnlinedataController::onlineClientsUpdated, clientSearch, &OnlineClientSearch::refreshData);
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, centerSearch, &OnlineCenterSearch::refreshData);
   connect(onlinedataController, &OnlinedataController::onlineServersUpdated, serverSearch, &OnlineServerSearch::refreshData);
 
@@ -1260,11 +1268,14 @@ void MainWindow::connectAllSlots()
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated,
           NavApp::getAirspaceController(), &AirspaceController::onlineClientAndAtcUpdated);
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, mapWidget, &MapPaintWidget::onlineClientAndAtcUpdated);
+  connect(onlinedataController, &OnlinedataController::onlineClientsUpdated, mapWidget, &MapPaintWidget::onlineClientsUpdated);
   connect(onlinedataController, &OnlinedataController::onlineNetworkChanged, mapWidget, &MapPaintWidget::onlineNetworkChanged);
 
   // Update info
   connect(onlinedataController, &OnlinedataController::onlineClientAndAtcUpdated, infoController,
           &InfoController::onlineClientAndAtcUpdated);
+  connect(onlinedataController, &OnlinedataController::onlineClientsUpdated, infoController,
+          &InfoController::onlineClientAndAtcUpdated);
   connect(onlinedataController, &OnlinedataController::onlineNetworkChanged, infoController, &InfoController::onlineNetworkChanged);
 
   connect(onlinedataController, &OnlinedataController::onlineNetworkChanged,
@@ -1499,6 +1510,7 @@ void MainWindow::connectAllSlots()
 
   // Airway/tracks =======================================================
   TrackController *trackController = NavApp::getTrackController();
+  connect(trackController, &TrackController::preTrackLoad, routeController, &RouteController::preTrackLoad);
   connect(trackController, &TrackController::postTrackLoad, routeController, &RouteController::clearAirwayNetworkCache);
   connect(trackController, &TrackController::postTrackLoad, infoController, &InfoController::tracksChanged);
   connect(trackController, &TrackController::postTrackLoad, this, &MainWindow::updateMapObjectsShown);
@@ -1608,6 +1620,7 @@ void MainWindow::connectAllSlots()
   connect(connectClient, &ConnectClient::dataPacketReceived, profileWidget, &ProfileWidget::simDataChanged);
   connect(connectClient, &ConnectClient::dataPacketReceived, infoController, &InfoController::simDataChanged);
   connect(connectClient, &ConnectClient::dataPacketReceived, NavApp::getAircraftPerfController(), &AircraftPerfController::simDataChanged);
+  connect(connectClient, &ConnectClient::dataPacketReceived, NavApp::getWebController(), &WebController::simDataChanged);
 
   connect(connectClient, &ConnectClient::connectedToSimulator,
           NavApp::getAircraftPerfController(), &AircraftPerfController::connectedToSimulator);
@@ -1615,6 +1628,12 @@ void MainWindow::connectAllSlots()
           NavApp::getAircraftPerfController(), &AircraftPerfController::disconnectedFromSimulator);
 
   connect(connectClient, &ConnectClient::disconnectedFromSimulator, routeController, &RouteController::disconnectedFromSimulator);
+  connect(connectClient, &ConnectClient::disconnectedFromSimulator, NavApp::getWebController(), &WebController::disconnectedFromSimulator);
+
+  // Keep snapshots for web server threads up to date
+  connect(routeController, &RouteController::routeChanged, NavApp::getWebController(), &WebController::routeChanged);
+  connect(routeController, &RouteController::routeAltitudeChanged, NavApp::getWebController(), &WebController::routeChanged);
+  connect(mapWidget, &MapPaintWidget::visibleLatLonAltBoxChanged, NavApp::getWebController(), &WebController::mapViewChanged);
 
   connect(connectClient, &ConnectClient::disconnectedFromSimulator, this, &MainWindow::sunShadingTimeChanged);
 
@@ -3424,6 +3443,14 @@ void MainWindow::mainWindowShownDelayed()
   // Update the information display later delayed to avoid long loading times due to weather timeout
   QTimer::singleShot(50, infoController, &InfoController::restoreInformation);
 
+  // Run benchmark once flight plan and map are loaded
+  if(!NavApp::getStartupOptionStr(lnm::STARTUP_MAP_BENCHMARK).isEmpty())
+    QTimer::singleShot(2000, this, &MainWindow::runMapBenchmark);
+
+  // Convert route descriptions once databases are loaded
+  if(!NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH).isEmpty())
+    QTimer::singleShot(0, this, &MainWindow::runRouteStringBatch);
+
 #ifdef DEBUG_INFORMATION
   qDebug() << "mapDistanceLabel->size()" << mapDistanceLabel->size();
   qDebug() << "mapPositionLabel->size()" << mapPositionLabel->size();
@@ -3437,6 +3464,36 @@ void MainWindow::mainWindowShownDelayed()
   qDebug() << Q_FUNC_INFO << "leave";
 }
 
+void MainWindow::runMapBenchmark()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  bool ok = false;
+  {
+    MapBenchmark benchmark(this, NavApp::getStartupOptionStr(lnm::STARTUP_MAP_BENCHMARK));
+    ok = benchmark.run();
+  }
+
+  // Exit without asking for unsaved changes and without saving settings to keep benchmarks reproducible
+  QCoreApplication::exit(ok ? 0 : 1);
+}
+
+void MainWindow::runRouteStringBatch()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  bool ok = false;
+  {
+    RouteStringBatch batch(NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH),
+                           NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH_OUTPUT),
+                           NavApp::getStartupOptionStr(lnm::STARTUP_ROUTE_STRING_BATCH_FORMAT));
+    ok = batch.run();
+  }
+
+  // Exit without asking for unsaved changes since the loaded flight plan is not touched
+  QCoreApplication::exit(ok ? 0 : 1);
+}
+
 void MainWindow::runDirToolManual()
 {
   runDirTool(true /* manual */);
@@ -284,6 +284,10 @@ private:
   void mainWindowShown();
   void mainWindowShownDelayed();
 
+  /* Render map benchmark sequences offscreen, save results and exit. Started by command line option. */
+  void runMapBenchmark();
+  void runRouteStringBatch();
+
   /* Dock window functions */
   void raiseFloatingWindows();
   void hideTitleBar();
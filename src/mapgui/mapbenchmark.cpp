@@ -0,0 +1,248 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapbenchmark.h"
+
+#include "app/navapp.h"
+#include "geo/rect.h"
+#include "mapgui/mappaintwidget.h"
+#include "mapgui/mapwidget.h"
+#include "query/mapquery.h"
+#include "route/route.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPixmap>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+/* Frame time in ms for the given percentile 0.0 to 1.0 of the sorted list */
+static float percentile(const QVector<float>& sortedMs, float fraction)
+{
+  if(sortedMs.isEmpty())
+    return 0.f;
+
+  int index = static_cast<int>(std::ceil(fraction * sortedMs.size())) - 1;
+  return sortedMs.at(std::max(0, std::min(index, sortedMs.size() - 1)));
+}
+
+/* Number of legs visited at most in the route sequence */
+static const int MAX_ROUTE_FRAMES = 500;
+
+MapBenchmark::MapBenchmark(QWidget *parent, const QString& filenameParam, const QSize& sizeParam)
+  : filename(filenameParam), size(sizeParam)
+{
+  qDebug() << Q_FUNC_INFO << filename << size;
+
+  // Hidden map widget having its own query caches
+  mapPaintWidget = new MapPaintWidget(parent, false /* no real widget - hidden */);
+  mapPaintWidget->setActive();
+}
+
+MapBenchmark::~MapBenchmark()
+{
+  qDebug() << Q_FUNC_INFO;
+  delete mapPaintWidget;
+}
+
+bool MapBenchmark::run()
+{
+  qInfo() << Q_FUNC_INFO << "Starting map benchmark" << size;
+
+  frames.clear();
+
+  // Copy all map settings from the visible map
+  mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+  mapPaintWidget->setKeepWorldRect(false);
+
+  // Drop statistics from initialization
+  mapPaintWidget->getMapQuery()->takeTileCacheStats();
+
+  // First pass with empty caches and second pass with filled caches
+  for(int pass = 0; pass < 2; pass++)
+  {
+    runPanEurope(pass);
+    runZoom(pass);
+    runRoute(pass);
+  }
+
+  printSummary();
+  return saveCsv();
+}
+
+void MapBenchmark::runPanEurope(int pass)
+{
+  // West to east across central Europe and back along a more southern track
+  const float distanceKm = 800.f;
+  int index = 0;
+  for(float lonX = -10.f; lonX <= 30.f; lonX += 1.f)
+    renderPos("pan_europe", pass, index++, atools::geo::Pos(lonX, 50.f), distanceKm);
+  for(float lonX = 30.f; lonX >= -10.f; lonX -= 1.f)
+    renderPos("pan_europe", pass, index++, atools::geo::Pos(lonX, 45.f), distanceKm);
+}
+
+void MapBenchmark::runZoom(int pass)
+{
+  // Frankfurt airport - halve distance from world view down to airport diagram
+  const atools::geo::Pos pos(8.5706f, 50.0333f);
+  int index = 0;
+  for(float distanceKm = 20000.f; distanceKm >= 0.5f; distanceKm /= 2.f)
+    renderPos("zoom", pass, index++, pos, distanceKm);
+}
+
+void MapBenchmark::runRoute(int pass)
+{
+  const Route& route = NavApp::getRouteConst();
+  if(route.size() < 2)
+  {
+    if(pass == 0)
+      qWarning() << Q_FUNC_INFO << "No flight plan loaded. Skipping route sequence.";
+    return;
+  }
+
+  // Enable all airspaces for this sequence
+  map::MapAirspaceFilter airspaceFilter = mapPaintWidget->getShownAirspaces();
+  bool airspacesShown = mapPaintWidget->getShownMapTypes().testFlag(map::AIRSPACE);
+  mapPaintWidget->setShowMapAirspaces(map::MapAirspaceFilter(map::AIRSPACE_ALL, map::AIRSPACE_ALTITUDE_ALL, 0, 0));
+  mapPaintWidget->setShowMapObject(map::AIRSPACE, true);
+
+  // Whole flight plan first
+  int index = 0;
+  renderRect("route", pass, index++, NavApp::getRouteRect());
+
+  // Follow legs with a close zoom distance
+  int step = std::max(1, route.size() / MAX_ROUTE_FRAMES);
+  for(int i = 0; i < route.size(); i += step)
+    renderPos("route", pass, index++, route.value(i).getPosition(), 200.f);
+
+  mapPaintWidget->setShowMapAirspaces(airspaceFilter);
+  mapPaintWidget->setShowMapObject(map::AIRSPACE, airspacesShown);
+}
+
+void MapBenchmark::renderPos(const QString& sequence, int pass, int index, const atools::geo::Pos& pos, float distanceKm)
+{
+  if(pos.isValid())
+  {
+    mapPaintWidget->showPosNotAdjusted(pos, distanceKm);
+    renderFrame(sequence, pass, index);
+  }
+}
+
+void MapBenchmark::renderRect(const QString& sequence, int pass, int index, const atools::geo::Rect& rect)
+{
+  if(rect.isValid())
+  {
+    mapPaintWidget->showRectStreamlined(rect);
+    renderFrame(sequence, pass, index);
+  }
+}
+
+void MapBenchmark::renderFrame(const QString& sequence, int pass, int index)
+{
+  // Drop queries from other map widgets
+  query::takeExecCount();
+
+  QElapsedTimer timer;
+  timer.start();
+  mapPaintWidget->getPixmap(size.width(), size.height());
+  float frameMs = timer.nsecsElapsed() / 1000000.f;
+
+  Frame frame;
+  frame.sequence = sequence;
+  frame.pass = pass;
+  frame.index = index;
+  frame.distanceKm = static_cast<float>(mapPaintWidget->distance());
+  frame.frameMs = frameMs;
+  frame.queries = query::takeExecCount();
+  frame.cacheMisses = frame.cacheHits = 0;
+
+  for(const query::TileCacheStats& stats : mapPaintWidget->getMapQuery()->takeTileCacheStats())
+  {
+    frame.cacheMisses += stats.misses;
+    frame.cacheHits += stats.hits;
+  }
+  frames.append(frame);
+}
+
+void MapBenchmark::printSummary() const
+{
+  // Collect sequence names in order of appearance
+  QStringList sequences;
+  for(const Frame& frame : frames)
+  {
+    if(!sequences.contains(frame.sequence))
+      sequences.append(frame.sequence);
+  }
+
+  for(const QString& sequence : sequences)
+  {
+    for(int pass = 0; pass < 2; pass++)
+    {
+      QVector<float> frameMs;
+      int queries = 0, cacheMisses = 0, cacheHits = 0;
+      float totalMs = 0.f;
+      for(const Frame& frame : frames)
+      {
+        if(frame.sequence == sequence && frame.pass == pass)
+        {
+          frameMs.append(frame.frameMs);
+          totalMs += frame.frameMs;
+          queries += frame.queries;
+          cacheMisses += frame.cacheMisses;
+          cacheHits += frame.cacheHits;
+        }
+      }
+
+      if(frameMs.isEmpty())
+        continue;
+
+      std::sort(frameMs.begin(), frameMs.end());
+      qInfo().noquote().nospace() << "Map benchmark " << sequence << (pass == 0 ? " cold" : " warm")
+                                  << ": frames " << frameMs.size()
+                                  << ", fps " << QString::number(totalMs > 0.f ? frameMs.size() * 1000.f / totalMs : 0.f, 'f', 1)
+                                  << ", p50 " << QString::number(percentile(frameMs, 0.5f), 'f', 2) << " ms"
+                                  << ", p99 " << QString::number(percentile(frameMs, 0.99f), 'f', 2) << " ms"
+                                  << ", max " << QString::number(frameMs.constLast(), 'f', 2) << " ms"
+                                  << ", queries " << queries << ", tile cache misses " << cacheMisses << ", hits " << cacheHits;
+    }
+  }
+}
+
+bool MapBenchmark::saveCsv() const
+{
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    stream << "sequence,pass,index,distance_km,frame_ms,queries,tile_cache_misses,tile_cache_hits" << endl;
+
+    for(const Frame& frame : frames)
+      stream << frame.sequence << ',' << (frame.pass == 0 ? "cold" : "warm") << ',' << frame.index << ','
+             << QString::number(frame.distanceKm, 'f', 3) << ',' << QString::number(frame.frameMs, 'f', 3) << ','
+             << frame.queries << ',' << frame.cacheMisses << ',' << frame.cacheHits << endl;
+
+    file.close();
+    qInfo() << Q_FUNC_INFO << "Saved" << frames.size() << "frames to" << filename;
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPBENCHMARK_H
+#define LNM_MAPBENCHMARK_H
+
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+class Rect;
+}
+}
+
+class MapPaintWidget;
+class QWidget;
+
+/*
+ * Renders scripted view sequences into an offscreen map widget and reports frame times, the number of SQL queries
+ * executed by the map query classes and hits and misses of the MapQuery tile caches.
+ * Uses the same hidden MapPaintWidget as the web server and does not need a GPU.
+ * Run the program with "-platform offscreen" on Linux machines without display.
+ *
+ * Sequences are a pan across Europe, a zoom from world view down to an airport diagram and a walk along
+ * the loaded flight plan with all airspaces enabled. Each sequence is rendered twice to get
+ * numbers for empty (cold) and filled (warm) caches.
+ *
+ * Started by command line option "--map-benchmark <file>". Results are printed to the log and saved as CSV.
+ */
+class MapBenchmark
+{
+public:
+  MapBenchmark(QWidget *parent, const QString& filenameParam, const QSize& sizeParam = QSize(1920, 1080));
+  ~MapBenchmark();
+
+  MapBenchmark(const MapBenchmark& other) = delete;
+  MapBenchmark& operator=(const MapBenchmark& other) = delete;
+
+  /* Runs all sequences blocking, prints summary and saves the CSV file. Returns false if saving failed. */
+  bool run();
+
+private:
+  struct Frame
+  {
+    QString sequence;
+    int pass, index;
+    float distanceKm, frameMs;
+    int queries; /* SQL queries executed while rendering the frame */
+    int cacheMisses, cacheHits; /* Tiles loaded from database and tiles found in the MapQuery tile caches */
+  };
+
+  void runPanEurope(int pass);
+  void runZoom(int pass);
+  void runRoute(int pass);
+
+  /* Move map to position or rectangle and measure rendering into a pixmap */
+  void renderPos(const QString& sequence, int pass, int index, const atools::geo::Pos& pos, float distanceKm);
+  void renderRect(const QString& sequence, int pass, int index, const atools::geo::Rect& rect);
+  void renderFrame(const QString& sequence, int pass, int index);
+
+  void printSummary() const;
+  bool saveCsv() const;
+
+  MapPaintWidget *mapPaintWidget = nullptr;
+  QVector<Frame> frames;
+  QString filename;
+  QSize size;
+};
+
+#endif // LNM_MAPBENCHMARK_H
@@ -23,6 +23,7 @@
 #include "common/unit.h"
 #include "geo/calculations.h"
 #include "mapgui/aprongeometrycache.h"
+#include "mapgui/mapprefetch.h"
 #include "mapgui/mapscreenindex.h"
 #include "mapgui/mapthemehandler.h"
 #include "mappainter/mappaintlayer.h"
@@ -112,10 +113,16 @@ MapPaintWidget::MapPaintWidget(QWidget *parent, bool visible)
   waypointTrackQuery->initQueries();
 
   paintLayer->initQueries();
+
+  if(visibleWidget)
+    mapPrefetch = new MapPrefetch(this);
 }
 
 MapPaintWidget::~MapPaintWidget()
 {
+  qDebug() << Q_FUNC_INFO << "delete mapPrefetch";
+  delete mapPrefetch;
+
   removeLayer(paintLayer);
 
   // Have to delete manually since classes can be copied and does not delete in destructor
@@ -291,6 +298,9 @@ void MapPaintWidget::optionsChanged()
 {
   const OptionData& options = OptionData::instance();
 
+  // Colors, sizes and display options affect all painters
+  paintLayer->invalidateStaticLayer();
+
   // Pass API keys or tokens to map
   setKeys(NavApp::getMapThemeHandler()->getMapThemeKeysHash());
 
@@ -335,10 +345,18 @@ void MapPaintWidget::setShowMapSunShading(bool show)
   setShowSunShading(show);
 }
 
+void MapPaintWidget::invalidateStaticLayer()
+{
+  paintLayer->invalidateStaticLayer();
+}
+
 void MapPaintWidget::weatherUpdated()
 {
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::AIRPORT_WEATHER))
+  {
+    paintLayer->invalidateStaticLayer();
     update();
+  }
 
   updateMapVisibleUi();
 }
@@ -347,7 +365,10 @@ void MapPaintWidget::windDisplayUpdated()
 {
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::WIND_BARBS) ||
      paintLayer->getShownMapDisplayTypes().testFlag(map::WIND_BARBS_ROUTE))
+  {
+    paintLayer->invalidateStaticLayer();
     update();
+  }
 
   updateMapVisibleUi();
 }
@@ -513,6 +534,8 @@ void MapPaintWidget::preDatabaseLoad()
   cancelDragAll();
   databaseLoadStatus = true;
   apronGeometryCache->clear();
+  if(mapPrefetch != nullptr)
+    mapPrefetch->stop();
   paintLayer->preDatabaseLoad();
   mapQuery->deInitQueries();
   airwayTrackQuery->deInitQueries();
@@ -531,6 +554,7 @@ void MapPaintWidget::postDatabaseLoad()
   waypointTrackQuery->initQueries();
   mapQuery->initQueries();
   paintLayer->postDatabaseLoad();
+  paintLayer->invalidateStaticLayer();
   update();
   updateMapVisibleUiPostDatabaseLoad();
 }
@@ -906,6 +930,7 @@ void MapPaintWidget::showAircraft(bool centerAircraftChecked)
 void MapPaintWidget::changeRouteHighlights(const QList<int>& routeHighlight)
 {
   screenIndex->setRouteHighlights(routeHighlight);
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -921,6 +946,7 @@ void MapPaintWidget::routeChanged(bool geometryChanged)
     screenIndex->updateRouteScreenGeometry(getCurrentViewBoundingBox());
   }
   screenIndex->updateIlsScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -931,6 +957,7 @@ void MapPaintWidget::routeAltitudeChanged(float)
 
   qDebug() << Q_FUNC_INFO;
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -983,6 +1010,7 @@ void MapPaintWidget::clearSearchHighlights()
 
   screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -990,6 +1018,7 @@ void MapPaintWidget::clearAirspaceHighlights()
 {
   screenIndex->changeAirspaceHighlights(QList<map::MapAirspace>());
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -997,6 +1026,7 @@ void MapPaintWidget::clearAirwayHighlights()
 {
   screenIndex->changeAirwayHighlights(QList<QList<map::MapAirway> >());
   screenIndex->updateAirwayScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1045,6 +1075,7 @@ void MapPaintWidget::changeProcedureHighlights(const QVector<proc::MapProcedureL
   cancelDragAll();
   screenIndex->setProcedureHighlights(procedures);
   screenIndex->updateRouteScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1062,12 +1093,14 @@ void MapPaintWidget::changeProcedureHighlight(const proc::MapProcedureLegs& proc
   cancelDragAll();
   screenIndex->setProcedureHighlight(procedure);
   screenIndex->updateRouteScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
 void MapPaintWidget::changeProcedureLegHighlight(const proc::MapProcedureLeg& procedureLeg)
 {
   screenIndex->setProcedureLegHighlight(procedureLeg);
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1076,6 +1109,7 @@ void MapPaintWidget::changeAirspaceHighlights(const QList<map::MapAirspace>& air
 {
   screenIndex->changeAirspaceHighlights(airspaces);
   screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1084,6 +1118,7 @@ void MapPaintWidget::changeAirwayHighlights(const QList<QList<map::MapAirway> >&
 {
   screenIndex->changeAirwayHighlights(airways);
   screenIndex->updateAirwayScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1100,6 +1135,7 @@ void MapPaintWidget::changeSearchHighlights(const map::MapResult& newHighlights,
     screenIndex->updateLogEntryScreenGeometry(getCurrentViewBoundingBox());
   if(updateAirspace)
     screenIndex->updateAirspaceScreenGeometry(getCurrentViewBoundingBox());
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1108,6 +1144,7 @@ void MapPaintWidget::changeProfileHighlight(const atools::geo::Pos& pos)
   if(pos != screenIndex->getProfileHighlight())
   {
     screenIndex->setProfileHighlight(pos);
+    paintLayer->invalidateStaticLayer();
     update();
   }
 }
@@ -1149,6 +1186,7 @@ void MapPaintWidget::postTrackLoad()
 
   waypointTrackQuery->initQueries();
   airwayTrackQuery->initQueries();
+  paintLayer->invalidateStaticLayer();
 }
 
 void MapPaintWidget::cancelDragAll()
@@ -1343,6 +1381,10 @@ void MapPaintWidget::paintEvent(QPaintEvent *paintEvent)
         // Passed by queued connection - execute later in event loop
         emit resultTruncated();
       }
+
+      // Schedule loading of data for the next view after painting
+      if(mapPrefetch != nullptr && !databaseLoadStatus)
+        mapPrefetch->viewPainted(visibleLatLonBox);
     } // if(!active) ... else ...
 
     painting = false;
@@ -1367,6 +1409,13 @@ bool MapPaintWidget::loadKml(const QString& filename, bool center)
 void MapPaintWidget::onlineClientAndAtcUpdated()
 {
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  paintLayer->invalidateStaticLayer();
+  update();
+}
+
+void MapPaintWidget::onlineClientsUpdated()
+{
+  paintLayer->invalidateStaticLayer();
   update();
 }
 
@@ -1374,5 +1423,6 @@ void MapPaintWidget::onlineNetworkChanged()
 {
   screenIndex->resetAirspaceOnlineScreenGeometry();
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+  paintLayer->invalidateStaticLayer();
   update();
 }
@@ -59,6 +59,7 @@ class MainWindow;
 class MapPaintLayer;
 class MapScreenIndex;
 class ApronGeometryCache;
+class MapPrefetch;
 class MapQuery;
 class AirwayTrackQuery;
 class WaypointTrackQuery;
@@ -246,9 +247,15 @@ public:
   /* Update indexes for online network changes */
   void onlineClientAndAtcUpdated();
 
+  /* Only clients changed - centers and their screen geometry stay the same */
+  void onlineClientsUpdated();
+
   /* Whole online network has changed */
   void onlineNetworkChanged();
 
+  /* Drop cached static map content on next paint event after data changes. Does not trigger a repaint. */
+  void invalidateStaticLayer();
+
   /* Redraw map to reflect weather changes */
   void weatherUpdated();
 
@@ -508,6 +515,9 @@ protected:
   /* Caches complex X-Plane apron geometry as objects in screen coordinates for faster painting. */
   ApronGeometryCache *apronGeometryCache;
 
+  /* Loads data for predicted views into the query caches. Only created for the visible widget. */
+  MapPrefetch *mapPrefetch = nullptr;
+
   /* Keep the the overlays for the GUI widget from updating */
   bool ignoreOverlayUpdates = false;
 
@@ -0,0 +1,195 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapprefetch.h"
+
+#include "mapgui/mappaintwidget.h"
+#include "mappainter/mappaintlayer.h"
+#include "query/mapquery.h"
+
+#include <QDebug>
+
+using Marble::GeoDataLatLonBox;
+using Marble::GeoDataCoordinates;
+
+/* Interval for loading time slices */
+static const int PREFETCH_INTERVAL_MS = 50;
+
+/* Maximum time used in one slice */
+static const int PREFETCH_SLICE_MS = 10;
+
+/* Predict view position this time ahead */
+static const double PREFETCH_LOOKAHEAD_S = 1.5;
+
+/* Movement below this is considered as not moving in view widths per second */
+static const double MIN_VELOCITY_VIEWS_PER_S = 0.05;
+
+/* Reset movement if paint events are further apart */
+static const qint64 MAX_PAINT_INTERVAL_MS = 1000L;
+
+/* Do not prefetch if view is larger than this in degree */
+static const double MAX_VIEW_SIZE_DEG = 60.;
+
+/* Normalize longitude difference to -180 to 180 */
+static double normalizeLonDiff(double diff)
+{
+  while(diff > 180.)
+    diff -= 360.;
+  while(diff < -180.)
+    diff += 360.;
+  return diff;
+}
+
+/* Move box by the given degrees and limit latitude to valid range */
+static GeoDataLatLonBox shiftedBox(const GeoDataLatLonBox& box, double lonX, double latY)
+{
+  double north = box.north(GeoDataCoordinates::Degree) + latY, south = box.south(GeoDataCoordinates::Degree) + latY;
+  if(north > 90.)
+  {
+    south -= north - 90.;
+    north = 90.;
+  }
+  if(south < -90.)
+  {
+    north += -90. - south;
+    south = -90.;
+  }
+
+  double east = box.east(GeoDataCoordinates::Degree) + lonX, west = box.west(GeoDataCoordinates::Degree) + lonX;
+  return GeoDataLatLonBox(north, south, normalizeLonDiff(east), normalizeLonDiff(west), GeoDataCoordinates::Degree);
+}
+
+MapPrefetch::MapPrefetch(MapPaintWidget *mapPaintWidgetParam)
+  : QObject(mapPaintWidgetParam), mapPaintWidget(mapPaintWidgetParam)
+{
+  timer.setInterval(PREFETCH_INTERVAL_MS);
+  connect(&timer, &QTimer::timeout, this, &MapPrefetch::prefetchTimeout);
+  clock.start();
+}
+
+MapPrefetch::~MapPrefetch()
+{
+  timer.stop();
+}
+
+void MapPrefetch::stop()
+{
+  timer.stop();
+  pending.clear();
+  lastBox = GeoDataLatLonBox();
+  velocityLonX = velocityLatY = 0.;
+}
+
+void MapPrefetch::viewPainted(const GeoDataLatLonBox& viewBox)
+{
+  qint64 timeMs = clock.elapsed();
+  double width = viewBox.width(GeoDataCoordinates::Degree), height = viewBox.height(GeoDataCoordinates::Degree);
+
+  if(lastBox.isEmpty() || (timeMs - lastTimeMs) > MAX_PAINT_INTERVAL_MS || timeMs <= lastTimeMs ||
+     std::abs(lastBox.width(GeoDataCoordinates::Degree) - width) > width / 100.)
+  {
+    // First paint, pause or zoom changed - no movement
+    velocityLonX = velocityLatY = 0.;
+  }
+  else if(viewBox != lastBox)
+  {
+    // Calculate smoothed velocity from center movement
+    double seconds = (timeMs - lastTimeMs) / 1000.;
+    double lonX = normalizeLonDiff(viewBox.center().longitude(GeoDataCoordinates::Degree) -
+                                   lastBox.center().longitude(GeoDataCoordinates::Degree)) / seconds;
+    double latY = (viewBox.center().latitude(GeoDataCoordinates::Degree) -
+                   lastBox.center().latitude(GeoDataCoordinates::Degree)) / seconds;
+
+    velocityLonX = (velocityLonX + lonX) / 2.;
+    velocityLatY = (velocityLatY + latY) / 2.;
+  }
+  else if(timeMs - lastTimeMs > PREFETCH_INTERVAL_MS)
+    // Decay velocity if view did not move
+    velocityLonX = velocityLatY = 0.;
+
+  lastBox = viewBox;
+  lastTimeMs = timeMs;
+
+  updatePending(viewBox);
+
+  if(!pending.isEmpty() && !timer.isActive())
+    timer.start();
+}
+
+void MapPrefetch::updatePending(const GeoDataLatLonBox& viewBox)
+{
+  pending.clear();
+
+  double width = viewBox.width(GeoDataCoordinates::Degree), height = viewBox.height(GeoDataCoordinates::Degree);
+  if(viewBox.isEmpty() || width > MAX_VIEW_SIZE_DEG || height > MAX_VIEW_SIZE_DEG)
+    return;
+
+  if(std::abs(velocityLonX) > width * MIN_VELOCITY_VIEWS_PER_S || std::abs(velocityLatY) > height * MIN_VELOCITY_VIEWS_PER_S)
+  {
+    // Moving - load view at predicted position limited to one view size ahead and half way there
+    double lonX = std::max(-width, std::min(velocityLonX * PREFETCH_LOOKAHEAD_S, width));
+    double latY = std::max(-height, std::min(velocityLatY * PREFETCH_LOOKAHEAD_S, height));
+    pending.append(shiftedBox(viewBox, lonX / 2., latY / 2.));
+    pending.append(shiftedBox(viewBox, lonX, latY));
+  }
+  else
+  {
+    // Not moving - load half a view into each direction
+    for(int latY = -1; latY <= 1; latY++)
+    {
+      for(int lonX = -1; lonX <= 1; lonX++)
+      {
+        if(lonX != 0 || latY != 0)
+          pending.append(shiftedBox(viewBox, lonX * width / 2., latY * height / 2.));
+      }
+    }
+  }
+}
+
+void MapPrefetch::prefetchTimeout()
+{
+  MapQuery *mapQuery = mapPaintWidget->getMapQuery();
+  const MapLayer *mapLayer = mapPaintWidget->getMapPaintLayer()->getMapLayer();
+
+  if(pending.isEmpty() || mapQuery == nullptr || mapLayer == nullptr)
+  {
+    timer.stop();
+    return;
+  }
+
+  // Load one tile after the other until the time slice is used up
+  QElapsedTimer sliceTimer;
+  sliceTimer.start();
+  int loaded = 0;
+  while(!pending.isEmpty() && sliceTimer.elapsed() < PREFETCH_SLICE_MS)
+  {
+    int num = mapQuery->prefetch(pending.constFirst(), mapLayer, mapPaintWidget->getShownMapTypes(), 1 /* maxTiles */);
+    if(num == 0)
+      // All done for this view
+      pending.removeFirst();
+    loaded += num;
+  }
+
+#ifdef DEBUG_INFORMATION_PREFETCH
+  qDebug() << Q_FUNC_INFO << "loaded" << loaded << "tiles in" << sliceTimer.elapsed() << "ms pending" << pending.size();
+#else
+  Q_UNUSED(loaded)
+#endif
+
+  if(pending.isEmpty())
+    timer.stop();
+}
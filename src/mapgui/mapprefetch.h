@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPPREFETCH_H
+#define LNM_MAPPREFETCH_H
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include <marble/GeoDataLatLonBox.h>
+
+class MapPaintWidget;
+
+/*
+ * Loads map objects for views which are likely to be shown next into the tile caches of MapQuery.
+ *
+ * The predicted view is calculated from the movement of the view center across the last paint events, which covers
+ * both panning and following the aircraft. Adjacent views are loaded if the view is not moving.
+ *
+ * Loading is done in small time slices from a timer in the event loop since the database connections are bound to
+ * the GUI thread. Painters use available tiles while dragging and can draw the prefetched data without a query.
+ *
+ * Only used for the visible map widget.
+ */
+class MapPrefetch :
+  public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit MapPrefetch(MapPaintWidget *mapPaintWidgetParam);
+  virtual ~MapPrefetch() override;
+
+  MapPrefetch(const MapPrefetch& other) = delete;
+  MapPrefetch& operator=(const MapPrefetch& other) = delete;
+
+  /* Call after each paint event. Updates movement and schedules loading of predicted or adjacent views. */
+  void viewPainted(const Marble::GeoDataLatLonBox& viewBox);
+
+  /* Stop all pending loading. Needed before switching databases. */
+  void stop();
+
+private:
+  /* Load data for the first pending view in time slices */
+  void prefetchTimeout();
+
+  /* Views to load in order of priority */
+  void updatePending(const Marble::GeoDataLatLonBox& viewBox);
+
+  MapPaintWidget *mapPaintWidget;
+  QTimer timer;
+
+  /* Views to load, first is loaded first */
+  QVector<Marble::GeoDataLatLonBox> pending;
+
+  /* View at last paint event and clock for velocity */
+  Marble::GeoDataLatLonBox lastBox;
+  QElapsedTimer clock;
+  qint64 lastTimeMs = 0L;
+
+  /* Smoothed movement of the view center in degree per second */
+  double velocityLonX = 0., velocityLatY = 0.;
+};
+
+#endif // LNM_MAPPREFETCH_H
@@ -0,0 +1,136 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mapgui/mapscreengrid.h"
+
+#include "atools.h"
+
+#include <QLine>
+#include <QPolygon>
+
+#include <algorithm>
+#include <cmath>
+
+/* Polygons covering more than this fraction of all cells are added to the list of large objects */
+static const float LARGE_OBJECT_FRACTION = 0.25f;
+
+void MapScreenGrid::reset(const QRect& screenRect, int cellSizeParam)
+{
+  rect = screenRect;
+  cellSize = std::max(cellSizeParam, 1);
+  columns = std::max(rect.width() / cellSize + 1, 1);
+  rows = std::max(rect.height() / cellSize + 1, 1);
+  cells.clear();
+  cells.resize(columns * rows);
+  large.clear();
+  numObjects = 0;
+}
+
+void MapScreenGrid::clear()
+{
+  for(QVector<int>& cell : cells)
+    cell.clear();
+  large.clear();
+  numObjects = 0;
+}
+
+int MapScreenGrid::cellX(int xs) const
+{
+  return atools::minmax(0, columns - 1, (xs - rect.left()) / cellSize);
+}
+
+int MapScreenGrid::cellY(int ys) const
+{
+  return atools::minmax(0, rows - 1, (ys - rect.top()) / cellSize);
+}
+
+void MapScreenGrid::insertCell(int index, int cx, int cy)
+{
+  QVector<int>& cell = cells[cy * columns + cx];
+
+  // Avoid duplicates from consecutive samples along a line
+  if(cell.isEmpty() || cell.constLast() != index)
+    cell.append(index);
+}
+
+void MapScreenGrid::insertLine(int index, const QLine& line)
+{
+  if(cells.isEmpty())
+    return;
+
+  // Sample the line in steps of half a cell size and add all touched cells
+  float dx = line.dx(), dy = line.dy();
+  int steps = static_cast<int>(std::ceil(std::max(std::abs(dx), std::abs(dy)) / (cellSize / 2.f)));
+
+  for(int i = 0; i <= steps; i++)
+  {
+    float fraction = steps > 0 ? static_cast<float>(i) / steps : 0.f;
+    int xs = line.x1() + static_cast<int>(dx * fraction);
+    int ys = line.y1() + static_cast<int>(dy * fraction);
+
+    // Lines are already clipped to the screen but might have points slightly outside
+    insertCell(index, cellX(xs), cellY(ys));
+  }
+  numObjects++;
+}
+
+void MapScreenGrid::insertPolygon(int index, const QPolygon& polygon)
+{
+  if(cells.isEmpty() || polygon.isEmpty())
+    return;
+
+  QRect bounding = polygon.boundingRect().intersected(rect);
+  if(bounding.isEmpty())
+    return;
+
+  int left = cellX(bounding.left()), right = cellX(bounding.right());
+  int top = cellY(bounding.top()), bottom = cellY(bounding.bottom());
+
+  if((right - left + 1) * (bottom - top + 1) > cells.size() * LARGE_OBJECT_FRACTION)
+    large.append(index);
+  else
+  {
+    for(int cy = top; cy <= bottom; cy++)
+    {
+      for(int cx = left; cx <= right; cx++)
+        insertCell(index, cx, cy);
+    }
+  }
+  numObjects++;
+}
+
+QVector<int> MapScreenGrid::candidates(int xs, int ys, int maxDistance) const
+{
+  QVector<int> indexes(large);
+
+  if(!cells.isEmpty())
+  {
+    int left = cellX(xs - maxDistance), right = cellX(xs + maxDistance);
+    int top = cellY(ys - maxDistance), bottom = cellY(ys + maxDistance);
+
+    for(int cy = top; cy <= bottom; cy++)
+    {
+      for(int cx = left; cx <= right; cx++)
+        indexes.append(cells.at(cy * columns + cx));
+    }
+  }
+
+  // Keep original order of the index list
+  std::sort(indexes.begin(), indexes.end());
+  indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+  return indexes;
+}
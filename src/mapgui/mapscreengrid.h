@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPSCREENGRID_H
+#define LNM_MAPSCREENGRID_H
+
+#include <QRect>
+#include <QVector>
+
+class QLine;
+class QPolygon;
+
+/*
+ * Uniform bucket grid in screen coordinates used by the MapScreenIndex to find candidates for hit testing.
+ * Stores only indexes into the list of lines or polygons which is kept by the caller.
+ *
+ * Objects covering a large part of the screen (e.g. FIR airspaces) are not inserted into cells but kept in a separate list
+ * which is always returned as candidates.
+ */
+class MapScreenGrid
+{
+public:
+  /* Clear grid and set new screen size. Cell size in pixel. */
+  void reset(const QRect& screenRect, int cellSizeParam = 32);
+  void clear();
+
+  /* Add a line by following its path through the cells */
+  void insertLine(int index, const QLine& line);
+
+  /* Add a polygon by its bounding rectangle */
+  void insertPolygon(int index, const QPolygon& polygon);
+
+  /* Get sorted and unique list of indexes for objects which might be within maxDistance of the point */
+  QVector<int> candidates(int xs, int ys, int maxDistance) const;
+
+  bool isEmpty() const
+  {
+    return numObjects == 0;
+  }
+
+private:
+  void insertCell(int index, int cx, int cy);
+  int cellX(int xs) const;
+  int cellY(int ys) const;
+
+  QRect rect;
+  int cellSize = 32, columns = 0, rows = 0, numObjects = 0;
+
+  /* Indexes per cell in row major order */
+  QVector<QVector<int> > cells;
+
+  /* Indexes for objects covering a large part of the grid */
+  QVector<int> large;
+};
+
+#endif // LNM_MAPSCREENGRID_H
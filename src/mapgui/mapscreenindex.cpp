@@ -37,6 +37,8 @@
 #include "settings/settings.h"
 #include "util/average.h"
 
+#include <QElapsedTimer>
+
 #include <marble/GeoDataLineString.h>
 
 using atools::geo::Pos;
@@ -64,6 +66,23 @@ void assignIdAndInsert(const QString& settingsName, QHash<int, TYPE>& hash)
   }
 }
 
+/* Fill screen grid with indexes of all lines or polygons in list */
+template<typename ID>
+void buildGrid(MapScreenGrid& grid, const QRect& rect, const QList<std::pair<ID, QLine> >& lines)
+{
+  grid.reset(rect);
+  for(int i = 0; i < lines.size(); i++)
+    grid.insertLine(i, lines.at(i).second);
+}
+
+template<typename ID>
+void buildGrid(MapScreenGrid& grid, const QRect& rect, const QList<std::pair<ID, QPolygon> >& polygons)
+{
+  grid.reset(rect);
+  for(int i = 0; i < polygons.size(); i++)
+    grid.insertPolygon(i, polygons.at(i).second);
+}
+
 // ==============================================================================
 
 MapScreenIndex::MapScreenIndex(MapPaintWidget *mapPaintWidgetParam, MapPaintLayer *mapPaintLayer)
@@ -121,6 +140,12 @@ void MapScreenIndex::copy(const MapScreenIndex& other)
   airspacePolygons = other.airspacePolygons;
   ilsPolygons = other.ilsPolygons;
   ilsLines = other.ilsLines;
+  routeLinesGrid = other.routeLinesGrid;
+  airwayLinesGrid = other.airwayLinesGrid;
+  logEntryLinesGrid = other.logEntryLinesGrid;
+  airspacePolygonsGrid = other.airspacePolygonsGrid;
+  ilsPolygonsGrid = other.ilsPolygonsGrid;
+  ilsLinesGrid = other.ilsLinesGrid;
   routePointsEditable = other.routePointsEditable;
   routePointsAll = other.routePointsAll;
   lastUserAircraftForAverageTs = other.lastUserAircraftForAverageTs;
@@ -172,12 +197,11 @@ void MapScreenIndex::updateAirspaceScreenGeometryInternal(QSet<map::MapAirspaceI
       if(airspacebox.intersects(curBox) && !ids.contains(airspace->combinedId()))
       {
 
-        const atools::geo::LineString *lines = controller->getAirspaceGeometry(airspace->combinedId());
-        if(lines != nullptr)
+        // Use polygons cached by airspace painter if view did not change
+        const QVector<QPolygonF> *polygons = controller->getAirspaceScreenPolygons(airspace->combinedId(), mapWidget->viewport());
+        if(polygons != nullptr)
         {
-          QVector<QPolygonF> polygons = conv.wToS(*lines);
-
-          for(const QPolygonF& poly : polygons)
+          for(const QPolygonF& poly : *polygons)
           {
             // Cut off all polygon parts that are not visible on screen
             airspacePolygons.append(std::make_pair(airspace->combinedId(), poly.intersected(QPolygon(mapWidget->rect())).toPolygon()));
@@ -199,11 +223,14 @@ void MapScreenIndex::resetIlsScreenGeometry()
 {
   ilsPolygons.clear();
   ilsLines.clear();
+  ilsPolygonsGrid.clear();
+  ilsLinesGrid.clear();
 }
 
 void MapScreenIndex::updateAirspaceScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
 {
   airspacePolygons.clear();
+  airspacePolygonsGrid.clear();
   if(paintLayer == nullptr || paintLayer->getMapLayer() == nullptr)
     return;
 
@@ -213,15 +240,14 @@ void MapScreenIndex::updateAirspaceScreenGeometry(const Marble::GeoDataLatLonBox
   // First get geometry from highlights
   updateAirspaceScreenGeometryInternal(ids, NavApp::getAirspaceController()->getAirspaceSources(), curBox, true /* highlights */);
 
-  if(!paintLayer->getMapLayer()->isAirspace() || !paintLayer->getShownMapTypes().testFlag(map::AIRSPACE))
-    return;
-
-  // Do not put into index if nothing is drawn
-  if(mapWidget->isDistanceCutOff())
-    return;
+  // Do not put visible airspaces into index if nothing is drawn
+  if(paintLayer->getMapLayer()->isAirspace() && paintLayer->getShownMapTypes().testFlag(map::AIRSPACE) &&
+     !mapWidget->isDistanceCutOff())
+    // Get geometry from visible airspaces
+    updateAirspaceScreenGeometryInternal(ids, NavApp::getAirspaceController()->getAirspaceSources(), curBox, false /* highlights */);
 
-  // Get geometry from visible airspaces
-  updateAirspaceScreenGeometryInternal(ids, NavApp::getAirspaceController()->getAirspaceSources(), curBox, false /* highlights */);
+  // Index highlights and visible airspaces
+  buildGrid(airspacePolygonsGrid, mapWidget->rect(), airspacePolygons);
 }
 
 void MapScreenIndex::updateIlsScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
@@ -306,6 +332,9 @@ void MapScreenIndex::updateIlsScreenGeometry(const Marble::GeoDataLatLonBox& cur
         ilsPolygons.append(std::make_pair(ils.id, polygon));
     }
   }
+
+  buildGrid(ilsLinesGrid, mapWidget->rect(), ilsLines);
+  buildGrid(ilsPolygonsGrid, mapWidget->rect(), ilsPolygons);
 }
 
 void MapScreenIndex::updateLogEntryScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
@@ -342,6 +371,8 @@ void MapScreenIndex::updateLogEntryScreenGeometry(const Marble::GeoDataLatLonBox
       }
     }
   }
+
+  buildGrid(logEntryLinesGrid, mapWidget->rect(), logEntryLines);
 }
 
 void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonBox& curBox)
@@ -350,6 +381,7 @@ void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonBox&
     return;
 
   airwayLines.clear();
+  airwayLinesGrid.clear();
 
   // Use ID set to check for duplicates between calls
   QSet<int> ids;
@@ -359,6 +391,8 @@ void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonBox&
 
   // Get geometry from visible airways
   updateAirwayScreenGeometryInternal(ids, curBox, false /* highlight */);
+
+  buildGrid(airwayLinesGrid, mapWidget->rect(), airwayLines);
 }
 
 void MapScreenIndex::updateAirwayScreenGeometryInternal(QSet<int>& ids, const Marble::GeoDataLatLonBox& curBox, bool highlight)
@@ -792,6 +826,8 @@ void MapScreenIndex::updateRouteScreenGeometry(const Marble::GeoDataLatLonBox& c
     routePointsAll.append(otherPointsEditable);
     routePointsAll.append(otherPointsNotEditable);
   }
+
+  buildGrid(routeLinesGrid, mapWidget->rect(), routeLines);
 }
 
 void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::MapResult& result, map::MapObjectQueryTypes types) const
@@ -802,6 +838,11 @@ void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::Ma
   if(mapLayer == nullptr)
     return;
 
+#ifdef DEBUG_INFORMATION_SCREEN_INDEX
+  QElapsedTimer timer;
+  timer.start();
+#endif
+
   int xs = point.x(), ys = point.y();
   CoordinateConverter conv(mapWidget->viewport());
 
@@ -973,6 +1014,10 @@ void MapScreenIndex::getAllNearest(const QPoint& point, int maxDistance, map::Ma
       }
     }
   }
+
+#ifdef DEBUG_INFORMATION_SCREEN_INDEX
+  qDebug() << Q_FUNC_INFO << "Nearest query" << timer.nsecsElapsed() / 1000L << "us";
+#endif
 }
 
 void MapScreenIndex::getNearestHighlights(int xs, int ys, int maxDistance, map::MapResult& result, map::MapObjectQueryTypes types) const
@@ -1178,17 +1223,29 @@ int MapScreenIndex::getNearestRoutePointIndex(int xs, int ys, int maxDistance, b
 
 void MapScreenIndex::updateAllGeometry(const Marble::GeoDataLatLonBox& curBox)
 {
+#ifdef DEBUG_INFORMATION_SCREEN_INDEX
+  QElapsedTimer timer;
+  timer.start();
+#endif
+
   updateRouteScreenGeometry(curBox);
   updateAirwayScreenGeometry(curBox);
   updateLogEntryScreenGeometry(curBox);
   updateAirspaceScreenGeometry(curBox);
   updateIlsScreenGeometry(curBox);
+
+#ifdef DEBUG_INFORMATION_SCREEN_INDEX
+  qDebug() << Q_FUNC_INFO << "Screen index update including grids" << timer.elapsed() << "ms"
+           << "route lines" << routeLines.size() << "airway lines" << airwayLines.size()
+           << "logbook lines" << logEntryLines.size() << "airspace polygons" << airspacePolygons.size()
+           << "ILS polygons" << ilsPolygons.size() << "ILS lines" << ilsLines.size();
+#endif
 }
 
 /* Get all airways near cursor position */
 void MapScreenIndex::getNearestAirspaces(int xs, int ys, map::MapResult& result) const
 {
-  for(int i = 0; i < airspacePolygons.size(); i++)
+  for(int i : airspacePolygonsGrid.candidates(xs, ys, 0))
   {
     const std::pair<map::MapAirspaceId, QPolygon>& polyPair = airspacePolygons.at(i);
 
@@ -1201,11 +1258,11 @@ void MapScreenIndex::getNearestAirspaces(int xs, int ys, map::MapResult& result)
   }
 }
 
-QSet<int> MapScreenIndex::nearestLineIds(const QList<std::pair<int, QLine> >& lineList, int xs, int ys,
+QSet<int> MapScreenIndex::nearestLineIds(const QList<std::pair<int, QLine> >& lineList, const MapScreenGrid& grid, int xs, int ys,
                                          int maxDistance, bool lineDistanceOnly) const
 {
   QSet<int> ids;
-  for(int i = 0; i < lineList.size(); i++)
+  for(int i : grid.candidates(xs, ys, maxDistance))
   {
     const std::pair<int, QLine>& linePair = lineList.at(i);
     const QLine& line = linePair.second;
@@ -1236,7 +1293,7 @@ void MapScreenIndex::getNearestLogEntries(int xs, int ys, int maxDistance, map::
   if(paintLayer->getShownMapDisplayTypes().testFlag(map::LOGBOOK_DIRECT) ||
      paintLayer->getShownMapDisplayTypes().testFlag(map::LOGBOOK_ROUTE))
   {
-    for(int id : nearestLineIds(logEntryLines, xs, ys, maxDistance, false /* also distance to points */))
+    for(int id : nearestLineIds(logEntryLines, logEntryLinesGrid, xs, ys, maxDistance, false /* also distance to points */))
       maptools::insertSortedByDistance(conv, result.logbookEntries, &ids, xs, ys,
                                        NavApp::getLogdataController()->getLogEntryById(id));
   }
@@ -1250,10 +1307,10 @@ void MapScreenIndex::getNearestIls(int xs, int ys, int maxDistance, map::MapResu
     return;
 
   // Get nearest center lines (also considering buffer)
-  QSet<int> ilsIds = nearestLineIds(ilsLines, xs, ys, maxDistance, false /* lineDistanceOnly */);
+  QSet<int> ilsIds = nearestLineIds(ilsLines, ilsLinesGrid, xs, ys, maxDistance, false /* lineDistanceOnly */);
 
   // Get nearest ILS by geometry - duplicates are removed in set
-  for(int i = 0; i < ilsPolygons.size(); i++)
+  for(int i : ilsPolygonsGrid.candidates(xs, ys, 0))
   {
     const std::pair<int, QPolygon>& polyPair = ilsPolygons.at(i);
     if(polyPair.second.containsPoint(QPoint(xs, ys), Qt::OddEvenFill))
@@ -1273,7 +1330,7 @@ void MapScreenIndex::getNearestIls(int xs, int ys, int maxDistance, map::MapResu
 void MapScreenIndex::getNearestAirways(int xs, int ys, int maxDistance, map::MapResult& result) const
 {
   AirwayTrackQuery *airwayTrackQuery = mapWidget->getAirwayTrackQuery();
-  for(int id : nearestLineIds(airwayLines, xs, ys, maxDistance, true /* lineDistanceOnly */))
+  for(int id : nearestLineIds(airwayLines, airwayLinesGrid, xs, ys, maxDistance, true /* lineDistanceOnly */))
     result.airways.append(airwayTrackQuery->getAirwayById(id));
 }
 
@@ -1285,7 +1342,7 @@ int MapScreenIndex::getNearestRouteLegIndex(int xs, int ys, int maxDistance) con
   int minIndex = -1;
   float minDist = std::numeric_limits<float>::max();
 
-  for(int i = 0; i < routeLines.size(); i++)
+  for(int i : routeLinesGrid.candidates(xs, ys, maxDistance))
   {
     const std::pair<int, QLine>& line = routeLines.at(i);
 
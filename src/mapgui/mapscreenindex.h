@@ -19,6 +19,7 @@
 #define LITTLENAVMAP_MAPSCREENINDEX_H
 
 #include "common/mapflags.h"
+#include "mapgui/mapscreengrid.h"
 
 #include <QDateTime>
 #include <QHash>
@@ -321,7 +322,8 @@ private:
   /* Fill average values for ground speed and turn speed for turn path display. */
   void updateAverageTurn();
 
-  QSet<int> nearestLineIds(const QList<std::pair<int, QLine> >& lineList, int xs, int ys, int maxDistance, bool lineDistanceOnly) const;
+  QSet<int> nearestLineIds(const QList<std::pair<int, QLine> >& lineList, const MapScreenGrid& grid, int xs, int ys, int maxDistance,
+                           bool lineDistanceOnly) const;
 
   template<typename TYPE>
   int getNearestId(int xs, int ys, int maxDistance, const QHash<int, TYPE>& typeList) const;
@@ -387,6 +389,9 @@ private:
   QList<std::pair<int, QPolygon> > ilsPolygons;
   QList<std::pair<int, QLine> > ilsLines; /* Index ILS center lines separately to allow
                                            * tooltips when getting the cursor near a line */
+
+  /* Screen grids pointing into the lists above. Rebuilt after each geometry update. */
+  MapScreenGrid routeLinesGrid, airwayLinesGrid, logEntryLinesGrid, airspacePolygonsGrid, ilsPolygonsGrid, ilsLinesGrid;
 };
 
 #endif // LITTLENAVMAP_MAPSCREENINDEX_H
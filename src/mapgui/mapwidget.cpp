@@ -2758,8 +2758,12 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
     // touchdownDetected = false;
 
     if((dataHasChanged || aiVisible) && !contextMenuActive)
+    {
       // Not scrolled or zoomed but needs a redraw
+      // Static map content is taken from the paint layer cache if view was not changed by centering above
+      paintLayer->setDynamicUpdate();
       update();
+    }
 
     if(!updatesEnabled())
       setUpdatesEnabled(true);
@@ -3348,6 +3352,9 @@ void MapWidget::updateMapObjectsShown()
 
   emit shownMapFeaturesChanged(paintLayer->getShownMapTypes());
 
+  // Also called after userpoint, logbook, track and wind changes which are not part of the static layer key
+  paintLayer->invalidateStaticLayer();
+
   // Update widget
   update();
 }
@@ -101,10 +101,14 @@ void MapPainterAirspace::render()
         if(!context->drawFast)
           painter->setBrush(mapcolors::colorForAirspaceFill(*airspace));
 
-        const LineString *lines = controller->getAirspaceGeometry(airspace->combinedId());
+        // Simplified and projected geometry is cached for this view and shared with the screen index
+        const QVector<QPolygonF> *polygons = controller->getAirspaceScreenPolygons(airspace->combinedId(), context->viewport);
 
-        if(lines != nullptr)
-          drawPolygon(painter, *lines);
+        if(polygons != nullptr)
+        {
+          for(const QPolygonF& polygon : *polygons)
+            painter->drawPolygon(polygon);
+        }
 
         if(airspace->isOnline())
         {
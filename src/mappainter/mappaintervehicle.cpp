@@ -225,8 +225,10 @@ void MapPainterVehicle::paintAircraftTrack()
   {
     context->painter->setPen(mapcolors::aircraftTrailPen(context->sz(context->thicknessTrail, 2)));
 
-    // Draw with simple precision
-    for(const LineString& line : aircraftTrack.getLineStrings())
+    // Draw with simple precision and skip points closer than one pixel
+    // Simplified lines are cached per zoom level in the track and extended incrementally
+    float toleranceDeg = meterToNm(scale->getMeterPerPixel()) / 60.f;
+    for(const LineString& line : aircraftTrack.getLineStrings(toleranceDeg))
       drawLineString(context->painter, line);
   }
 }
@@ -41,22 +41,29 @@
 #include "mappainter/mappainterwind.h"
 #include "app/navapp.h"
 #include "options/optiondata.h"
+#include "query/mapquery.h"
 #include "route/route.h"
 #include "settings/settings.h"
 #include "userdata/userdatacontroller.h"
 
-#include <QElapsedTimer>
-
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using namespace Marble;
 using namespace atools::geo;
 
+/* Redraw static painters at least this often to catch changes not covered by the layer key */
+static const qint64 STATIC_LAYER_MAX_AGE_MS = 5000L;
+
 MapPaintLayer::MapPaintLayer(MapPaintWidget *widget)
   : mapPaintWidget(widget)
 {
   verbose = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_LAYER_DEBUG, false).toBool();
 
+  if(mapPaintWidget->isVisibleWidget() &&
+     atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_MAP_PROFILE, false).toBool())
+    profile = new MapPaintProfile;
+
   // Create the layer configuration
   initMapLayerSettings();
 
@@ -87,6 +94,14 @@ MapPaintLayer::MapPaintLayer(MapPaintWidget *widget)
 
 MapPaintLayer::~MapPaintLayer()
 {
+  if(profile != nullptr)
+  {
+    // Save recorded frames to configuration directory
+    profile->saveCsv(atools::settings::Settings::getConfigFilename(lnm::MAP_PROFILE_CSV_SUFFIX));
+    profile->saveJson(atools::settings::Settings::getConfigFilename(lnm::MAP_PROFILE_JSON_SUFFIX));
+    delete profile;
+  }
+
   delete mapPainterNav;
   delete mapPainterIls;
   delete mapPainterAirport;
@@ -122,6 +137,7 @@ void MapPaintLayer::copySettings(const MapPaintLayer& other)
 void MapPaintLayer::preDatabaseLoad()
 {
   databaseLoadStatus = true;
+  invalidateStaticLayer();
 }
 
 void MapPaintLayer::postDatabaseLoad()
@@ -226,6 +242,11 @@ void MapPaintLayer::initMapLayerSettings()
   layers->loadFromFile();
 }
 
+const MapLayer *MapPaintLayer::getMapLayerForDistance(float distanceKm, int detailLevel) const
+{
+  return layers->getLayer(distanceKm, detailLevel);
+}
+
 /* Update the stored layer pointers after zoom distance has changed */
 void MapPaintLayer::updateLayers()
 {
@@ -260,6 +281,127 @@ void MapPaintLayer::dumpMapLayers() const
   qDebug() << Q_FUNC_INFO << *layers;
 }
 
+void MapPaintLayer::renderPainter(MapPainter *painter, MapPaintProfile::Painter type)
+{
+  if(profile != nullptr)
+  {
+    int objectCount = context.getObjectCount();
+    profile->beginPainter();
+    painter->render();
+    profile->endPainter(type, context.getObjectCount() - objectCount);
+  }
+  else
+    painter->render();
+}
+
+void MapPaintLayer::renderStaticPainters(bool ships)
+{
+  // Altitude below all others
+  renderPainter(mapPainterAltitude, MapPaintProfile::ALTITUDE);
+
+  // Ship below other navaids and airports
+  if(ships)
+    renderPainter(mapPainterShip, MapPaintProfile::SHIP);
+
+  if(!mapPaintWidget->isDistanceCutOff())
+  {
+    if(!context.isObjectOverflow())
+      renderPainter(mapPainterAirspace, MapPaintProfile::AIRSPACE);
+
+    if(!context.isObjectOverflow())
+      renderPainter(mapPainterIls, MapPaintProfile::ILS);
+
+    if(context.mapLayer->isAirportDiagram())
+    {
+      if(!context.isObjectOverflow())
+        renderPainter(mapPainterAirport, MapPaintProfile::AIRPORT);
+
+      if(!context.isObjectOverflow())
+        renderPainter(mapPainterNav, MapPaintProfile::NAV);
+    }
+    else
+    {
+      if(!context.isObjectOverflow())
+        renderPainter(mapPainterMsa, MapPaintProfile::MSA);
+
+      if(!context.isObjectOverflow())
+        renderPainter(mapPainterNav, MapPaintProfile::NAV);
+
+      if(!context.isObjectOverflow())
+        renderPainter(mapPainterAirport, MapPaintProfile::AIRPORT);
+    }
+  }
+
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterUser, MapPaintProfile::USER);
+
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterWind, MapPaintProfile::WIND);
+
+  // if(!context.isOverflow()) always paint route even if number of objects is too large
+  renderPainter(mapPainterRoute, MapPaintProfile::ROUTE);
+
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterWeather, MapPaintProfile::WEATHER);
+
+  if(context.mapLayer->isAirportDiagram() && !context.isObjectOverflow())
+    renderPainter(mapPainterMsa, MapPaintProfile::MSA);
+
+  if(!context.isObjectOverflow())
+    renderPainter(mapPainterTrack, MapPaintProfile::TRACK);
+}
+
+void MapPaintLayer::renderDynamicPainters(bool ships)
+{
+  if(ships)
+    renderPainter(mapPainterShip, MapPaintProfile::SHIP);
+
+  renderPainter(mapPainterAircraft, MapPaintProfile::AIRCRAFT);
+
+  renderPainter(mapPainterMark, MapPaintProfile::MARK);
+
+  renderPainter(mapPainterTop, MapPaintProfile::TOP);
+}
+
+MapPaintLayer::StaticLayerKey MapPaintLayer::staticLayerKeyForView(const ViewportParams *viewport) const
+{
+  const GeoDataLatLonAltBox& box = viewport->viewLatLonAltBox();
+  const Route& route = NavApp::getRouteConst();
+
+  StaticLayerKey key;
+  key.west = box.west();
+  key.north = box.north();
+  key.east = box.east();
+  key.south = box.south();
+  key.size = viewport->size();
+  key.distanceKm = static_cast<float>(mapPaintWidget->distance());
+  key.objectTypes = objectTypes;
+  key.objectDisplayTypes = objectDisplayTypes;
+  key.airspaceTypes = airspaceTypes.types;
+  key.airspaceFlags = airspaceTypes.flags;
+  key.minAltitudeFt = airspaceTypes.minAltitudeFt;
+  key.maxAltitudeFt = airspaceTypes.maxAltitudeFt;
+  key.detailLevel = detailLevel;
+  key.routeSize = route.size();
+  key.activeLegIndex = route.getActiveLegIndex();
+  key.highlightCount = mapPaintWidget->getSearchHighlights().size() + mapPaintWidget->getProcedureHighlight().size() +
+                       mapPaintWidget->getProcedureHighlights().size() + mapPaintWidget->getRouteHighlights().size();
+  key.themeId = mapPaintWidget->getCurrentThemeId();
+  return key;
+}
+
+bool MapPaintLayer::StaticLayerKey::operator==(const StaticLayerKey& other) const
+{
+  // View box is calculated from the same values and is exactly equal if not changed
+  return west == other.west && north == other.north && east == other.east && south == other.south &&
+         size == other.size && distanceKm == other.distanceKm &&
+         objectTypes == other.objectTypes && objectDisplayTypes == other.objectDisplayTypes &&
+         airspaceTypes == other.airspaceTypes && airspaceFlags == other.airspaceFlags &&
+         minAltitudeFt == other.minAltitudeFt && maxAltitudeFt == other.maxAltitudeFt && detailLevel == other.detailLevel &&
+         routeSize == other.routeSize && activeLegIndex == other.activeLegIndex && highlightCount == other.highlightCount &&
+         themeId == other.themeId;
+}
+
 bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const QString& renderPos, GeoSceneLayer *layer)
 {
   Q_UNUSED(renderPos)
@@ -281,8 +423,24 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
       qDebug() << Q_FUNC_INFO << "layer" << *mapLayer;
 #endif
 
-      // Clear the airport id cache
-      shownDetailAirportIds.clear();
+      if(profile != nullptr)
+        profile->beginFrame(static_cast<float>(mapPaintWidget->distance()));
+
+      // Cache static painters in an image when simulator updates cause frequent repaints =================
+      bool useStaticLayer = mapPaintWidget->isVisibleWidget() && mapPaintWidget->viewContext() == Marble::Still &&
+                            NavApp::isConnected();
+      StaticLayerKey layerKey;
+      if(useStaticLayer)
+        layerKey = staticLayerKeyForView(viewport);
+
+      // Reuse only if a simulator update is the only reason for this paint event
+      bool reuseStaticLayer = useStaticLayer && dynamicUpdate && !staticLayer.isNull() && layerKey == staticLayerKey &&
+                              staticLayerTimer.isValid() && staticLayerTimer.elapsed() < STATIC_LAYER_MAX_AGE_MS;
+      dynamicUpdate = false;
+
+      if(!reuseStaticLayer)
+        // Clear the airport id cache - keep from last full paint otherwise
+        shownDetailAirportIds.clear();
 
       // Prepare context =====================================================
       context = PaintContext();
@@ -372,11 +530,13 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
 
       // Prepare index for all navaids drawn by route - needed for context menu and tooltips
       context.routeDrawnNavaids = mapPaintWidget->getRouteDrawnNavaids();
-      context.routeDrawnNavaids->clear();
+      if(!reuseStaticLayer)
+        context.routeDrawnNavaids->clear();
 
       // ====================================
       // Get all waypoints from the route and add them to the map to avoid duplicate drawing
-      if(context.objectDisplayTypes.testFlag(map::FLIGHTPLAN))
+      // Only needed by static painters
+      if(!reuseStaticLayer && context.objectDisplayTypes.testFlag(map::FLIGHTPLAN))
       {
         const Route *route = context.route;
         // Active normally start at 1 - this will consider all legs as not passed
@@ -442,7 +602,7 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
       // Get navaids from procedure highlight to avoid duplicate drawing
       // These will be drawn in the procedure preview or flight plan instead of the navaid painter
 
-      if(context.mapLayerRoute->isApproach())
+      if(!reuseStaticLayer && context.mapLayerRoute->isApproach())
       {
         // Procedure legs from "show all" function ======================================
         for(const proc::MapProcedureLegs& procedure : mapPaintWidget->getProcedureHighlights())
@@ -503,65 +663,55 @@ bool MapPaintLayer::render(GeoPainter *painter, ViewportParams *viewport, const
 
       // =========================================================================
       // Draw ====================================
-
-      // Altitude below all others
-      mapPainterAltitude->render();
-
-      // Ship below other navaids and airports
-      mapPainterShip->render();
-
-      if(!mapPaintWidget->isDistanceCutOff())
+      if(reuseStaticLayer)
       {
-        if(!context.isObjectOverflow())
-          mapPainterAirspace->render();
-
-        if(!context.isObjectOverflow())
-          mapPainterIls->render();
+        // Only aircraft changed - draw image and keep object counts from the last full paint
+        painter->drawImage(QPointF(0., 0.), staticLayer);
+        context.objectCount = staticObjectCount;
+        context.setQueryOverflow(staticQueryOverflow);
+      }
+      else if(useStaticLayer)
+      {
+        // Draw static painters into the image first
+        qreal pixelRatio = painter->device()->devicePixelRatioF();
+        QSize imageSize = viewport->size() * pixelRatio;
+        if(staticLayer.size() != imageSize)
+          staticLayer = QImage(imageSize, QImage::Format_ARGB32_Premultiplied);
+        staticLayer.setDevicePixelRatio(pixelRatio);
+        staticLayer.fill(Qt::transparent);
 
-        if(context.mapLayer->isAirportDiagram())
         {
-          if(!context.isObjectOverflow())
-            mapPainterAirport->render();
+          GeoPainter imagePainter(&staticLayer, viewport, painter->mapQuality());
+          imagePainter.setRenderHints(painter->renderHints());
+          imagePainter.setFont(context.defaultFont);
 
-          if(!context.isObjectOverflow())
-            mapPainterNav->render();
+          context.painter = &imagePainter;
+          renderStaticPainters(false /* ships */);
+          context.painter = painter;
         }
-        else
-        {
-          if(!context.isObjectOverflow())
-            mapPainterMsa->render();
 
-          if(!context.isObjectOverflow())
-            mapPainterNav->render();
+        painter->drawImage(QPointF(0., 0.), staticLayer);
 
-          if(!context.isObjectOverflow())
-            mapPainterAirport->render();
-        }
+        staticLayerKey = layerKey;
+        staticObjectCount = context.getObjectCount();
+        staticQueryOverflow = context.isQueryOverflow();
+        staticLayerTimer.start();
+      }
+      else
+      {
+        // Draw directly without caching
+        staticLayer = QImage();
+        renderStaticPainters(true /* ships */);
       }
 
-      if(!context.isObjectOverflow())
-        mapPainterUser->render();
-
-      if(!context.isObjectOverflow())
-        mapPainterWind->render();
-
-      // if(!context.isOverflow()) always paint route even if number of objects is too large
-      mapPainterRoute->render();
-
-      if(!context.isObjectOverflow())
-        mapPainterWeather->render();
-
-      if(context.mapLayer->isAirportDiagram() && !context.isObjectOverflow())
-        mapPainterMsa->render();
-
-      if(!context.isObjectOverflow())
-        mapPainterTrack->render();
-
-      mapPainterAircraft->render();
-
-      mapPainterMark->render();
+      // Ships move with simulator updates and are drawn above the static image if caching is used
+      renderDynamicPainters(useStaticLayer /* ships */);
 
-      mapPainterTop->render();
+      if(profile != nullptr)
+      {
+        profile->endFrame(mapPaintWidget->getMapQuery()->takeTileCacheStats());
+        profile->paintOverlay(painter);
+      }
     } // if(!noRender())
 
     if(!mapPaintWidget->isPrinting() && mapPaintWidget->isVisibleWidget())
@@ -19,7 +19,10 @@
 #define LITTLENAVMAP_MAPPAINTLAYER_H
 
 #include "mappainter/mappainter.h"
+#include "mappainter/mappaintprofile.h"
 
+#include <QElapsedTimer>
+#include <QImage>
 #include <QPen>
 
 #include <marble/LayerInterface.h>
@@ -84,6 +87,9 @@ public:
     return mapLayerEffective;
   }
 
+  /* Get layer for the given zoom distance and detail level independent of the current view */
+  const MapLayer *getMapLayerForDistance(float distanceKm, int detailLevel) const;
+
   /* Set the flags for map objects on or off depending on value show. Does not repaint */
   void setShowMapObject(map::MapTypes type, bool show);
   void setShowMapObjectDisplay(map::MapDisplayTypes type, bool show);
@@ -184,9 +190,55 @@ public:
     return shownDetailAirportIds;
   }
 
+  /* Next paint event is caused by simulator updates only. Static painters are not called and the cached
+   * image is used instead if the view and settings did not change. Reset after each paint event. */
+  void setDynamicUpdate()
+  {
+    dynamicUpdate = true;
+  }
+
+  /* Force full repaint of static painters on next paint event */
+  void invalidateStaticLayer()
+  {
+    staticLayer = QImage();
+  }
+
 private:
+  /* Identifies view and settings used to draw the cached static layer */
+  struct StaticLayerKey
+  {
+    double west = 0., north = 0., east = 0., south = 0.;
+    QSize size;
+    float distanceKm = 0.f;
+    map::MapTypes objectTypes = map::NONE;
+    map::MapDisplayTypes objectDisplayTypes = map::DISPLAY_TYPE_NONE;
+    map::MapAirspaceTypes airspaceTypes = map::AIRSPACE_NONE;
+    map::MapAirspaceFlags airspaceFlags = map::AIRSPACE_ALTITUDE_FLAG_NONE;
+    int minAltitudeFt = 0, maxAltitudeFt = 0, detailLevel = 0, routeSize = 0, activeLegIndex = 0, highlightCount = 0;
+    QString themeId;
+
+    bool operator==(const StaticLayerKey& other) const;
+
+    bool operator!=(const StaticLayerKey& other) const
+    {
+      return !(*this == other);
+    }
+
+  };
+
+  StaticLayerKey staticLayerKeyForView(const Marble::ViewportParams *viewport) const;
+
+  /* Painters which change only with view, settings or data. Ships are left out if drawn as dynamic content. */
+  void renderStaticPainters(bool ships);
+
+  /* Painters for aircraft, trail, marks and top overlays which change with each simulator update */
+  void renderDynamicPainters(bool ships);
+
   void initMapLayerSettings();
 
+  /* Call render() of painter and record time and drawn objects if profiling is enabled */
+  void renderPainter(MapPainter *painter, MapPaintProfile::Painter type);
+
   /* Implemented from LayerInterface: We  draw above all but below user tools */
   virtual QStringList renderPosition() const override
   {
@@ -239,6 +291,15 @@ private:
   const MapLayer *mapLayer = nullptr, *mapLayerRoute = nullptr, *mapLayerEffective = nullptr;
   bool verbose = false;
 
+  /* Not null if profiling is enabled for the visible map */
+  MapPaintProfile *profile = nullptr;
+
+  /* Result of static painters for the visible map while connected to a simulator */
+  QImage staticLayer;
+  StaticLayerKey staticLayerKey;
+  QElapsedTimer staticLayerTimer;
+  int staticObjectCount = 0;
+  bool staticQueryOverflow = false, dynamicUpdate = false;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTLAYER_H
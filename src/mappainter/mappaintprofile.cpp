@@ -0,0 +1,209 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "mappainter/mappaintprofile.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QPainter>
+#include <QTextStream>
+
+/* Number of frames used to calculate averages in overlay */
+static const int OVERLAY_NUM_FRAMES = 30;
+
+const QStringList MapPaintProfile::PAINTER_NAMES({"Altitude", "Ship", "Airspace", "ILS", "Airport", "MSA", "Nav", "User",
+                                                  "Wind", "Route", "Weather", "Track", "Aircraft", "Mark", "Top"});
+
+MapPaintProfile::MapPaintProfile(int maxFramesParam)
+  : maxFrames(maxFramesParam)
+{
+}
+
+void MapPaintProfile::beginFrame(float distanceKm)
+{
+  frame.timestampMs = QDateTime::currentMSecsSinceEpoch();
+  frame.distanceKm = distanceKm;
+  frame.totalMs = 0.f;
+  std::fill(std::begin(frame.painterMs), std::end(frame.painterMs), 0.f);
+  std::fill(std::begin(frame.painterObjects), std::end(frame.painterObjects), 0);
+  frame.cacheStats.clear();
+  frameTimer.start();
+}
+
+void MapPaintProfile::beginPainter()
+{
+  painterTimer.start();
+}
+
+void MapPaintProfile::endPainter(Painter painter, int objectCount)
+{
+  frame.painterMs[painter] += painterTimer.nsecsElapsed() / 1000000.f;
+  frame.painterObjects[painter] += objectCount;
+}
+
+void MapPaintProfile::endFrame(const QVector<query::TileCacheStats>& cacheStats)
+{
+  frame.totalMs = frameTimer.nsecsElapsed() / 1000000.f;
+  frame.cacheStats = cacheStats;
+
+  frames.append(frame);
+  while(frames.size() > maxFrames)
+    frames.removeFirst();
+}
+
+void MapPaintProfile::paintOverlay(QPainter *painter) const
+{
+  if(frames.isEmpty())
+    return;
+
+  // Calculate averages for the last frames ==============================
+  int num = std::min(frames.size(), OVERLAY_NUM_FRAMES);
+  float totalMs = 0.f, painterMs[NUM_PAINTERS] = {}, painterObjects[NUM_PAINTERS] = {};
+  QVector<query::TileCacheStats> cacheStats = frames.constLast().cacheStats;
+  for(query::TileCacheStats& stats : cacheStats)
+  {
+    stats.hits = stats.misses = 0;
+    stats.loadNs = 0L;
+  }
+
+  for(int i = frames.size() - num; i < frames.size(); i++)
+  {
+    const Frame& f = frames.at(i);
+    totalMs += f.totalMs;
+    for(int p = 0; p < NUM_PAINTERS; p++)
+    {
+      painterMs[p] += f.painterMs[p];
+      painterObjects[p] += f.painterObjects[p];
+    }
+
+    for(int c = 0; c < std::min(f.cacheStats.size(), cacheStats.size()); c++)
+    {
+      cacheStats[c].hits += f.cacheStats.at(c).hits;
+      cacheStats[c].misses += f.cacheStats.at(c).misses;
+      cacheStats[c].loadNs += f.cacheStats.at(c).loadNs;
+    }
+  }
+
+  // Build text ==============================
+  QStringList lines;
+  lines.append(QString("Frame %1 ms (average of %2)").arg(totalMs / num, 0, 'f', 1).arg(num));
+  for(int p = 0; p < NUM_PAINTERS; p++)
+    lines.append(QString("%1: %2 ms, %3 obj").arg(PAINTER_NAMES.at(p)).
+                 arg(painterMs[p] / num, 0, 'f', 2).arg(painterObjects[p] / num, 0, 'f', 0));
+
+  for(const query::TileCacheStats& stats : cacheStats)
+  {
+    int tiles = stats.hits + stats.misses;
+    if(tiles > 0)
+      lines.append(QString("%1 cache: %2 % hits, %3 ms load").arg(stats.name).
+                   arg(stats.hits * 100.f / tiles, 0, 'f', 0).arg(stats.loadNs / 1000000.f / num, 0, 'f', 2));
+  }
+
+  // Draw text into semi-transparent box ==============================
+  painter->save();
+  QFontMetrics metrics(painter->font());
+  int width = 0;
+  for(const QString& line : lines)
+    width = std::max(width, metrics.horizontalAdvance(line));
+
+  int x = 10, y = 10, lineHeight = metrics.height();
+  painter->setPen(Qt::NoPen);
+  painter->setBrush(QColor(255, 255, 255, 200));
+  painter->drawRect(x - 4, y - 4, width + 8, lineHeight * lines.size() + 8);
+
+  painter->setPen(Qt::black);
+  for(const QString& line : lines)
+  {
+    painter->drawText(x, y + metrics.ascent(), line);
+    y += lineHeight;
+  }
+  painter->restore();
+}
+
+bool MapPaintProfile::saveCsv(const QString& filename) const
+{
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+
+    // Header ==========================
+    QStringList header({"timestamp_ms", "distance_km", "total_ms"});
+    for(const QString& name : PAINTER_NAMES)
+      header << name.toLower() + "_ms" << name.toLower() + "_objects";
+    if(!frames.isEmpty())
+    {
+      for(const query::TileCacheStats& stats : frames.constFirst().cacheStats)
+        header << stats.name.toLower() + "_hits" << stats.name.toLower() + "_misses" << stats.name.toLower() + "_load_ms";
+    }
+    stream << header.join(',') << endl;
+
+    // Frames ==========================
+    for(const Frame& f : frames)
+    {
+      QStringList values({QString::number(f.timestampMs), QString::number(f.distanceKm, 'f', 3),
+                          QString::number(f.totalMs, 'f', 3)});
+      for(int p = 0; p < NUM_PAINTERS; p++)
+        values << QString::number(f.painterMs[p], 'f', 3) << QString::number(f.painterObjects[p]);
+      for(const query::TileCacheStats& stats : f.cacheStats)
+        values << QString::number(stats.hits) << QString::number(stats.misses) << QString::number(stats.loadNs / 1000000., 'f', 3);
+      stream << values.join(',') << endl;
+    }
+
+    file.close();
+    qInfo() << Q_FUNC_INFO << "Saved" << frames.size() << "frames to" << filename;
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
+
+bool MapPaintProfile::saveJson(const QString& filename) const
+{
+  QJsonArray frameArray;
+  for(const Frame& f : frames)
+  {
+    QJsonObject painters;
+    for(int p = 0; p < NUM_PAINTERS; p++)
+      painters.insert(PAINTER_NAMES.at(p), QJsonObject({{"ms", f.painterMs[p]}, {"objects", f.painterObjects[p]}}));
+
+    QJsonObject caches;
+    for(const query::TileCacheStats& stats : f.cacheStats)
+      caches.insert(stats.name, QJsonObject({{"hits", stats.hits}, {"misses", stats.misses},
+                                             {"load_ms", stats.loadNs / 1000000.}}));
+
+    frameArray.append(QJsonObject({{"timestamp_ms", f.timestampMs}, {"distance_km", f.distanceKm}, {"total_ms", f.totalMs},
+                                   {"painters", painters}, {"caches", caches}}));
+  }
+
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly))
+  {
+    file.write(QJsonDocument(QJsonObject({{"frames", frameArray}})).toJson());
+    file.close();
+    qInfo() << Q_FUNC_INFO << "Saved" << frames.size() << "frames to" << filename;
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
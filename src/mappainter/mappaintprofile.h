@@ -0,0 +1,96 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_MAPPAINTPROFILE_H
+#define LNM_MAPPAINTPROFILE_H
+
+#include "query/querytypes.h"
+
+#include <QElapsedTimer>
+
+class QPainter;
+
+/*
+ * Records timings, number of drawn objects and tile cache statistics for each painter and frame
+ * of the map. Keeps a limited number of frames which can be saved as CSV or JSON.
+ *
+ * Enabled for the visible map by "MapProfile=true" in section "[Options]" of the configuration file.
+ */
+class MapPaintProfile
+{
+public:
+  /* Painters in drawing order. Used as index and for column names. */
+  enum Painter
+  {
+    ALTITUDE,
+    SHIP,
+    AIRSPACE,
+    ILS,
+    AIRPORT,
+    MSA,
+    NAV,
+    USER,
+    WIND,
+    ROUTE,
+    WEATHER,
+    TRACK,
+    AIRCRAFT,
+    MARK,
+    TOP,
+    NUM_PAINTERS
+  };
+
+  explicit MapPaintProfile(int maxFramesParam = 2000);
+
+  /* Start recording a frame */
+  void beginFrame(float distanceKm);
+
+  /* Start time measurement for a painter */
+  void beginPainter();
+
+  /* Stop time measurement and add the time and drawn objects to the painter. Painters can be called more than once. */
+  void endPainter(Painter painter, int objectCount);
+
+  /* Finish and store frame */
+  void endFrame(const QVector<query::TileCacheStats>& cacheStats);
+
+  /* Draw averages of the last frames into the top left corner of the map */
+  void paintOverlay(QPainter *painter) const;
+
+  /* Save all recorded frames. One line or object per frame. */
+  bool saveCsv(const QString& filename) const;
+  bool saveJson(const QString& filename) const;
+
+private:
+  struct Frame
+  {
+    qint64 timestampMs;
+    float distanceKm, totalMs;
+    float painterMs[NUM_PAINTERS];
+    int painterObjects[NUM_PAINTERS];
+    QVector<query::TileCacheStats> cacheStats;
+  };
+
+  static const QStringList PAINTER_NAMES;
+
+  QList<Frame> frames;
+  Frame frame;
+  QElapsedTimer frameTimer, painterTimer;
+  int maxFrames;
+};
+
+#endif // LNM_MAPPAINTPROFILE_H
@@ -29,6 +29,7 @@
 #include "geo/calculations.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlrecord.h"
+#include "sql/sqltransaction.h"
 #include "mapgui/maplayer.h"
 #include "app/navapp.h"
 #include "settings/settings.h"
@@ -38,6 +39,9 @@
 #include <QMessageBox>
 #include <QTextCodec>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 static const int MIN_SERVER_DOWNLOAD_INTERVAL_MIN = 15;
 static const int MIN_TRANSCEIVER_DOWNLOAD_INTERVAL_MIN = 5;
@@ -71,8 +75,9 @@ atools::fs::online::Format convertFormat(opts::OnlineFormat format)
   return atools::fs::online::UNKNOWN;
 }
 
-OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager *onlineManager, MainWindow *parent)
-  : manager(onlineManager), mainWindow(parent), aircraftCache()
+OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager *onlineManager,
+                                           atools::fs::online::OnlinedataManager *onlineStagingManager, MainWindow *parent)
+  : manager(onlineManager), stagingManager(onlineStagingManager), mainWindow(parent), aircraftCache()
 {
   // Files use Windows code with embedded UTF-8 for ATIS text
   codec = QTextCodec::codecForName("Windows-1252");
@@ -98,12 +103,14 @@ OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager
   connect(downloader, &HttpDownloader::downloadFinished, this, &OnlinedataController::downloadFinished);
   connect(downloader, &HttpDownloader::downloadFailed, this, &OnlinedataController::downloadFailed);
   connect(downloader, &HttpDownloader::downloadSslErrors, this, &OnlinedataController::downloadSslErrors);
+  connect(&decodeWatcher, &QFutureWatcher<QString>::finished, this, &OnlinedataController::decodeFinished);
 
   // Recurring downloads
   connect(&downloadTimer, &QTimer::timeout, this, &OnlinedataController::startDownloadInternal);
 
+  // Geometry is only needed while parsing into the staging database
   using namespace std::placeholders;
-  manager->setGeometryCallback(std::bind(&OnlinedataController::airspaceGeometryCallback, this, _1, _2));
+  stagingManager->setGeometryCallback(std::bind(&OnlinedataController::airspaceGeometryCallback, this, _1, _2));
 
 #ifdef DEBUG_ONLINE_DOWNLOAD
   downloader->enableCache(60);
@@ -112,7 +119,9 @@ OnlinedataController::OnlinedataController(atools::fs::online::OnlinedataManager
 
 OnlinedataController::~OnlinedataController()
 {
-  manager->setGeometryCallback(atools::fs::online::GeoCallbackType(nullptr));
+  cancelDecode();
+
+  stagingManager->setGeometryCallback(atools::fs::online::GeoCallbackType(nullptr));
 
   deInitQueries();
 
@@ -121,6 +130,7 @@ OnlinedataController::~OnlinedataController()
   // Remove all from the database to avoid confusion on startup
 #ifndef DEBUG_INFORMATION
   manager->clearData();
+  stagingManager->clearData();
 #endif
 }
 
@@ -166,6 +176,7 @@ void OnlinedataController::updateAtcSizes()
     sizeMap.insert(type, diameter != -1 ? std::max(1, diameter / 2) : -1);
   }
   manager->setAtcSize(sizeMap);
+  stagingManager->setAtcSize(sizeMap);
 }
 
 void OnlinedataController::startProcessing()
@@ -250,7 +261,7 @@ atools::sql::SqlDatabase *OnlinedataController::getDatabase()
   return manager->getDatabase();
 }
 
-QString OnlinedataController::uncompress(const QByteArray& data, const QString& func, bool utf8)
+QString OnlinedataController::uncompress(const QByteArray& data, const QString& func, bool utf8) const
 {
   QByteArray textData = atools::zip::gzipDecompressIf(data, func);
 
@@ -266,6 +277,99 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
   if(verbose)
     qDebug() << Q_FUNC_INFO << "url" << url << "data size" << data.size() << "state" << stateAsStr(currentState);
 
+  // Whazzup JSON files are several megabytes on busy days - unzip, convert and parse them in background
+  atools::fs::online::Format format = convertFormat(OptionData::instance().getOnlineFormat());
+  bool utf8 = false;
+  if(currentState == DOWNLOADING_TRANSCEIVERS)
+    utf8 = true;
+  else if(currentState == DOWNLOADING_WHAZZUP)
+    utf8 = format == atools::fs::online::VATSIM_JSON3 || format == atools::fs::online::IVAO_JSON2;
+
+  // State stays unchanged while decoding which prevents new downloads
+  State state = currentState;
+  decodeCanceled = false;
+  decodeWatcher.setFuture(QtConcurrent::run([ = ]() -> DecodeResult {
+    return decode(data, state, format, utf8);
+  }));
+}
+
+OnlinedataController::DecodeResult OnlinedataController::decode(const QByteArray& data, State state,
+                                                                atools::fs::online::Format format, bool utf8)
+{
+  DecodeResult result;
+  result.text = uncompress(data, Q_FUNC_INFO, utf8);
+
+  // Parse into the staging database which is not used by the main thread - status.txt is small and read later
+  if(state == DOWNLOADING_TRANSCEIVERS)
+    stagingManager->readFromTransceivers(result.text);
+  else if(state == DOWNLOADING_WHAZZUP)
+  {
+    result.updated = stagingManager->readFromWhazzup(result.text, format, stagingManager->getLastUpdateTimeFromWhazzup());
+
+    if(result.updated && !decodeCanceled)
+      updateDifferences(result.clientsChanged, result.atcChanged);
+  }
+  else if(state == DOWNLOADING_WHAZZUP_SERVERS)
+  {
+    stagingManager->readServersFromWhazzup(result.text, format, stagingManager->getLastUpdateTimeFromWhazzup());
+    result.updated = true;
+  }
+
+  return result;
+}
+
+void OnlinedataController::cancelDecode()
+{
+  // Ignore result of running decoder
+  decodeCanceled = true;
+
+  // Parser might wait for airspace geometry from the main thread - keep the event loop running
+  while(decodeWatcher.isRunning())
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents, 10);
+}
+
+void OnlinedataController::copyFromStaging()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // Parsing and geometry calculation is done - copy the tables in one transaction
+  // which avoids partial updates for queries in the main thread
+  atools::sql::SqlDatabase *db = getDatabase();
+  atools::sql::SqlQuery query(db);
+  query.exec("attach database '" + stagingManager->getDatabase()->databaseName() + "' as staging");
+
+  {
+    atools::sql::SqlTransaction transaction(db);
+    for(const QString& table : {QStringLiteral("client"), QStringLiteral("atc"), QStringLiteral("server")})
+    {
+      query.exec("delete from " + table);
+      query.exec("insert into " + table + " select * from staging." + table);
+    }
+    transaction.commit();
+  }
+
+  query.exec("detach database staging");
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Copied staging database in" << timer.elapsed() << "ms";
+}
+
+void OnlinedataController::decodeFinished()
+{
+  if(decodeCanceled)
+  {
+    // Options changed or shutdown while decoding
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Canceled";
+    return;
+  }
+
+  processDownload(decodeWatcher.result());
+}
+
+void OnlinedataController::processDownload(const DecodeResult& result)
+{
   const QDateTime now = QDateTime::currentDateTime();
   if(currentState == DOWNLOADING_STATUS)
   {
@@ -274,7 +378,7 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_STATUS";
 
     // Parse status file
-    manager->readFromStatus(uncompress(data, Q_FUNC_INFO, false /* utf8 */));
+    manager->readFromStatus(result.text);
 
     // Get URL from status file
     bool whazzupGzipped = false, whazzupJson = false;
@@ -312,9 +416,7 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_TRANSCEIVERS";
 
-    // transceivers.json downloaded ============================================
-    manager->readFromTransceivers(uncompress(data, Q_FUNC_INFO, true /* utf8 */));
-
+    // transceivers.json downloaded and read into staging database ============================================
     // Next in chain after transceivers is JSON
     currentState = DOWNLOADING_WHAZZUP;
     lastUpdateTimeTransceivers = now;
@@ -326,16 +428,29 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_WHAZZUP";
 
-    // whazzup.txt or JSON downloaded ============================================
+    // whazzup.txt or JSON downloaded and read into staging database ============================================
     atools::fs::online::Format format = convertFormat(OptionData::instance().getOnlineFormat());
 
     // Contains servers and does not need an extra download
     bool vatsimJson = format == atools::fs::online::VATSIM_JSON3;
     bool ivaoJson = format == atools::fs::online::IVAO_JSON2;
 
-    if(manager->readFromWhazzup(uncompress(data, Q_FUNC_INFO, ivaoJson || vatsimJson /* utf8 */),
-                                format, manager->getLastUpdateTimeFromWhazzup()))
+    if(result.updated)
     {
+      copyFromStaging();
+
+      // Clear map display cache and update spatial index to match simulator shadow aircraft
+      aircraftCache.clear();
+      QHash<int, int> lastShadows = aircraftIdOnlineToSim;
+      updateShadowIndex();
+
+      // Message for search tabs, map widget and info - skip expensive reload of centers if not changed
+      // Search tables load only the visible rows and the selection
+      if(result.atcChanged)
+        emit onlineClientAndAtcUpdated(false /* load all */, true /* keep selection */);
+      else if(result.clientsChanged || lastShadows != aircraftIdOnlineToSim)
+        emit onlineClientsUpdated(false /* load all */, true /* keep selection */);
+
       QString whazzupVoiceUrlFromStatus = manager->getWhazzupVoiceUrlFromStatus();
       if(!vatsimJson && !ivaoJson && !whazzupVoiceUrlFromStatus.isEmpty() &&
          lastServerDownload < now.addSecs(-MIN_SERVER_DOWNLOAD_INTERVAL_MIN * 60))
@@ -352,13 +467,7 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
         currentState = NONE;
         lastUpdateTime = now;
 
-        // Clear map display cache and update spatial index to match simulator shadow aircraft
-        aircraftCache.clear();
-        updateShadowIndex();
-
-        // Message for search tabs, map widget and info
         emit onlineServersUpdated(true /* load all */, true /* keep selection */);
-        emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
         statusBarMessage();
       }
     }
@@ -378,9 +487,8 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     if(verbose)
       qDebug() << Q_FUNC_INFO << "DOWNLOADING_WHAZZUP_SERVERS";
 
-    manager->readServersFromWhazzup(uncompress(data, Q_FUNC_INFO, false /* utf8 */),
-                                    convertFormat(OptionData::instance().getOnlineFormat()),
-                                    manager->getLastUpdateTimeFromWhazzup());
+    // Servers were read into staging database
+    copyFromStaging();
     lastServerDownload = now;
 
     // Done after downloading server.txt - start timer for next session
@@ -388,8 +496,7 @@ void OnlinedataController::downloadFinished(const QByteArray& data, QString url)
     currentState = NONE;
     lastUpdateTime = now;
 
-    // Message for search tabs, map widget and info
-    emit onlineClientAndAtcUpdated(true /* load all */, true /* keep selection */);
+    // Clients and centers were already sent after whazzup download
     emit onlineServersUpdated(true /* load all */, true /* keep selection */);
     statusBarMessage();
   }
@@ -449,6 +556,8 @@ void OnlinedataController::statusBarMessage()
 
 void OnlinedataController::stopAllProcesses()
 {
+  // Ignore result of running decoder
+  decodeCanceled = true;
   downloader->cancelDownload();
   downloadTimer.stop();
   currentState = NONE;
@@ -462,6 +571,27 @@ void OnlinedataController::showMessageDialog()
 }
 
 const LineString *OnlinedataController::airspaceGeometryCallback(const QString& callsign, atools::fs::online::fac::FacilityType type)
+{
+  if(!(OptionData::instance().getFlags2() & (opts2::ONLINE_AIRSPACE_BY_NAME | opts2::ONLINE_AIRSPACE_BY_FILE)))
+    return nullptr;
+
+  // Airspace queries and caches are not thread safe - run in main thread and keep a copy of the geometry
+  bool found = false;
+  if(!decodeCanceled)
+  {
+    QMetaObject::invokeMethod(this, [this, &callsign, type, &found]() {
+      const LineString *lineString = airspaceGeometryCallbackInternal(callsign, type);
+      found = lineString != nullptr;
+      if(found)
+        geometryCallbackLineString = *lineString;
+    }, Qt::BlockingQueuedConnection);
+  }
+
+  return found ? &geometryCallbackLineString : nullptr;
+}
+
+const LineString *OnlinedataController::airspaceGeometryCallbackInternal(const QString& callsign,
+                                                                         atools::fs::online::fac::FacilityType type)
 {
   opts2::Flags2 flags2 = OptionData::instance().getFlags2();
 
@@ -486,12 +616,17 @@ void OnlinedataController::optionsChanged()
   qDebug() << Q_FUNC_INFO;
 
   // Clear all URL from status.txt too
+  cancelDecode();
   manager->resetForNewOptions();
+  stagingManager->resetForNewOptions();
   stopAllProcesses();
 
   // Remove all from the database
   manager->clearData();
+  stagingManager->clearData();
   aircraftCache.clear();
+  lastClients.clear();
+  lastAtcChecksum.clear();
   onlineAircraftSpatialIndex.clear();
   aircraftIdSimToOnline.clear();
   aircraftIdOnlineToSim.clear();
@@ -772,7 +907,7 @@ void OnlinedataController::updateShadowIndex()
 
   if(OptionData::instance().getFlags().testFlag(opts::ONLINE_REMOVE_SHADOW) && !currentDataPacketMap.isEmpty())
   {
-    const QDateTime lastUpdateTimeWhazzup = manager->getLastUpdateTimeFromWhazzup();
+    const QDateTime lastUpdateTimeWhazzup = stagingManager->getLastUpdateTimeFromWhazzup();
     const auto upper = currentDataPacketMap.upperBound(lastUpdateTimeWhazzup);
     const auto lower = currentDataPacketMap.lowerBound(lastUpdateTimeWhazzup);
     QMap<QDateTime, atools::fs::sc::SimConnectData>::iterator entry = currentDataPacketMap.end();
@@ -817,7 +952,7 @@ void OnlinedataController::updateShadowIndex()
       if(currentDataPacket.isUserAircraftValid())
       {
         // Fill and update spatial index =================================
-        onlineAircraftSpatialIndex.append(manager->getClientCallsignAndPosMap());
+        onlineAircraftSpatialIndex.append(stagingManager->getClientCallsignAndPosMap());
         onlineAircraftSpatialIndex.updateIndex();
 
         const atools::fs::sc::SimConnectUserAircraft& simUserAircraft = currentDataPacket.getUserAircraftConst();
@@ -862,6 +997,54 @@ void OnlinedataController::updateShadowIndex()
   }
 }
 
+void OnlinedataController::updateDifferences(bool& clientsChanged, bool& atcChanged)
+{
+  // Clients ===========================================================
+  // Compare by semi-permanent id and all values shown on the map
+  QHash<int, OnlineAircraft> clients;
+  int added = 0, removed = 0, changed = 0;
+  for(const OnlineAircraft& aircraft : stagingManager->getClientCallsignAndPosMap())
+  {
+    clients.insert(aircraft.id, aircraft);
+
+    auto it = lastClients.constFind(aircraft.id);
+    if(it == lastClients.constEnd())
+      added++;
+    else if(it->pos.getLonX() != aircraft.pos.getLonX() || it->pos.getLatY() != aircraft.pos.getLatY() ||
+            it->pos.getAltitude() != aircraft.pos.getAltitude() || it->groundSpeedKts != aircraft.groundSpeedKts ||
+            it->headingTrue != aircraft.headingTrue || it->registration != aircraft.registration)
+      changed++;
+  }
+
+  for(auto it = lastClients.constBegin(); it != lastClients.constEnd(); ++it)
+  {
+    if(!clients.contains(it.key()))
+      removed++;
+  }
+  lastClients.swap(clients);
+  clientsChanged = added > 0 || removed > 0 || changed > 0;
+
+  // Centers ===========================================================
+  // Checksum over all columns including the id since the map, screen index and information window keep
+  // airspace ids of centers. New ids have to clear the online airspace caches by sending onlineClientAndAtcUpdated.
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  atools::sql::SqlQuery query(stagingManager->getDatabase());
+  query.exec("select * from atc order by atc_id");
+  while(query.next())
+  {
+    atools::sql::SqlRecord rec = query.record();
+    for(int i = 0; i < rec.count(); i++)
+      hash.addData(rec.value(i).toString().toUtf8().append('\0'));
+  }
+  QByteArray atcChecksum = hash.result();
+  atcChanged = atcChecksum != lastAtcChecksum;
+  lastAtcChecksum = atcChecksum;
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "clients added" << added << "removed" << removed << "changed" << changed
+             << "atcChanged" << atcChanged;
+}
+
 atools::fs::sc::SimConnectAircraft OnlinedataController::getClientAircraftById(int id)
 {
   return manager->getClientAircraftById(id);
@@ -940,7 +1123,7 @@ void OnlinedataController::startDownloadTimer()
     if(intervalSeconds == -1)
     {
       // Use time from whazzup.txt - mode auto
-      intervalSeconds = std::max(manager->getReloadMinutesFromWhazzup() * 60, 60);
+      intervalSeconds = std::max(stagingManager->getReloadMinutesFromWhazzup() * 60, 60);
       source = "whazzup";
     }
     else
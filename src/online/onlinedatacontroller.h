@@ -19,13 +19,17 @@
 #define LNM_ONLINECONTROLLER_H
 
 #include "fs/online/onlinetypes.h"
+#include "geo/linestring.h"
 #include "geo/spatialindex.h"
 #include "query/querytypes.h"
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <QObject>
 #include <QTimer>
 
+#include <atomic>
+
 class MapLayer;
 
 namespace Marble {
@@ -73,7 +77,9 @@ class OnlinedataController :
   Q_OBJECT
 
 public:
-  explicit OnlinedataController(atools::fs::online::OnlinedataManager *onlineManager, MainWindow *parent);
+  /* onlineStagingManager is used to parse files in background. Data is copied to onlineManager afterwards. */
+  explicit OnlinedataController(atools::fs::online::OnlinedataManager *onlineManager,
+                                atools::fs::online::OnlinedataManager *onlineStagingManager, MainWindow *parent);
   virtual ~OnlinedataController() override;
 
   OnlinedataController(const OnlinedataController& other) = delete;
@@ -147,19 +153,60 @@ public:
   void debugDumpContainerSizes() const;
 
 signals:
-  /* Sent whenever new data was downloaded */
+  /* Sent whenever new data was downloaded and centers changed. Covers clients too. */
   void onlineClientAndAtcUpdated(bool loadAll, bool keepSelection);
+
+  /* Sent after download if only clients changed but not centers */
+  void onlineClientsUpdated(bool loadAll, bool keepSelection);
+
   void onlineServersUpdated(bool loadAll, bool keepSelection);
 
   /* Sent when network changes via options dialog */
   void onlineNetworkChanged();
 
 private:
+  /* State is set before triggering the download and clear on the last download in the chain.
+   *  Set to NONE while timeout for whazzup download is running. */
+  enum State
+  {
+    NONE, /* Not downloading anything */
+    DOWNLOADING_STATUS, /* Downloading status.txt */
+    DOWNLOADING_WHAZZUP, /* Downloading whazzup.txt or JSON file */
+    DOWNLOADING_TRANSCEIVERS, /* Downloading transceivers-data-fmt.json */
+    DOWNLOADING_WHAZZUP_SERVERS /* Downloading servers */
+  };
+
+  /* Result of background decoding and parsing */
+  struct DecodeResult
+  {
+    QString text; /* Uncompressed and converted file content */
+    bool updated = false; /* Staging database was updated and has to be copied */
+    bool clientsChanged = false, atcChanged = false; /* Differences to last whazzup file */
+  };
+
   /* True if there is an online network aircraft that has similar position and altitude as the simulator aircraft. */
   bool isShadowAircraft(const atools::fs::sc::SimConnectAircraft& simAircraft);
 
-  /* HTTP download signal slots for all possible files/URLs */
+  /* HTTP download signal slots for all possible files/URLs. Starts decoding in background. */
   void downloadFinished(const QByteArray& data, QString url);
+
+  /* Called in background. Uncompresses data and reads whazzup, server and transceiver files into the staging database. */
+  DecodeResult decode(const QByteArray& data, OnlinedataController::State state, atools::fs::online::Format format, bool utf8);
+
+  /* Decoding finished - copy staging database and continue download chain */
+  void decodeFinished();
+  void processDownload(const DecodeResult& result);
+
+  /* Stop background decoding and wait until it is finished */
+  void cancelDecode();
+
+  /* Replace clients, centers and servers in the online database with the content of the staging database */
+  void copyFromStaging();
+
+  /* Compare clients and centers in staging database with last download. Returns false for both if nothing changed.
+   * Called in background. */
+  void updateDifferences(bool& clientsChanged, bool& atcChanged);
+
   void downloadFailed(const QString& error, int errorCode, QString url);
   void downloadSslErrors(const QStringList& errors, const QString& downloadUrl);
   void statusBarMessage();
@@ -171,11 +218,15 @@ private:
 
   /* Show message from status.txt */
   void showMessageDialog();
-  QString uncompress(const QByteArray& data, const QString& func, bool utf8);
+  /* Thread safe */
+  QString uncompress(const QByteArray& data, const QString& func, bool utf8) const;
   void startDownloader();
 
-  /* Tries to fetch geometry for atc centers from the user geometry database from cache */
+  /* Tries to fetch geometry for atc centers from the user geometry database from cache.
+   * Called in background while parsing. Runs airspaceGeometryCallbackInternal() in main thread. */
   const atools::geo::LineString *airspaceGeometryCallback(const QString& callsign, atools::fs::online::fac::FacilityType type);
+  const atools::geo::LineString *airspaceGeometryCallbackInternal(const QString& callsign,
+                                                                   atools::fs::online::fac::FacilityType type);
 
   /* Called after each download */
   void updateShadowIndex();
@@ -187,22 +238,14 @@ private:
   /* Database manager */
   atools::fs::online::OnlinedataManager *manager;
 
+  /* Database manager used for parsing in background. Keeps state of the last whazzup file. */
+  atools::fs::online::OnlinedataManager *stagingManager;
+
   /* Downloader for all files */
   atools::util::HttpDownloader *downloader;
 
   MainWindow *mainWindow;
 
-  /* State is set before triggering the download and clear on the last download in the chain.
-   *  Set to NONE while timeout for whazzup download is running. */
-  enum State
-  {
-    NONE, /* Not downloading anything */
-    DOWNLOADING_STATUS, /* Downloading status.txt */
-    DOWNLOADING_WHAZZUP, /* Downloading whazzup.txt or JSON file */
-    DOWNLOADING_TRANSCEIVERS, /* Downloading transceivers-data-fmt.json */
-    DOWNLOADING_WHAZZUP_SERVERS /* Downloading servers */
-  };
-
   QString stateAsStr(OnlinedataController::State state);
 
   // Criteria used to detect shadow aircraft right after download finished
@@ -241,6 +284,17 @@ private:
   // fit to the last update time of the downloaded whazzup file
   QMap<QDateTime, atools::fs::sc::SimConnectData> currentDataPacketMap;
 
+  // Unzips, converts and parses downloaded files in background
+  QFutureWatcher<DecodeResult> decodeWatcher;
+  std::atomic_bool decodeCanceled{false};
+
+  // Copy of the geometry returned to the parser since cache entries in the airspace controller can be evicted
+  atools::geo::LineString geometryCallbackLineString;
+
+  // Clients from last download by client id and checksum of all centers to detect changes
+  QHash<int, atools::fs::online::OnlineAircraft> lastClients;
+  QByteArray lastAtcChecksum;
+
   // Cache used for map display
   query::SimpleRectCache<atools::fs::sc::SimConnectAircraft> aircraftCache;
   atools::sql::SqlQuery *aircraftByRectQuery = nullptr;
@@ -1509,7 +1509,7 @@ private:
   int displaySunShadingDimFactor = 40;
 
   // spinBoxSimMaxTrackPoints
-  int aircraftTrackMaxPoints = 20000;
+  int aircraftTrackMaxPoints = 50000;
 
   // spinBoxSimDoNotFollowOnScrollTime
   int simNoFollowOnScrollTime = 10;
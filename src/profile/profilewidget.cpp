@@ -45,6 +45,7 @@
 
 #include <QPainter>
 #include <QTimer>
+#include <QtConcurrent/QtConcurrentMap>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QStringBuilder>
 
@@ -74,6 +75,9 @@ static const float ELEVATION_SAMPLE_RADIUS_NM = 0.1f;
 /* Do not calculate a profile for legs longer than this value */
 static const int ELEVATION_MAX_LEG_NM = 2000;
 
+/* Maximum number of elevation points kept in the leg cache */
+static const int ELEVATION_CACHE_MAX_POINTS = 1000000;
+
 /* Zoom to aircraft + 100 NM or to aircraft to destination */
 static const float ZOOM_DESTINATION_MAX_AHEAD = 100.f;
 
@@ -153,6 +157,21 @@ struct ElevationLeg
   float maxElevation = 0.f; /* Max ground altitude for this leg */
 };
 
+/* Cached elevation points for one leg geometry */
+struct ElevationCacheEntry
+{
+  atools::geo::LineString geometry, /* Used to detect hash collisions */
+                          elevations; /* Elevations in meter as returned by ProfileWidget::fetchRouteElevations() */
+};
+
+/* Elevation points for one leg which are fetched in parallel */
+struct ElevationFetch
+{
+  atools::geo::LineString geometry, elevations;
+  bool skip = false, /* Leg is too long for online elevation data */
+       ok = true; /* false if aborted */
+};
+
 struct ElevationLegList
 {
   Route route; /* Copy from route controller.
@@ -176,6 +195,7 @@ ProfileWidget::ProfileWidget(QWidget *parent)
 
   profileOptions = new ProfileOptions(this);
   legList = new ElevationLegList;
+  elevationCache = new QCache<uint, ElevationCacheEntry>(ELEVATION_CACHE_MAX_POINTS);
 
   scrollArea = new ProfileScrollArea(this, ui->scrollAreaProfile);
   scrollArea->setProfileLeftOffset(left);
@@ -228,6 +248,9 @@ ProfileWidget::~ProfileWidget()
   delete legList;
   legList = nullptr;
 
+  delete elevationCache;
+  elevationCache = nullptr;
+
   qDebug() << Q_FUNC_INFO << "delete profileOptions";
   delete profileOptions;
   profileOptions = nullptr;
@@ -1818,6 +1841,12 @@ QStringList ProfileWidget::textsAndColorForLeg(QColor& color, bool& procSymbol,
 /* Update signal from Marble elevation model */
 void ProfileWidget::elevationUpdateAvailable()
 {
+  {
+    // Elevation data changed - all cached legs are invalid
+    QMutexLocker locker(&elevationCacheMutex);
+    elevationCache->clear();
+  }
+
   if(databaseLoadStatus)
     return;
 
@@ -1944,20 +1973,22 @@ bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations, co
       QVector<Marble::GeoDataLineString *> coordsCorrected = coords.toDateLineCorrected();
       for(const Marble::GeoDataLineString *ls : coordsCorrected)
       {
-        for(int j = 1; j < ls->size(); j++)
+        if(terminateThreadSignal)
         {
-          if(terminateThreadSignal)
-            return false;
-
-          const Marble::GeoDataCoordinates& c1 = ls->at(j - 1);
-          const Marble::GeoDataCoordinates& c2 = ls->at(j);
-          Pos p1(c1.longitude(), c1.latitude());
-          Pos p2(c2.longitude(), c2.latitude());
+          qDeleteAll(coordsCorrected);
+          return false;
+        }
 
-          p1.toDeg();
-          p2.toDeg();
-          elevationProvider->getElevations(elevations, atools::geo::Line(p1, p2), atools::geo::nmToMeter(ELEVATION_SAMPLE_RADIUS_NM));
+        LineString lineString;
+        for(const Marble::GeoDataCoordinates& c : *ls)
+        {
+          Pos pos(c.longitude(), c.latitude());
+          pos.toDeg();
+          lineString.append(pos);
         }
+
+        // Get elevations for all points in one call
+        elevationProvider->getElevations(elevations, lineString, atools::geo::nmToMeter(ELEVATION_SAMPLE_RADIUS_NM));
       }
       qDeleteAll(coordsCorrected);
     }
@@ -1983,6 +2014,42 @@ bool ProfileWidget::fetchRouteElevations(atools::geo::LineString& elevations, co
   return true;
 }
 
+/* Hash for leg geometry used as key in the elevation cache */
+static uint geometryHash(const atools::geo::LineString& geometry)
+{
+  uint hash = static_cast<uint>(geometry.size());
+  for(const Pos& pos : geometry)
+    hash = (hash * 31) ^ ::qHash(pos.getLonX()) ^ (::qHash(pos.getLatY()) << 1);
+  return hash;
+}
+
+bool ProfileWidget::fetchRouteElevationsCached(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const
+{
+  uint hash = geometryHash(geometry);
+
+  {
+    QMutexLocker locker(&elevationCacheMutex);
+    const ElevationCacheEntry *entry = elevationCache->object(hash);
+    if(entry != nullptr && entry->geometry == geometry)
+    {
+      elevations = entry->elevations;
+      return true;
+    }
+  }
+
+  // Fetch outside of lock to allow parallel loading of other legs
+  if(!fetchRouteElevations(elevations, geometry))
+    return false;
+
+  ElevationCacheEntry *entry = new ElevationCacheEntry;
+  entry->geometry = geometry;
+  entry->elevations = elevations;
+
+  QMutexLocker locker(&elevationCacheMutex);
+  elevationCache->insert(hash, entry, elevations.size());
+  return true;
+}
+
 /* Background thread. Fetches elevation points from Marble elevation model and updates totals. */
 ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs) const
 {
@@ -2006,19 +2073,51 @@ ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs
     // Return empty result
     return ElevationLegList();
 
+  // Collect geometry for all legs first ===============================================
+  int lastLegIndex = legs.route.getDestinationLegIndex();
+  QVector<ElevationFetch> fetches;
+  for(int i = 1; i <= lastLegIndex; i++)
+  {
+    const RouteAltitudeLeg& altLeg = legs.route.getAltitudeLegAt(i);
+    if(altLeg.isMissed() || altLeg.isAlternate())
+    {
+      lastLegIndex = i - 1;
+      break;
+    }
+
+    ElevationFetch fetch;
+    // Skip for too long segments when using the marble online provider
+    fetch.skip = !(altLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::isGlobeOfflineProvider());
+    if(!fetch.skip)
+    {
+      fetch.geometry = altLeg.getGeoLineString();
+      fetch.geometry.removeInvalid();
+      if(fetch.geometry.size() == 1)
+        fetch.geometry.append(fetch.geometry.constFirst());
+    }
+    fetches.append(fetch);
+  }
+
+  // Get elevations for all legs in parallel - unchanged legs are taken from the cache ================
+  QtConcurrent::blockingMap(fetches, [this](ElevationFetch& fetch) -> void
+  {
+    if(!fetch.skip && !terminateThreadSignal)
+      // Includes first and last point
+      fetch.ok = fetchRouteElevationsCached(fetch.elevations, fetch.geometry);
+  });
+
   // Total calculated distance across all legs
   double totalDistanceNm = 0.;
 
   // Loop over all route legs - first is departure airport point
-  for(int i = 1; i <= legs.route.getDestinationLegIndex(); i++)
+  for(int i = 1; i <= lastLegIndex; i++)
   {
     if(terminateThreadSignal)
       // Return empty result
       return ElevationLegList();
 
     const RouteAltitudeLeg& altLeg = legs.route.getAltitudeLegAt(i);
-    if(altLeg.isMissed() || altLeg.isAlternate())
-      break;
+    ElevationFetch& fetch = fetches[i - 1];
 
     ElevationLeg leg;
     leg.ident = altLeg.getIdent();
@@ -2026,18 +2125,12 @@ ElevationLegList ProfileWidget::fetchRouteElevationsThread(ElevationLegList legs
     // Used to adapt distances of all legs to total distance due to inaccuracies
     double scale = 1.;
 
-    // Skip for too long segments when using the marble online provider
-    if(altLeg.getDistanceTo() < ELEVATION_MAX_LEG_NM || NavApp::isGlobeOfflineProvider())
+    if(!fetch.skip)
     {
-      LineString geometry = altLeg.getGeoLineString();
-
-      geometry.removeInvalid();
-      if(geometry.size() == 1)
-        geometry.append(geometry.constFirst());
+      const LineString& geometry = fetch.geometry;
+      LineString& elevations = fetch.elevations;
 
-      // Includes first and last point
-      LineString elevations;
-      if(!fetchRouteElevations(elevations, geometry))
+      if(!fetch.ok)
         return ElevationLegList();
 
       if(elevations.isEmpty())
@@ -20,7 +20,9 @@
 
 #include "fs/sc/simconnectdata.h"
 
+#include <QCache>
 #include <QFutureWatcher>
+#include <QMutex>
 #include <QWidget>
 
 namespace atools {
@@ -48,6 +50,7 @@ class Route;
 class RouteLeg;
 class ProfileOptions;
 struct ElevationLegList;
+struct ElevationCacheEntry;
 
 /*
  * Loads and displays the flight plan elevation profile. The elevation data is
@@ -208,6 +211,9 @@ private:
   virtual void contextMenuEvent(QContextMenuEvent *event) override;
 
   bool fetchRouteElevations(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const;
+
+  /* Get elevations for leg geometry from cache or fetch them. Thread safe. @return false if aborted */
+  bool fetchRouteElevationsCached(atools::geo::LineString& elevations, const atools::geo::LineString& geometry) const;
   ElevationLegList fetchRouteElevationsThread(ElevationLegList legs) const;
   void elevationUpdateAvailable();
   void updateTimeout();
@@ -306,6 +312,11 @@ private:
   QFutureWatcher<ElevationLegList> watcher;
   bool terminateThreadSignal = false;
 
+  /* Elevation points for each leg keyed by geometry hash. Avoids fetching elevations for unchanged legs when
+   * editing the flight plan. Cleared when elevation data changes. */
+  QCache<uint, ElevationCacheEntry> *elevationCache;
+  mutable QMutex elevationCacheMutex;
+
   bool databaseLoadStatus = false;
   bool active = false;
   bool insideResizeEvent = false; // Avoid recursion when resize is called by ProfileScrollArea::scaleView
@@ -73,7 +73,7 @@ bool AirspaceQuery::hasAirspaceById(int airspaceId)
 
   bool retval = false;
   airspaceByIdQuery->bindValue(":id", airspaceId);
-  airspaceByIdQuery->exec();
+  query::exec(airspaceByIdQuery);
   if(airspaceByIdQuery->next())
     retval = true;
   airspaceByIdQuery->finish();
@@ -87,7 +87,7 @@ SqlRecord AirspaceQuery::getOnlineAirspaceRecordById(int airspaceId)
     SqlQuery query(db);
     query.prepare("select * from atc where atc_id = :id");
     query.bindValue(":id", airspaceId);
-    query.exec();
+    query::exec(&query);
     if(query.next())
       return query.record();
   }
@@ -100,7 +100,7 @@ void AirspaceQuery::getAirspaceById(map::MapAirspace& airspace, int airspaceId)
     return;
 
   airspaceByIdQuery->bindValue(":id", airspaceId);
-  airspaceByIdQuery->exec();
+  query::exec(airspaceByIdQuery);
   if(airspaceByIdQuery->next())
     mapTypesFactory->fillAirspace(airspaceByIdQuery->record(), airspace, source);
 
@@ -195,7 +195,7 @@ const QList<map::MapAirspace> *AirspaceQuery::getAirspaces(const GeoDataLatLonBo
             }
 
             // Run query ===========================================
-            query->exec();
+            query::exec(query);
             while(query->next())
             {
               // Avoid double airspaces which can happen if they cross the date boundary
@@ -244,7 +244,7 @@ const LineString *AirspaceQuery::getAirspaceGeometryById(int airspaceId)
     LineString *lines = new LineString;
 
     airspaceLinesByIdQuery->bindValue(":id", airspaceId);
-    airspaceLinesByIdQuery->exec();
+    query::exec(airspaceLinesByIdQuery);
     if(airspaceLinesByIdQuery->next())
     {
       atools::fs::common::BinaryGeometry geometry(airspaceLinesByIdQuery->value("geometry").toByteArray());
@@ -257,6 +257,24 @@ const LineString *AirspaceQuery::getAirspaceGeometryById(int airspaceId)
   }
 }
 
+const LineString *AirspaceQuery::getAirspaceGeometryById(int airspaceId, int lodLevel)
+{
+  const LineString *lines = getAirspaceGeometryById(airspaceId);
+  if(lines != nullptr)
+    return geometryCache.getGeometry(airspaceId, lodLevel, *lines);
+  else
+    return nullptr;
+}
+
+const QVector<QPolygonF> *AirspaceQuery::getAirspaceScreenPolygonsById(int airspaceId, const Marble::ViewportParams *viewport)
+{
+  const LineString *lines = getAirspaceGeometryById(airspaceId, AirspaceGeometryCache::lodLevel(viewport));
+  if(lines != nullptr)
+    return geometryCache.getScreenPolygons(airspaceId, viewport, *lines);
+  else
+    return nullptr;
+}
+
 const LineString *AirspaceQuery::getAirspaceGeometryByFile(QString callsign)
 {
   if(airspaceGeoByFileQuery != nullptr)
@@ -275,7 +293,7 @@ const LineString *AirspaceQuery::getAirspaceGeometryByFile(QString callsign)
 
       // Do a pattern query and check for basename matches later
       airspaceGeoByFileQuery->bindValue(":filepath", "%" + callsign + "%");
-      airspaceGeoByFileQuery->exec();
+      query::exec(airspaceGeoByFileQuery);
 
       while(airspaceGeoByFileQuery->next())
       {
@@ -351,7 +369,7 @@ const LineString *AirspaceQuery::airspaceGeometryByNameInternal(const QString& c
       // Check if the airspace name matches the callsign
       airspaceGeoByNameQuery->bindValue(":name", callsign);
       airspaceGeoByNameQuery->bindValue(":type", facilityType.isEmpty() ? "%" : facilityType);
-      airspaceGeoByNameQuery->exec();
+      query::exec(airspaceGeoByNameQuery);
 
       if(airspaceGeoByNameQuery->next())
       {
@@ -374,7 +392,7 @@ SqlRecord AirspaceQuery::getAirspaceInfoRecordById(int airspaceId)
   if(airspaceInfoQuery != nullptr)
   {
     airspaceInfoQuery->bindValue(":id", airspaceId);
-    airspaceInfoQuery->exec();
+    query::exec(airspaceInfoQuery);
     if(airspaceInfoQuery->next())
       retval = airspaceInfoQuery->record();
     airspaceInfoQuery->finish();
@@ -393,7 +411,7 @@ void AirspaceQuery::updateAirspaceStatus()
   {
     // Check if the database contains the new FIR/UIR types which are preferred before FIR/UIR center types
     SqlQuery query("select count(1) from boundary where type in ('FIR', 'UIR')", db);
-    query.exec();
+    query::exec(&query);
     hasFirUir = query.next() && query.valueInt(0) > 0;
   }
   else
@@ -518,6 +536,7 @@ void AirspaceQuery::clearCache()
 {
   airspaceCache.clear();
   airspaceLineCache.clear();
+  geometryCache.clear();
   onlineCenterGeoCache.clear();
   onlineCenterGeoFileCache.clear();
 
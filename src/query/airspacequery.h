@@ -18,10 +18,15 @@
 #ifndef LITTLENAVMAP_AIRSPACEQUERY_H
 #define LITTLENAVMAP_AIRSPACEQUERY_H
 
+#include "airspace/airspacegeometrycache.h"
 #include "query/querytypes.h"
 
 #include <QCache>
 
+namespace Marble {
+class ViewportParams;
+}
+
 namespace atools {
 namespace geo {
 class Rect;
@@ -69,6 +74,12 @@ public:
                                               map::MapAirspaceFilter filter, float flightPlanAltitude, bool lazy, bool& overflow);
   const atools::geo::LineString *getAirspaceGeometryById(int airspaceId);
 
+  /* Simplified geometry for level of detail as returned by AirspaceGeometryCache::lodLevel() */
+  const atools::geo::LineString *getAirspaceGeometryById(int airspaceId, int lodLevel);
+
+  /* Projected and simplified polygons for the viewport. Cached per viewport until its view changes. */
+  const QVector<QPolygonF> *getAirspaceScreenPolygonsById(int airspaceId, const Marble::ViewportParams *viewport);
+
   /* Query raw geometry blob by online callsign (name) and facility type */
   const atools::geo::LineString *getAirspaceGeometryByName(QString callsign, const QString& facilityType);
 
@@ -106,6 +117,9 @@ private:
   QCache<int, atools::geo::LineString> airspaceLineCache;
   QCache<QString, atools::geo::LineString> onlineCenterGeoCache, onlineCenterGeoFileCache;
 
+  /* Simplified geometry and screen polygons */
+  AirspaceGeometryCache geometryCache;
+
   static int queryMaxRows;
 
   /* True if tables atc or boundary have content. Updated in clearCache and initQueries */
@@ -55,7 +55,7 @@ void AirwayQuery::getAirwaysForWaypoint(QList<map::MapAirway>& airways, int wayp
     return;
 
   airwayByWaypointIdQuery->bindValue(":id", waypointId);
-  airwayByWaypointIdQuery->exec();
+  query::exec(airwayByWaypointIdQuery);
   while(airwayByWaypointIdQuery->next())
   {
     map::MapAirway airway;
@@ -86,7 +86,7 @@ void AirwayQuery::getWaypointsForAirway(QList<map::MapWaypoint>& waypoints, cons
 
   airwayWaypointByIdentQuery->bindValue(":waypoint", waypointIdent.isEmpty() ? "%" : waypointIdent);
   airwayWaypointByIdentQuery->bindValue(":airway", airwayName.isEmpty() ? "%" : airwayName);
-  airwayWaypointByIdentQuery->exec();
+  query::exec(airwayWaypointByIdentQuery);
   while(airwayWaypointByIdentQuery->next())
   {
     map::MapWaypoint waypoint;
@@ -102,7 +102,7 @@ void AirwayQuery::getWaypointListForAirwayName(QList<map::MapAirwayWaypoint>& wa
     return;
 
   airwayWaypointsQuery->bindValue(":name", airwayName);
-  airwayWaypointsQuery->exec();
+  query::exec(airwayWaypointsQuery);
 
   // Collect records first
   QVector<SqlRecord> records;
@@ -148,7 +148,7 @@ map::MapWaypoint AirwayQuery::waypointById(int id)
     return wp;
 
   waypointByIdQuery->bindValue(":id", id);
-  waypointByIdQuery->exec();
+  query::exec(waypointByIdQuery);
   if(waypointByIdQuery->next())
     mapTypesFactory->fillWaypoint(waypointByIdQuery->record(), wp, trackDatabase);
   waypointByIdQuery->finish();
@@ -163,7 +163,7 @@ void AirwayQuery::getAirwayFull(QList<map::MapAirway>& airways, atools::geo::Rec
 
   airwayFullQuery->bindValue(":name", airwayName);
   airwayFullQuery->bindValue(":fragment", fragment);
-  airwayFullQuery->exec();
+  query::exec(airwayFullQuery);
   while(airwayFullQuery->next())
   {
     map::MapAirway airway;
@@ -186,7 +186,7 @@ void AirwayQuery::getAirwayById(map::MapAirway& airway, int airwayId)
     return;
 
   airwayByIdQuery->bindValue(":id", airwayId);
-  airwayByIdQuery->exec();
+  query::exec(airwayByIdQuery);
   if(airwayByIdQuery->next())
     mapTypesFactory->fillAirwayOrTrack(airwayByIdQuery->record(), airway, trackDatabase);
   airwayByIdQuery->finish();
@@ -199,7 +199,7 @@ void AirwayQuery::getAirwaysByName(QList<map::MapAirway>& airways, const QString
     return;
 
   airwayByNameQuery->bindValue(":name", name);
-  airwayByNameQuery->exec();
+  query::exec(airwayByNameQuery);
   while(airwayByNameQuery->next())
   {
     map::MapAirway airway;
@@ -229,7 +229,7 @@ void AirwayQuery::getAirwaysByNameAndWaypoint(QList<map::MapAirway>& airways, co
     airwayByNameAndWaypointQuery->bindValue(":airway", airwayName.isEmpty() ? "%" : airwayName);
     airwayByNameAndWaypointQuery->bindValue(":ident1", waypoint1);
     airwayByNameAndWaypointQuery->bindValue(":ident2", waypoint2.isEmpty() ? "%" : waypoint2);
-    airwayByNameAndWaypointQuery->exec();
+    query::exec(airwayByNameAndWaypointQuery);
     while(airwayByNameAndWaypointQuery->next())
     {
       map::MapAirway airway;
@@ -263,7 +263,7 @@ const QList<map::MapAirway> *AirwayQuery::getAirways(const GeoDataLatLonBox& rec
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
       query::bindRect(r, airwayByRectQuery);
-      airwayByRectQuery->exec();
+      query::exec(airwayByRectQuery);
       while(airwayByRectQuery->next())
       {
         if(ids.contains(airwayByRectQuery->valueInt(airwayIdCol)))
@@ -53,6 +53,42 @@ using map::MapHolding;
 
 static double queryRectInflationFactor = 0.5;
 static double queryRectInflationIncrement = 0.5;
+
+/* ILS length is 9 NM * 1' per degree. Added to queryRectInflationIncrement to increase covered tiles
+ * since ILS has no bounding to query */
+static const double QUERY_RECT_INFLATION_INCREMENT_ILS = 9. / 60.;
+
+/* Functions comparing the query parameters of layers. Tile caches are invalidated if these return false. */
+static bool sameLayerVor(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersVor(newLayer);
+}
+
+static bool sameLayerNdb(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersNdb(newLayer);
+}
+
+static bool sameLayerMarker(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersMarker(newLayer);
+}
+
+static bool sameLayerHolding(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersHolding(newLayer);
+}
+
+static bool sameLayerAirportMsa(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersAirportMsa(newLayer);
+}
+
+static bool sameLayerIls(const MapLayer *curLayer, const MapLayer *newLayer)
+{
+  return curLayer->hasSameQueryParametersIls(newLayer);
+}
+
 int MapQuery::queryMaxRows = map::MAX_MAP_OBJECTS;
 
 // Queries only used for export ================================================
@@ -80,6 +116,16 @@ MapQuery::MapQuery(atools::sql::SqlDatabase *sqlDbSim, SqlDatabase *sqlDbNav, Sq
   atools::settings::Settings& settings = atools::settings::Settings::instance();
 
   runwayOverwiewCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayOverwiewCache", 1000).toInt());
+
+  // Maximum number of objects kept in the tile caches for each type
+  int tileCacheObjects = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "TileCacheObjects", 50000).toInt();
+  airportCache.setMaxCost(tileCacheObjects);
+  vorCache.setMaxCost(tileCacheObjects);
+  ndbCache.setMaxCost(tileCacheObjects);
+  markerCache.setMaxCost(tileCacheObjects);
+  holdingCache.setMaxCost(tileCacheObjects);
+  ilsCache.setMaxCost(tileCacheObjects);
+  airportMsaCache.setMaxCost(tileCacheObjects);
   queryRectInflationFactor = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationFactor", 0.5).toDouble();
   queryRectInflationIncrement = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "QueryRectInflationIncrement", 0.5).toDouble();
   queryMaxRows = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "MapQueryRowLimit", map::MAX_MAP_OBJECTS).toInt();
@@ -181,7 +227,7 @@ void MapQuery::getVorForWaypoint(map::MapVor& vor, int waypointId) const
     return;
 
   vorByWaypointIdQuery->bindValue(":id", waypointId);
-  vorByWaypointIdQuery->exec();
+  query::exec(vorByWaypointIdQuery);
   if(vorByWaypointIdQuery->next())
     mapTypesFactory->fillVor(vorByWaypointIdQuery->record(), vor);
   vorByWaypointIdQuery->finish();
@@ -193,7 +239,7 @@ void MapQuery::getNdbForWaypoint(map::MapNdb& ndb, int waypointId) const
     return;
 
   ndbByWaypointIdQuery->bindValue(":id", waypointId);
-  ndbByWaypointIdQuery->exec();
+  query::exec(ndbByWaypointIdQuery);
   if(ndbByWaypointIdQuery->next())
     mapTypesFactory->fillNdb(ndbByWaypointIdQuery->record(), ndb);
   ndbByWaypointIdQuery->finish();
@@ -206,7 +252,7 @@ void MapQuery::getVorNearest(map::MapVor& vor, const atools::geo::Pos& pos) cons
 
   vorNearestQuery->bindValue(":lonx", pos.getLonX());
   vorNearestQuery->bindValue(":laty", pos.getLatY());
-  vorNearestQuery->exec();
+  query::exec(vorNearestQuery);
   if(vorNearestQuery->next())
     mapTypesFactory->fillVor(vorNearestQuery->record(), vor);
   vorNearestQuery->finish();
@@ -219,7 +265,7 @@ void MapQuery::getNdbNearest(map::MapNdb& ndb, const atools::geo::Pos& pos) cons
 
   ndbNearestQuery->bindValue(":lonx", pos.getLonX());
   ndbNearestQuery->bindValue(":laty", pos.getLatY());
-  ndbNearestQuery->exec();
+  query::exec(ndbNearestQuery);
   if(ndbNearestQuery->next())
     mapTypesFactory->fillNdb(ndbNearestQuery->record(), ndb);
   ndbNearestQuery->finish();
@@ -399,7 +445,7 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
     airportMsaByIdentQuery->bindValue(":navident", ident);
     airportMsaByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
     airportMsaByIdentQuery->bindValue(":airportident", airport.isEmpty() ? "%" : airport);
-    airportMsaByIdentQuery->exec();
+    query::exec(airportMsaByIdentQuery);
     while(airportMsaByIdentQuery->next())
     {
       MapAirportMsa msa;
@@ -414,7 +460,7 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
   {
     vorByIdentQuery->bindValue(":ident", ident);
     vorByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
-    vorByIdentQuery->exec();
+    query::exec(vorByIdentQuery);
     while(vorByIdentQuery->next())
     {
       MapVor vor;
@@ -429,7 +475,7 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
   {
     ndbByIdentQuery->bindValue(":ident", ident);
     ndbByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
-    ndbByIdentQuery->exec();
+    query::exec(ndbByIdentQuery);
     while(ndbByIdentQuery->next())
     {
       MapNdb ndb;
@@ -451,7 +497,7 @@ void MapQuery::mapObjectByIdentInternal(map::MapResult& result, map::MapTypes ty
   {
     ilsByIdentQuery->bindValue(":ident", ident);
     ilsByIdentQuery->bindValue(":airport", airport);
-    ilsByIdentQuery->exec();
+    query::exec(ilsByIdentQuery);
     while(ilsByIdentQuery->next())
     {
       MapIls ils;
@@ -564,7 +610,7 @@ map::MapVor MapQuery::getVorById(int id) const
     return vor;
 
   vorByIdQuery->bindValue(":id", id);
-  vorByIdQuery->exec();
+  query::exec(vorByIdQuery);
   if(vorByIdQuery->next())
     mapTypesFactory->fillVor(vorByIdQuery->record(), vor);
   vorByIdQuery->finish();
@@ -578,7 +624,7 @@ map::MapNdb MapQuery::getNdbById(int id) const
     return ndb;
 
   ndbByIdQuery->bindValue(":id", id);
-  ndbByIdQuery->exec();
+  query::exec(ndbByIdQuery);
   if(ndbByIdQuery->next())
     mapTypesFactory->fillNdb(ndbByIdQuery->record(), ndb);
   ndbByIdQuery->finish();
@@ -593,7 +639,7 @@ map::MapIls MapQuery::getIlsById(int id) const
     return ils;
 
   ilsByIdQuery->bindValue(":id", id);
-  ilsByIdQuery->exec();
+  query::exec(ilsByIdQuery);
   if(ilsByIdQuery->next())
     mapTypesFactory->fillIls(ilsByIdQuery->record(), ils);
   ilsByIdQuery->finish();
@@ -606,7 +652,7 @@ map::MapAirportMsa MapQuery::getAirportMsaById(int id) const
   if(airportMsaByIdQuery != nullptr)
   {
     airportMsaByIdQuery->bindValue(":id", id);
-    airportMsaByIdQuery->exec();
+    query::exec(airportMsaByIdQuery);
     if(airportMsaByIdQuery->next())
       mapTypesFactory->fillAirportMsa(airportMsaByIdQuery->record(), msa);
     airportMsaByIdQuery->finish();
@@ -620,7 +666,7 @@ map::MapHolding MapQuery::getHoldingById(int id) const
   if(holdingByIdQuery != nullptr)
   {
     holdingByIdQuery->bindValue(":id", id);
-    holdingByIdQuery->exec();
+    query::exec(holdingByIdQuery);
     if(holdingByIdQuery->next())
       mapTypesFactory->fillHolding(holdingByIdQuery->record(), holding);
     holdingByIdQuery->finish();
@@ -649,7 +695,7 @@ QVector<MapIls> MapQuery::getIlsByAirportAndIdent(const QString& airportIdent, c
 
   ilsQuerySimByAirportAndIdent->bindValue(":apt", airportIdent);
   ilsQuerySimByAirportAndIdent->bindValue(":ident", ilsIdent);
-  ilsQuerySimByAirportAndIdent->exec();
+  query::exec(ilsQuerySimByAirportAndIdent);
   while(ilsQuerySimByAirportAndIdent->next())
   {
     MapIls ils;
@@ -667,7 +713,7 @@ QVector<map::MapIls> MapQuery::ilsByAirportAndRunway(const QString& airportIdent
 
   ilsQuerySimByAirportAndRw->bindValue(":apt", airportIdent);
   ilsQuerySimByAirportAndRw->bindValue(":rwy", runway);
-  ilsQuerySimByAirportAndRw->exec();
+  query::exec(ilsQuerySimByAirportAndRw);
   while(ilsQuerySimByAirportAndRw->next())
   {
     MapIls ils;
@@ -867,35 +913,22 @@ const QList<map::MapAirport> *MapQuery::getAirports(const Marble::GeoDataLatLonB
   airportCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
                            [ = ](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
   {
-    return curLayer->hasSameQueryParametersAirport(newLayer) &&
-    // Invalidate cache if settings differ
-    airportCacheAddonFlag == addon && airportCacheNormalFlag == normal;
+    return sameLayerAirport(curLayer, newLayer, addon, normal);
   });
 
   airportCacheAddonFlag = addon;
   airportCacheNormalFlag = normal;
 
   airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
-  return fetchAirports(rect, airportByRectQuery, lazy, false /* overview */, addon, normal, overflow);
+  return fetchAirports(airportByRectQuery, false /* overview */, addon, normal, overflow);
 }
 
 const QList<map::MapAirport> *MapQuery::getAirportsByRect(const atools::geo::Rect& rect, const MapLayer *mapLayer, bool lazy,
                                                           map::MapTypes types, bool& overflow)
 {
-  if(!query::valid(Q_FUNC_INFO, airportByRectQuery))
-    return nullptr;
-
-  const GeoDataLatLonBox latLonBox = GeoDataLatLonBox(rect.getNorth(), rect.getSouth(), rect.getEast(), rect.getWest());
-
-  // Get flags for running separate queries for add-on and normal airports
-  bool addon = types.testFlag(map::AIRPORT_ADDON);
-  bool normal = types & map::AIRPORT_ALL;
-
-  airportCacheAddonFlag = addon;
-  airportCacheNormalFlag = normal;
-
-  airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
-  return fetchAirports(latLonBox, airportByRectQuery, lazy, false /* overview */, addon, normal, overflow);
+  const GeoDataLatLonBox latLonBox = GeoDataLatLonBox(rect.getNorth(), rect.getSouth(), rect.getEast(),
+                                                      rect.getWest(), GeoDataCoordinates::Degree);
+  return getAirports(latLonBox, mapLayer, lazy, types, overflow);
 }
 
 const QList<map::MapVor> *MapQuery::getVors(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
@@ -904,27 +937,11 @@ const QList<map::MapVor> *MapQuery::getVors(const GeoDataLatLonBox& rect, const
   if(!query::valid(Q_FUNC_INFO, vorsByRectQuery))
     return nullptr;
 
-  vorCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+  vorCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy, sameLayerVor);
+  vorCache.fetchTiles([this](const GeoDataLatLonBox& tileRect, QList<MapVor>& tileList) -> void
   {
-    return curLayer->hasSameQueryParametersVor(newLayer);
+    fetchVorTile(tileRect, tileList);
   });
-
-  if(vorCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r :
-        query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-    {
-      query::bindRect(r, vorsByRectQuery);
-      vorsByRectQuery->exec();
-      while(vorsByRectQuery->next())
-      {
-        MapVor vor;
-        mapTypesFactory->fillVor(vorsByRectQuery->record(), vor);
-        vorCache.list.append(vor);
-      }
-    }
-  }
   overflow = vorCache.validate(queryMaxRows);
   return &vorCache.list;
 }
@@ -941,27 +958,11 @@ const QList<map::MapNdb> *MapQuery::getNdbs(const GeoDataLatLonBox& rect, const
   if(!query::valid(Q_FUNC_INFO, ndbsByRectQuery))
     return nullptr;
 
-  ndbCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+  ndbCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy, sameLayerNdb);
+  ndbCache.fetchTiles([this](const GeoDataLatLonBox& tileRect, QList<MapNdb>& tileList) -> void
   {
-    return curLayer->hasSameQueryParametersNdb(newLayer);
+    fetchNdbTile(tileRect, tileList);
   });
-
-  if(ndbCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r :
-        query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-    {
-      query::bindRect(r, ndbsByRectQuery);
-      ndbsByRectQuery->exec();
-      while(ndbsByRectQuery->next())
-      {
-        MapNdb ndb;
-        mapTypesFactory->fillNdb(ndbsByRectQuery->record(), ndb);
-        ndbCache.list.append(ndb);
-      }
-    }
-  }
   overflow = ndbCache.validate(queryMaxRows);
   return &ndbCache.list;
 }
@@ -1004,7 +1005,7 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
       for(const QString& queryType : queryTypes)
       {
         userdataPointByRectQuery->bindValue(":type", queryType);
-        userdataPointByRectQuery->exec();
+        query::exec(userdataPointByRectQuery);
         while(userdataPointByRectQuery->next())
         {
           if(unknownType && !allTypesSelected)
@@ -1059,7 +1060,7 @@ QString MapQuery::airportIdentFromQuery(const QString& queryStr, const QString&
   query.bindValue(":laty", pos.getLatY());
 
   QString airport;
-  query.exec();
+  query::exec(&query);
   if(query.next())
   {
     // Check if max distance is not exceeded
@@ -1080,27 +1081,11 @@ const QList<map::MapMarker> *MapQuery::getMarkers(const GeoDataLatLonBox& rect,
   if(!query::valid(Q_FUNC_INFO, markersByRectQuery))
     return nullptr;
 
-  markerCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                          [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+  markerCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy, sameLayerMarker);
+  markerCache.fetchTiles([this](const GeoDataLatLonBox& tileRect, QList<MapMarker>& tileList) -> void
   {
-    return curLayer->hasSameQueryParametersMarker(newLayer);
+    fetchMarkerTile(tileRect, tileList);
   });
-
-  if(markerCache.list.isEmpty() && !lazy)
-  {
-    for(const GeoDataLatLonBox& r :
-        query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-    {
-      query::bindRect(r, markersByRectQuery);
-      markersByRectQuery->exec();
-      while(markersByRectQuery->next())
-      {
-        map::MapMarker marker;
-        mapTypesFactory->fillMarker(markersByRectQuery->record(), marker);
-        markerCache.list.append(marker);
-      }
-    }
-  }
   overflow = markerCache.validate(queryMaxRows);
   return &markerCache.list;
 }
@@ -1118,27 +1103,11 @@ const QList<map::MapHolding> *MapQuery::getHoldings(const Marble::GeoDataLatLonB
 {
   if(holdingByRectQuery != nullptr)
   {
-    holdingCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                             [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+    holdingCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy, sameLayerHolding);
+    holdingCache.fetchTiles([this](const GeoDataLatLonBox& tileRect, QList<MapHolding>& tileList) -> void
     {
-      return curLayer->hasSameQueryParametersHolding(newLayer);
+      fetchHoldingTile(tileRect, tileList);
     });
-
-    if(holdingCache.list.isEmpty() && !lazy)
-    {
-      for(const GeoDataLatLonBox& r :
-          query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-      {
-        query::bindRect(r, holdingByRectQuery);
-        holdingByRectQuery->exec();
-        while(holdingByRectQuery->next())
-        {
-          MapHolding holding;
-          mapTypesFactory->fillHolding(holdingByRectQuery->record(), holding);
-          holdingCache.list.append(holding);
-        }
-      }
-    }
     overflow = holdingCache.validate(queryMaxRows);
     return &holdingCache.list;
   }
@@ -1150,28 +1119,11 @@ const QList<map::MapAirportMsa> *MapQuery::getAirportMsa(const Marble::GeoDataLa
 {
   if(airportMsaByRectQuery != nullptr)
   {
-    airportMsaCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                                [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+    airportMsaCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy, sameLayerAirportMsa);
+    airportMsaCache.fetchTiles([this](const GeoDataLatLonBox& tileRect, QList<MapAirportMsa>& tileList) -> void
     {
-      return curLayer->hasSameQueryParametersAirportMsa(newLayer);
+      fetchAirportMsaTile(tileRect, tileList);
     });
-
-    if(airportMsaCache.list.isEmpty() && !lazy)
-    {
-      for(const GeoDataLatLonBox& r :
-          query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-      {
-        query::bindRect(r, airportMsaByRectQuery);
-
-        airportMsaByRectQuery->exec();
-        while(airportMsaByRectQuery->next())
-        {
-          MapAirportMsa msa;
-          mapTypesFactory->fillAirportMsa(airportMsaByRectQuery->record(), msa);
-          airportMsaCache.list.append(msa);
-        }
-      }
-    }
     overflow = airportMsaCache.validate(queryMaxRows);
     return &airportMsaCache.list;
   }
@@ -1183,107 +1135,242 @@ const QList<map::MapIls> *MapQuery::getIls(GeoDataLatLonBox rect, const MapLayer
   if(!query::valid(Q_FUNC_INFO, ilsByRectQuery))
     return nullptr;
 
-  ilsCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
-                       [](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+  ilsCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement + QUERY_RECT_INFLATION_INCREMENT_ILS,
+                       lazy, sameLayerIls);
+  ilsCache.fetchTiles([this, mapLayer](const GeoDataLatLonBox& tileRect, QList<MapIls>& tileList) -> void
   {
-    return curLayer->hasSameQueryParametersIls(newLayer);
+    fetchIlsTile(mapLayer, tileRect, tileList);
   });
-
-  if(ilsCache.list.isEmpty() && !lazy)
-  {
-    // ILS length is 9 NM * 1' per degree
-    double increase = atools::geo::toRadians(9. / 60.);
-
-    // Increase bounding rect since ILS has no bounding to query
-    rect.setBoundaries(rect.north() + increase, rect.south() - increase, rect.east() + increase, rect.west() - increase);
-
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
-    {
-      query::bindRect(r, ilsByRectQuery);
-
-      ilsByRectQuery->exec();
-      while(ilsByRectQuery->next())
-      {
-        // ILS is always loaded from nav except if all is off
-        map::MapRunwayEnd end;
-        if(mapLayer->isIlsDetail() && !NavApp::isNavdataOff())
-          // Get the runway end to fix graphical alignment issues in map
-          end = NavApp::getAirportQueryNav()->getRunwayEndById(ilsByRectQuery->valueInt("loc_runway_end_id"));
-
-        MapIls ils;
-        mapTypesFactory->fillIls(ilsByRectQuery->record(), ils, end.isFullyValid() ? end.heading : map::INVALID_HEADING_VALUE);
-        ilsCache.list.append(ils);
-      }
-    }
-  }
   overflow = ilsCache.validate(queryMaxRows);
   return &ilsCache.list;
 }
 
 /*
- * Get airport cache
- * @param reverse reverse order of airports to have unimportant small ones below in painting order
- * @param lazy do not update cache - instead return incomplete resut
+ * Load missing tiles into the airport cache
  * @param overview fetch only incomplete data for overview airports
  * @return pointer to the airport cache
  */
-const QList<map::MapAirport> *MapQuery::fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query,
-                                                      bool lazy, bool overview, bool addon, bool normal, bool& overflow)
+const QList<map::MapAirport> *MapQuery::fetchAirports(atools::sql::SqlQuery *query, bool overview, bool addon, bool normal,
+                                                      bool& overflow)
 {
   if(!query::valid(Q_FUNC_INFO, query))
     return nullptr;
 
-  if(airportCache.list.isEmpty() && !lazy)
+  bool navdata = NavApp::isNavdataAll();
+  bool xplane = NavApp::isAirportDatabaseXPlane(navdata);
+
+  airportCache.fetchTiles([ = ](const GeoDataLatLonBox& tileRect, QList<MapAirport>& tileList) -> void
   {
-    bool navdata = NavApp::isNavdataAll();
+    fetchAirportTile(query, overview, addon, normal, navdata, xplane, tileRect, tileList);
+  });
 
-    for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
+  overflow = airportCache.validate(queryMaxRows);
+  return &airportCache.list;
+}
+
+bool MapQuery::sameLayerAirport(const MapLayer *curLayer, const MapLayer *newLayer, bool addon, bool normal) const
+{
+  return curLayer->hasSameQueryParametersAirport(newLayer) &&
+         // Invalidate cache if settings differ
+         airportCacheAddonFlag == addon && airportCacheNormalFlag == normal;
+}
+
+void MapQuery::fetchAirportTile(atools::sql::SqlQuery *query, bool overview, bool addon, bool normal, bool navdata, bool xplane,
+                                const GeoDataLatLonBox& tileRect, QList<map::MapAirport>& tileList)
+{
+  // Avoid duplicates between both queries
+  QSet<int> ids;
+
+  // Get normal airports ==========
+  if(normal)
+  {
+    query::bindRect(tileRect, query);
+    query::exec(query);
+    while(query->next())
     {
-      // Avoid duplicates between both queries
-      QSet<int> ids;
+      MapAirport ap;
+      if(overview)
+        // Fill only a part of the object
+        mapTypesFactory->fillAirportForOverview(query->record(), ap, navdata, xplane);
+      else
+        mapTypesFactory->fillAirport(query->record(), ap, true /* complete */, navdata, xplane);
 
-      // Get normal airports ==========
-      if(normal)
-      {
-        query::bindRect(r, query);
-        query->exec();
-        while(query->next())
-        {
-          MapAirport ap;
-          if(overview)
-            // Fill only a part of the object
-            mapTypesFactory->fillAirportForOverview(query->record(), ap, navdata, NavApp::isAirportDatabaseXPlane(navdata));
-          else
-            mapTypesFactory->fillAirport(query->record(), ap, true /* complete */, navdata, NavApp::isAirportDatabaseXPlane(navdata));
-
-          ids.insert(ap.id);
-          airportCache.list.append(ap);
-        }
-      }
+      ids.insert(ap.id);
+      tileList.append(ap);
+    }
+  }
 
-      // Get add-on airports ==========
-      if(addon && airportAddonByRectQuery != nullptr)
-      {
-        query::bindRect(r, airportAddonByRectQuery);
-        airportAddonByRectQuery->exec();
-        while(airportAddonByRectQuery->next())
-        {
-          MapAirport ap;
-          if(overview)
-            // Fill only a part of the object
-            mapTypesFactory->fillAirportForOverview(airportAddonByRectQuery->record(), ap, navdata,
-                                                    NavApp::isAirportDatabaseXPlane(navdata));
-          else
-            mapTypesFactory->fillAirport(airportAddonByRectQuery->record(), ap, true /* complete */, navdata,
-                                         NavApp::isAirportDatabaseXPlane(navdata));
-          if(!ids.contains(ap.id))
-            airportCache.list.append(ap);
-        }
-      }
+  // Get add-on airports ==========
+  if(addon && airportAddonByRectQuery != nullptr)
+  {
+    query::bindRect(tileRect, airportAddonByRectQuery);
+    query::exec(airportAddonByRectQuery);
+    while(airportAddonByRectQuery->next())
+    {
+      MapAirport ap;
+      if(overview)
+        // Fill only a part of the object
+        mapTypesFactory->fillAirportForOverview(airportAddonByRectQuery->record(), ap, navdata, xplane);
+      else
+        mapTypesFactory->fillAirport(airportAddonByRectQuery->record(), ap, true /* complete */, navdata, xplane);
+      if(!ids.contains(ap.id))
+        tileList.append(ap);
     }
   }
-  overflow = airportCache.validate(queryMaxRows);
-  return &airportCache.list;
+}
+
+void MapQuery::fetchVorTile(const GeoDataLatLonBox& tileRect, QList<map::MapVor>& tileList)
+{
+  query::bindRect(tileRect, vorsByRectQuery);
+  query::exec(vorsByRectQuery);
+  while(vorsByRectQuery->next())
+  {
+    MapVor vor;
+    mapTypesFactory->fillVor(vorsByRectQuery->record(), vor);
+    tileList.append(vor);
+  }
+}
+
+void MapQuery::fetchNdbTile(const GeoDataLatLonBox& tileRect, QList<map::MapNdb>& tileList)
+{
+  query::bindRect(tileRect, ndbsByRectQuery);
+  query::exec(ndbsByRectQuery);
+  while(ndbsByRectQuery->next())
+  {
+    MapNdb ndb;
+    mapTypesFactory->fillNdb(ndbsByRectQuery->record(), ndb);
+    tileList.append(ndb);
+  }
+}
+
+void MapQuery::fetchMarkerTile(const GeoDataLatLonBox& tileRect, QList<map::MapMarker>& tileList)
+{
+  query::bindRect(tileRect, markersByRectQuery);
+  query::exec(markersByRectQuery);
+  while(markersByRectQuery->next())
+  {
+    map::MapMarker marker;
+    mapTypesFactory->fillMarker(markersByRectQuery->record(), marker);
+    tileList.append(marker);
+  }
+}
+
+void MapQuery::fetchHoldingTile(const GeoDataLatLonBox& tileRect, QList<map::MapHolding>& tileList)
+{
+  query::bindRect(tileRect, holdingByRectQuery);
+  query::exec(holdingByRectQuery);
+  while(holdingByRectQuery->next())
+  {
+    MapHolding holding;
+    mapTypesFactory->fillHolding(holdingByRectQuery->record(), holding);
+    tileList.append(holding);
+  }
+}
+
+void MapQuery::fetchAirportMsaTile(const GeoDataLatLonBox& tileRect, QList<map::MapAirportMsa>& tileList)
+{
+  query::bindRect(tileRect, airportMsaByRectQuery);
+  query::exec(airportMsaByRectQuery);
+  while(airportMsaByRectQuery->next())
+  {
+    MapAirportMsa msa;
+    mapTypesFactory->fillAirportMsa(airportMsaByRectQuery->record(), msa);
+    tileList.append(msa);
+  }
+}
+
+void MapQuery::fetchIlsTile(const MapLayer *mapLayer, const GeoDataLatLonBox& tileRect, QList<map::MapIls>& tileList)
+{
+  query::bindRect(tileRect, ilsByRectQuery);
+
+  query::exec(ilsByRectQuery);
+  while(ilsByRectQuery->next())
+  {
+    // ILS is always loaded from nav except if all is off
+    map::MapRunwayEnd end;
+    if(mapLayer->isIlsDetail() && !NavApp::isNavdataOff())
+      // Get the runway end to fix graphical alignment issues in map
+      end = NavApp::getAirportQueryNav()->getRunwayEndById(ilsByRectQuery->valueInt("loc_runway_end_id"));
+
+    MapIls ils;
+    mapTypesFactory->fillIls(ilsByRectQuery->record(), ils, end.isFullyValid() ? end.heading : map::INVALID_HEADING_VALUE);
+    tileList.append(ils);
+  }
+}
+
+int MapQuery::prefetch(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types, int maxTiles)
+{
+  // Load types in the same way as the painters do
+  int loaded = 0;
+  if(loaded < maxTiles && types.testFlag(map::AIRPORT) && mapLayer->isAirport() && query::valid(Q_FUNC_INFO, airportByRectQuery))
+  {
+    bool addon = types.testFlag(map::AIRPORT_ADDON), normal = types & map::AIRPORT_ALL;
+    bool navdata = NavApp::isNavdataAll();
+    bool xplane = NavApp::isAirportDatabaseXPlane(navdata);
+
+    airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
+    loaded += airportCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                         [ = ](const MapLayer *curLayer, const MapLayer *newLayer) -> bool
+    {
+      return sameLayerAirport(curLayer, newLayer, addon, normal);
+    }, [ = ](const GeoDataLatLonBox& tileRect, QList<MapAirport>& tileList) -> void
+    {
+      fetchAirportTile(airportByRectQuery, false /* overview */, addon, normal, navdata, xplane, tileRect, tileList);
+    });
+  }
+
+  if(loaded < maxTiles && types.testFlag(map::VOR) && mapLayer->isVor() && vorsByRectQuery != nullptr)
+    loaded += vorCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                     sameLayerVor, [this](const GeoDataLatLonBox& tileRect, QList<MapVor>& tileList) -> void
+    {
+      fetchVorTile(tileRect, tileList);
+    });
+
+  if(loaded < maxTiles && types.testFlag(map::NDB) && mapLayer->isNdb() && ndbsByRectQuery != nullptr)
+    loaded += ndbCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                     sameLayerNdb, [this](const GeoDataLatLonBox& tileRect, QList<MapNdb>& tileList) -> void
+    {
+      fetchNdbTile(tileRect, tileList);
+    });
+
+  if(loaded < maxTiles && types.testFlag(map::MARKER) && mapLayer->isMarker() && markersByRectQuery != nullptr)
+    loaded += markerCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                        sameLayerMarker, [this](const GeoDataLatLonBox& tileRect, QList<MapMarker>& tileList) -> void
+    {
+      fetchMarkerTile(tileRect, tileList);
+    });
+
+  if(loaded < maxTiles && types.testFlag(map::HOLDING) && mapLayer->isHolding() && holdingByRectQuery != nullptr)
+    loaded += holdingCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                         sameLayerHolding, [this](const GeoDataLatLonBox& tileRect, QList<MapHolding>& tileList) -> void
+    {
+      fetchHoldingTile(tileRect, tileList);
+    });
+
+  if(loaded < maxTiles && types.testFlag(map::AIRPORT_MSA) && mapLayer->isAirportMsa() && airportMsaByRectQuery != nullptr)
+    loaded += airportMsaCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, maxTiles - loaded,
+                                            sameLayerAirportMsa,
+                                            [this](const GeoDataLatLonBox& tileRect, QList<MapAirportMsa>& tileList) -> void
+    {
+      fetchAirportMsaTile(tileRect, tileList);
+    });
+
+  if(loaded < maxTiles && types.testFlag(map::ILS) && mapLayer->isIls() && ilsByRectQuery != nullptr)
+    loaded += ilsCache.prefetchTiles(rect, mapLayer, queryRectInflationFactor,
+                                     queryRectInflationIncrement + QUERY_RECT_INFLATION_INCREMENT_ILS, maxTiles - loaded,
+                                     sameLayerIls, [this, mapLayer](const GeoDataLatLonBox& tileRect, QList<MapIls>& tileList) -> void
+    {
+      fetchIlsTile(mapLayer, tileRect, tileList);
+    });
+
+  return loaded;
+}
+
+QVector<query::TileCacheStats> MapQuery::takeTileCacheStats()
+{
+  return QVector<query::TileCacheStats>({airportCache.takeStats("Airport"), vorCache.takeStats("VOR"), ndbCache.takeStats("NDB"),
+                                         markerCache.takeStats("Marker"), holdingCache.takeStats("Holding"),
+                                         ilsCache.takeStats("ILS"), airportMsaCache.takeStats("MSA")});
 }
 
 const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
@@ -1298,7 +1385,7 @@ const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
     using atools::geo::Pos;
 
     runwayOverviewQuery->bindValue(":airportId", airportId);
-    runwayOverviewQuery->exec();
+    query::exec(runwayOverviewQuery);
 
     QList<map::MapRunway> *rws = new QList<map::MapRunway>;
     while(runwayOverviewQuery->next())
@@ -226,6 +226,15 @@ public:
   /* Similar to getAirports */
   const QList<map::MapIls> *getIls(Marble::GeoDataLatLonBox rect, const MapLayer *mapLayer, bool lazy, bool& overflow);
 
+  /* Loads up to maxTiles missing tiles for rect into the airport, navaid, holding, MSA and ILS caches.
+   * Only types enabled in types and mapLayer are loaded. The lists returned by the methods above are not changed.
+   * Does nothing for a cache until it was used at least once with the same layer query parameters.
+   * @return number of tiles loaded. Less than maxTiles if all data for rect is cached. */
+  int prefetch(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, map::MapTypes types, int maxTiles);
+
+  /* Get hit and load statistics for all tile caches and reset them. Used for profiling. */
+  QVector<query::TileCacheStats> takeTileCacheStats();
+
   /* Get a partially filled runway list for the overview */
   const QList<map::MapRunway> *getRunwaysForOverview(int airportId);
 
@@ -259,8 +268,21 @@ private:
                                 const atools::geo::Pos& sortByDistancePos,
                                 float maxDistanceMeter, bool airportFromNavDatabase, map::AirportQueryFlags flags) const;
 
-  const QList<map::MapAirport> *fetchAirports(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query,
-                                              bool lazy, bool overview, bool addon, bool normal, bool& overflow);
+  const QList<map::MapAirport> *fetchAirports(atools::sql::SqlQuery *query, bool overview, bool addon, bool normal,
+                                              bool& overflow);
+
+  /* Compare layer query parameters and add-on/normal flags for the airport cache */
+  bool sameLayerAirport(const MapLayer *curLayer, const MapLayer *newLayer, bool addon, bool normal) const;
+
+  /* Load all objects for a tile of the respective cache */
+  void fetchAirportTile(atools::sql::SqlQuery *query, bool overview, bool addon, bool normal, bool navdata, bool xplane,
+                        const Marble::GeoDataLatLonBox& tileRect, QList<map::MapAirport>& tileList);
+  void fetchVorTile(const Marble::GeoDataLatLonBox& tileRect, QList<map::MapVor>& tileList);
+  void fetchNdbTile(const Marble::GeoDataLatLonBox& tileRect, QList<map::MapNdb>& tileList);
+  void fetchMarkerTile(const Marble::GeoDataLatLonBox& tileRect, QList<map::MapMarker>& tileList);
+  void fetchHoldingTile(const Marble::GeoDataLatLonBox& tileRect, QList<map::MapHolding>& tileList);
+  void fetchAirportMsaTile(const Marble::GeoDataLatLonBox& tileRect, QList<map::MapAirportMsa>& tileList);
+  void fetchIlsTile(const MapLayer *mapLayer, const Marble::GeoDataLatLonBox& tileRect, QList<map::MapIls>& tileList);
 
   QVector<map::MapIls> ilsByAirportAndRunway(const QString& airportIdent, const QString& runway) const;
 
@@ -272,17 +294,19 @@ private:
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *dbSim, *dbNav, *dbUser;
 
-  /* Simple bounding rectangle caches */
+  /* Tiled spatial caches */
   bool airportCacheAddonFlag = false; // Keep addon status flag for comparing
   bool airportCacheNormalFlag = false; // Keep normal (non add-on) status flag for comparing
-  query::SimpleRectCache<map::MapAirport> airportCache;
+  query::TileRectCache<map::MapAirport> airportCache;
+  query::TileRectCache<map::MapVor> vorCache;
+  query::TileRectCache<map::MapNdb> ndbCache;
+  query::TileRectCache<map::MapMarker> markerCache;
+  query::TileRectCache<map::MapHolding> holdingCache;
+  query::TileRectCache<map::MapIls> ilsCache;
+  query::TileRectCache<map::MapAirportMsa> airportMsaCache;
+
+  /* Simple bounding rectangle cache. Not used for caching but for the screen index. */
   query::SimpleRectCache<map::MapUserpoint> userpointCache;
-  query::SimpleRectCache<map::MapVor> vorCache;
-  query::SimpleRectCache<map::MapNdb> ndbCache;
-  query::SimpleRectCache<map::MapMarker> markerCache;
-  query::SimpleRectCache<map::MapHolding> holdingCache;
-  query::SimpleRectCache<map::MapIls> ilsCache;
-  query::SimpleRectCache<map::MapAirportMsa> airportMsaCache;
 
   bool gls = false;
 
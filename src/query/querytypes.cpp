@@ -17,13 +17,33 @@
 
 #include "query/querytypes.h"
 
+#include "atools.h"
 #include "sql/sqlquery.h"
 #include "geo/rect.h"
 
+#include <QAtomicInt>
+
+#include <algorithm>
+#include <cmath>
+
 using namespace Marble;
 
 namespace query {
 
+/* Number of calls to exec() */
+static QAtomicInt execCount;
+
+void exec(atools::sql::SqlQuery *query)
+{
+  execCount.fetchAndAddRelaxed(1);
+  query->exec();
+}
+
+int takeExecCount()
+{
+  return execCount.fetchAndStoreRelaxed(0);
+}
+
 void inflateQueryRect(Marble::GeoDataLatLonBox& rect, double factor, double increment)
 {
   rect.scale(1. + factor, 1. + factor);
@@ -92,12 +112,81 @@ void fetchObjectsForRect(const atools::geo::Rect& rect, atools::sql::SqlQuery *q
   for(const atools::geo::Rect& r : rect.splitAtAntiMeridian())
   {
     query::bindRect(r, query);
-    query->exec();
+    query::exec(query);
     while(query->next())
       callback(query);
   }
 }
 
+/* Tile sizes from 1/8 to 32 degree */
+static const int MIN_TILE_LEVEL = -3;
+static const int MAX_TILE_LEVEL = 5;
+
+/* Number of tiles covering the larger side of the view */
+static const double TILES_PER_VIEW = 4.;
+
+static double tileSize(int level)
+{
+  return std::ldexp(1., level);
+}
+
+TileKey tileForPos(const atools::geo::Pos& pos, int level)
+{
+  double size = tileSize(level);
+  int maxX = static_cast<int>(std::ceil(360. / size)) - 1, maxY = static_cast<int>(std::ceil(180. / size)) - 1;
+
+  TileKey key = {level,
+                 atools::minmax(0, maxX, static_cast<int>(std::floor((pos.getLonX() + 180.) / size))),
+                 atools::minmax(0, maxY, static_cast<int>(std::floor((pos.getLatY() + 90.) / size)))};
+  return key;
+}
+
+Marble::GeoDataLatLonBox tileRect(const TileKey& key)
+{
+  double size = tileSize(key.level);
+  double west = -180. + key.x * size, south = -90. + key.y * size;
+  return GeoDataLatLonBox(std::min(south + size, 90.), south, std::min(west + size, 180.), west, GeoDataCoordinates::Degree);
+}
+
+QVector<TileKey> tilesForRect(const Marble::GeoDataLatLonBox& rect, int level, double factor, double increment)
+{
+  QVector<TileKey> keys;
+  for(const GeoDataLatLonBox& r : splitAtAntiMeridian(rect, factor, increment))
+  {
+    TileKey topLeft = tileForPos(atools::geo::Pos(r.west(GeoDataCoordinates::Degree), r.north(GeoDataCoordinates::Degree)), level);
+    TileKey bottomRight = tileForPos(atools::geo::Pos(r.east(GeoDataCoordinates::Degree), r.south(GeoDataCoordinates::Degree)), level);
+
+    for(int y = bottomRight.y; y <= topLeft.y; y++)
+    {
+      for(int x = topLeft.x; x <= bottomRight.x; x++)
+      {
+        TileKey key = {level, x, y};
+        if(!keys.contains(key))
+          keys.append(key);
+      }
+    }
+  }
+  return keys;
+}
+
+int tileLevelForRect(const Marble::GeoDataLatLonBox& rect, int curLevel)
+{
+  double span = std::max(rect.width(GeoDataCoordinates::Degree), rect.height(GeoDataCoordinates::Degree));
+
+  if(curLevel >= MIN_TILE_LEVEL && curLevel <= MAX_TILE_LEVEL)
+  {
+    // Keep level if view covers at least one and not more than eight tiles
+    double numTiles = span / tileSize(curLevel);
+    if((numTiles >= 1. || curLevel == MIN_TILE_LEVEL) && (numTiles <= 8. || curLevel == MAX_TILE_LEVEL))
+      return curLevel;
+  }
+
+  if(!(span > 0.))
+    return MIN_TILE_LEVEL;
+
+  return atools::minmax(MIN_TILE_LEVEL, MAX_TILE_LEVEL, static_cast<int>(std::ceil(std::log2(span / TILES_PER_VIEW))));
+}
+
 bool valid(const QString& function, const atools::sql::SqlQuery *query)
 {
   if(query == nullptr)
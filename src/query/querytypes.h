@@ -22,9 +22,14 @@
 #include "sql/sqlquery.h"
 #include "common/maptypes.h"
 
+#include <QCache>
+#include <QElapsedTimer>
+#include <QHash>
 #include <QList>
+#include <QSet>
 
 #include <functional>
+#include <limits>
 
 #include <marble/GeoDataCoordinates.h>
 #include <marble/GeoDataLatLonBox.h>
@@ -45,6 +50,12 @@ namespace query {
 /* Returns false and logs message if query is null */
 bool valid(const QString& function, const atools::sql::SqlQuery *query);
 
+/* Executes the query and counts the execution for statistics. Used by all map query classes. */
+void exec(atools::sql::SqlQuery *query);
+
+/* Get number of queries executed by exec() in all threads since the last call and reset the counter */
+int takeExecCount();
+
 void bindRect(const Marble::GeoDataLatLonBox& rect, atools::sql::SqlQuery *query, const QString& prefix = QString());
 void bindRect(const atools::geo::Rect& rect, atools::sql::SqlQuery *query, const QString& prefix = QString());
 
@@ -146,6 +157,357 @@ void SimpleRectCache<TYPE>::clear()
   curMapLayer = nullptr;
 }
 
+/* Key for one tile of the TileRectCache. The level is the binary logarithm of the tile size in degree. */
+struct TileKey
+{
+  int level, x, y;
+
+  bool operator==(const query::TileKey& other) const
+  {
+    return level == other.level && x == other.x && y == other.y;
+  }
+
+  bool operator!=(const query::TileKey& other) const
+  {
+    return !operator==(other);
+  }
+
+};
+
+inline uint qHash(const query::TileKey& key)
+{
+  return ::qHash(key.level) ^ ::qHash((key.x << 16) | (key.y & 0xffff));
+}
+
+/* Statistics for a TileRectCache since the last call of TileRectCache::takeStats() */
+struct TileCacheStats
+{
+  QString name;
+  int hits = 0, misses = 0; /* Tiles found in cache and tiles loaded */
+  qint64 loadNs = 0L; /* Time used to load missing tiles */
+};
+
+/* Get tile containing the position for the given level */
+TileKey tileForPos(const atools::geo::Pos& pos, int level);
+
+/* Get bounding rectangle in degree of the tile limited to the world */
+Marble::GeoDataLatLonBox tileRect(const TileKey& key);
+
+/* Get all tiles for the given level covering the rectangle after inflating it. Splits at anti-meridian if needed. */
+QVector<TileKey> tilesForRect(const Marble::GeoDataLatLonBox& rect, int level, double factor, double increment);
+
+/* Calculate a tile level giving about four tiles per view width or height.
+ * Keeps curLevel if the view still covers between one and eight tiles to avoid reloading on small zoom changes. */
+int tileLevelForRect(const Marble::GeoDataLatLonBox& rect, int curLevel);
+
+/*
+ * Spatial cache which splits the world into a lat/lon grid of tiles and loads each tile separately.
+ * Tile size depends on the view size. Tiles are kept in a LRU cache with a maximum number of objects
+ * as cost. Panning only loads the newly exposed tiles. The merged list of all objects in the needed tiles is
+ * available in "list".
+ *
+ * Only usable for point objects since objects are assigned to tiles by position.
+ */
+template<typename TYPE>
+class TileRectCache
+{
+public:
+  typedef std::function<bool (const MapLayer *curLayer, const MapLayer *mapLayer)> LayerCompareFunc;
+
+  /* Has to append all objects inside tileRect to tileList */
+  typedef std::function<void (const Marble::GeoDataLatLonBox& tileRect, QList<TYPE>& tileList)> FetchFunc;
+
+  /*
+   * Calculates the tiles needed for rect. Clears all tiles if the map layer query parameters change.
+   * @param rect bounding rectangle - all objects inside this rectangle are returned
+   * @param mapLayer current map layer
+   * @param lazy if true do not fetch new data but return the old potentially incomplete dataset
+   * merged with all tiles which are already available in the cache
+   * @return true if the set of needed tiles changed. The caller has to call fetchTiles() then.
+   */
+  bool updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor, double increment,
+                   bool lazy, LayerCompareFunc funcSameLayer);
+
+  /* Loads missing tiles using fetchFunc and rebuilds the merged list if the needed tiles changed.
+   * Does nothing if nothing changed since the last call.
+   * Only tiles already in the cache are merged if the last update was lazy. Missing tiles are loaded
+   * on the next call after a non-lazy update. */
+  void fetchTiles(FetchFunc fetchFunc);
+
+  /* Loads up to maxTiles missing tiles covering rect into the cache without changing the merged list.
+   * Used to prefetch data for adjacent or predicted views. Does nothing if the layer query parameters differ from
+   * the last update.
+   * Tiles which were prefetched but not used yet can fill only a share of the cache budget to avoid evicting the
+   * tiles of the current view. Tiles which are larger than this share are loaded once and then marked as done.
+   * @return number of tiles loaded. Less than maxTiles if all tiles for rect are in the cache or done. */
+  int prefetchTiles(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor, double increment,
+                    int maxTiles, LayerCompareFunc funcSameLayer, FetchFunc fetchFunc);
+
+  void clear();
+
+  /* Removes tiles loaded since the last call from the cache if their query hit the row limit.
+   * Returns true if any tile of the current view was truncated. Data of truncated tiles is kept in the merged list. */
+  bool validate(int queryMaxRows);
+
+  /* Maximum number of objects kept in all tiles */
+  void setMaxCost(int maxObjects)
+  {
+    tiles.setMaxCost(maxObjects);
+  }
+
+  /* Get statistics for fetchTiles() calls and reset them */
+  TileCacheStats takeStats(const QString& name)
+  {
+    TileCacheStats retval = stats;
+    retval.name = name;
+    stats = TileCacheStats();
+    return retval;
+  }
+
+  /* Merged objects of all tiles needed for the current view */
+  QList<TYPE> list;
+
+private:
+  /* Fetch objects for tile and drop the ones belonging to a neighbor tile. Returned list is not inserted into the cache. */
+  QList<TYPE> *loadTile(const TileKey& key, FetchFunc fetchFunc);
+
+  /* Remove all tiles and prefetch state */
+  void clearTiles();
+
+  /* Remove evicted tiles from prefetch cost */
+  void updatePrefetchCost();
+
+  /* Remove tile from prefetch cost if it was prefetched */
+  void removePrefetched(const TileKey& key);
+
+  /* Share of the cache budget which can be filled by prefetching */
+  static Q_DECL_CONSTEXPR double PREFETCH_COST_SHARE = 0.5;
+
+  QCache<TileKey, QList<TYPE> > tiles;
+  QSet<TileKey> prefetchSkipped; /* Tiles loaded by prefetch which are larger than the budget */
+  QHash<TileKey, int> prefetched; /* Prefetched tiles and their cost which were not used yet */
+  int prefetchCost = 0; /* Sum of cost in prefetched */
+  QHash<TileKey, int> loadedRows; /* Number of rows fetched for tiles loaded since last validate() */
+  QSet<TileKey> truncatedTiles; /* Tiles where the query hit the row limit */
+  QVector<TileKey> curTiles;
+  const MapLayer *curMapLayer = nullptr;
+  int curLevel = std::numeric_limits<int>::min();
+  bool mergeNeeded = false, cachedOnly = false;
+  TileCacheStats stats;
+};
+
+// ---------------------------------------------------------------------------------
+
+template<typename TYPE>
+bool TileRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor,
+                                      double increment, bool lazy, LayerCompareFunc funcSameLayer)
+{
+#ifndef DEBUG_DISABLE_RECT_CACHE
+  bool sameLayer = curMapLayer != nullptr && funcSameLayer(curMapLayer, mapLayer);
+#else
+  Q_UNUSED(funcSameLayer)
+  bool sameLayer = false;
+#endif
+
+  int level = tileLevelForRect(rect, curLevel);
+
+  if(lazy && (!sameLayer || level != curLevel))
+    // Keep old dataset while zooming or changing parameters since tiles for the new level are not loaded yet
+    return false;
+
+  if(!sameLayer)
+  {
+    // New layer selected with different query parameters - all tiles are invalid
+    clearTiles();
+    curTiles.clear();
+    list.clear();
+  }
+  curMapLayer = mapLayer;
+  curLevel = level;
+
+  QVector<TileKey> newTiles = tilesForRect(rect, curLevel, factor, increment);
+  if(newTiles != curTiles || (list.isEmpty() && !lazy))
+  {
+    curTiles = newTiles;
+    mergeNeeded = true;
+  }
+  cachedOnly = lazy;
+  return mergeNeeded;
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::fetchTiles(FetchFunc fetchFunc)
+{
+  if(!mergeNeeded)
+    return;
+
+  bool missing = false;
+  list.clear();
+  for(const TileKey& key : curTiles)
+  {
+    const QList<TYPE> *tileList = tiles.object(key);
+    if(tileList != nullptr)
+    {
+      // Tile already loaded
+      list.append(*tileList);
+      stats.hits++;
+
+      // Used now - not counted for the prefetch budget anymore
+      removePrefetched(key);
+    }
+    else if(cachedOnly)
+      // Draw what is available and load the rest on next non-lazy call
+      missing = true;
+    else
+    {
+      QElapsedTimer timer;
+      timer.start();
+      QList<TYPE> *newTileList = loadTile(key, fetchFunc);
+      stats.loadNs += timer.nsecsElapsed();
+      stats.misses++;
+      removePrefetched(key); // In case it was evicted and not detected yet
+
+      // Append before inserting since the cache might delete the list immediately if it exceeds the budget
+      list.append(*newTileList);
+      tiles.insert(key, newTileList, newTileList->size() + 1);
+    }
+  }
+  mergeNeeded = missing;
+}
+
+template<typename TYPE>
+int TileRectCache<TYPE>::prefetchTiles(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor,
+                                       double increment, int maxTiles, LayerCompareFunc funcSameLayer, FetchFunc fetchFunc)
+{
+  if(curMapLayer == nullptr || !funcSameLayer(curMapLayer, mapLayer))
+    // Tiles would be invalidated on next update anyway
+    return 0;
+
+  int maxPrefetchCost = static_cast<int>(tiles.maxCost() * PREFETCH_COST_SHARE);
+  updatePrefetchCost();
+
+  int loaded = 0;
+  for(const TileKey& key : tilesForRect(rect, curLevel, factor, increment))
+  {
+    if(loaded >= maxTiles || prefetchCost >= maxPrefetchCost)
+      break;
+
+    if(!tiles.contains(key) && !prefetchSkipped.contains(key))
+    {
+      QList<TYPE> *newTileList = loadTile(key, fetchFunc);
+      int cost = newTileList->size() + 1;
+
+      if(cost <= maxPrefetchCost)
+      {
+        tiles.insert(key, newTileList, cost);
+        prefetched.insert(key, cost);
+        prefetchCost += cost;
+      }
+      else
+      {
+        // Would evict tiles of the current view - remember to avoid loading it again
+        delete newTileList;
+        prefetchSkipped.insert(key);
+      }
+      loaded++;
+    }
+  }
+  return loaded;
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::updatePrefetchCost()
+{
+  // QCache does not notify about evicted objects
+  for(auto it = prefetched.begin(); it != prefetched.end();)
+  {
+    if(!tiles.contains(it.key()))
+    {
+      prefetchCost -= it.value();
+      it = prefetched.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::removePrefetched(const TileKey& key)
+{
+  auto it = prefetched.find(key);
+  if(it != prefetched.end())
+  {
+    prefetchCost -= it.value();
+    prefetched.erase(it);
+  }
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::clearTiles()
+{
+  tiles.clear();
+  prefetchSkipped.clear();
+  prefetched.clear();
+  prefetchCost = 0;
+  loadedRows.clear();
+  truncatedTiles.clear();
+}
+
+template<typename TYPE>
+QList<TYPE> *TileRectCache<TYPE>::loadTile(const TileKey& key, FetchFunc fetchFunc)
+{
+  QList<TYPE> fetched;
+  fetchFunc(tileRect(key), fetched);
+
+  // Remember number of rows to detect truncation by the query limit in validate()
+  loadedRows.insert(key, fetched.size());
+
+  // Drop objects on tile borders which belong to the neighbor tile to avoid duplicates
+  QList<TYPE> *newTileList = new QList<TYPE>;
+  for(const TYPE& obj : fetched)
+  {
+    if(tileForPos(obj.getPosition(), key.level) == key)
+      newTileList->append(obj);
+  }
+  return newTileList;
+}
+
+template<typename TYPE>
+bool TileRectCache<TYPE>::validate(int queryMaxRows)
+{
+  for(auto it = loadedRows.constBegin(); it != loadedRows.constEnd(); ++it)
+  {
+    if(it.value() >= queryMaxRows)
+    {
+      // Query hit the limit - do not keep incomplete tile and load it again on next change of the view
+      tiles.remove(it.key());
+      removePrefetched(it.key());
+      truncatedTiles.insert(it.key());
+    }
+    else
+      truncatedTiles.remove(it.key());
+  }
+  loadedRows.clear();
+
+  for(const TileKey& key : curTiles)
+  {
+    if(truncatedTiles.contains(key))
+      return true;
+  }
+  return false;
+}
+
+template<typename TYPE>
+void TileRectCache<TYPE>::clear()
+{
+  list.clear();
+  clearTiles();
+  curTiles.clear();
+  curMapLayer = nullptr;
+  curLevel = std::numeric_limits<int>::min();
+  mergeNeeded = cachedOnly = false;
+}
+
 /* Get a record from the cache or get it from a database query */
 template<typename ID>
 const atools::sql::SqlRecord *cachedRecord(QCache<ID, atools::sql::SqlRecord>& cache, atools::sql::SqlQuery *query,
@@ -163,7 +525,7 @@ const atools::sql::SqlRecord *cachedRecord(QCache<ID, atools::sql::SqlRecord>& c
   }
   else
   {
-    query->exec();
+    query::exec(query);
     if(query->next())
     {
       // Insert it into the cache
@@ -194,7 +556,7 @@ const atools::sql::SqlRecordList *cachedRecordList(QCache<ID, atools::sql::SqlRe
   }
   else
   {
-    query->exec();
+    query::exec(query);
 
     rec = new atools::sql::SqlRecordList;
 
@@ -60,7 +60,7 @@ map::MapWaypoint WaypointQuery::getWaypointById(int id)
     return wp;
 
   waypointByIdQuery->bindValue(":id", id);
-  waypointByIdQuery->exec();
+  query::exec(waypointByIdQuery);
   if(waypointByIdQuery->next())
     mapTypesFactory->fillWaypoint(waypointByIdQuery->record(), wp, trackDatabase);
   waypointByIdQuery->finish();
@@ -82,7 +82,7 @@ MapWaypoint WaypointQuery::getWaypointByNavId(int navId, map::MapType type)
   else
     waypointByNavIdQuery->bindValue(":type", "%");
 
-  waypointByNavIdQuery->exec();
+  query::exec(waypointByNavIdQuery);
   if(waypointByNavIdQuery->next())
     mapTypesFactory->fillWaypoint(waypointByNavIdQuery->record(), wp, trackDatabase);
   waypointByNavIdQuery->finish();
@@ -97,7 +97,7 @@ void WaypointQuery::getWaypointByByIdent(QList<map::MapWaypoint>& waypoints, con
 
   waypointByIdentQuery->bindValue(":ident", ident);
   waypointByIdentQuery->bindValue(":region", region.isEmpty() ? "%" : region);
-  waypointByIdentQuery->exec();
+  query::exec(waypointByIdentQuery);
   while(waypointByIdentQuery->next())
   {
     map::MapWaypoint wp;
@@ -113,7 +113,7 @@ void WaypointQuery::getWaypointNearest(map::MapWaypoint& waypoint, const Pos& po
 
   waypointNearestQuery->bindValue(":lonx", pos.getLonX());
   waypointNearestQuery->bindValue(":laty", pos.getLatY());
-  waypointNearestQuery->exec();
+  query::exec(waypointNearestQuery);
   if(waypointNearestQuery->next())
     mapTypesFactory->fillWaypoint(waypointNearestQuery->record(), waypoint, trackDatabase);
   waypointNearestQuery->finish();
@@ -127,7 +127,7 @@ void WaypointQuery::getWaypointsRect(QVector<map::MapWaypoint>& waypoints, const
   for(Rect r : Rect(pos, nmToMeter(distanceNm), true /* fast */).splitAtAntiMeridian())
   {
     query::bindRect(r, waypointRectQuery);
-    waypointRectQuery->exec();
+    query::exec(waypointRectQuery);
     while(waypointRectQuery->next())
     {
       map::MapWaypoint waypoint;
@@ -164,7 +164,7 @@ const QList<map::MapWaypoint> *WaypointQuery::getWaypoints(const GeoDataLatLonBo
     for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
       query::bindRect(r, waypointsByRectQuery);
-      waypointsByRectQuery->exec();
+      query::exec(waypointsByRectQuery);
       while(waypointsByRectQuery->next())
       {
         map::MapWaypoint wp;
@@ -197,7 +197,7 @@ const QList<MapWaypoint> *WaypointQuery::getWaypointsAirway(const Marble::GeoDat
     for(const GeoDataLatLonBox& r : query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
       query::bindRect(r, waypointsAirwayByRectQuery);
-      waypointsAirwayByRectQuery->exec();
+      query::exec(waypointsAirwayByRectQuery);
       while(waypointsAirwayByRectQuery->next())
       {
         map::MapWaypoint wp;
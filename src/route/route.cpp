@@ -119,6 +119,7 @@ void Route::copy(const Route& other)
   flightplan = other.flightplan;
   shownTypes = other.shownTypes;
   boundingRect = other.boundingRect;
+  segmentIndex = other.segmentIndex;
   activePos = other.activePos;
 
   approachLegs = other.approachLegs;
@@ -156,6 +157,7 @@ void Route::clearAll()
   getFlightplan().clearAll();
   resetActive();
   clear();
+  segmentIndex.clear();
 
   altitude->clearAll();
   destRunwayIlsMap.clear();
@@ -1868,6 +1870,57 @@ void Route::updateAll()
   updateApproachIls();
 }
 
+void Route::updateChangedLegs(int from, int to)
+{
+  // Successor of the last changed leg gets a new previous leg too
+  int last = to + 1;
+  int sizeBefore = size();
+
+  updateIndicesAndOffsets();
+  removeDuplicateRouteLegs();
+
+  if(size() != sizeBefore || !canUpdateLegs(from, last))
+  {
+#ifdef DEBUG_INFORMATION
+    qDebug() << Q_FUNC_INFO << "Full update for" << from << to;
+#endif
+    updateAll();
+    updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+    return;
+  }
+
+  validateAirways();
+  updateMagvar(from, last);
+  updateDistancesAndCourse(from, last);
+  updateBoundingRect();
+  updateWaypointNames();
+  updateDepartureAndDestination();
+
+  // Approach and ILS do not change since destination and procedures are not touched
+
+  float minAltitudeFt, maxAltitudeFt;
+  updateAirways(minAltitudeFt, maxAltitudeFt, false /* adjustRouteAltitude */, from, last);
+}
+
+bool Route::canUpdateLegs(int from, int to)
+{
+  // Departure, destination and alternates affect other legs
+  if(from < 1 || to >= size() || from > to || to > getDestinationAirportLegIndex())
+    return false;
+
+  for(int i = from; i <= to; i++)
+  {
+    const RouteLeg& leg = at(i);
+    if(leg.isAlternate() || isAirportAfterArrival(i))
+      return false;
+
+    // Only the successor can be the destination or the first procedure leg
+    if(i < to && (leg.isAnyProcedure() || i == getDestinationAirportLegIndex()))
+      return false;
+  }
+  return true;
+}
+
 void Route::updateWaypointNames()
 {
   int num = 1;
@@ -2111,10 +2164,35 @@ void Route::updateDistancesAndCourse()
 #endif
 }
 
+void Route::updateDistancesAndCourse(int from, int to)
+{
+  // Range is en-route only and checked by canUpdateLegs() - previous leg is always the one before
+  for(int i = from; i <= to; i++)
+    (*this)[i].updateDistanceAndCourse(i, &at(i - 1));
+
+  // Sum up using the same rules as the full update
+  totalDistance = 0.f;
+  for(int i = 0; i < size(); i++)
+  {
+    const RouteLeg& leg = at(i);
+    if(!leg.isAlternate() && !isAirportAfterArrival(i) && !leg.getProcedureLeg().isMissed())
+      totalDistance += leg.getDistanceTo();
+  }
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << "from" << from << "to" << to << "totalDistance" << totalDistance;
+#endif
+}
+
 void Route::updateMagvar()
+{
+  updateMagvar(0, size() - 1);
+}
+
+void Route::updateMagvar(int from, int to)
 {
   // get magvar from internal database objects (waypoints, VOR and others)
-  for(int i = 0; i < size(); i++)
+  for(int i = from; i <= to; i++)
     (*this)[i].updateMagvar(i > 0 ? &at(i - 1) : nullptr);
 }
 
@@ -2137,6 +2215,9 @@ void Route::updateBoundingRect()
   Marble::GeoDataLatLonBox box = Marble::GeoDataLatLonBox::fromLineString(line);
   boundingRect = atools::geo::Rect(box.west(), box.north(), box.east(), box.south());
   boundingRect.toDeg();
+
+  // Bounding boxes for each leg
+  segmentIndex.build(*this);
 }
 
 void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDistanceMeter,
@@ -2153,12 +2234,29 @@ void Route::nearestAllLegIndex(const map::PosCourse& pos, float& crossTrackDista
   // Check only until the approach starts if required
   atools::geo::LineDistance result;
 
-  for(int i = 1; i < size(); i++)
+  // Use all legs in order if index is outdated
+  QVector<std::pair<float, int> > candidates;
+  if(segmentIndex.isValid(size()))
+    segmentIndex.candidates(candidates, pos.pos);
+  else
+  {
+    for(int i = 1; i < size(); i++)
+      candidates.append(std::make_pair(0.f, i));
+  }
+
+  std::pair<float, int> candidate;
+  while(RouteSegmentIndex::nextCandidate(candidates, candidate))
   {
+    // Remaining legs cannot be nearer
+    if(candidate.first > minDistance)
+      break;
+
+    int i = candidate.second;
     pos.pos.distanceMeterToLine(getPrevPositionAt(i), getPositionAt(i), result);
     float distance = std::abs(result.distance);
 
-    if(result.status != atools::geo::INVALID && distance < minDistance)
+    // Prefer lower index for equal distance like the sequential search
+    if(result.status != atools::geo::INVALID && (distance < minDistance || (distance <= minDistance && i < index)))
     {
       minDistance = distance;
       crossTrackDistanceMeter = result.distance;
@@ -2192,8 +2290,24 @@ int Route::getNearestRouteLegResult(const Pos& pos, atools::geo::LineDistance& l
   minResult.status = atools::geo::INVALID;
   minResult.distance = map::INVALID_DISTANCE_VALUE;
 
-  for(int i = 1; i < size(); i++)
+  // Use all legs in order if index is outdated
+  QVector<std::pair<float, int> > candidates;
+  if(segmentIndex.isValid(size()))
+    segmentIndex.candidates(candidates, pos);
+  else
+  {
+    for(int i = 1; i < size(); i++)
+      candidates.append(std::make_pair(0.f, i));
+  }
+
+  std::pair<float, int> candidate;
+  while(RouteSegmentIndex::nextCandidate(candidates, candidate))
   {
+    // Remaining legs cannot be nearer
+    if(candidate.first > std::abs(minResult.distance))
+      break;
+
+    int i = candidate.second;
     if(ignoreNotEditable && !canEditLeg(i))
       continue;
     if(ignoreMissed && value(i).isAnyProcedure() && value(i).getProcedureLeg().isMissed())
@@ -2201,7 +2315,10 @@ int Route::getNearestRouteLegResult(const Pos& pos, atools::geo::LineDistance& l
 
     pos.distanceMeterToLine(getPrevPositionAt(i), getPositionAt(i), result);
 
-    if(result.status != atools::geo::INVALID && std::abs(result.distance) < std::abs(minResult.distance))
+    float distance = std::abs(result.distance), minDistance = std::abs(minResult.distance);
+
+    // Prefer lower index for equal distance like the sequential search
+    if(result.status != atools::geo::INVALID && (distance < minDistance || (distance <= minDistance && i < index)))
     {
       minResult = result;
       index = i;
@@ -2656,6 +2773,38 @@ void Route::createRouteLegsFromFlightplan()
   }
 }
 
+void Route::createRouteLegsFromFlightplan(const QList<RouteLeg>& legs, int index, int numInserted, int numRemoved)
+{
+  clear();
+
+  const RouteLeg *lastLeg = nullptr;
+
+  for(int i = 0; i < flightplan.size(); i++)
+  {
+    if(i >= index && i < index + numInserted)
+    {
+      // Changed entry - load from database
+      RouteLeg leg(&flightplan);
+      leg.createFromDatabaseByEntry(i, lastLeg);
+
+      if(leg.getMapObjectType() == map::INVALID)
+        // Not found in database
+        qWarning() << "Entry for ident" << flightplan.at(i).getIdent() << "region" << flightplan.at(i).getRegion() << "is not valid";
+
+      append(leg);
+    }
+    else
+    {
+      // Unchanged entry - copy leg and point it to this plan - distances are updated later in updateAll()
+      RouteLeg leg(legs.at(i < index ? i : i - numInserted + numRemoved));
+      leg.setFlightplan(&flightplan);
+      leg.setFlightplanEntryIndex(i);
+      append(leg);
+    }
+    lastLeg = &constLast();
+  }
+}
+
 void Route::assignAltitudes()
 {
   QVector<float> altVector = altitude->getAltitudes();
@@ -3299,12 +3448,12 @@ bool Route::hasValidParking() const
     return false;
 }
 
-void Route::updateAirways(float& minAltitudeFt, float& maxAltitudeFt, bool adjustRouteAltitude)
+void Route::updateAirways(float& minAltitudeFt, float& maxAltitudeFt, bool adjustRouteAltitude, int from, int to)
 {
   minAltitudeFt = atools::fs::pln::FLIGHTPLAN_ALTITUDE_FT_MIN;
   maxAltitudeFt = atools::fs::pln::FLIGHTPLAN_ALTITUDE_FT_MAX;
 
-  for(int i = 1; i < size(); i++)
+  for(int i = std::max(from, 1); i <= to && i < size(); i++)
   {
     RouteLeg& routeLeg = (*this)[i];
     const RouteLeg& prevLeg = value(i - 1);
@@ -3382,7 +3531,7 @@ void Route::updateAirwaysAndAltitude(bool adjustRouteAltitude)
     return;
 
   float minAltitudeFt, maxAltitudeFt;
-  updateAirways(minAltitudeFt, maxAltitudeFt, adjustRouteAltitude); // Returns ft
+  updateAirways(minAltitudeFt, maxAltitudeFt, adjustRouteAltitude, 1, size() - 1); // Returns ft
 
   // Local units are ft or meter depending on options
   // Convert ft to local unit
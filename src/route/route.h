@@ -20,6 +20,7 @@
 
 #include "route/routeleg.h"
 #include "route/routeflags.h"
+#include "route/routesegmentindex.h"
 
 #include "fs/pln/flightplan.h"
 
@@ -466,6 +467,12 @@ public:
    *  Also calculates maximum number of user points. */
   void updateAll();
 
+  /* Same as updateAll() and updateAirwaysAndAltitude(false) but recalculates distance, course, magvar and airways
+   * only for the changed legs from and to (inclusive) and the successor of the last one.
+   * Use after inserting or replacing en-route legs. Falls back to a full update if the range touches departure,
+   * destination, procedures or alternates or if the number of legs changes. */
+  void updateChangedLegs(int from, int to);
+
   /* Use an expensive heuristic to update the missing regions in all airports
    * before export for formats which need it. */
   void updateAirportRegions();
@@ -576,6 +583,10 @@ public:
    * Flight plan will be corrected if needed. */
   void createRouteLegsFromFlightplan();
 
+  /* Same as above but copies already resolved legs for all entries except the numInserted ones starting at index.
+   * legs have to match the flight plan entries before the change where numRemoved entries were replaced at index. */
+  void createRouteLegsFromFlightplan(const QList<RouteLeg>& legs, int index, int numInserted, int numRemoved);
+
   /* @return true if departure is valid and departure airport has no parking or departure of flight plan
    *  has parking or helipad as start position */
   bool hasValidParking() const;
@@ -710,6 +721,12 @@ private:
   void updateDistancesAndCourse();
   void updateBoundingRect();
 
+  /* Calculate distances and courses for legs from and to (inclusive) and sum up total distance */
+  void updateDistancesAndCourse(int from, int to);
+
+  /* true if legs from and to (inclusive) can be updated without touching neighbors other than the given range */
+  bool canUpdateLegs(int from, int to);
+
   /* Looks fuzzy for a waypoint at the given position from front to end or vice versa if reverse is true */
   int legIndexForPosition(const atools::geo::Pos& pos, bool reverse);
 
@@ -720,6 +737,7 @@ private:
 
   /* Update and calculate magnetic variation for all route map objects */
   void updateMagvar();
+  void updateMagvar(int from, int to);
 
   /* Get indexes to nearest approach or route leg and cross track distance to the nearest ofthem in nm */
   void copy(const Route& other);
@@ -737,11 +755,15 @@ private:
   /* Update waypoint numbers with prefix "WP" automatically in order of plan */
   void updateWaypointNames();
 
-  /* Updates airway objects in route legs and returns min and max altitude defined by airways and flight plan restrictions */
-  void updateAirways(float& minAltitudeFt, float& maxAltitudeFt, bool adjustRouteAltitude);
+  /* Updates airway objects in route legs and returns min and max altitude defined by airways and flight plan restrictions.
+   * Checks only legs from and to (inclusive). */
+  void updateAirways(float& minAltitudeFt, float& maxAltitudeFt, bool adjustRouteAltitude, int from, int to);
 
   atools::geo::Rect boundingRect;
 
+  /* Bounding boxes of leg lines to speed up nearest leg search. Updated with bounding rect. */
+  RouteSegmentIndex segmentIndex;
+
   /* Nautical miles not including missed approach and alternates */
   float totalDistance = 0.f;
 
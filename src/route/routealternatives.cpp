@@ -0,0 +1,97 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "route/routealternatives.h"
+
+#include "routing/routefinder.h"
+#include "routing/routenetwork.h"
+
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace  {
+/* All jobs for one network */
+struct NetworkJobs
+{
+  atools::routing::RouteNetwork *network;
+  QVector<int> jobIndexes;
+};
+
+}
+
+RouteAlternatives::RouteAlternatives(const QVector<ralt::Job>& jobsParam, const atools::geo::Pos& departurePosParam,
+                                     const atools::geo::Pos& destinationPosParam)
+  : jobs(jobsParam), departurePos(departurePosParam), destinationPos(destinationPosParam)
+{
+  // Worker threads write into the jobs - do not share data with the caller
+  jobs.detach();
+}
+
+void RouteAlternatives::run(const QVector<atools::routing::RouteNetwork *>& airwayNetworks,
+                            atools::routing::RouteNetwork *radioNetwork)
+{
+  // Distribute jobs to networks ============================================
+  QVector<NetworkJobs> networkJobs;
+  for(atools::routing::RouteNetwork *network : airwayNetworks)
+    networkJobs.append({network, QVector<int>()});
+  if(radioNetwork != nullptr)
+    networkJobs.append({radioNetwork, QVector<int>()});
+
+  int radioIndex = radioNetwork != nullptr ? networkJobs.size() - 1 : -1, airwayIndex = 0;
+  for(int i = 0; i < jobs.size(); i++)
+  {
+    if(jobs.at(i).radionav && radioIndex != -1)
+      networkJobs[radioIndex].jobIndexes.append(i);
+    else if(!jobs.at(i).radionav && !airwayNetworks.isEmpty())
+    {
+      networkJobs[airwayIndex].jobIndexes.append(i);
+      airwayIndex = (airwayIndex + 1) % airwayNetworks.size();
+    }
+    else
+      // Nothing to do
+      numJobsDone++;
+  }
+
+  // Run one thread per network ============================================
+  // Use raw pointer to avoid calling the detaching non-const operator[] from several threads
+  ralt::Job *jobData = jobs.data();
+  QtConcurrent::blockingMap(networkJobs, [this, jobData](NetworkJobs& netJobs) -> void
+  {
+    for(int index : netJobs.jobIndexes)
+    {
+      if(!canceled)
+        runJob(jobData[index], netJobs.network);
+      numJobsDone++;
+    }
+  });
+}
+
+void RouteAlternatives::runJob(ralt::Job& job, atools::routing::RouteNetwork *network)
+{
+  atools::routing::RouteFinder routeFinder(network);
+  routeFinder.setCostFactorForceAirways(job.costFactor);
+  routeFinder.setProgressCallback([this](int, int) -> bool
+  {
+    return !canceled;
+  });
+
+  if(routeFinder.calculateRoute(departurePos, destinationPos, job.altitudeFt, job.mode) && !canceled)
+  {
+    RouteExtractor extractor(&routeFinder);
+    extractor.extractRoute(job.entries, job.distanceMeter);
+    job.found = !job.entries.isEmpty();
+  }
+}
@@ -0,0 +1,132 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ROUTEALTERNATIVES_H
+#define LNM_ROUTEALTERNATIVES_H
+
+#include "geo/pos.h"
+#include "route/routeextractor.h"
+#include "routing/routenetworktypes.h"
+
+#include <atomic>
+
+namespace atools {
+namespace routing {
+class RouteNetwork;
+}
+}
+
+namespace ralt {
+
+/* One route finder run of the alternatives matrix */
+struct Job
+{
+  /* Type description like "Jet airways" shown in the result list */
+  QString typeText;
+
+  atools::routing::Modes mode = atools::routing::MODE_NONE;
+  int altitudeFt = 0;
+
+  /* Slider position in the calculation dialog or -1 for radionav. Determines cost factor. */
+  int preference = -1;
+  float costFactor = 1.f;
+
+  /* Use radionav network and do not fetch airways */
+  bool radionav = false;
+
+  /* Result filled by worker thread ========== */
+  bool found = false;
+  float distanceMeter = 0.f;
+  QVector<RouteEntry> entries;
+};
+
+/* Evaluated result of a job or the direct connection shown in the selection dialog */
+struct Alternative
+{
+  /* Index in job list or -1 for direct connection */
+  int jobIndex = -1;
+
+  QString typeText, preferenceText, routeString;
+  int altitudeFt = 0;
+  float distanceNm = 0.f;
+
+  /* From RouteAltitude. Fuel is weight or volume depending on aircraft performance. Not valid if validProfile is false. */
+  bool validProfile = false;
+  float travelTimeHours = 0.f, tripFuel = 0.f;
+};
+
+}
+
+/*
+ * Runs a list of route finder jobs for the same departure and destination concurrently.
+ *
+ * A network cannot be shared between concurrent searches since the finder stores the search parameters,
+ * start and destination nodes in it. Therefore jobs are distributed round robin over the given airway
+ * networks and all jobs for one network run sequentially in one thread.
+ *
+ * run() blocks and is meant to be called in a worker thread. Cancel and progress can be accessed from any thread.
+ */
+class RouteAlternatives
+{
+public:
+  RouteAlternatives(const QVector<ralt::Job>& jobsParam, const atools::geo::Pos& departurePosParam,
+                    const atools::geo::Pos& destinationPosParam);
+
+  RouteAlternatives(const RouteAlternatives& other) = delete;
+  RouteAlternatives& operator=(const RouteAlternatives& other) = delete;
+
+  /* Run all jobs. Networks have to be loaded and must not be used by others until this returns. */
+  void run(const QVector<atools::routing::RouteNetwork *>& airwayNetworks, atools::routing::RouteNetwork *radioNetwork);
+
+  /* Stop after current search steps. Remaining jobs are not found. */
+  void cancel()
+  {
+    canceled = true;
+  }
+
+  bool isCanceled() const
+  {
+    return canceled;
+  }
+
+  int getNumJobsDone() const
+  {
+    return numJobsDone;
+  }
+
+  int getNumJobs() const
+  {
+    return jobs.size();
+  }
+
+  /* Jobs including results. Do not access while running. */
+  const QVector<ralt::Job>& getJobs() const
+  {
+    return jobs;
+  }
+
+private:
+  void runJob(ralt::Job& job, atools::routing::RouteNetwork *network);
+
+  QVector<ralt::Job> jobs;
+  atools::geo::Pos departurePos, destinationPos;
+
+  std::atomic_bool canceled{false};
+  std::atomic_int numJobsDone{0};
+};
+
+#endif // LNM_ROUTEALTERNATIVES_H
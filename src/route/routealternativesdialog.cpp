@@ -0,0 +1,170 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "route/routealternativesdialog.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "common/formatter.h"
+#include "common/unit.h"
+#include "fs/perf/aircraftperf.h"
+#include "gui/helphandler.h"
+#include "gui/itemviewzoomhandler.h"
+#include "gui/widgetstate.h"
+#include "ui_routealternativesdialog.h"
+
+#include <QPushButton>
+
+namespace ralt {
+
+enum Column
+{
+  RANK,
+  TYPE,
+  PREFERENCE,
+  ALTITUDE,
+  DISTANCE,
+  TIME,
+  FUEL,
+  ROUTE,
+  COUNT = ROUTE + 1
+};
+
+}
+
+RouteAlternativesDialog::RouteAlternativesDialog(QWidget *parent, const QVector<ralt::Alternative>& alternativesParam, int numJobs)
+  : QDialog(parent), ui(new Ui::RouteAlternativesDialog), alternatives(alternativesParam)
+{
+  setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+  setWindowModality(Qt::ApplicationModal);
+
+  ui->setupUi(this);
+
+  ui->buttonBoxRouteAlternatives->button(QDialogButtonBox::Ok)->setText(tr("&Use Selected"));
+  ui->labelRouteAlternatives->setText(ui->labelRouteAlternatives->text().
+                                      arg(alternatives.size()).arg(numJobs));
+
+  zoomHandler = new atools::gui::ItemViewZoomHandler(ui->tableWidgetRouteAlternatives);
+
+  restoreState();
+  updateTable();
+  updateButtons();
+
+  connect(ui->tableWidgetRouteAlternatives, &QTableWidget::itemSelectionChanged, this, &RouteAlternativesDialog::updateButtons);
+  connect(ui->buttonBoxRouteAlternatives, &QDialogButtonBox::clicked, this, &RouteAlternativesDialog::buttonBoxClicked);
+  connect(ui->tableWidgetRouteAlternatives, &QTableWidget::doubleClicked, this, &RouteAlternativesDialog::doubleClicked);
+}
+
+RouteAlternativesDialog::~RouteAlternativesDialog()
+{
+  saveState();
+
+  delete zoomHandler;
+  delete ui;
+}
+
+int RouteAlternativesDialog::getSelectedIndex() const
+{
+  QTableWidgetItem *item = ui->tableWidgetRouteAlternatives->currentItem();
+  if(item != nullptr && ui->tableWidgetRouteAlternatives->selectionModel()->hasSelection())
+    return ui->tableWidgetRouteAlternatives->item(item->row(), ralt::RANK)->data(Qt::UserRole).toInt();
+  else
+    return -1;
+}
+
+void RouteAlternativesDialog::buttonBoxClicked(QAbstractButton *button)
+{
+  saveState();
+
+  if(button == ui->buttonBoxRouteAlternatives->button(QDialogButtonBox::Ok))
+    QDialog::accept();
+  else if(button == ui->buttonBoxRouteAlternatives->button(QDialogButtonBox::Cancel))
+    QDialog::reject();
+  else if(button == ui->buttonBoxRouteAlternatives->button(QDialogButtonBox::Help))
+    atools::gui::HelpHandler::openHelpUrlWeb(parentWidget(), lnm::helpOnlineUrl + "ROUTECALC.html", lnm::helpLanguageOnline());
+}
+
+void RouteAlternativesDialog::doubleClicked()
+{
+  saveState();
+  QDialog::accept();
+}
+
+void RouteAlternativesDialog::updateTable()
+{
+  const atools::fs::perf::AircraftPerf& perf = NavApp::getAircraftPerformance();
+  QTableWidget *table = ui->tableWidgetRouteAlternatives;
+
+  table->setColumnCount(ralt::COUNT);
+  table->setRowCount(alternatives.size());
+  table->setHorizontalHeaderLabels({tr(" # "), tr(" Type "), tr(" Airway\nPreference "), tr(" Cruise\nAltitude "),
+                                    tr(" Distance "), tr(" Time "), tr(" Trip Fuel "), tr(" Flight Plan ")});
+
+  for(int row = 0; row < alternatives.size(); row++)
+  {
+    const ralt::Alternative& alt = alternatives.at(row);
+    QVector<QTableWidgetItem *> items(ralt::COUNT, nullptr);
+
+    items[ralt::RANK] = new QTableWidgetItem(QLocale().toString(row + 1));
+    items[ralt::RANK]->setData(Qt::UserRole, row);
+    items[ralt::TYPE] = new QTableWidgetItem(alt.typeText);
+    items[ralt::PREFERENCE] = new QTableWidgetItem(alt.preferenceText);
+    items[ralt::ALTITUDE] = new QTableWidgetItem(Unit::altFeet(alt.altitudeFt));
+    items[ralt::DISTANCE] = new QTableWidgetItem(Unit::distNm(alt.distanceNm));
+
+    if(alt.validProfile)
+    {
+      items[ralt::TIME] = new QTableWidgetItem(formatter::formatMinutesHours(alt.travelTimeHours));
+
+      if(perf.isFuelFlowValid())
+        items[ralt::FUEL] = new QTableWidgetItem(perf.useFuelAsVolume() ? Unit::volGallon(alt.tripFuel) : Unit::weightLbs(alt.tripFuel));
+    }
+    items[ralt::ROUTE] = new QTableWidgetItem(alt.routeString);
+    items[ralt::ROUTE]->setToolTip(alt.routeString);
+
+    for(int col = 0; col < ralt::COUNT; col++)
+    {
+      if(items.at(col) == nullptr)
+        items[col] = new QTableWidgetItem();
+
+      if(col >= ralt::ALTITUDE && col <= ralt::FUEL)
+        items[col]->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+      table->setItem(row, col, items.at(col));
+    }
+  }
+
+  table->resizeColumnsToContents();
+
+  if(!alternatives.isEmpty())
+    // Select best
+    table->selectRow(0);
+}
+
+void RouteAlternativesDialog::updateButtons()
+{
+  ui->buttonBoxRouteAlternatives->button(QDialogButtonBox::Ok)->setEnabled(getSelectedIndex() != -1);
+}
+
+void RouteAlternativesDialog::saveState()
+{
+  atools::gui::WidgetState(lnm::ROUTE_ALTERNATIVES_DIALOG).save(this);
+}
+
+void RouteAlternativesDialog::restoreState()
+{
+  atools::gui::WidgetState(lnm::ROUTE_ALTERNATIVES_DIALOG).restore(this);
+}
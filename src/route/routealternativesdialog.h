@@ -0,0 +1,69 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ROUTEALTERNATIVESDIALOG_H
+#define LNM_ROUTEALTERNATIVESDIALOG_H
+
+#include "route/routealternatives.h"
+
+#include <QDialog>
+
+namespace Ui {
+class RouteAlternativesDialog;
+}
+
+namespace atools {
+namespace gui {
+class ItemViewZoomHandler;
+}
+}
+
+class QAbstractButton;
+
+/*
+ * Shows the ranked results of a flight plan alternatives calculation and allows to select one of them.
+ * Alternatives are shown in the given order.
+ */
+class RouteAlternativesDialog :
+  public QDialog
+{
+  Q_OBJECT
+
+public:
+  explicit RouteAlternativesDialog(QWidget *parent, const QVector<ralt::Alternative>& alternativesParam, int numJobs);
+  virtual ~RouteAlternativesDialog() override;
+
+  RouteAlternativesDialog(const RouteAlternativesDialog& other) = delete;
+  RouteAlternativesDialog& operator=(const RouteAlternativesDialog& other) = delete;
+
+  /* Index in alternatives list or -1 if nothing selected */
+  int getSelectedIndex() const;
+
+private:
+  void saveState();
+  void restoreState();
+  void updateTable();
+  void updateButtons();
+  void buttonBoxClicked(QAbstractButton *button);
+  void doubleClicked();
+
+  Ui::RouteAlternativesDialog *ui;
+  atools::gui::ItemViewZoomHandler *zoomHandler = nullptr;
+  QVector<ralt::Alternative> alternatives;
+};
+
+#endif // LNM_ROUTEALTERNATIVESDIALOG_H
@@ -43,6 +43,25 @@ const float MIN_FLIGHTPLAN_DIST_NM = 0.5f;
 using atools::interpolate;
 namespace ageo = atools::geo;
 
+namespace {
+/* Distances, true airspeeds and wind indexes for the climb, cruise and descent phases of a leg */
+struct LegPhases
+{
+  float climbDist = 0.f, cruiseDist = 0.f, descentDist = 0.f;
+  float climbSpeed = 0.f, cruiseSpeed = 0.f, descentSpeed = 0.f;
+
+  /* Index into batch wind result or -1 if phase is not touched by leg */
+  int climbWindIndex = -1, cruiseWindIndex = -1, descentWindIndex = -1, posWindIndex = -1;
+};
+
+/* Get wind from batch result or default (calm) wind if index is -1 */
+inline atools::grib::Wind windAt(const QVector<atools::grib::Wind>& winds, int index)
+{
+  return index >= 0 ? winds.at(index) : atools::grib::Wind();
+}
+
+}
+
 RouteAltitude::RouteAltitude(const Route *routeParam)
   : route(routeParam)
 {
@@ -1152,7 +1171,7 @@ void RouteAltitude::calculate(QStringList& altRestErrors)
   {
     for(int i = 0; i < size(); i++)
     {
-      const RouteAltitudeLeg& leg = value(i);
+      const RouteAltitudeLeg& leg = at(i);
 
       if(!leg.isMissed() && !leg.isAlternate())
       {
@@ -1758,6 +1777,108 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
     return;
   }
 
+  // Collect line strings for all phases of all legs first and get winds in one batch =======================
+  // Results are cached in the wind reporter by geometry and altitude band which avoids
+  // recalculation in further iterations of calculateAll() and for unchanged legs after edits
+  QVector<LegPhases> phases(size());
+  QVector<ageo::LineString> windLines;
+  auto addWindLine = [&windLines](const ageo::LineString& line) -> int {
+                       windLines.append(line);
+                       return windLines.size() - 1;
+                     };
+
+  for(int i = 0; i < size(); i++)
+  {
+    const RouteAltitudeLeg& leg = at(i);
+    float legDist = leg.getDistanceTo();
+
+    // Alternate legs have no wind data since altitude is unknown
+    if(atools::almostEqual(legDist, 0.f) || leg.isAlternate())
+      continue;
+
+    LegPhases& phase = phases[i];
+
+    // Beginning and end of this leg
+    float startDistLeg = leg.getDistanceFromStart() - leg.getDistanceTo();
+    float endDistLeg = leg.getDistanceFromStart();
+    const ageo::LineString& legLine = leg.getLineString();
+
+    // Check if leg covers TOC and/or TOD =================================================
+    // Calculate distance and average speed (TAS) for this leg and collect lines for wind
+    // Need to use smaller/greater *or equal* to catch special cases of exactly matching distances
+    if(endDistLeg <= tocDist)
+    {
+      // All climb before TOC ==========================
+      phase.climbDist = legDist;
+      phase.climbWindIndex = addWindLine(legLine);
+      phase.climbSpeed = perf.getClimbSpeed();
+    }
+    else if(startDistLeg >= todDist)
+    {
+      // All descent after TOD ==========================
+      phase.descentDist = legDist;
+      phase.descentWindIndex = addWindLine(legLine);
+      phase.descentSpeed = perf.getDescentSpeed();
+    }
+    else if(startDistLeg <= tocDist && endDistLeg >= todDist)
+    {
+      // Crosses TOC *and* TOD  - phases climb, cruise and descent ==========================
+      // Climb to TOC ===================
+      phase.climbDist = tocDist - startDistLeg;
+      phase.climbWindIndex = addWindLine(legLine.left(2));
+      phase.climbSpeed = perf.getClimbSpeed();
+
+      // cruise - TOC to TOD ===================
+      phase.cruiseDist = todDist - tocDist;
+      phase.cruiseWindIndex = addWindLine(legLine.mid(1, 2));
+      phase.cruiseSpeed = perf.getCruiseSpeed();
+
+      // TOD to destination ===================
+      phase.descentDist = endDistLeg - todDist;
+      phase.descentWindIndex = addWindLine(legLine.right(2));
+      phase.descentSpeed = perf.getDescentSpeed();
+    }
+    else if(startDistLeg <= tocDist && endDistLeg <= todDist)
+    {
+      // Crosses TOC and goes into cruise ==========================
+      phase.climbDist = tocDist - startDistLeg;
+      phase.climbWindIndex = addWindLine(legLine.left(2));
+      phase.climbSpeed = perf.getClimbSpeed();
+
+      // Cruise to TOD ==========================
+      phase.cruiseDist = endDistLeg - tocDist;
+      phase.cruiseWindIndex = addWindLine(legLine.right(2));
+      phase.cruiseSpeed = perf.getCruiseSpeed();
+    }
+    else if(startDistLeg >= tocDist && endDistLeg >= todDist)
+    {
+      // Goes from cruise to and after TOD ==========================
+      // Cruise to TOD ==========================
+      phase.cruiseDist = todDist - startDistLeg;
+      phase.cruiseWindIndex = addWindLine(legLine.left(2));
+      phase.cruiseSpeed = perf.getCruiseSpeed();
+
+      // TOD to destination ===================
+      phase.descentDist = endDistLeg - todDist;
+      phase.descentWindIndex = addWindLine(legLine.right(2));
+      phase.descentSpeed = perf.getDescentSpeed();
+    }
+    else
+    {
+      // Cruise only ==========================
+      phase.cruiseDist = legDist;
+      phase.cruiseWindIndex = addWindLine(legLine);
+      phase.cruiseSpeed = perf.getCruiseSpeed();
+    }
+
+    // Wind at leg end
+    if(!leg.isMissed() && legDist < map::INVALID_DISTANCE_VALUE)
+      phase.posWindIndex = addWindLine(ageo::LineString({legLine.getPos2()}));
+  }
+
+  QVector<atools::grib::Wind> winds;
+  windReporter->getWindForLineStringsRoute(winds, windLines);
+
   for(int i = 0; i < size(); i++)
   {
     RouteAltitudeLeg& leg = (*this)[i];
@@ -1784,84 +1905,12 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
     }
     else
     {
-      // Beginning and end of this leg
-      float startDistLeg = leg.getDistanceFromStart() - leg.getDistanceTo();
-      float endDistLeg = leg.getDistanceFromStart();
-      const ageo::LineString& legLine = leg.getLineString();
-
-      // Reset all variables
-      float climbDist = 0.f, cruiseDist = 0.f, descentDist = 0.f;
-      float climbSpeed = 0.f, cruiseSpeed = 0.f, descentSpeed = 0.f;
-      atools::grib::Wind climbWind, cruiseWind, descentWind;
-
-      // Check if leg covers TOC and/or TOD =================================================
-      // Calculate wind, distance and averate speed (TAS) for this leg
-      // Wind is interpolated by altitude
-      // Need to use smaller/greater *or equal* to catch special cases of exactly matching distances
-      if(endDistLeg <= tocDist)
-      {
-        // All climb before TOC ==========================
-        climbDist = legDist;
-        climbWind = windReporter->getWindForLineStringRoute(legLine);
-        climbSpeed = perf.getClimbSpeed();
-      }
-      else if(startDistLeg >= todDist)
-      {
-        // All descent after TOD ==========================
-        descentDist = legDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine);
-        descentSpeed = perf.getDescentSpeed();
-      }
-      else if(startDistLeg <= tocDist && endDistLeg >= todDist)
-      {
-        // Crosses TOC *and* TOD  - phases climb, cruise and descent ==========================
-        // Climb to TOC ===================
-        climbDist = tocDist - startDistLeg;
-        climbWind = windReporter->getWindForLineStringRoute(legLine.left(2));
-        climbSpeed = perf.getClimbSpeed();
-
-        // cruise - TOC to TOD ===================
-        cruiseDist = todDist - tocDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.mid(1, 2));
-        cruiseSpeed = perf.getCruiseSpeed();
-
-        // TOD to destination ===================
-        descentDist = endDistLeg - todDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine.right(2));
-        descentSpeed = perf.getDescentSpeed();
-      }
-      else if(startDistLeg <= tocDist && endDistLeg <= todDist)
-      {
-        // Crosses TOC and goes into cruise ==========================
-        climbDist = tocDist - startDistLeg;
-        climbWind = windReporter->getWindForLineStringRoute(legLine.left(2));
-        climbSpeed = perf.getClimbSpeed();
-
-        // Cruise to TOD ==========================
-        cruiseDist = endDistLeg - tocDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.right(2));
-        cruiseSpeed = perf.getCruiseSpeed();
-      }
-      else if(startDistLeg >= tocDist && endDistLeg >= todDist)
-      {
-        // Goes from cruise to and after TOD ==========================
-        // Cruise to TOD ==========================
-        cruiseDist = todDist - startDistLeg;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine.left(2));
-        cruiseSpeed = perf.getCruiseSpeed();
-
-        // TOD to destination ===================
-        descentDist = endDistLeg - todDist;
-        descentWind = windReporter->getWindForLineStringRoute(legLine.right(2));
-        descentSpeed = perf.getDescentSpeed();
-      }
-      else
-      {
-        // Cruise only ==========================
-        cruiseDist = legDist;
-        cruiseWind = windReporter->getWindForLineStringRoute(legLine);
-        cruiseSpeed = perf.getCruiseSpeed();
-      }
+      // Distances, speeds and winds for phases as collected above - wind is interpolated by altitude
+      const LegPhases& phase = phases.at(i);
+      float climbDist = phase.climbDist, cruiseDist = phase.cruiseDist, descentDist = phase.descentDist;
+      float climbSpeed = phase.climbSpeed, cruiseSpeed = phase.cruiseSpeed, descentSpeed = phase.descentSpeed;
+      atools::grib::Wind climbWind = windAt(winds, phase.climbWindIndex), cruiseWind = windAt(winds, phase.cruiseWindIndex),
+                         descentWind = windAt(winds, phase.descentWindIndex);
 
       // Calculate ground speed for each phase (climb, cruise, descent) of this leg - 0 is phase is not touched
       float course = route->value(i).getCourseEndTrue();
@@ -1950,7 +1999,7 @@ void RouteAltitude::calculateTrip(const atools::fs::perf::AircraftPerf& perf)
         leg.cruiseFuel = perf.getCruiseFuelFlow() * leg.cruiseTime;
         leg.descentFuel = perf.getDescentFuelFlow() * leg.descentTime;
 
-        atools::grib::Wind wind = windReporter->getWindForPosRoute(legLine.getPos2());
+        atools::grib::Wind wind = windAt(winds, phase.posWindIndex);
         leg.windSpeed = wind.speed;
         leg.windDirection = wind.dir;
 
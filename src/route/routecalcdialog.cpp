@@ -79,6 +79,7 @@ RouteCalcDialog::RouteCalcDialog(QWidget *parent)
 
   connect(ui->pushButtonRouteCalcDirect, &QPushButton::clicked, this, &RouteCalcDialog::calculateDirectClicked);
   connect(ui->pushButtonRouteCalcReverse, &QPushButton::clicked, this, &RouteCalcDialog::calculateReverseClicked);
+  connect(ui->pushButtonRouteCalcAlternatives, &QPushButton::clicked, this, &RouteCalcDialog::alternativesClicked);
   connect(ui->pushButtonRouteCalcTrackDownload, &QPushButton::clicked, this, &RouteCalcDialog::downloadTrackClicked);
   connect(ui->pushButtonRouteCalcAdjustAltitude, &QPushButton::clicked, this, &RouteCalcDialog::adjustAltitudePressed);
   connect(ui->radioButtonRouteCalcAirway, &QRadioButton::clicked, this, &RouteCalcDialog::updateWidgets);
@@ -105,12 +106,10 @@ void RouteCalcDialog::buttonBoxClicked(QAbstractButton *button)
 {
   if(button == ui->buttonBox->button(QDialogButtonBox::Apply))
   {
+    // Calculation runs in background - reset by calculationFinished()
     calculating = true;
     updateWidgets();
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
     emit calculateClicked();
-    calculating = false;
-    updateWidgets();
   }
   else if(button == ui->buttonBox->button(QDialogButtonBox::Help))
     atools::gui::HelpHandler::openHelpUrlWeb(NavApp::getQMainWidget(), lnm::helpOnlineUrl + "ROUTECALC.html", lnm::helpLanguageOnline());
@@ -118,6 +117,12 @@ void RouteCalcDialog::buttonBoxClicked(QAbstractButton *button)
     QDialog::hide();
 }
 
+void RouteCalcDialog::calculationFinished()
+{
+  calculating = false;
+  updateWidgets();
+}
+
 void RouteCalcDialog::showForFullCalculation()
 {
   ui->radioButtonRouteCalcFull->setChecked(true);
@@ -170,6 +175,7 @@ void RouteCalcDialog::updateWidgets()
     ui->buttonBox->button(QDialogButtonBox::Close)->setEnabled(false);
     ui->pushButtonRouteCalcDirect->setEnabled(false);
     ui->pushButtonRouteCalcReverse->setEnabled(false);
+    ui->pushButtonRouteCalcAlternatives->setEnabled(false);
   }
   else
   {
@@ -191,6 +197,7 @@ void RouteCalcDialog::updateWidgets()
 
     ui->pushButtonRouteCalcDirect->setEnabled(canCalcRoute && NavApp::getRouteConst().hasEntries());
     ui->pushButtonRouteCalcReverse->setEnabled(canCalcRoute);
+    ui->pushButtonRouteCalcAlternatives->setEnabled(canCalcRoute && !isCalculateSelection());
 
     QString msg = tr("Use downloaded NAT, PACOTS or AUSOTS tracks.\n"
                      "Best track will be selected automatically.\n"
@@ -368,6 +375,25 @@ float RouteCalcDialog::getAirwayPreferenceCostFactor() const
   return DIRECT_COST_FACTORS.at(ui->horizontalSliderRouteCalcAirwayPref->value());
 }
 
+float RouteCalcDialog::getCostFactorForPreference(int preference)
+{
+  return DIRECT_COST_FACTORS.at(preference);
+}
+
+QString RouteCalcDialog::getPreferenceText(int preference) const
+{
+  // Use only first line
+  return preferenceTexts.value(preference).section('\n', 0, 0);
+}
+
+void RouteCalcDialog::alternativesClicked()
+{
+  // Calculation runs in background - reset by calculationFinished()
+  calculating = true;
+  updateWidgets();
+  emit calculateAlternativesClicked();
+}
+
 void RouteCalcDialog::adjustAltitudePressed()
 {
   ui->spinBoxRouteCalcCruiseAltitude->setValue(NavApp::getRouteConst().getAdjustedAltitude(ui->spinBoxRouteCalcCruiseAltitude->value()));
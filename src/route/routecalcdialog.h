@@ -81,6 +81,9 @@ public:
   /* Update messages if route has changed. */
   void updateWidgets();
 
+  /* Enable buttons again after background calculation is done or canceled */
+  void calculationFinished();
+
   /* Load and save widget status */
   void restoreState();
   void saveState();
@@ -126,6 +129,10 @@ public:
 
   float getAirwayPreferenceCostFactor() const;
 
+  /* Cost factor and short description for a preference slider position */
+  static float getCostFactorForPreference(int preference);
+  QString getPreferenceText(int preference) const;
+
   /* Min and max values including for ui->horizontalSliderRouteCalcAirwayPreference.
    * Sync with DIRECT_COST_FACTORS */
   static constexpr int AIRWAY_WAYPOINT_PREF_MIN = 0;
@@ -138,6 +145,7 @@ signals:
   void calculateClicked();
   void calculateDirectClicked();
   void calculateReverseClicked();
+  void calculateAlternativesClicked();
 
 private:
   /* Fill header message with departure, destination or error messages. */
@@ -148,6 +156,7 @@ private:
   void adjustAltitudePressed();
 
   void buttonBoxClicked(QAbstractButton *button);
+  void alternativesClicked();
 
   /* Catch events to allow repositioning */
   virtual void showEvent(QShowEvent *) override;
@@ -18,6 +18,8 @@
 #include "route/routecommand.h"
 #include "route/routecontroller.h"
 
+#include "atools.h"
+
 RouteCommand::RouteCommand(RouteController *routeController,
                            const atools::fs::pln::Flightplan& flightplanBefore, const QString& text,
                            rctype::RouteCmdType rcType)
@@ -33,12 +35,40 @@ RouteCommand::~RouteCommand()
 
 void RouteCommand::setFlightplanAfter(const atools::fs::pln::Flightplan& flightplanAfter)
 {
-  planAfterChange = flightplanAfter;
+  const atools::fs::pln::Flightplan& before = planBeforeChange;
+  const atools::fs::pln::Flightplan& after = flightplanAfter;
+
+  // Skip equal entries at start and end to get the changed range ===========
+  int sizeMin = std::min(before.size(), after.size());
+  int prefix = 0;
+  while(prefix < sizeMin && entryEqual(before.at(prefix), after.at(prefix)))
+    prefix++;
+
+  int suffix = 0;
+  while(suffix < sizeMin - prefix && entryEqual(before.at(before.size() - 1 - suffix), after.at(after.size() - 1 - suffix)))
+    suffix++;
+
+  changedIndex = prefix;
+  entriesBeforeChange = before.mid(prefix, before.size() - prefix - suffix);
+  entriesAfterChange = after.mid(prefix, after.size() - prefix - suffix);
+  sizeBeforeChange = before.size();
+  sizeAfterChange = after.size();
+
+  headerBeforeChange = header(before);
+  headerAfterChange = header(after);
+
+  // Release full copy
+  planBeforeChange = atools::fs::pln::Flightplan();
+
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << text() << "changedIndex" << changedIndex
+           << "before" << entriesBeforeChange.size() << "after" << entriesAfterChange.size();
+#endif
 }
 
 void RouteCommand::undo()
 {
-  controller->changeRouteUndo(planBeforeChange);
+  controller->changeRouteUndo(headerBeforeChange, changedIndex, entriesAfterChange, sizeAfterChange, entriesBeforeChange);
 }
 
 void RouteCommand::redo()
@@ -47,5 +77,32 @@ void RouteCommand::redo()
     // Skip first redo - I need to do the initial changes myself
     firstRedoExecuted = true;
   else
-    controller->changeRouteRedo(planAfterChange);
+    controller->changeRouteRedo(headerAfterChange, changedIndex, entriesBeforeChange, sizeBeforeChange, entriesAfterChange);
+}
+
+atools::fs::pln::Flightplan RouteCommand::header(const atools::fs::pln::Flightplan& flightplan)
+{
+  atools::fs::pln::Flightplan plan(flightplan);
+  plan.erase(plan.begin(), plan.end());
+  return plan;
+}
+
+bool RouteCommand::entryEqual(const atools::fs::pln::FlightplanEntry& entry1, const atools::fs::pln::FlightplanEntry& entry2)
+{
+  const atools::geo::Pos& pos1 = entry1.getPosition();
+  const atools::geo::Pos& pos2 = entry2.getPosition();
+
+  return entry1.getWaypointType() == entry2.getWaypointType() &&
+         entry1.getIdent() == entry2.getIdent() &&
+         entry1.getRegion() == entry2.getRegion() &&
+         entry1.getName() == entry2.getName() &&
+         entry1.getComment() == entry2.getComment() &&
+         entry1.getAirway() == entry2.getAirway() &&
+         entry1.getFlags() == entry2.getFlags() &&
+         pos1.isValid() == pos2.isValid() &&
+         atools::almostEqual(pos1.getLonX(), pos2.getLonX()) &&
+         atools::almostEqual(pos1.getLatY(), pos2.getLatY()) &&
+         atools::almostEqual(pos1.getAltitude(), pos2.getAltitude()) &&
+         atools::almostEqual(entry1.getAltitude(), entry2.getAltitude()) &&
+         atools::almostEqual(entry1.getMagvar(), entry2.getMagvar());
 }
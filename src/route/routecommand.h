@@ -40,7 +40,8 @@ enum RouteCmdType
 
 /*
  * Flight plan undo command including a few workaround for QUndoCommand inflexibilities.
- * Keeps a copy of the flight plan before and after the change.
+ * Keeps only the difference between the flight plan before and after the change as a changed range of entries
+ * plus the flight plan header (properties, type, cruise altitude, etc.) without entries.
  */
 class RouteCommand :
   public QUndoCommand
@@ -53,15 +54,36 @@ public:
   virtual void undo() override;
   virtual void redo() override;
 
-  /* Need to keep both versions in a redundant way since linking between commands is not reliable */
+  /* Calculates the changed range of entries compared to the plan given in the constructor.
+   * Full copies of both plans are not kept. */
   void setFlightplanAfter(const atools::fs::pln::Flightplan& flightplanAfter);
 
+  /* Compares all fields which can be changed by editing. Also used to detect plan changes during calculation
+   * and to check if undo or redo fit the current plan. */
+  static bool entryEqual(const atools::fs::pln::FlightplanEntry& entry1, const atools::fs::pln::FlightplanEntry& entry2);
+
 private:
+  /* Copy of flight plan without entries */
+  static atools::fs::pln::Flightplan header(const atools::fs::pln::Flightplan& flightplan);
+
   /* Avoid the first redo action when inserting the command. This not usable for complex interactions. */
   bool firstRedoExecuted = false;
   RouteController *controller;
   rctype::RouteCmdType type;
-  atools::fs::pln::Flightplan planBeforeChange, planAfterChange;
+
+  /* Full plan before change. Only kept until setFlightplanAfter() is called. */
+  atools::fs::pln::Flightplan planBeforeChange;
+
+  /* Plans before and after change without entries */
+  atools::fs::pln::Flightplan headerBeforeChange, headerAfterChange;
+
+  /* Changed entries starting at changedIndex. Entries after are removed and entries before are inserted on undo
+   * and vice versa on redo. */
+  int changedIndex = 0;
+  QList<atools::fs::pln::FlightplanEntry> entriesBeforeChange, entriesAfterChange;
+
+  /* Number of entries of full plans used to check if undo or redo fit the current plan */
+  int sizeBeforeChange = 0, sizeAfterChange = 0;
 };
 
 #endif // LITTLENAVMAP_ROUTECOMMAND_H
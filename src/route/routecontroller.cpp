@@ -27,6 +27,7 @@
 #include "common/unit.h"
 #include "common/unit.h"
 #include "common/unitstringtool.h"
+#include "db/databasemanager.h"
 #include "exception.h"
 #include "export/csvexporter.h"
 #include "fs/perf/aircraftperf.h"
@@ -53,6 +54,8 @@
 #include "query/procedurequery.h"
 #include "route/customproceduredialog.h"
 #include "route/flightplanentrybuilder.h"
+#include "route/routealternatives.h"
+#include "route/routealternativesdialog.h"
 #include "route/routealtitude.h"
 #include "route/routecalcdialog.h"
 #include "route/routelabel.h"
@@ -78,6 +81,9 @@
 #include <QTextTable>
 #include <QPlainTextEdit>
 #include <QProgressDialog>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QThread>
+#include <QSet>
 #include <QScrollBar>
 #include <QStringBuilder>
 
@@ -316,6 +322,14 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
   connect(&routeAltDelayTimer, &QTimer::timeout, this, &RouteController::routeAltChangedDelayed);
   routeAltDelayTimer.setSingleShot(true);
 
+  // Background flight plan calculation
+  connect(&routeCalcWatcher, &QFutureWatcher<bool>::finished, this, &RouteController::calculateRouteFinished);
+  connect(&routeAlternativesWatcher, &QFutureWatcher<void>::finished, this, &RouteController::calculateRouteAlternativesFinished);
+  connect(&routeCalcProgressTimer, &QTimer::timeout, this, &RouteController::calculateRouteProgress);
+
+  // Databases are already open - load networks to have them ready for the first calculation
+  loadRouteNetworksStart();
+
   // Clear selection after inactivity
   // Or move active to top after inactivity (no scrolling)
   connect(&tableCleanupTimer, &QTimer::timeout, this, &RouteController::cleanupTableTimeout);
@@ -397,6 +411,7 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
   connect(routeCalcDialog, &RouteCalcDialog::calculateClicked, this, &RouteController::calculateRoute);
   connect(routeCalcDialog, &RouteCalcDialog::calculateDirectClicked, this, &RouteController::calculateDirect);
   connect(routeCalcDialog, &RouteCalcDialog::calculateReverseClicked, this, &RouteController::reverseRoute);
+  connect(routeCalcDialog, &RouteCalcDialog::calculateAlternativesClicked, this, &RouteController::calculateRouteAlternatives);
   connect(routeCalcDialog, &RouteCalcDialog::downloadTrackClicked, NavApp::getTrackController(), &TrackController::startDownload);
 
   connect(routeLabel, &RouteLabel::flightplanLabelLinkActivated, this, &RouteController::flightplanLabelLinkActivated);
@@ -414,6 +429,10 @@ RouteController::RouteController(QMainWindow *parentWindow, QTableView *tableVie
 
 RouteController::~RouteController()
 {
+  // Wait for worker threads before deleting the networks
+  cancelRouteCalculation();
+  loadRouteNetworksWait();
+
   NavApp::removeDialogFromDockHandler(routeCalcDialog);
   routeAltDelayTimer.stop();
 
@@ -449,6 +468,10 @@ RouteController::~RouteController()
   delete routeNetworkAirway;
   routeNetworkAirway = nullptr;
 
+  qDebug() << Q_FUNC_INFO << "delete routeNetworksAirwayExtra";
+  qDeleteAll(routeNetworksAirwayExtra);
+  routeNetworksAirwayExtra.clear();
+
   qDebug() << Q_FUNC_INFO << "delete zoomHandler";
   delete zoomHandler;
   zoomHandler = nullptr;
@@ -1828,6 +1851,9 @@ void RouteController::calculateRoute()
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(isRouteCalculationRunning())
+    return;
+
   atools::routing::RouteNetwork *net = nullptr;
   QString command;
   atools::routing::Modes mode = atools::routing::MODE_NONE;
@@ -1884,14 +1910,21 @@ void RouteController::calculateRoute()
       mode |= atools::routing::MODE_RADIONAV_NDB;
   }
 
+  // Wait for preloading
+  loadRouteNetworksWait();
+
   if(!net->isLoaded())
   {
+    // Network is kept until database or tracks change
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
     atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
     loader.load(net);
+    QGuiApplication::restoreOverrideCursor();
   }
 
-  atools::routing::RouteFinder routeFinder(net);
-  routeFinder.setCostFactorForceAirways(routeCalcDialog->getAirwayPreferenceCostFactor());
+  // Deleted in calculateRouteCleanup()
+  atools::routing::RouteFinder *routeFinder = new atools::routing::RouteFinder(net);
+  routeFinder->setCostFactorForceAirways(routeCalcDialog->getAirwayPreferenceCostFactor());
 
   int fromIdx = -1, toIdx = -1;
   if(routeCalcDialog->isCalculateSelection())
@@ -1907,36 +1940,77 @@ void RouteController::calculateRoute()
     // Disable certain optimizations in route finder - use nearest underlying point as start for departure position
     mode |= atools::routing::MODE_POINT_TO_POINT;
 
-  if(calculateRouteInternal(&routeFinder, command, fetchAirways, routeCalcDialog->getCruisingAltitudeFt(), fromIdx, toIdx, mode))
-    NavApp::setStatusMessage(tr("Calculated flight plan."));
-  else
-    NavApp::setStatusMessage(tr("No route found."));
+  calculateRouteStart(routeFinder, command, fetchAirways, routeCalcDialog->getCruisingAltitudeFt(), fromIdx, toIdx, mode);
+}
 
-  routeCalcDialog->updateWidgets();
+void RouteController::preTrackLoad()
+{
+  // Loader reads the track database
+  loadRouteNetworksWait();
 }
 
 void RouteController::clearAirwayNetworkCache()
 {
+  // Network is used by the worker threads
+  cancelRouteCalculation();
+  loadRouteNetworksWait();
   routeNetworkAirway->clear();
+  for(atools::routing::RouteNetwork *net : routeNetworksAirwayExtra)
+    net->clear();
+
+  // Load again with new tracks
+  loadRouteNetworksStart();
 }
 
-/* Calculate a flight plan to all types */
-bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *routeFinder, const QString& commandName,
-                                             bool fetchAirways, float altitudeFt, int fromIndex, int toIndex,
-                                             atools::routing::Modes mode)
+void RouteController::loadRouteNetworksStart()
+{
+  loadRouteNetworksWait();
+
+  atools::routing::RouteNetwork *airwayNetwork = routeNetworkAirway->isLoaded() ? nullptr : routeNetworkAirway;
+  atools::routing::RouteNetwork *radioNetwork = routeNetworkRadio->isLoaded() ? nullptr : routeNetworkRadio;
+
+  if(airwayNetwork != nullptr || radioNetwork != nullptr)
+  {
+    qDebug() << Q_FUNC_INFO << "airway" << (airwayNetwork != nullptr) << "radio" << (radioNetwork != nullptr);
+
+    // Connections are only used by this thread
+    DatabaseManager *databaseManager = NavApp::getDatabaseManager();
+    atools::sql::SqlDatabase *navDb = databaseManager->getDatabaseNavRoute();
+    atools::sql::SqlDatabase *trackDb = databaseManager->getDatabaseTrackRoute();
+
+    routeNetworkLoadFuture = QtConcurrent::run([navDb, trackDb, airwayNetwork, radioNetwork]() -> void {
+      atools::routing::RouteNetworkLoader loader(navDb, trackDb);
+      if(airwayNetwork != nullptr)
+        loader.load(airwayNetwork);
+      if(radioNetwork != nullptr)
+        loader.load(radioNetwork);
+    });
+  }
+}
+
+void RouteController::loadRouteNetworksWait()
+{
+  if(routeNetworkLoadFuture.isRunning())
+  {
+    qDebug() << Q_FUNC_INFO << "waiting";
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    routeNetworkLoadFuture.waitForFinished();
+    QGuiApplication::restoreOverrideCursor();
+  }
+}
+
+/* Calculate a flight plan to all types. Starts the route finder in a worker thread and returns immediately.
+ * calculateRouteFinished() is called when done. */
+void RouteController::calculateRouteStart(atools::routing::RouteFinder *routeFinder, const QString& commandName,
+                                          bool fetchAirways, float altitudeFt, int fromIndex, int toIndex,
+                                          atools::routing::Modes mode)
 {
   qDebug() << Q_FUNC_INFO;
   bool calcRange = fromIndex != -1 && toIndex != -1;
-  int oldRouteSize = route.size();
 
   // Stop any background tasks
   beforeRouteCalc();
 
-  Flightplan& flightplan = route.getFlightplan();
-
-  // Load network from database if not already done
-  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
-
   Pos departurePos, destinationPos;
 
   if(calcRange)
@@ -1953,45 +2027,192 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
     destinationPos = route.getDestinationBeforeProcedure().getPosition();
   }
 
-  // ===================================================================
+  // Remember parameters and plan to apply the result later
+  routeCalcFinder = routeFinder;
+  routeCalcParams.commandName = commandName;
+  routeCalcParams.fetchAirways = fetchAirways;
+  routeCalcParams.altitudeFt = altitudeFt;
+  routeCalcParams.fromIndex = fromIndex;
+  routeCalcParams.toIndex = toIndex;
+  routeCalcParams.departurePos = departurePos;
+  routeCalcParams.destinationPos = destinationPos;
+  routeCalcParams.flightplan = route.getFlightplanConst();
+
+  startRouteCalcProgress(tr("Calculating Flight Plan ..."));
+
+  routeFinder->setProgressCallback([this](int distToDest, int currentDistToDest) -> bool
+  {
+    routeCalcProgressMax = distToDest;
+    routeCalcProgressValue = distToDest - currentDistToDest;
+    return !routeCalcCanceled;
+  });
+
+  // Calculate the route in background - calls above lambda ================================================
+  int altitude = atools::roundToInt(altitudeFt);
+  routeCalcFuture = QtConcurrent::run([routeFinder, departurePos, destinationPos, altitude, mode]() -> bool {
+    return routeFinder->calculateRoute(departurePos, destinationPos, altitude, mode);
+  });
+
+  // Watcher will call RouteController::calculateRouteFinished() when finished
+  routeCalcWatcher.setFuture(routeCalcFuture);
+}
+
+void RouteController::startRouteCalcProgress(const QString& text)
+{
   // Set up a progress dialog which shows for all calculations taking more than half a second
-  QProgressDialog progress(tr("Calculating Flight Plan ..."), tr("Cancel"), 0, 0, routeCalcDialog);
-  progress.setWindowTitle(tr("Little Navmap - Calculating Flight Plan"));
-  progress.setWindowFlags(progress.windowFlags() & ~Qt::WindowContextHelpButtonHint);
-  progress.setWindowModality(Qt::ApplicationModal);
-  progress.setMinimumDuration(500);
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  routeCalcOverrideCursor = true;
+
+  routeCalcProgress = new QProgressDialog(text, tr("Cancel"), 0, 0, routeCalcDialog);
+  routeCalcProgress->setWindowTitle(tr("Little Navmap - Calculating Flight Plan"));
+  routeCalcProgress->setWindowFlags(routeCalcProgress->windowFlags() & ~Qt::WindowContextHelpButtonHint);
+  routeCalcProgress->setWindowModality(Qt::ApplicationModal);
+  routeCalcProgress->setMinimumDuration(500);
+  connect(routeCalcProgress, &QProgressDialog::canceled, this, [this]() -> void {
+    routeCalcCanceled = true;
+    if(routeAlternatives != nullptr)
+      routeAlternatives->cancel();
+  });
 
-  bool dialogShown = false, canceled = false;
-  routeFinder->setProgressCallback([&progress, &canceled, &dialogShown](int distToDest, int currentDistToDest) -> bool
+  // Progress values are updated by the worker thread and read by the timer
+  routeCalcCanceled = false;
+  routeCalcProgressMax = 0;
+  routeCalcProgressValue = 0;
+  routeCalcProgressTimer.start(ROUTE_CALC_PROGRESS_MS);
+}
+
+void RouteController::calculateRouteProgress()
+{
+  if(routeCalcProgress != nullptr)
   {
-    QApplication::processEvents();
-    progress.setMaximum(distToDest);
-    progress.setValue(distToDest - currentDistToDest);
-    canceled = progress.wasCanceled();
+    if(routeAlternatives != nullptr)
+    {
+      // Count finished jobs
+      routeCalcProgress->setMaximum(routeAlternatives->getNumJobs());
+      routeCalcProgress->setValue(routeAlternatives->getNumJobsDone());
+    }
+    else
+    {
+      routeCalcProgress->setMaximum(routeCalcProgressMax);
+      routeCalcProgress->setValue(routeCalcProgressValue);
+    }
 
-    if(!dialogShown && progress.isVisible())
+    if(routeCalcOverrideCursor && routeCalcProgress->isVisible())
     {
       // Dialog is shown - remove wait cursor
-      dialogShown = true;
+      routeCalcOverrideCursor = false;
       QGuiApplication::restoreOverrideCursor();
     }
+  }
+}
 
-    return !canceled;
-  });
+void RouteController::cancelRouteCalculation()
+{
+  if(routeCalcFinder != nullptr)
+  {
+    qDebug() << Q_FUNC_INFO;
+    routeCalcCanceled = true;
+    routeCalcFuture.waitForFinished();
+    calculateRouteCleanup();
+  }
 
-  // Calculate the route - calls above lambda ================================================
-  bool found = routeFinder->calculateRoute(departurePos, destinationPos, atools::roundToInt(altitudeFt), mode);
+  if(routeAlternatives != nullptr)
+  {
+    qDebug() << Q_FUNC_INFO << "alternatives";
+    routeAlternatives->cancel();
+    routeAlternativesFuture.waitForFinished();
+    calculateRouteCleanup();
+  }
+}
+
+bool RouteController::isRouteCalculationRunning() const
+{
+  return routeCalcFinder != nullptr || routeAlternatives != nullptr;
+}
 
-  if(!dialogShown)
+bool RouteController::isFlightplanChangedSinceCalculation() const
+{
+  const Flightplan& oldFlightplan = routeCalcParams.flightplan;
+  const Flightplan& flightplan = route.getFlightplanConst();
+  if(oldFlightplan.size() != flightplan.size())
+    return true;
+
+  for(int i = 0; i < oldFlightplan.size(); i++)
+  {
+    if(!RouteCommand::entryEqual(oldFlightplan.at(i), flightplan.at(i)))
+      return true;
+  }
+  return false;
+}
+
+void RouteController::calculateRouteCleanup()
+{
+  routeCalcProgressTimer.stop();
+
+  if(routeCalcOverrideCursor)
+  {
+    routeCalcOverrideCursor = false;
     QGuiApplication::restoreOverrideCursor();
+  }
 
-  qDebug() << Q_FUNC_INFO << "found" << found << "canceled" << canceled;
+  if(routeCalcProgress != nullptr)
+  {
+    // Hide dialog
+    routeCalcProgress->reset();
+    routeCalcProgress->deleteLater();
+    routeCalcProgress = nullptr;
+  }
+
+  delete routeCalcFinder;
+  routeCalcFinder = nullptr;
+  delete routeAlternatives;
+  routeAlternatives = nullptr;
+  routeCalcParams = RouteCalcParams();
+
+  if(routeCalcDialog != nullptr)
+    routeCalcDialog->calculationFinished();
+}
+
+/* Called by watcher when the worker thread is finished. Extracts the result and applies it to the flight plan. */
+void RouteController::calculateRouteFinished()
+{
+  if(routeCalcFinder == nullptr)
+    // Already cleaned up by cancelRouteCalculation()
+    return;
+
+  bool found = routeCalcFuture.result();
+  bool canceled = routeCalcCanceled;
 
   // Hide dialog
-  progress.reset();
+  routeCalcProgressTimer.stop();
+  if(routeCalcProgress != nullptr)
+    routeCalcProgress->reset();
 
-  // Create wait cursor if calculation takes too long
-  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  qDebug() << Q_FUNC_INFO << "found" << found << "canceled" << canceled;
+
+  // Plan might have been changed before the modal progress dialog was shown
+  if(isFlightplanChangedSinceCalculation())
+  {
+    qDebug() << Q_FUNC_INFO << "Flight plan changed while calculating";
+    NavApp::setStatusMessage(tr("Flight plan changed while calculating. Result discarded."));
+    calculateRouteCleanup();
+    return;
+  }
+
+  if(!routeCalcOverrideCursor)
+  {
+    // Create wait cursor if calculation takes too long
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    routeCalcOverrideCursor = true;
+  }
+
+  const QString& commandName = routeCalcParams.commandName;
+  bool fetchAirways = routeCalcParams.fetchAirways;
+  float altitudeFt = routeCalcParams.altitudeFt;
+  int fromIndex = routeCalcParams.fromIndex, toIndex = routeCalcParams.toIndex;
+  const Pos& departurePos = routeCalcParams.departurePos;
+  const Pos& destinationPos = routeCalcParams.destinationPos;
+  atools::routing::RouteFinder *routeFinder = routeCalcFinder;
 
   float distance = 0.f;
   QVector<RouteEntry> calculatedRoute;
@@ -2017,101 +2238,409 @@ bool RouteController::calculateRouteInternal(atools::routing::RouteFinder *route
              << "direct distance" << QString::number(directDistance, 'f', 0) << "ratio" << ratio;
 
     if(ratio < MAX_DISTANCE_DIRECT_RATIO)
-    {
-      // Start undo
-      RouteCommand *undoCommand = preChange(commandName);
-      int numAlternateLegs = route.getNumAlternateLegs();
+      applyCalculatedRoute(calculatedRoute, commandName, fetchAirways, altitudeFt, fromIndex, toIndex);
+    else
+      // Too long
+      found = false;
+  }
 
-      if(calcRange)
-      {
-        flightplan[toIndex].setAirway(QString());
-        flightplan[toIndex].setFlag(atools::fs::pln::entry::TRACK, false);
-        flightplan.erase(flightplan.begin() + fromIndex + 1, flightplan.begin() + toIndex);
-      }
-      else
-        // Erase all but start and destination
-        flightplan.erase(flightplan.begin() + 1, flightplan.end() - numAlternateLegs - 1);
+  // Restores cursor and deletes route finder
+  calculateRouteCleanup();
+
+  if(!found && !canceled)
+    // Use routeCalcDialog as parent to avoid main raising in front
+    atools::gui::Dialog(routeCalcDialog).showInfoMsgBox(lnm::ACTIONS_SHOW_ROUTE_ERROR,
+                                                        tr("Cannot calculate flight plan.\n\n"
+                                                           "Try another calculation type,\n"
+                                                           "change the cruise altitude or\n"
+                                                           "create the flight plan manually."),
+                                                        tr("Do not &show this dialog again."));
+#ifdef DEBUG_INFORMATION
+  qDebug() << Q_FUNC_INFO << route;
+#endif
+
+  if(found && !canceled)
+    NavApp::setStatusMessage(tr("Calculated flight plan."));
+  else
+    NavApp::setStatusMessage(tr("No route found."));
+}
+
+void RouteController::calculateRouteAlternatives()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  if(isRouteCalculationRunning())
+    return;
+
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  int altitudeStepFt = settings.getAndStoreValue(lnm::SETTINGS_ROUTE_CALC % "AlternativesAltitudeStepFt", 2000).toInt();
+  int altitudeSteps = settings.getAndStoreValue(lnm::SETTINGS_ROUTE_CALC % "AlternativesAltitudeSteps", 1).toInt();
+  int numNetworks = settings.getAndStoreValue(lnm::SETTINGS_ROUTE_CALC % "AlternativesAirwayNetworks",
+                                              std::max(1, std::min(QThread::idealThreadCount() - 1, 3))).toInt();
+
+  // Mode flags for all calculations =======================================
+  atools::routing::Modes baseMode = atools::routing::MODE_NONE;
+  if(route.hasAnySidProcedure())
+    // Disable certain optimizations in route finder - use nearest underlying point as start for departure position
+    baseMode |= atools::routing::MODE_POINT_TO_POINT;
+
+  atools::routing::Modes airwayBaseMode = baseMode;
+  if(routeCalcDialog->isAirwayNoRnav())
+    airwayBaseMode |= atools::routing::MODE_NO_RNAV;
+
+  // Cruise altitudes around the one selected in the dialog =======================================
+  int cruiseAltitudeFt = atools::roundToInt(routeCalcDialog->getCruisingAltitudeFt());
+  QVector<int> altitudes;
+  for(int i = -altitudeSteps; i <= altitudeSteps; i++)
+  {
+    int altitude = cruiseAltitudeFt + i * altitudeStepFt;
+    if(altitude >= ROUTE_ALTERNATIVES_MIN_ALT_FT)
+      altitudes.append(altitude);
+  }
+
+  // Airways only, balanced and value selected in dialog =======================================
+  QVector<int> preferences({RouteCalcDialog::AIRWAY_WAYPOINT_PREF_MIN, RouteCalcDialog::AIRWAY_WAYPOINT_PREF_CENTER});
+  if(!preferences.contains(routeCalcDialog->getAirwayWaypointPreference()))
+    preferences.append(routeCalcDialog->getAirwayWaypointPreference());
 
-      int idx = 1;
-      // Create flight plan entries - will be copied later to the route map objects
-      for(const RouteEntry& routeEntry : calculatedRoute)
+  QVector<std::pair<QString, atools::routing::Modes> > airwayTypes({
+    std::make_pair(tr("Airways"), atools::routing::Modes(atools::routing::MODE_AIRWAY_WAYPOINT)),
+    std::make_pair(tr("High altitude airways"), atools::routing::Modes(atools::routing::MODE_JET_WAYPOINT)),
+    std::make_pair(tr("Low altitude airways"), atools::routing::Modes(atools::routing::MODE_VICTOR_WAYPOINT))
+  });
+
+  if(NavApp::hasTracks())
+    airwayTypes.append(std::make_pair(tr("Airways and tracks"),
+                                      atools::routing::Modes(atools::routing::MODE_AIRWAY_WAYPOINT |
+                                                             atools::routing::MODE_TRACK)));
+
+  // Build job matrix =======================================
+  QVector<ralt::Job> jobs;
+  for(const std::pair<QString, atools::routing::Modes>& type : airwayTypes)
+  {
+    for(int altitude : altitudes)
+    {
+      for(int preference : preferences)
       {
-        FlightplanEntry flightplanEntry;
-        entryBuilder->buildFlightplanEntry(routeEntry.ref.id, atools::geo::EMPTY_POS, routeEntry.ref.objType,
-                                           flightplanEntry, fetchAirways);
-        if(fetchAirways && routeEntry.airwayId != -1)
-          // Get airway by id - needed to fetch the name first
-          updateFlightplanEntryAirway(routeEntry.airwayId, flightplanEntry);
-
-        if(calcRange)
-          flightplan.insert(flightplan.begin() + fromIndex + idx, flightplanEntry);
-        else
-          flightplan.insert(flightplan.end() - numAlternateLegs - 1, flightplanEntry);
-        idx++;
+        ralt::Job job;
+        job.typeText = type.first;
+        job.mode = type.second | airwayBaseMode;
+        if(preference == RouteCalcDialog::AIRWAY_WAYPOINT_PREF_MIN)
+          job.mode &= ~atools::routing::MODE_WAYPOINT;
+        else if(preference == RouteCalcDialog::AIRWAY_WAYPOINT_PREF_MAX)
+          job.mode &= ~atools::routing::MODE_AIRWAY;
+        job.altitudeFt = altitude;
+        job.preference = preference;
+        job.costFactor = RouteCalcDialog::getCostFactorForPreference(preference);
+        jobs.append(job);
       }
+    }
+  }
 
-      // Remove procedure points from flight plan
-      flightplan.removeProcedureEntries();
+  // Radionav does not depend on altitude and airway preference
+  ralt::Job radionavJob;
+  radionavJob.typeText = routeCalcDialog->isRadionavNdb() ? tr("Radionav VOR and NDB") : tr("Radionav VOR");
+  radionavJob.mode = baseMode | atools::routing::MODE_RADIONAV_VOR;
+  if(routeCalcDialog->isRadionavNdb())
+    radionavJob.mode |= atools::routing::MODE_RADIONAV_NDB;
+  radionavJob.altitudeFt = cruiseAltitudeFt;
+  radionavJob.costFactor = routeCalcDialog->getAirwayPreferenceCostFactor();
+  radionavJob.radionav = true;
+  jobs.append(radionavJob);
 
-      // Copy flight plan to route object
-      route.createRouteLegsFromFlightplan();
+  // Load networks - one airway network for each thread =======================================
+  loadRouteNetworksWait();
 
-      // Reload procedures from properties
-      loadProceduresFromFlightplan(true /* clearOldProcedureProperties */, false /* cleanupRoute */, false /* autoresolveTransition */);
-      QGuiApplication::restoreOverrideCursor();
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  while(routeNetworksAirwayExtra.size() < numNetworks - 1)
+    routeNetworksAirwayExtra.append(new atools::routing::RouteNetwork(atools::routing::SOURCE_AIRWAY));
 
-      // Remove duplicates in flight plan and route
-      route.updateAll();
+  QVector<atools::routing::RouteNetwork *> airwayNetworks({routeNetworkAirway});
+  airwayNetworks.append(routeNetworksAirwayExtra.mid(0, std::max(numNetworks - 1, 0)));
 
-      // Set altitude in local units
-      flightplan.setCruiseAltitudeFt(altitudeFt);
+  atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
+  for(atools::routing::RouteNetwork *net : airwayNetworks)
+  {
+    if(!net->isLoaded())
+      loader.load(net);
+  }
+  if(!routeNetworkRadio->isLoaded())
+    loader.load(routeNetworkRadio);
+  QGuiApplication::restoreOverrideCursor();
 
-      route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  // Stop any background tasks
+  beforeRouteCalc();
 
-      updateActiveLeg();
+  // Remember parameters and plan to check for changes later
+  routeCalcParams.altitudeFt = cruiseAltitudeFt;
+  routeCalcParams.departurePos = route.getLastLegOfDepartureProcedure().getPosition();
+  routeCalcParams.destinationPos = route.getDestinationBeforeProcedure().getPosition();
+  routeCalcParams.flightplan = route.getFlightplanConst();
 
-      route.updateLegAltitudes();
+  qDebug() << Q_FUNC_INFO << "jobs" << jobs.size() << "airway networks" << airwayNetworks.size();
 
-      updateTableModel();
-      updateMoveAndDeleteActions();
+  RouteAlternatives *alternatives = new RouteAlternatives(jobs, routeCalcParams.departurePos, routeCalcParams.destinationPos);
+  routeAlternatives = alternatives;
+  startRouteCalcProgress(tr("Calculating Flight Plan Alternatives ..."));
 
-      postChange(undoCommand);
-      NavApp::updateWindowTitle();
+  // Calculate all in background ================================================
+  atools::routing::RouteNetwork *radioNetwork = routeNetworkRadio;
+  routeAlternativesFuture = QtConcurrent::run([alternatives, airwayNetworks, radioNetwork]() -> void {
+    alternatives->run(airwayNetworks, radioNetwork);
+  });
 
-#ifdef DEBUG_INFORMATION
-      qDebug() << flightplan;
-#endif
+  // Watcher will call RouteController::calculateRouteAlternativesFinished() when finished
+  routeAlternativesWatcher.setFuture(routeAlternativesFuture);
+}
+
+/* Called by watcher when all alternatives are calculated. Evaluates and ranks results and lets the user select one. */
+void RouteController::calculateRouteAlternativesFinished()
+{
+  if(routeAlternatives == nullptr)
+    // Already cleaned up by cancelRouteCalculation()
+    return;
 
-      NavApp::updateErrorLabel();
+  bool canceled = routeAlternatives->isCanceled();
 
-      if(calcRange)
-      {
-        // will also update route window
-        int newToIndex = toIndex - (oldRouteSize - route.size());
-        selectRange(fromIndex, newToIndex);
-      }
+  // Hide dialog
+  routeCalcProgressTimer.stop();
+  if(routeCalcProgress != nullptr)
+    routeCalcProgress->reset();
 
-      emit routeChanged(true);
+  qDebug() << Q_FUNC_INFO << "canceled" << canceled;
+
+  if(isFlightplanChangedSinceCalculation())
+  {
+    qDebug() << Q_FUNC_INFO << "Flight plan changed while calculating";
+    NavApp::setStatusMessage(tr("Flight plan changed while calculating. Result discarded."));
+    calculateRouteCleanup();
+    return;
+  }
+
+  if(canceled)
+  {
+    NavApp::setStatusMessage(tr("Flight plan alternatives calculation canceled."));
+    calculateRouteCleanup();
+    return;
+  }
+
+  if(!routeCalcOverrideCursor)
+  {
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    routeCalcOverrideCursor = true;
+  }
+
+  // Copy results since calculation objects are deleted below
+  const QVector<ralt::Job> jobs = routeAlternatives->getJobs();
+  float cruiseAltitudeFt = routeCalcParams.altitudeFt;
+  float directDistance = routeCalcParams.departurePos.distanceMeterTo(routeCalcParams.destinationPos);
+
+  // Evaluate direct connection and all found routes with procedures and aircraft performance ================
+  QVector<ralt::Alternative> alternatives;
+  QSet<QString> keys;
+  for(int jobIndex = -1; jobIndex < jobs.size(); jobIndex++)
+  {
+    ralt::Alternative alternative;
+    alternative.jobIndex = jobIndex;
+    QVector<RouteEntry> entries;
+    bool fetchAirways = false;
+
+    if(jobIndex == -1)
+    {
+      alternative.typeText = tr("Direct");
+      alternative.altitudeFt = atools::roundToInt(cruiseAltitudeFt);
     }
     else
-      // Too long
-      found = false;
+    {
+      const ralt::Job& job = jobs.at(jobIndex);
+      if(!job.found || job.distanceMeter / directDistance >= MAX_DISTANCE_DIRECT_RATIO)
+        continue;
+
+      alternative.typeText = job.typeText;
+      alternative.altitudeFt = job.altitudeFt;
+      if(job.preference != -1)
+        alternative.preferenceText = routeCalcDialog->getPreferenceText(job.preference);
+      entries = job.entries;
+      fetchAirways = !job.radionav;
+    }
+
+    // Skip duplicates resulting from different modes or preferences
+    QString key = QString::number(alternative.altitudeFt);
+    for(const RouteEntry& entry : entries)
+      key += QString(" %1:%2:%3").arg(entry.ref.id).arg(entry.ref.objType).arg(fetchAirways ? entry.airwayId : -1);
+    if(keys.contains(key))
+      continue;
+    keys.insert(key);
+
+    Route alternativeRoute = createCalculatedRoute(entries, fetchAirways, alternative.altitudeFt);
+    alternative.distanceNm = alternativeRoute.getTotalDistance();
+    alternative.validProfile = alternativeRoute.isValidProfile();
+    alternative.travelTimeHours = alternativeRoute.getAltitudeLegs().getTravelTimeHours();
+    alternative.tripFuel = alternativeRoute.getAltitudeLegs().getTripFuel();
+    alternative.routeString = RouteStringWriter().createStringForRoute(alternativeRoute, 0.f, rs::START_AND_DEST | rs::SID_STAR);
+    alternatives.append(alternative);
   }
 
-  QGuiApplication::restoreOverrideCursor();
-  if(!found && !canceled)
-    // Use routeCalcDialog as parent to avoid main raising in front
-    atools::gui::Dialog(routeCalcDialog).showInfoMsgBox(lnm::ACTIONS_SHOW_ROUTE_ERROR,
-                                                        tr("Cannot calculate flight plan.\n\n"
-                                                           "Try another calculation type,\n"
-                                                           "change the cruise altitude or\n"
-                                                           "create the flight plan manually."),
-                                                        tr("Do not &show this dialog again."));
+  // Rank by fuel if available, then time and distance. Invalid profiles at the end sorted by distance.
+  bool fuelValid = NavApp::getAircraftPerformance().isFuelFlowValid();
+  std::stable_sort(alternatives.begin(), alternatives.end(), [fuelValid](const ralt::Alternative& alt1,
+                                                                         const ralt::Alternative& alt2) -> bool
+  {
+    if(alt1.validProfile != alt2.validProfile)
+      return alt1.validProfile > alt2.validProfile;
+    else if(alt1.validProfile)
+    {
+      // Compare exact values to keep a strict weak ordering
+      if(fuelValid && alt1.tripFuel < alt2.tripFuel)
+        return true;
+      else if(fuelValid && alt2.tripFuel < alt1.tripFuel)
+        return false;
+      else if(alt1.travelTimeHours < alt2.travelTimeHours)
+        return true;
+      else if(alt2.travelTimeHours < alt1.travelTimeHours)
+        return false;
+      else
+        return alt1.distanceNm < alt2.distanceNm;
+    }
+    else
+      return alt1.distanceNm < alt2.distanceNm;
+  });
+
+  // Restores cursor and deletes calculation
+  calculateRouteCleanup();
+
+  // Let user select ============================================================
+  RouteAlternativesDialog dialog(routeCalcDialog, alternatives, jobs.size() + 1);
+  int selected = dialog.exec() == QDialog::Accepted ? dialog.getSelectedIndex() : -1;
+
+  if(selected != -1)
+  {
+    const ralt::Alternative& alternative = alternatives.at(selected);
+    QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+    if(alternative.jobIndex == -1)
+      applyCalculatedRoute(QVector<RouteEntry>(), tr("Direct Calculation"), false, alternative.altitudeFt, -1, -1);
+    else
+    {
+      const ralt::Job& job = jobs.at(alternative.jobIndex);
+      applyCalculatedRoute(job.entries, tr("%1 Flight Plan Calculation").arg(job.typeText), !job.radionav,
+                           job.altitudeFt, -1, -1);
+    }
+    QGuiApplication::restoreOverrideCursor();
+    NavApp::setStatusMessage(tr("Calculated flight plan."));
+  }
+}
+
+void RouteController::applyCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, const QString& commandName,
+                                           bool fetchAirways, float altitudeFt, int fromIndex, int toIndex)
+{
+  bool calcRange = fromIndex != -1 && toIndex != -1;
+  int oldRouteSize = route.size();
+  Flightplan& flightplan = route.getFlightplan();
+
+  // Start undo
+  RouteCommand *undoCommand = preChange(commandName);
+  int numAlternateLegs = route.getNumAlternateLegs();
+
+  if(calcRange)
+  {
+    flightplan[toIndex].setAirway(QString());
+    flightplan[toIndex].setFlag(atools::fs::pln::entry::TRACK, false);
+    flightplan.erase(flightplan.begin() + fromIndex + 1, flightplan.begin() + toIndex);
+  }
+  else
+    // Erase all but start and destination
+    flightplan.erase(flightplan.begin() + 1, flightplan.end() - numAlternateLegs - 1);
+
+  int idx = 1;
+  // Create flight plan entries - will be copied later to the route map objects
+  for(const RouteEntry& routeEntry : calculatedRoute)
+  {
+    FlightplanEntry flightplanEntry = calculatedFlightplanEntry(routeEntry, fetchAirways);
+
+    if(calcRange)
+      flightplan.insert(flightplan.begin() + fromIndex + idx, flightplanEntry);
+    else
+      flightplan.insert(flightplan.end() - numAlternateLegs - 1, flightplanEntry);
+    idx++;
+  }
+
+  // Remove procedure points from flight plan
+  flightplan.removeProcedureEntries();
+
+  // Copy flight plan to route object
+  route.createRouteLegsFromFlightplan();
+
+  // Reload procedures from properties
+  loadProceduresFromFlightplan(true /* clearOldProcedureProperties */, false /* cleanupRoute */, false /* autoresolveTransition */);
+
+  // Remove duplicates in flight plan and route
+  route.updateAll();
+
+  // Set altitude in local units
+  flightplan.setCruiseAltitudeFt(altitudeFt);
+
+  route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+
+  updateActiveLeg();
+
+  route.updateLegAltitudes();
+
+  updateTableModel();
+  updateMoveAndDeleteActions();
+
+  postChange(undoCommand);
+  NavApp::updateWindowTitle();
+
 #ifdef DEBUG_INFORMATION
-  qDebug() << Q_FUNC_INFO << route;
+  qDebug() << flightplan;
 #endif
 
-  return found;
+  NavApp::updateErrorLabel();
+
+  if(calcRange)
+  {
+    // will also update route window
+    int newToIndex = toIndex - (oldRouteSize - route.size());
+    selectRange(fromIndex, newToIndex);
+  }
+
+  emit routeChanged(true);
+}
+
+Route RouteController::createCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, bool fetchAirways, float altitudeFt)
+{
+  // Copy keeps procedures
+  Route calcRoute(route);
+  Flightplan& flightplan = calcRoute.getFlightplan();
+  int numAlternateLegs = calcRoute.getNumAlternateLegs();
+
+  // Erase all but start and destination
+  flightplan.erase(flightplan.begin() + 1, flightplan.end() - numAlternateLegs - 1);
+
+  for(const RouteEntry& routeEntry : calculatedRoute)
+    flightplan.insert(flightplan.end() - numAlternateLegs - 1, calculatedFlightplanEntry(routeEntry, fetchAirways));
+
+  flightplan.removeProcedureEntries();
+  flightplan.setCruiseAltitudeFt(altitudeFt);
+
+  // Add procedures again from the copied procedure legs
+  calcRoute.createRouteLegsFromFlightplan();
+  calcRoute.updateProcedureLegs(entryBuilder, false /* clearOldProcedureProperties */, false /* cleanupRoute */);
+  calcRoute.updateAll();
+  calcRoute.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  calcRoute.updateLegAltitudes();
+  return calcRoute;
+}
+
+FlightplanEntry RouteController::calculatedFlightplanEntry(const RouteEntry& routeEntry, bool fetchAirways)
+{
+  FlightplanEntry flightplanEntry;
+  entryBuilder->buildFlightplanEntry(routeEntry.ref.id, atools::geo::EMPTY_POS, routeEntry.ref.objType,
+                                     flightplanEntry, fetchAirways);
+  if(fetchAirways && routeEntry.airwayId != -1)
+    // Get airway by id - needed to fetch the name first
+    updateFlightplanEntryAirway(routeEntry.airwayId, flightplanEntry);
+  return flightplanEntry;
 }
 
 void RouteController::adjustFlightplanAltitude()
@@ -2199,6 +2728,10 @@ void RouteController::reverseRoute()
 
 void RouteController::preDatabaseLoad()
 {
+  // Network and database are used by the calculation and the loader
+  cancelRouteCalculation();
+  loadRouteNetworksWait();
+
   loadingDatabaseState = true;
   routeAltDelayTimer.stop();
 
@@ -2220,8 +2753,11 @@ void RouteController::preDatabaseLoad()
 void RouteController::postDatabaseLoad()
 {
   // Clear routing caches
+  loadRouteNetworksWait();
   routeNetworkRadio->clear();
   routeNetworkAirway->clear();
+  for(atools::routing::RouteNetwork *net : routeNetworksAirwayExtra)
+    net->clear();
   clearAllErrors();
 
   Flightplan flightplan;
@@ -2255,6 +2791,9 @@ void RouteController::postDatabaseLoad()
 
   routeCalcDialog->postDatabaseLoad();
 
+  // Load networks for new database in background
+  loadRouteNetworksStart();
+
   NavApp::updateWindowTitle();
   loadingDatabaseState = false;
 }
@@ -3175,34 +3714,83 @@ void RouteController::tableSelectionChanged(const QItemSelection& selected, cons
 }
 
 /* Called by undo command */
-void RouteController::changeRouteUndo(const atools::fs::pln::Flightplan& newFlightplan)
+void RouteController::changeRouteUndo(const atools::fs::pln::Flightplan& header, int index,
+                                      const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                                      const QList<atools::fs::pln::FlightplanEntry>& entries)
 {
   // Keep our own index as a workaround
   undoIndex--;
 
   qDebug() << "changeRouteUndo undoIndex" << undoIndex << "undoIndexClean" << undoIndexClean;
-  changeRouteUndoRedo(newFlightplan);
+  if(!changeRouteUndoRedo(header, index, expectedEntries, expectedSize, entries))
+    // Plan was not changed
+    undoIndex++;
 }
 
 /* Called by undo command */
-void RouteController::changeRouteRedo(const atools::fs::pln::Flightplan& newFlightplan)
+void RouteController::changeRouteRedo(const atools::fs::pln::Flightplan& header, int index,
+                                      const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                                      const QList<atools::fs::pln::FlightplanEntry>& entries)
 {
   // Keep our own index as a workaround
   undoIndex++;
   qDebug() << "changeRouteRedo undoIndex" << undoIndex << "undoIndexClean" << undoIndexClean;
-  changeRouteUndoRedo(newFlightplan);
+  if(!changeRouteUndoRedo(header, index, expectedEntries, expectedSize, entries))
+    // Plan was not changed
+    undoIndex--;
 }
 
 /* Update window after undo or redo action */
-void RouteController::changeRouteUndoRedo(const atools::fs::pln::Flightplan& newFlightplan)
+bool RouteController::changeRouteUndoRedo(const atools::fs::pln::Flightplan& header, int index,
+                                          const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                                          const QList<atools::fs::pln::FlightplanEntry>& entries)
 {
   int currentRow = tableViewRoute->currentIndex().isValid() ? tableViewRoute->currentIndex().row() : -1;
 
+  // Get current plan without procedures like stored in the undo command and the matching legs =============
+  Flightplan current = route.getFlightplanConst();
+  current.removeProcedureEntries();
+
+  QList<RouteLeg> currentLegs;
+  for(const RouteLeg& leg : route)
+  {
+    if(!leg.isAnyProcedure())
+      currentLegs.append(leg);
+  }
+
+  // Check if the entries to replace are the same as stored in the undo command ===============
+  int numRemove = expectedEntries.size();
+  bool valid = index >= 0 && current.size() == expectedSize && index + numRemove <= current.size();
+  for(int i = 0; valid && i < numRemove; i++)
+    valid = RouteCommand::entryEqual(current.at(index + i), expectedEntries.at(i));
+
+  if(!valid)
+  {
+    // Plan was changed without undo command - applying the change would mix different plans
+    qWarning() << Q_FUNC_INFO << "Plan does not match" << index << numRemove << "expected size" << expectedSize
+               << "size" << current.size();
+
+    // Cannot delete commands while the undo stack is executing one
+    QTimer::singleShot(0, this, &RouteController::clearUndoStackInvalid);
+    return false;
+  }
+
+  // Build new plan from header and unchanged entries ===============
+  Flightplan newFlightplan(header);
+  for(int i = 0; i < index; i++)
+    newFlightplan.append(current.at(i));
+  newFlightplan.append(entries);
+  for(int i = index + numRemove; i < current.size(); i++)
+    newFlightplan.append(current.at(i));
+
   route.clearAll();
   route.setFlightplan(newFlightplan);
 
-  // Change format in plan according to last saved format
-  route.createRouteLegsFromFlightplan();
+  if(currentLegs.size() == current.size())
+    // Copy unchanged legs and load only new entries from database
+    route.createRouteLegsFromFlightplan(currentLegs, index, entries.size(), numRemove);
+  else
+    route.createRouteLegsFromFlightplan();
   loadProceduresFromFlightplan(false /* clearOldProcedureProperties */, false /* cleanupRoute */, false /* autoresolveTransition */);
   route.updateAll();
   route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
@@ -3219,6 +3807,19 @@ void RouteController::changeRouteUndoRedo(const atools::fs::pln::Flightplan& new
     model->index(currentRow, 0), QItemSelectionModel::SelectCurrent | QItemSelectionModel::Rows);
 
   emit routeChanged(true);
+  return true;
+}
+
+void RouteController::clearUndoStackInvalid()
+{
+  // Keep changed state of the plan
+  undoIndexClean = undoIndex == undoIndexClean ? 0 : -1;
+  undoIndex = 0;
+  undoStack->clear();
+
+  QMessageBox::warning(mainWindow, QApplication::applicationName(),
+                       tr("The undo history does not match the current flight plan and was cleared.\n"
+                          "The flight plan was not changed."));
 }
 
 void RouteController::styleChanged()
@@ -4167,8 +4768,14 @@ void RouteController::routeAdd(int id, atools::geo::Pos userPos, map::MapTypes t
   // This is needed since attached transitions can change procedures.
   route.reloadProcedures(procs);
 
-  route.updateAll();
-  route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  if(procs == proc::PROCEDURE_NONE)
+    // Update only inserted leg and successor if procedures are not affected
+    route.updateChangedLegs(insertIndex, insertIndex);
+  else
+  {
+    route.updateAll();
+    route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  }
   route.updateLegAltitudes();
 
   route.updateDepartureAndDestination();
@@ -4239,8 +4846,8 @@ void RouteController::routeReplace(int id, atools::geo::Pos userPos, map::MapTyp
   if(legIndex == 0)
     route.removeProcedureLegs(proc::PROCEDURE_DEPARTURE);
 
-  route.updateAll();
-  route.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+  // Falls back to full update for departure, destination and alternates
+  route.updateChangedLegs(legIndex, legIndex);
   route.updateLegAltitudes();
 
   route.updateDepartureAndDestination();
@@ -5392,6 +5999,7 @@ void RouteController::debugNetworkClick(const atools::geo::Pos& pos)
   {
     qDebug() << Q_FUNC_INFO << pos;
 
+    loadRouteNetworksWait();
     atools::routing::RouteNetworkLoader loader(NavApp::getDatabaseNav(), NavApp::getDatabaseTrack());
     if(!routeNetworkAirway->isLoaded())
       loader.load(routeNetworkAirway);
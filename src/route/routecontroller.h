@@ -22,8 +22,11 @@
 #include "routing/routenetworktypes.h"
 #include "route/route.h"
 
+#include <QFutureWatcher>
 #include <QTimer>
 
+#include <atomic>
+
 namespace atools {
 namespace routing {
 class RouteFinder;
@@ -50,6 +53,7 @@ class FlightplanEntry;
 }
 
 class QMainWindow;
+class QProgressDialog;
 class QTableView;
 class QStandardItemModel;
 class QItemSelection;
@@ -60,6 +64,8 @@ class AirwayTrackQuery;
 class UnitStringTool;
 class QTextCursor;
 class RouteCalcDialog;
+class RouteAlternatives;
+struct RouteEntry;
 class RouteLabel;
 
 /*
@@ -285,6 +291,9 @@ public:
     return tabHandlerRoute;
   }
 
+  /* Wait for background network loading before the track database is changed */
+  void preTrackLoad();
+
   /* Clear network, so it will be reloaded before next flight plan calculation. */
   void clearAirwayNetworkCache();
 
@@ -363,11 +372,16 @@ private:
   /* Saves flight plan sippet using LNM format to given name. Given range must not contains procedures or alternates. */
   bool saveFlightplanLnmSelectionAs(const QString& filename, int from, int to) const;
 
-  /* Called by route command */
-  void changeRouteUndo(const atools::fs::pln::Flightplan& newFlightplan);
+  /* Called by route command. Replaces the expected entries at index with entries and uses header for the
+   * flight plan properties. Current plan has to have expectedSize entries without procedures. */
+  void changeRouteUndo(const atools::fs::pln::Flightplan& header, int index,
+                       const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                       const QList<atools::fs::pln::FlightplanEntry>& entries);
 
   /* Called by route command */
-  void changeRouteRedo(const atools::fs::pln::Flightplan& newFlightplan);
+  void changeRouteRedo(const atools::fs::pln::Flightplan& header, int index,
+                       const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                       const QList<atools::fs::pln::FlightplanEntry>& entries);
 
   /* Save undo state before and after change */
   RouteCommand *preChange(const QString& text = QString(), rctype::RouteCmdType rcType = rctype::EDIT);
@@ -410,17 +424,67 @@ private:
 
   /* Calculate flight plan pressed in dock window */
   void calculateRoute();
-  bool calculateRouteInternal(atools::routing::RouteFinder *routeFinder,
-                              const QString& commandName,
-                              bool fetchAirways, float altitudeFt, int fromIndex, int toIndex,
-                              atools::routing::Modes mode);
+
+  /* Run route finder in a worker thread. Takes ownership of routeFinder. */
+  void calculateRouteStart(atools::routing::RouteFinder *routeFinder,
+                           const QString& commandName,
+                           bool fetchAirways, float altitudeFt, int fromIndex, int toIndex,
+                           atools::routing::Modes mode);
+
+  /* Called by watcher when the worker thread is done. Applies result to flight plan. */
+  void calculateRouteFinished();
+
+  /* Called by timer to update the progress dialog from the worker thread state */
+  void calculateRouteProgress();
+
+  /* Delete route finder, progress dialog and reset state after calculation */
+  void calculateRouteCleanup();
+
+  /* Cancel a running calculation and wait for the worker thread. Result is discarded. */
+  void cancelRouteCalculation();
+
+  /* True if a single or alternatives calculation is running */
+  bool isRouteCalculationRunning() const;
+
+  /* Start loading of all networks which are not loaded yet in a background thread using own database connections */
+  void loadRouteNetworksStart();
+
+  /* Wait for background loading. Has to be called before networks are used or cleared. */
+  void loadRouteNetworksWait();
+
+  /* True if the plan differs from the one saved in routeCalcParams */
+  bool isFlightplanChangedSinceCalculation() const;
+
+  /* Create progress dialog and start update timer for a calculation */
+  void startRouteCalcProgress(const QString& text);
+
+  /* Replace flight plan or range with calculated entries and add undo command */
+  void applyCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, const QString& commandName,
+                            bool fetchAirways, float altitudeFt, int fromIndex, int toIndex);
+
+  /* Copy of the current route with the calculated entries between departure and destination.
+   * Procedures are kept. Used to evaluate alternatives. */
+  Route createCalculatedRoute(const QVector<RouteEntry>& calculatedRoute, bool fetchAirways, float altitudeFt);
+  atools::fs::pln::FlightplanEntry calculatedFlightplanEntry(const RouteEntry& routeEntry, bool fetchAirways);
+
+  /* Alternatives button pressed in calculation dialog. Runs several calculations in background. */
+  void calculateRouteAlternatives();
+
+  /* Called by watcher when alternatives are done. Evaluates results and shows selection dialog. */
+  void calculateRouteAlternativesFinished();
 
   /* Assign type and altitude from GUI */
   void updateFlightplanFromWidgets(atools::fs::pln::Flightplan& flightplan);
   void updateFlightplanFromWidgets();
 
-  /* Used by undo/redo */
-  void changeRouteUndoRedo(const atools::fs::pln::Flightplan& newFlightplan);
+  /* Used by undo/redo. Applies the change to the current plan and resolves only new entries in the database.
+   * Returns false and clears the undo stack later if the expected entries do not match the current plan. */
+  bool changeRouteUndoRedo(const atools::fs::pln::Flightplan& header, int index,
+                           const QList<atools::fs::pln::FlightplanEntry>& expectedEntries, int expectedSize,
+                           const QList<atools::fs::pln::FlightplanEntry>& entries);
+
+  /* Clear undo stack and show a message. Called deferred from changeRouteUndoRedo(). */
+  void clearUndoStackInvalid();
 
   void tableCopyClipboard();
 
@@ -526,6 +590,51 @@ private:
   /* Network cache for flight plan calculation */
   atools::routing::RouteNetwork *routeNetworkRadio = nullptr, *routeNetworkAirway = nullptr;
 
+  /* Loads routeNetworkAirway and routeNetworkRadio in background. Networks must not be accessed while running. */
+  QFuture<void> routeNetworkLoadFuture;
+
+  /* Background flight plan calculation ================================ */
+  /* Parameters of the running calculation */
+  struct RouteCalcParams
+  {
+    QString commandName;
+    bool fetchAirways = false;
+    float altitudeFt = 0.f;
+    int fromIndex = -1, toIndex = -1;
+    atools::geo::Pos departurePos, destinationPos;
+
+    /* Plan at start to detect changes before the modal progress dialog is shown */
+    atools::fs::pln::Flightplan flightplan;
+  };
+
+  RouteCalcParams routeCalcParams;
+
+  /* Running route finder or null if no calculation is active. Uses one of the networks above. */
+  atools::routing::RouteFinder *routeCalcFinder = nullptr;
+  QFuture<bool> routeCalcFuture;
+  QFutureWatcher<bool> routeCalcWatcher;
+  QProgressDialog *routeCalcProgress = nullptr;
+  QTimer routeCalcProgressTimer;
+  bool routeCalcOverrideCursor = false;
+
+  /* Shared with worker thread */
+  std::atomic_bool routeCalcCanceled{false};
+  std::atomic_int routeCalcProgressMax{0}, routeCalcProgressValue{0};
+
+  /* Running alternatives calculation or null. Uses routeNetworkAirway, routeNetworksAirwayExtra and routeNetworkRadio. */
+  RouteAlternatives *routeAlternatives = nullptr;
+  QFuture<void> routeAlternativesFuture;
+  QFutureWatcher<void> routeAlternativesWatcher;
+
+  /* Additional airway networks allowing parallel alternatives calculation. A network can be used by one finder only. */
+  QVector<atools::routing::RouteNetwork *> routeNetworksAirwayExtra;
+
+  /* Progress dialog update interval */
+  static Q_DECL_CONSTEXPR int ROUTE_CALC_PROGRESS_MS = 100;
+
+  /* Lowest cruise altitude used for alternatives */
+  static Q_DECL_CONSTEXPR int ROUTE_ALTERNATIVES_MIN_ALT_FT = 1000;
+
   /* Flightplan and route objects */
   Route route; /* real route containing all segments */
 
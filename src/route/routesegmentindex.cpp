@@ -0,0 +1,181 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "route/routesegmentindex.h"
+
+#include "geo/calculations.h"
+#include "geo/linestring.h"
+#include "route/route.h"
+
+#include <QtMath>
+
+#include <algorithm>
+#include <functional>
+
+namespace  {
+/* Number of points to sample great circle lines */
+const int NUM_SAMPLES = 8;
+
+/* Poles are not handled by longitude interval */
+const float MAX_LAT_FOR_LON_INTERVAL = 85.f;
+
+/* Minimum margin for boxes in degree */
+const float MIN_MARGIN_DEG = 0.01f;
+
+/* Lower bound is reduced a bit to catch rounding errors and differences in earth radius */
+const float LOWER_BOUND_FACTOR = 0.99f;
+
+/* Normalize longitude difference to -180 to 180 */
+float wrapLonDiff(float diff)
+{
+  diff = std::fmod(diff + 540.f, 360.f);
+  if(diff < 0.f)
+    diff += 360.f;
+  return diff - 180.f;
+}
+
+float degToMeter(float deg)
+{
+  return atools::geo::nmToMeter(deg * 60.f) * LOWER_BOUND_FACTOR;
+}
+
+}
+
+void RouteSegmentIndex::build(const Route& route)
+{
+  segments.clear();
+  segments.resize(route.size());
+
+  for(int i = 1; i < route.size(); i++)
+  {
+    const atools::geo::Pos pos1 = route.getPrevPositionAt(i), pos2 = route.getPositionAt(i);
+    if(!pos1.isValid() || !pos2.isValid())
+    {
+      // Candidate which is always checked
+      segments[i].empty = false;
+      continue;
+    }
+
+    // Sample the great circle line since it can bulge beyond latitude of the endpoints
+    atools::geo::LineString points;
+    for(int j = 0; j <= NUM_SAMPLES; j++)
+      points.append(j == 0 ? pos1 : (j == NUM_SAMPLES ? pos2 : pos1.interpolate(pos2, static_cast<float>(j) / NUM_SAMPLES)));
+
+    // Include procedure geometry like arcs and holds
+    const RouteLeg& leg = route.value(i);
+    if(leg.isAnyProcedure())
+    {
+      for(const atools::geo::Pos& pos : leg.getGeometry())
+      {
+        if(pos.isValid())
+          points.append(pos);
+      }
+    }
+
+    // Points on the line are not farther away from the next sample than half of the sample distance
+    float marginDeg = atools::geo::meterToNm(pos1.distanceMeterTo(pos2)) / NUM_SAMPLES / 2.f / 60.f;
+    segments[i] = segment(points, std::max(marginDeg, MIN_MARGIN_DEG));
+  }
+}
+
+void RouteSegmentIndex::clear()
+{
+  segments.clear();
+}
+
+RouteSegmentIndex::Segment RouteSegmentIndex::segment(const atools::geo::LineString& points, float marginDeg)
+{
+  Segment seg;
+  seg.any = seg.empty = false;
+
+  // Unwrap longitudes relative to first point to handle the anti-meridian
+  float refLon = points.constFirst().getLonX();
+  float minLon = 0.f, maxLon = 0.f;
+  seg.north = seg.south = points.constFirst().getLatY();
+
+  for(const atools::geo::Pos& pos : points)
+  {
+    float lon = wrapLonDiff(pos.getLonX() - refLon);
+    minLon = std::min(minLon, lon);
+    maxLon = std::max(maxLon, lon);
+    seg.north = std::max(seg.north, pos.getLatY());
+    seg.south = std::min(seg.south, pos.getLatY());
+  }
+
+  seg.north += marginDeg;
+  seg.south -= marginDeg;
+
+  if(seg.north > MAX_LAT_FOR_LON_INTERVAL || seg.south < -MAX_LAT_FOR_LON_INTERVAL)
+    // Near pole - use all longitudes
+    seg.lonHalfWidth = 180.f;
+  else
+  {
+    float lonMarginDeg = marginDeg / std::cos(qDegreesToRadians(std::max(std::abs(seg.north), std::abs(seg.south))));
+    seg.lonCenter = refLon + (minLon + maxLon) / 2.f;
+    seg.lonHalfWidth = (maxLon - minLon) / 2.f + lonMarginDeg;
+  }
+  return seg;
+}
+
+void RouteSegmentIndex::candidates(QVector<std::pair<float, int> >& result, const atools::geo::Pos& pos) const
+{
+  result.clear();
+  result.reserve(segments.size());
+
+  float lat = pos.getLatY(), lon = pos.getLonX();
+
+  // sin(x) >= x * 2 / pi for 0 <= x <= pi / 2 and asin(x) >= x give a lower bound for the longitude gap
+  // without trigonometric functions per leg
+  float lonFactor = std::cos(qDegreesToRadians(lat)) * 2.f / static_cast<float>(M_PI);
+
+  for(int i = 0; i < segments.size(); i++)
+  {
+    const Segment& seg = segments.at(i);
+    if(seg.empty)
+      continue;
+
+    float bound = 0.f;
+    if(!seg.any)
+    {
+      // Distance along meridian is a lower bound for latitude gap
+      float latGap = std::max(0.f, std::max(seg.south - lat, lat - seg.north));
+
+      // Distance to nearest meridian of the box is a lower bound for longitude gap
+      float lonGap = std::abs(wrapLonDiff(lon - seg.lonCenter)) - seg.lonHalfWidth;
+      float lonBound = 0.f;
+      if(lonGap > 0.f)
+        lonBound = lonFactor * std::min(lonGap, 90.f);
+
+      bound = degToMeter(std::max(latGap, lonBound));
+    }
+    result.append(std::make_pair(bound, i));
+  }
+
+  // Linear time - most queries need only a few candidates from the top
+  std::make_heap(result.begin(), result.end(), std::greater<std::pair<float, int> >());
+}
+
+bool RouteSegmentIndex::nextCandidate(QVector<std::pair<float, int> >& heap, std::pair<float, int>& candidate)
+{
+  if(heap.isEmpty())
+    return false;
+
+  std::pop_heap(heap.begin(), heap.end(), std::greater<std::pair<float, int> >());
+  candidate = heap.constLast();
+  heap.removeLast();
+  return true;
+}
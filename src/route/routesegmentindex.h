@@ -0,0 +1,79 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ROUTESEGMENTINDEX_H
+#define LNM_ROUTESEGMENTINDEX_H
+
+#include <QVector>
+
+namespace atools {
+namespace geo {
+class Pos;
+class LineString;
+}
+}
+
+class Route;
+
+/*
+ * Spatial index for the leg lines of a flight plan used to find the nearest leg for a position.
+ *
+ * Keeps a bounding box for each leg line from previous position to leg position. Geometry of procedure legs is
+ * included. Queries calculate a cheap lower bound of the distance to each box which allows to skip the expensive
+ * cross track calculation for all legs which cannot be closer than the best one found so far.
+ * Candidates are kept in a heap and ordered only as far as the caller consumes them.
+ */
+class RouteSegmentIndex
+{
+public:
+  /* Build index for all legs of the route. Leg at index 0 has no line and is never a candidate. */
+  void build(const Route& route);
+  void clear();
+
+  /* true if index was built for a route with the given number of legs */
+  bool isValid(int routeSize) const
+  {
+    return !segments.isEmpty() && segments.size() == routeSize;
+  }
+
+  /* Get leg indexes and lower bound of distance in meter to pos as a heap. Use nextCandidate() to get them
+   * ascending by distance. */
+  void candidates(QVector<std::pair<float, int> >& result, const atools::geo::Pos& pos) const;
+
+  /* Removes the candidate with the lowest bound from a heap filled by candidates() and returns false if empty.
+   * A list sorted ascending is also a valid heap. Callers can stop once the lower bound exceeds the best distance found. */
+  static bool nextCandidate(QVector<std::pair<float, int> >& heap, std::pair<float, int>& candidate);
+
+private:
+  struct Segment
+  {
+    float north = 0.f, south = 0.f;
+    float lonCenter = 0.f, lonHalfWidth = 0.f;
+
+    /* Always a candidate if geometry is invalid */
+    bool any = true;
+
+    /* No line for first leg */
+    bool empty = true;
+  };
+
+  static Segment segment(const atools::geo::LineString& points, float marginDeg);
+
+  QVector<Segment> segments;
+};
+
+#endif // LNM_ROUTESEGMENTINDEX_H
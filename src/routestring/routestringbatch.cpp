@@ -0,0 +1,417 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "routestring/routestringbatch.h"
+
+#include "app/navapp.h"
+#include "atools.h"
+#include "exception.h"
+#include "fs/pln/flightplanio.h"
+#include "query/procedurequery.h"
+#include "route/flightplanentrybuilder.h"
+#include "route/route.h"
+#include "routestring/routestringdialog.h"
+#include "routestring/routestringreader.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QQueue>
+#include <QTextStream>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+using atools::fs::pln::Flightplan;
+using atools::fs::pln::FlightplanIO;
+
+/* Print progress to log after this number of routes */
+static const int PROGRESS_INTERVAL = 1000;
+
+/* Name of the report file in output directory */
+static const QLatin1String REPORT_FILENAME("route-string-batch-report.csv");
+
+/* Quote and escape field for CSV */
+static QString csvField(const QString& str)
+{
+  return '"' + QString(str).replace('"', "\"\"") + '"';
+}
+
+RouteStringBatch::RouteStringBatch(const QString& inputFilenameParam, const QString& outputDirParam, const QString& formatParam)
+  : inputFilename(inputFilenameParam), outputDir(outputDirParam)
+{
+  qDebug() << Q_FUNC_INFO << inputFilename << outputDir << formatParam;
+
+  format = formatFromString(formatParam);
+  entryBuilder = new FlightplanEntryBuilder();
+  reader = new RouteStringReader(entryBuilder);
+  reader->setPlaintextMessages(true);
+}
+
+RouteStringBatch::~RouteStringBatch()
+{
+  qDebug() << Q_FUNC_INFO;
+  delete reader;
+  delete entryBuilder;
+}
+
+bool RouteStringBatch::run()
+{
+  qInfo() << Q_FUNC_INFO << "Starting route description batch" << inputFilename << "to" << outputDir;
+
+  results.clear();
+
+  if(format == FORMAT_NONE)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid file format";
+    return false;
+  }
+
+  if(outputDir.isEmpty() || !QDir().mkpath(outputDir))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot create output directory" << outputDir;
+    return false;
+  }
+
+  QFile file(inputFilename);
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << inputFilename << file.errorString();
+    return false;
+  }
+
+  // Limit number of plans waiting for worker threads to keep memory usage low
+  const int maxPendingSaves = std::max(QThread::idealThreadCount(), 1) * 4;
+
+  // Index into results and future returning error message
+  QQueue<std::pair<int, QFuture<QString> > > pendingSaves;
+  auto finishSave = [this, &pendingSaves]() -> void {
+    std::pair<int, QFuture<QString> > pending = pendingSaves.dequeue();
+    QString error = pending.second.result();
+    Result& result = results[pending.first];
+    result.saved = error.isEmpty();
+    if(!result.saved)
+    {
+      result.messages.append(error);
+      qWarning().noquote().nospace() << "Route description batch line " << result.line << ": " << error;
+    }
+  };
+
+  QElapsedTimer totalTimer, resolveTimer;
+  totalTimer.start();
+  qint64 resolveMs = 0;
+
+  QTextStream stream(&file);
+  stream.setCodec("UTF-8");
+  int lineNum = 0;
+  while(!stream.atEnd())
+  {
+    QString line = stream.readLine().simplified();
+    lineNum++;
+
+    if(line.isEmpty() || line.startsWith('#'))
+      continue;
+
+    Result result;
+    result.line = lineNum;
+    result.routeString = line;
+    result.resolved = result.saved = result.warnings = false;
+
+    // Parse and resolve in this thread since the queries are not thread safe
+    resolveTimer.start();
+    Flightplan flightplan;
+    result.resolved = resolve(result, flightplan);
+    resolveMs += resolveTimer.elapsed();
+
+    if(result.resolved)
+      result.filename = buildFilename(lineNum, flightplan);
+    else
+      qWarning().noquote().nospace() << "Route description batch line " << lineNum << ": " << result.messages.join(" ");
+
+    results.append(result);
+
+    if(result.resolved)
+    {
+      // Save in worker thread - plan is copied
+      pendingSaves.enqueue(std::make_pair(results.size() - 1,
+                                          QtConcurrent::run(&RouteStringBatch::saveFlightplan, format, flightplan,
+                                                            QDir(outputDir).filePath(result.filename))));
+
+      if(pendingSaves.size() > maxPendingSaves)
+        finishSave();
+    }
+
+    if(results.size() % PROGRESS_INTERVAL == 0)
+      qInfo().noquote().nospace() << "Route description batch: " << results.size() << " routes in "
+                                  << totalTimer.elapsed() / 1000 << " s";
+  }
+  file.close();
+
+  // Wait for all remaining files
+  while(!pendingSaves.isEmpty())
+    finishSave();
+
+  printSummary(resolveMs, totalTimer.elapsed());
+  return saveReport();
+}
+
+bool RouteStringBatch::resolve(Result& result, Flightplan& flightplan)
+{
+  bool altIncluded = false;
+  bool ok = reader->createRouteFromString(result.routeString, RouteStringDialog::getOptionsFromSettings(), &flightplan,
+                                          nullptr, nullptr, &altIncluded);
+  result.messages = reader->getMessages();
+  result.warnings = reader->hasWarningMessages();
+
+  if(!ok)
+    return false;
+
+  // Build route and load procedures like RouteController::loadFlightplan() ======================
+  Route route;
+  route.setFlightplan(flightplan);
+  route.createRouteLegsFromFlightplan();
+  route.updateIndicesAndOffsets();
+
+  QStringList errors;
+  proc::MapProcedureLegs arrival, departure, star;
+  NavApp::getProcedureQuery()->getLegsForFlightplanProperties(route.getFlightplanConst().getPropertiesConst(),
+                                                              route.getDepartureAirportLeg().getAirport(),
+                                                              route.getDestinationAirportLeg().getAirport(),
+                                                              arrival, star, departure, errors, false /* autoresolveTransition */);
+  errors.removeDuplicates();
+  result.messages.append(errors);
+  result.warnings |= !errors.isEmpty();
+
+  route.setSidProcedureLegs(departure);
+  route.setStarProcedureLegs(star);
+  route.setArrivalProcedureLegs(arrival);
+  route.updateProcedureLegs(entryBuilder, false /* clearOldProcedureProperties */, false /* cleanupRoute */);
+
+  // Route descriptions do not have a type
+  if(route.hasAirways() || route.hasAnyProcedure())
+    route.getFlightplan().setFlightplanType(atools::fs::pln::IFR);
+  else
+    route.getFlightplan().setFlightplanType(atools::fs::pln::VFR);
+
+  route.updateAll();
+
+  // Calculate cruise altitude from airways and procedures if not given in description
+  route.updateAirwaysAndAltitude(!altIncluded /* adjustRouteAltitude */);
+  route.updateLegAltitudes();
+
+  // Adjust like RouteExport::buildAdjustedRoute() ======================
+  rf::RouteAdjustOptions options;
+  switch(format)
+  {
+    case FORMAT_NONE:
+    case FORMAT_LNMPLN:
+      options = rf::DEFAULT_OPTS_LNMPLN;
+      break;
+
+    case FORMAT_PLN:
+      options = rf::DEFAULT_OPTS_NO_PROC;
+      break;
+
+    case FORMAT_MSFS:
+      options = rf::DEFAULT_OPTS_MSFS | rf::REMOVE_RUNWAY_PROC;
+      break;
+
+    case FORMAT_FMS11:
+      options = rf::DEFAULT_OPTS_FMS11;
+      break;
+
+    case FORMAT_FMS3:
+      options = rf::DEFAULT_OPTS_FMS3;
+      break;
+
+    case FORMAT_FGFP:
+      options = rf::DEFAULT_OPTS;
+      break;
+  }
+
+  Route adjustedRoute = route.updatedAltitudes().adjustedToOptions(options);
+  adjustedRoute.updateAirwaysAndAltitude(false /* adjustRouteAltitude */);
+
+  flightplan = adjustedRoute.getFlightplanConst();
+  flightplan.setCruiseAltitudeFt(adjustedRoute.getCruiseAltitudeFt());
+  return true;
+}
+
+QString RouteStringBatch::saveFlightplan(RouteStringBatch::Format fileFormat, const Flightplan& flightplan, const QString& filename)
+{
+  try
+  {
+    // Separate instance for each thread
+    FlightplanIO flightplanIO;
+    switch(fileFormat)
+    {
+      case FORMAT_NONE:
+        break;
+
+      case FORMAT_LNMPLN:
+        flightplanIO.saveLnm(flightplan, filename);
+        break;
+
+      case FORMAT_PLN:
+        flightplanIO.savePln(flightplan, filename);
+        break;
+
+      case FORMAT_MSFS:
+        flightplanIO.savePlnMsfs(flightplan, filename);
+        break;
+
+      case FORMAT_FMS11:
+        flightplanIO.saveFms11(flightplan, filename);
+        break;
+
+      case FORMAT_FMS3:
+        flightplanIO.saveFms3(flightplan, filename);
+        break;
+
+      case FORMAT_FGFP:
+        flightplanIO.saveFlightGear(flightplan, filename);
+        break;
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    return tr("Error saving \"%1\": %2").arg(filename).arg(e.what());
+  }
+  catch(...)
+  {
+    return tr("Unknown error saving \"%1\".").arg(filename);
+  }
+  return QString();
+}
+
+QString RouteStringBatch::buildFilename(int line, const Flightplan& flightplan) const
+{
+  // Line number keeps names unique for repeated airport pairs
+  return QString("%1_%2_%3%4").
+         arg(line, 6, 10, QChar('0')).
+         arg(atools::cleanFilename(flightplan.getDepartureIdent())).
+         arg(atools::cleanFilename(flightplan.getDestinationIdent())).
+         arg(suffixForFormat(format));
+}
+
+RouteStringBatch::Format RouteStringBatch::formatFromString(const QString& str)
+{
+  QString fmt = str.trimmed().toLower();
+  if(fmt.isEmpty() || fmt == "lnmpln")
+    return FORMAT_LNMPLN;
+  else if(fmt == "pln")
+    return FORMAT_PLN;
+  else if(fmt == "msfs")
+    return FORMAT_MSFS;
+  else if(fmt == "fms11")
+    return FORMAT_FMS11;
+  else if(fmt == "fms3")
+    return FORMAT_FMS3;
+  else if(fmt == "fgfp")
+    return FORMAT_FGFP;
+  else
+  {
+    qWarning() << Q_FUNC_INFO << "Unknown format" << str;
+    return FORMAT_NONE;
+  }
+}
+
+QString RouteStringBatch::suffixForFormat(Format fileFormat)
+{
+  switch(fileFormat)
+  {
+    case FORMAT_NONE:
+      break;
+
+    case FORMAT_LNMPLN:
+      return ".lnmpln";
+
+    case FORMAT_PLN:
+    case FORMAT_MSFS:
+      return ".pln";
+
+    case FORMAT_FMS11:
+    case FORMAT_FMS3:
+      return ".fms";
+
+    case FORMAT_FGFP:
+      return ".fgfp";
+  }
+  return QString();
+}
+
+void RouteStringBatch::printSummary(qint64 resolveMs, qint64 totalMs) const
+{
+  int resolved = 0, saved = 0, withWarnings = 0;
+  for(const Result& result : results)
+  {
+    if(result.resolved)
+      resolved++;
+    if(result.saved)
+      saved++;
+    if(result.resolved && result.warnings)
+      withWarnings++;
+  }
+
+  qInfo().noquote().nospace() << "Route description batch: routes " << results.size()
+                              << ", resolved " << resolved << " (" << withWarnings << " with warnings)"
+                              << ", failed " << results.size() - resolved
+                              << ", saved " << saved;
+
+  qInfo().noquote().nospace() << "Route description batch: total " << QString::number(totalMs / 1000., 'f', 2) << " s"
+                              << ", resolving " << QString::number(resolveMs / 1000., 'f', 2) << " s"
+                              << ", routes per second "
+                              << QString::number(totalMs > 0 ? results.size() * 1000. / totalMs : 0., 'f', 1)
+                              << ", resolving per route "
+                              << QString::number(results.isEmpty() ? 0. : static_cast<double>(resolveMs) / results.size(), 'f', 2)
+                              << " ms";
+}
+
+bool RouteStringBatch::saveReport() const
+{
+  QString filename = QDir(outputDir).filePath(REPORT_FILENAME);
+  QFile file(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    stream.setCodec("UTF-8");
+    stream << "line,status,file,route,messages" << endl;
+
+    for(const Result& result : results)
+    {
+      QString status;
+      if(!result.resolved)
+        status = "error";
+      else if(!result.saved)
+        status = "save_error";
+      else if(result.warnings)
+        status = "warning";
+      else
+        status = "ok";
+
+      stream << result.line << ',' << status << ',' << csvField(result.filename) << ','
+             << csvField(result.routeString) << ',' << csvField(result.messages.join(" ")) << endl;
+    }
+
+    file.close();
+    qInfo() << Q_FUNC_INFO << "Saved report for" << results.size() << "routes to" << filename;
+    return true;
+  }
+  else
+    qWarning() << Q_FUNC_INFO << "Cannot open" << filename << file.errorString();
+  return false;
+}
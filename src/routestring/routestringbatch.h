@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_ROUTESTRINGBATCH_H
+#define LNM_ROUTESTRINGBATCH_H
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <QVector>
+
+namespace atools {
+namespace fs {
+namespace pln {
+class Flightplan;
+}
+}
+}
+
+class FlightplanEntryBuilder;
+class RouteStringReader;
+
+/*
+ * Converts a text file of flight plan route descriptions into flight plan files without user interaction.
+ * Each line is parsed like in the route description dialog, procedures and altitudes are resolved like when
+ * loading a flight plan and the result is saved into the output directory in the given format.
+ *
+ * Parsing and resolving is done one route after the other in the calling thread since the reader, Route and the
+ * procedure queries use the GUI query objects from NavApp. The reader and its caches are reused for all routes.
+ * Saving files is done in worker threads.
+ *
+ * Started by command line option "--route-string-batch <file>". Throughput is printed to the log and
+ * per-route errors and warnings are saved to a CSV report in the output directory.
+ */
+class RouteStringBatch
+{
+  Q_DECLARE_TR_FUNCTIONS(RouteStringBatch)
+
+public:
+  /* formatParam is one of "lnmpln", "pln", "msfs", "fms11", "fms3" or "fgfp". Empty uses "lnmpln". */
+  RouteStringBatch(const QString& inputFilenameParam, const QString& outputDirParam, const QString& formatParam);
+  ~RouteStringBatch();
+
+  RouteStringBatch(const RouteStringBatch& other) = delete;
+  RouteStringBatch& operator=(const RouteStringBatch& other) = delete;
+
+  /* Converts all route descriptions blocking, prints summary and saves the report.
+   * Returns false if input, output directory, format or report are not valid. Errors for single routes do not fail. */
+  bool run();
+
+private:
+  enum Format
+  {
+    FORMAT_NONE,
+    FORMAT_LNMPLN,
+    FORMAT_PLN,
+    FORMAT_MSFS,
+    FORMAT_FMS11,
+    FORMAT_FMS3,
+    FORMAT_FGFP
+  };
+
+  struct Result
+  {
+    int line; /* One based line number in input file */
+    QString routeString, filename;
+    QStringList messages;
+    bool resolved, saved, warnings;
+  };
+
+  /* Parse route string and build flight plan ready for saving in the given format. Fills messages in result. */
+  bool resolve(Result& result, atools::fs::pln::Flightplan& flightplan);
+
+  /* Save plan and return error message or empty string if successful. Called in worker threads. */
+  static QString saveFlightplan(RouteStringBatch::Format fileFormat, const atools::fs::pln::Flightplan& flightplan,
+                                const QString& filename);
+
+  QString buildFilename(int line, const atools::fs::pln::Flightplan& flightplan) const;
+  static Format formatFromString(const QString& str);
+  static QString suffixForFormat(Format fileFormat);
+
+  void printSummary(qint64 resolveMs, qint64 totalMs) const;
+  bool saveReport() const;
+
+  FlightplanEntryBuilder *entryBuilder = nullptr;
+  RouteStringReader *reader = nullptr;
+  QVector<Result> results;
+  QString inputFilename, outputDir;
+  Format format = FORMAT_NONE;
+};
+
+#endif // LNM_ROUTESTRINGBATCH_H
@@ -790,14 +790,9 @@ void AirportSearch::randomFlightplanClicked()
   QVector<std::pair<int, atools::geo::Pos> > *result = new QVector<std::pair<int, atools::geo::Pos> >();
   controller->getSqlModel()->getFullResultSet(*result);
 
-  const int countResult = result->size();
+  qDebug() << Q_FUNC_INFO << "random flight, count source airports: " << result->size();
 
-  qDebug() << Q_FUNC_INFO << "random flight, count source airports: " << countResult;
-
-  // above this limit do not try to find a random value beacuse this will only have few "space" to "pick" from many already picked
-  const int randomLimit = countResult / 10 * 7;
-
-  // maximum equals seconds to 100% (per attempted departure)
+  // maximum equals seconds to 100%
   progress = new QProgressDialog(tr("random picking and criteria comparison running..."),
                                  tr("Abort running"), 0, 30, NavApp::getQMainWidget());
   progress->setWindowModality(Qt::ApplicationModal);
@@ -811,10 +806,9 @@ void AirportSearch::randomFlightplanClicked()
   // Disable button to avoid multiple clicks
   ui->pushButtonAirportFlightplanSearch->setDisabled(true);
 
-  RandomDepartureAirportPickingByCriteria::initStatics(countResult, randomLimit, result,
-                                                       atools::roundToInt(distanceMinMeter),
-                                                       atools::roundToInt(distanceMaxMeter));
-  RandomDepartureAirportPickingByCriteria *departurePicker = new RandomDepartureAirportPickingByCriteria(this);
+  RandomDepartureAirportPickingByCriteria *departurePicker =
+    new RandomDepartureAirportPickingByCriteria(this, result, atools::roundToInt(distanceMinMeter),
+                                                atools::roundToInt(distanceMaxMeter));
   connect(progress, &QProgressDialog::canceled, departurePicker,
           &RandomDepartureAirportPickingByCriteria::cancellationReceived);
   connect(departurePicker, &RandomDepartureAirportPickingByCriteria::progressing, this, &AirportSearch::progressing);
@@ -15,139 +15,198 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *****************************************************************************/
 
-#include "search/randomdepartureairportpickingbycriteria.h"
-#include "search/randomdestinationairportpickingbycriteria.h"
 
-#include "search/airportsearch.h"
-#include "geo/pos.h"
+#include "search/randomdepartureairportpickingbycriteria.h"
 
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QFutureSynchronizer>
 #include <QRandomGenerator>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
-int RandomDepartureAirportPickingByCriteria::countResult = 0;
-int RandomDepartureAirportPickingByCriteria::randomLimit = 0;
-QVector<std::pair<int, atools::geo::Pos> > *RandomDepartureAirportPickingByCriteria::data = nullptr;
-int RandomDepartureAirportPickingByCriteria::distanceMin = 0;
-int RandomDepartureAirportPickingByCriteria::distanceMax = 0;
+/* Size of spatial grid cells in degrees */
+static const int GRID_CELL_SIZE_DEG = 2;
 
-RandomDepartureAirportPickingByCriteria::RandomDepartureAirportPickingByCriteria(QObject *parent) : QThread(parent)
+/* Emit progress signal every this milliseconds */
+static const int PROGRESS_INTERVAL_MS = 1000;
+
+RandomDepartureAirportPickingByCriteria::RandomDepartureAirportPickingByCriteria(QObject *parent,
+                                                                                 QVector<std::pair<int,
+                                                                                                   atools::geo::Pos> > *data,
+                                                                                 int distanceMinMeter, int distanceMaxMeter)
+  : QThread(parent), data(data), distanceMin(distanceMinMeter), distanceMax(distanceMaxMeter), nextDeparture(0), stop(false),
+  canceled(false), lastProgressMs(0)
 {
-  indexDestination = -1;
-  noSuccess = true;
 }
 
-void RandomDepartureAirportPickingByCriteria::initStatics(int countResult, int randomLimit, QVector<std::pair<int,
-                                                                                                              atools::geo::Pos> > *data,
-                                                          int distanceMinMeter, int distanceMaxMeter)
+void RandomDepartureAirportPickingByCriteria::buildGrid()
 {
-  RandomDepartureAirportPickingByCriteria::countResult = countResult;
-  RandomDepartureAirportPickingByCriteria::randomLimit = randomLimit;
-  RandomDepartureAirportPickingByCriteria::data = data;
-  RandomDepartureAirportPickingByCriteria::distanceMin = distanceMinMeter;
-  RandomDepartureAirportPickingByCriteria::distanceMax = distanceMaxMeter;
-  RandomDestinationAirportPickingByCriteria::initStatics(countResult, randomLimit, data->data(), distanceMinMeter, distanceMaxMeter);
+  const int columns = 360 / GRID_CELL_SIZE_DEG, rows = 180 / GRID_CELL_SIZE_DEG;
+
+  // Maps cell number to index in grid
+  QHash<int, int> cellIndex;
+
+  for(int i = 0; i < data->size(); i++)
+  {
+    const atools::geo::Pos& pos = data->at(i).second;
+    if(!pos.isValid())
+      continue;
+
+    departures.append(i);
+
+    int column = std::min(static_cast<int>((pos.getLonX() + 180.f) / GRID_CELL_SIZE_DEG), columns - 1);
+    int row = std::min(static_cast<int>((pos.getLatY() + 90.f) / GRID_CELL_SIZE_DEG), rows - 1);
+    int cell = row * columns + column;
+
+    int index = cellIndex.value(cell, -1);
+    if(index == -1)
+    {
+      // Create new cell
+      float west = column * GRID_CELL_SIZE_DEG - 180.f, south = row * GRID_CELL_SIZE_DEG - 90.f;
+      float east = west + GRID_CELL_SIZE_DEG, north = south + GRID_CELL_SIZE_DEG;
+
+      GridCell gridCell;
+      gridCell.center = atools::geo::Pos(west + GRID_CELL_SIZE_DEG / 2.f, south + GRID_CELL_SIZE_DEG / 2.f);
+      gridCell.radiusMeter = std::max(std::max(gridCell.center.distanceMeterTo(atools::geo::Pos(west, north)),
+                                               gridCell.center.distanceMeterTo(atools::geo::Pos(east, north))),
+                                      std::max(gridCell.center.distanceMeterTo(atools::geo::Pos(west, south)),
+                                               gridCell.center.distanceMeterTo(atools::geo::Pos(east, south))));
+      index = grid.size();
+      grid.append(gridCell);
+      cellIndex.insert(cell, index);
+    }
+    grid[index].indexes.append(i);
+  }
 }
 
 void RandomDepartureAirportPickingByCriteria::run()
 {
-  std::pair<int, atools::geo::Pos> *data = this->data->data();
+  QElapsedTimer timer;
+  timer.start();
+
+  buildGrid();
+
+  // Shuffle departures - workers pick them in this order which avoids bookkeeping of tried departures
+  QRandomGenerator *random = QRandomGenerator::global();
+  for(int i = departures.size() - 1; i > 0; i--)
+    std::swap(departures[i], departures[static_cast<int>(random->bounded(i + 1))]);
 
-  QMap<int, bool> triedIndexDeparture; // acts as a lookup which indices have been tried already; QMap keys are sorted, lookup is very fast
+  qDebug() << Q_FUNC_INFO << "grid cells" << grid.size() << "departures" << departures.size()
+           << "build" << timer.restart() << "ms";
 
-  bool departureSuccess;
+  // Start one worker per core and wait until all are done - workers emit progress
+  progressTimer.start();
+  lastProgressMs = 0;
+  QFutureSynchronizer<void> synchronizer;
+  for(int i = 0; i < std::max(QThread::idealThreadCount(), 1); i++)
+    synchronizer.addFuture(QtConcurrent::run(this, &RandomDepartureAirportPickingByCriteria::pickWorker));
+  synchronizer.waitForFinished();
 
-  int indexDeparture = 0;
+  qDebug() << Q_FUNC_INFO << "search" << timer.elapsed() << "ms" << "departures tried"
+           << std::min(static_cast<int>(nextDeparture), departures.size()) << "canceled" << canceled;
+
+  if(!canceled && resultDestination != -1)
+    emit resultReady(true, resultDeparture, resultDestination, data);
+  else
+    emit resultReady(false, -1, -1, data);
+}
 
-  runningDestinationThreads = 0;
+void RandomDepartureAirportPickingByCriteria::pickWorker()
+{
+  // Use own generator per thread to avoid locking
+  QRandomGenerator random(QRandomGenerator::global()->generate());
 
-  do
+  while(!stop)
   {
-    // split index finding into 2 approaches (if(while) rather than while(if) for performance reason)
-    if(triedIndexDeparture.count() < randomLimit)
+    int index = nextDeparture++;
+    if(index >= departures.size())
+      break; // All departures tried
+
+    int indexDeparture = departures.at(index);
+    int indexDestination = pickDestination(indexDeparture, random);
+
+    // Only one worker wins the exchange and emits the signal
+    qint64 last = lastProgressMs, now = progressTimer.elapsed();
+    if(now - last > PROGRESS_INTERVAL_MS && lastProgressMs.compare_exchange_strong(last, now))
+      emit progressing();
+
+    if(indexDestination != -1)
     {
-      // random picking
-      // on small result sets, if all are invalid value, we wouldn't switch to the incremented random approach (because the "if" is outside), but being a small result set, this approach might still try every index after some time
-      do
+      QMutexLocker locker(&resultMutex);
+      if(resultDestination == -1)
       {
-        departureSuccess = false;
-        if(triedIndexDeparture.count() == countResult)
-          break;
-        do
-        {
-          indexDeparture = QRandomGenerator::global()->bounded(countResult);
-        }while(triedIndexDeparture.contains(indexDeparture));
-        triedIndexDeparture.insert(indexDeparture, true);
-        departureSuccess = true;
-      }while(!data[indexDeparture].second.isValid());
+        resultDeparture = indexDeparture;
+        resultDestination = indexDestination;
+      }
+      stop = true;
     }
-    else
+  }
+}
+
+int RandomDepartureAirportPickingByCriteria::pickDestination(int indexDeparture, QRandomGenerator& random)
+{
+  const atools::geo::Pos& departurePos = data->at(indexDeparture).second;
+
+  // Collect cells which might contain positions within the distance range =======================
+  // Cumulated number of positions is used to pick a position randomly across all cells
+  QVector<const GridCell *> cells;
+  QVector<int> cumulated;
+  int total = 0;
+  for(const GridCell& cell : grid)
+  {
+    float distMeter = departurePos.distanceMeterTo(cell.center);
+    if(distMeter - cell.radiusMeter <= distanceMax && distMeter + cell.radiusMeter >= distanceMin)
     {
-      // random pick, then increment
-      indexDeparture = QRandomGenerator::global()->bounded(countResult);
-      do
-      {
-        departureSuccess = false;
-        if(triedIndexDeparture.count() == countResult)
-          break;
-        while(triedIndexDeparture.contains(indexDeparture))
-        {
-          indexDeparture = (indexDeparture + 1) % countResult;
-        }
-        triedIndexDeparture.insert(indexDeparture, true);
-        departureSuccess = true;
-      }while(!data[indexDeparture].second.isValid());
+      cells.append(&cell);
+      total += cell.indexes.size();
+      cumulated.append(total);
     }
+  }
+
+  // Pick positions randomly from cells and remember tried ones =======================
+  // above this limit do not try to find a random value beacuse this will only have few "space" to "pick" from many already picked
+  const int randomLimit = total / 10 * 7;
+  QBitArray tried(total);
+  int numTried = 0;
 
-    if(departureSuccess)
+  while(numTried < total && !stop)
+  {
+    int candidate = static_cast<int>(random.bounded(total));
+    if(numTried < randomLimit)
     {
-      runningDestinationThreads++;
-      RandomDestinationAirportPickingByCriteria *destinationPicker = new RandomDestinationAirportPickingByCriteria(indexDeparture);
-      connect(destinationPicker, &RandomDestinationAirportPickingByCriteria::resultReady, this,
-              &RandomDepartureAirportPickingByCriteria::dataReceived);
-      connect(destinationPicker, &RandomDestinationAirportPickingByCriteria::finished, destinationPicker, &QObject::deleteLater);
-      destinationPicker->start();
+      if(tried.testBit(candidate))
+        continue;
     }
-
-    while(noSuccess &&
-          ((runningDestinationThreads >= QThread::idealThreadCount()) ||
-           ((triedIndexDeparture.count() == countResult) && (runningDestinationThreads != 0)))) // if a CPU affinity tool is used on lnm exe, all threads created by lnm might be run on the designated core instead of being evenly distributed (at least with Process Lasso)
+    else
     {
-      emit progressing();
-      sleep(1);
+      // Increment if random pick is already tried
+      while(tried.testBit(candidate))
+        candidate = (candidate + 1) % total;
     }
 
-    if(!noSuccess || triedIndexDeparture.count() == countResult)
-      break;
-  }while(true);
+    tried.setBit(candidate);
+    numTried++;
 
-  RandomDestinationAirportPickingByCriteria::stopExecution = true;
-  while(runningDestinationThreads > 0)
-  {
-    sleep(1); // make sure all destination threads which still might use data have exited but not be a tight loop
-  }
+    // Find cell and position index for candidate
+    int cellIdx = static_cast<int>(std::upper_bound(cumulated.constBegin(), cumulated.constEnd(), candidate) - cumulated.constBegin());
+    int indexDestination = cells.at(cellIdx)->indexes.at(candidate - (cellIdx > 0 ? cumulated.at(cellIdx - 1) : 0));
 
-  if(departureSuccess && indexDestination > -1) // on cancellation departureSuccess is true and noSuccess is false but indexDestination is still -1
-  {
-    emit resultReady(true, associatedIndexDeparture, indexDestination, this->data);
-  }
-  else
-  {
-    emit resultReady(false, -1, -1, this->data);
+    if(indexDestination != indexDeparture) // destination shall != departure
+    {
+      float distMeter = departurePos.distanceMeterTo(data->at(indexDestination).second);
+      if(distMeter >= distanceMin && distMeter <= distanceMax)
+        return indexDestination;
+    }
   }
-}
 
-void RandomDepartureAirportPickingByCriteria::dataReceived(const bool isSuccess, const int indexDeparture, const int indexDestination)
-{
-  if(isSuccess)
-  {
-    noSuccess = false;
-    associatedIndexDeparture = indexDeparture;
-    this->indexDestination = indexDestination;
-  }
-  runningDestinationThreads--;
+  return -1;
 }
 
 void RandomDepartureAirportPickingByCriteria::cancellationReceived()
 {
-  noSuccess = false;
-  RandomDestinationAirportPickingByCriteria::stopExecution = true;
+  canceled = true;
+  stop = true;
 }
@@ -15,35 +15,42 @@
 * along with this program.  If not, see <http://www.gnu.org/licenses/>.
 *****************************************************************************/
 
+
 #ifndef RANDOMDEPARTUREAIRPORTPICKINGBYCRITERIA_H
 #define RANDOMDEPARTUREAIRPORTPICKINGBYCRITERIA_H
 
-#include <QObject>
+#include "geo/pos.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QThread>
 
-namespace atools {
-namespace geo {
-class Pos;
-}
-}
+#include <atomic>
 
-// should only be instantiated 1 at a time
+class QRandomGenerator;
+
+/*
+ * Picks a random departure and destination airport pair within a distance range.
+ *
+ * The thread starts one worker per core in the global thread pool. Workers take departures from a shuffled
+ * list and search destinations only in grid cells which can be within the distance range.
+ * Workers stop as soon as one pair is found or on cancellation.
+ *
+ * Should only be instantiated once at a time.
+ */
 class RandomDepartureAirportPickingByCriteria :
   public QThread
 {
   Q_OBJECT
 
 public:
-  explicit RandomDepartureAirportPickingByCriteria(QObject *parent);
-
-  // required calling !!
-  static void initStatics(int countResult, int randomLimit, QVector<std::pair<int, atools::geo::Pos> > *data, int distanceMinMeter,
-                          int distanceMaxMeter);
+  /* Data is not owned and has to be valid until resultReady() is emitted. Pair contains airport id and position. */
+  explicit RandomDepartureAirportPickingByCriteria(QObject *parent, QVector<std::pair<int, atools::geo::Pos> > *data,
+                                                   int distanceMinMeter, int distanceMaxMeter);
 
   void run() override;
 
 public slots:
-  void dataReceived(const bool isSuccess, const int indexDeparture, const int indexDestination);
   void cancellationReceived();
 
 signals:
@@ -52,15 +59,42 @@ signals:
   void progressing();
 
 private:
-  bool noSuccess;
-  int indexDestination;
-  int associatedIndexDeparture;
-  static int countResult;
-  static int randomLimit;
-  static QVector<std::pair<int, atools::geo::Pos> > *data;
-  static int distanceMin;
-  static int distanceMax;
-  int runningDestinationThreads;
+  /* Cell of the spatial grid covering airport positions */
+  struct GridCell
+  {
+    atools::geo::Pos center;
+    float radiusMeter; /* Distance from center to the farthest corner */
+    QVector<int> indexes; /* Indexes into data */
+  };
+
+  /* Builds grid from all valid positions */
+  void buildGrid();
+
+  /* Runs in thread pool. Takes departures from the shuffled list until a result is found or all are exhausted. */
+  void pickWorker();
+
+  /* Get random destination index within distance range for given departure index. -1 if nothing was found. */
+  int pickDestination(int indexDeparture, QRandomGenerator& random);
+
+  QVector<std::pair<int, atools::geo::Pos> > *data;
+  int distanceMin, distanceMax;
+
+  /* Non-empty grid cells only */
+  QVector<GridCell> grid;
+
+  /* Shuffled indexes of all valid departures and index of next departure to try */
+  QVector<int> departures;
+  std::atomic_int nextDeparture;
+
+  /* Set on success or cancellation to stop all workers */
+  std::atomic_bool stop, canceled;
+
+  /* Used by workers to emit progress signal in intervals */
+  QElapsedTimer progressTimer;
+  std::atomic<qint64> lastProgressMs;
+
+  QMutex resultMutex;
+  int resultDeparture = -1, resultDestination = -1;
 };
 
 #endif // RANDOMDEPARTUREAIRPORTPICKINGBYCRITERIA_H
@@ -27,6 +27,7 @@
 #include "perf/aircraftperfcontroller.h"
 #include "mapgui/maplayer.h"
 #include "gui/dialog.h"
+#include "geo/linestring.h"
 
 #include <QToolButton>
 #include <QMessageBox>
@@ -188,6 +189,9 @@ WindReporter::WindReporter(QObject *parent, atools::fs::FsPaths::SimulatorType t
   connect(ui->actionMapShowWindManual, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
   connect(ui->actionMapShowWindNOAA, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
   connect(ui->actionMapShowWindSimulator, &QAction::triggered, this, &WindReporter::sourceActionTriggered);
+
+  // Any change in wind data or source invalidates the cached flight plan winds
+  connect(this, &WindReporter::windUpdated, this, &WindReporter::clearRouteWindCache);
 }
 
 WindReporter::~WindReporter()
@@ -808,7 +812,9 @@ atools::grib::WindPos WindReporter::getWindForPos(const atools::geo::Pos& pos)
 
 atools::grib::Wind WindReporter::getWindForPosRoute(const atools::geo::Pos& pos)
 {
-  return currentWindQuery()->getWindForPos(pos);
+  QVector<atools::grib::Wind> winds;
+  getWindForLineStringsRoute(winds, {atools::geo::LineString({pos})});
+  return winds.constFirst();
 }
 
 atools::grib::Wind WindReporter::getWindForLineRoute(const atools::geo::Pos& pos1, const atools::geo::Pos& pos2)
@@ -823,7 +829,73 @@ atools::grib::Wind WindReporter::getWindForLineRoute(const atools::geo::Line& li
 
 atools::grib::Wind WindReporter::getWindForLineStringRoute(const atools::geo::LineString& line)
 {
-  return currentWindQuery()->getWindAverageForLineString(line);
+  QVector<atools::grib::Wind> winds;
+  getWindForLineStringsRoute(winds, {line});
+  return winds.constFirst();
+}
+
+void WindReporter::getWindForLineStringsRoute(QVector<atools::grib::Wind>& winds, const QVector<atools::geo::LineString>& lines)
+{
+  atools::grib::WindQuery *windQuery = currentWindQuery();
+  winds.clear();
+  winds.reserve(lines.size());
+
+  // Avoid unlimited growth if many plans are edited without wind updates
+  if(routeWindCache.size() > 50000)
+    routeWindCache.clear();
+
+  int hits = 0;
+  for(const atools::geo::LineString& line : lines)
+  {
+    atools::geo::LineString lineRounded(line);
+    QByteArray key = routeWindKey(lineRounded);
+
+    auto it = routeWindCache.constFind(key);
+    if(it != routeWindCache.constEnd())
+    {
+      // Geometry and altitude band already calculated
+      winds.append(it.value());
+      hits++;
+    }
+    else
+    {
+      atools::grib::Wind wind;
+      if(lineRounded.size() == 1)
+        wind = windQuery->getWindForPos(lineRounded.constFirst());
+      else if(lineRounded.size() > 1)
+        wind = windQuery->getWindAverageForLineString(lineRounded);
+
+      routeWindCache.insert(key, wind);
+      winds.append(wind);
+    }
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "lines" << lines.size() << "cache hits" << hits << "cache size" << routeWindCache.size();
+}
+
+QByteArray WindReporter::routeWindKey(atools::geo::LineString& lineRounded) const
+{
+  // Source prefix since manual and online winds can be toggled without data change
+  QByteArray key;
+  key.reserve(1 + lineRounded.size() * 3 * static_cast<int>(sizeof(float)));
+  key.append(isWindManual() ? 'm' : 'o');
+
+  for(atools::geo::Pos& pos : lineRounded)
+  {
+    // Round to altitude band which is much finer than the GRIB pressure levels
+    float alt = atools::roundToInt(pos.getAltitude() / ROUTE_WIND_ALT_BAND_FT) * static_cast<float>(ROUTE_WIND_ALT_BAND_FT);
+    pos.setAltitude(alt);
+
+    float values[3] = {pos.getLonX(), pos.getLatY(), alt};
+    key.append(reinterpret_cast<const char *>(values), sizeof(values));
+  }
+  return key;
+}
+
+void WindReporter::clearRouteWindCache()
+{
+  routeWindCache.clear();
 }
 
 atools::grib::WindPosList WindReporter::windStackForPosInternal(const atools::geo::Pos& pos, QVector<int> altitudesFt) const
@@ -917,6 +989,7 @@ void WindReporter::updateManualRouteWinds()
   windQueryManual->initFromFixedModel(perfController->getManualWindDirDeg(),
                                       perfController->getManualWindSpeedKts(),
                                       perfController->getManualWindAltFt());
+  clearRouteWindCache();
 }
 
 #ifdef DEBUG_INFORMATION
@@ -22,6 +22,7 @@
 #include "grib/windtypes.h"
 #include "query/querytypes.h"
 
+#include <QHash>
 #include <QWidgetAction>
 
 namespace windinternal {
@@ -139,6 +140,12 @@ public:
   atools::grib::Wind getWindForLineRoute(const atools::geo::Line& line);
   atools::grib::Wind getWindForLineStringRoute(const atools::geo::LineString& line);
 
+  /* Get interpolated average winds for a list of line strings in one pass. Line strings with only one position
+   * get the wind for this position. Altitudes are rounded to ROUTE_WIND_ALT_BAND_FT and results are cached by
+   * geometry and altitude band until wind data or source change. Use manual wind setting if checkbox is set.
+   * winds has the same size and order as lines. */
+  void getWindForLineStringsRoute(QVector<atools::grib::Wind>& winds, const QVector<atools::geo::LineString>& lines);
+
   /* Get a list of winds for the given position at all given altitudes. Returns only not interpolated levels.
    * Altitiude field in resulting pos contains the altitude. */
   atools::grib::WindPosList getWindStackForPos(const atools::geo::Pos& pos, const atools::grib::WindPos *additionalWind = nullptr) const;
@@ -146,6 +153,9 @@ public:
   /* Updates the query class */
   void updateManualRouteWinds();
 
+  /* Altitude band for route wind cache in feet */
+  const static int ROUTE_WIND_ALT_BAND_FT = 100;
+
   /* Update toolbar button and menu items */
   void updateToolButtonState();
 
@@ -202,6 +212,12 @@ private:
   /* Update altitude label from slider values */
   void updateSliderLabel();
 
+  /* Clear cache for flight plan winds. Called on all wind data and source changes. */
+  void clearRouteWindCache();
+
+  /* Get key for route wind cache and round altitudes in lineRounded to ROUTE_WIND_ALT_BAND_FT */
+  QByteArray routeWindKey(atools::geo::LineString& lineRounded) const;
+
   atools::grib::WindQuery *currentWindQuery() const
   {
     return isWindManual() ? windQueryManual : windQueryOnline;
@@ -239,6 +255,9 @@ private:
   query::SimpleRectCache<atools::grib::WindPos> windPosCache;
   int cachedLevel = wind::NONE;
 
+  /* Average winds for flight plan leg geometry keyed by routeWindKey(). Cleared on all wind changes.  */
+  QHash<QByteArray, atools::grib::Wind> routeWindCache;
+
   windinternal::WindSliderAction *sliderActionAltitude = nullptr;
   windinternal::WindLabelAction *labelActionWindAltitude = nullptr;
 
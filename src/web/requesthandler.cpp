@@ -26,6 +26,9 @@
 #include "info/infocontroller.h"
 #include "route/routecontroller.h"
 #include "web/webmapcontroller.h"
+#include "web/webeventstream.h"
+#include "web/websnapshot.h"
+#include "web/webresponsecache.h"
 #include "webapi/webapicontroller.h"
 #include "web/webtools.h"
 #include "web/webapp.h"
@@ -46,26 +49,19 @@
 using namespace stefanfrings;
 
 RequestHandler::RequestHandler(QObject *parent, WebMapController *webMapController,WebApiController *webApiController,
+                               WebEventStream *webEventStream, WebSnapshotPublisher *webSnapshotPublisher,
                                HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam)
-  : HttpRequestHandler(parent), webApiController(webApiController), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
+  : HttpRequestHandler(parent), webApiController(webApiController), eventStream(webEventStream),
+  snapshotPublisher(webSnapshotPublisher), htmlInfoBuilder(htmlInfoBuilderParam), verbose(verboseParam)
 {
   if(verbose)
     qDebug() << Q_FUNC_INFO;
 
   /* Fetch data through methods asynchronously to separate the call from this thread and run it in the main thread.
-   * It has to wait for the main event queue to finish the request but saves a lot of synchronization through mutexes. */
-  connect(this, &RequestHandler::getUserAircraft,
-          NavApp::getMapPaintWidgetGui(), &MapPaintWidget::getUserAircraft, Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getRoute,
-          NavApp::getRouteController(),
-          static_cast<const Route& (RouteController::*)() const>(&RouteController::getRouteConst),
-          Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getFlightplanTableAsHtml,
-          NavApp::getRouteController(), &RouteController::getFlightplanTableAsHtml, Qt::BlockingQueuedConnection);
+   * It has to wait for the main event queue to finish the request but saves a lot of synchronization through mutexes.
+   * Only used for database queries and map rendering. Route, aircraft and map position are taken from the snapshot. */
   connect(this, &RequestHandler::getAirportText,
           NavApp::getInfoController(), &InfoController::getAirportTextFull, Qt::BlockingQueuedConnection);
-  connect(this, &RequestHandler::getCurrentMapWidgetPos,
-          NavApp::getMapPaintWidgetGui(), &MapPaintWidget::getCurrentViewCenterPos, Qt::BlockingQueuedConnection);
 
   connect(this, &RequestHandler::getPixmap, webMapController, &WebMapController::getPixmap,
           Qt::BlockingQueuedConnection);
@@ -99,6 +95,10 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
     // ===========================================================================
     // Requests for map images only - either with or without session
     handleMapImage(request, response);
+  else if(path == webApiController->webApiPathPrefix + QStringLiteral(u"/sim/stream"))
+    // ===========================================================================
+    // Server-sent events for aircraft and progress - handled here since it must not block the main thread
+    handleEventStream(response);
   else if(path.startsWith(webApiController->webApiPathPrefix))
     // ===========================================================================
     // Requests for web api - either with or without session
@@ -188,10 +188,56 @@ void RequestHandler::service(HttpRequest& request, HttpResponse& response)
   } // else mapimage
 }
 
+bool RequestHandler::writeCachedResponse(HttpRequest& request, HttpResponse& response, const QByteArray& etag)
+{
+  if(WebResponseCache::matches(request.getHeader("If-None-Match"), etag))
+  {
+    // Client has the current version already
+    response.setStatus(304, "Not Modified");
+    response.setHeader("ETag", etag);
+    response.write(QByteArray(), true);
+    return true;
+  }
+
+  WebResponseCache::Response cached;
+  if(WebApp::getResponseCache()->get(etag, cached))
+  {
+    // Other client requested the same before
+    for(auto it = cached.headers.constBegin(); it != cached.headers.constEnd(); ++it)
+      response.setHeader(it.key(), it.value());
+    response.setHeader("ETag", etag);
+    response.setHeader("Cache-Control", "no-cache");
+    response.write(cached.body, true);
+    return true;
+  }
+  return false;
+}
+
+void RequestHandler::cacheResponse(HttpResponse& response, const QByteArray& etag, const QByteArray& body,
+                                   const QMultiMap<QByteArray, QByteArray>& headers)
+{
+  WebApp::getResponseCache()->insert(etag, {body, headers});
+
+  // Let the client revalidate each time using the ETag
+  response.setHeader("ETag", etag);
+  response.setHeader("Cache-Control", "no-cache");
+}
+
 inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& response)
 {
   Parameter params(request);
 
+  // Stateless requests are cached - stateful ones depend on the session
+  // Images show the user aircraft and AI - use generation which changes with simulator data
+  QByteArray etag;
+  if(!params.has("session"))
+  {
+    etag = WebApp::getResponseCache()->buildETag(request.getPath(), request.getParameterMap(),
+                                                 snapshotPublisher->getSnapshot()->generation);
+    if(writeCachedResponse(request, response, etag))
+      return;
+  }
+
   // Extract values from parameter list ===========================================
   int width = params.asInt(QStringLiteral(u"width"), 0);
   int height = params.asInt(QStringLiteral(u"height"), 0);
@@ -309,20 +355,29 @@ inline void RequestHandler::handleMapImage(HttpRequest& request, HttpResponse& r
     // Image format, jpg is default and only jpg and png allowed ===========================================
     QString format = params.asEnum(QStringLiteral(u"format"), QStringLiteral(u"jpg"), {QStringLiteral(u"jpg"), QStringLiteral(u"png")});
 
+    QByteArray contentType;
     if(format == QLatin1String("jpg"))
     {
-      response.setHeader("Content-Type", "image/jpeg");
+      contentType = "image/jpeg";
       mapPixmap.pixmap.save(&buffer, "JPG", quality);
     }
     else if(format == QLatin1String("png"))
     {
-      response.setHeader("Content-Type", "image/png");
+      contentType = "image/png";
       mapPixmap.pixmap.save(&buffer, "PNG", quality);
     }
     else
       // Should never happen
       qWarning() << Q_FUNC_INFO << "invalid format";
 
+    if(!contentType.isEmpty())
+    {
+      response.setHeader("Content-Type", contentType);
+
+      if(!etag.isEmpty())
+        cacheResponse(response, etag, bytes, {{"Content-Type", contentType}});
+    }
+
     response.write(bytes);
   }
   else
@@ -344,8 +399,29 @@ inline void RequestHandler::handleWebApiRequest(HttpRequest& request, HttpRespon
   apiRequest.parameters = request.getParameterMap();
   apiRequest.body = request.getBody();
 
-  // Call API in-sync
-  WebApiResponse result = emit serviceWebApi(apiRequest);
+  // Read-only requests are cached
+  QByteArray etag;
+  if(request.getMethod() == "GET")
+  {
+    // Responses not using simulator data stay valid while only simulator packets arrive
+    WebSnapshotPtr snapshot = snapshotPublisher->getSnapshot();
+    etag = WebApp::getResponseCache()->buildETag(request.getPath(), request.getParameterMap(),
+                                                 webApiController->isStatic(apiRequest) ?
+                                                 snapshot->staticGeneration : snapshot->generation);
+
+    // Cross-origin clients need the CORS headers also for not modified and cached responses
+    WebApiResponse commonHeaders;
+    webApiController->addCommonResponseHeaders(commonHeaders);
+    for(auto it = commonHeaders.headers.constBegin(); it != commonHeaders.headers.constEnd(); ++it)
+      response.setHeader(it.key(), it.value());
+
+    if(writeCachedResponse(request, response, etag))
+      return;
+  }
+
+  // Call API in this thread if the action uses only the snapshot - otherwise in-sync in the main thread
+  WebApiResponse result = webApiController->isThreadSafe(apiRequest) ?
+                          webApiController->service(apiRequest) : emit serviceWebApi(apiRequest);
 
   // Map API response
   response.setStatus(result.status);
@@ -353,11 +429,62 @@ inline void RequestHandler::handleWebApiRequest(HttpRequest& request, HttpRespon
   for (auto it = result.headers.constBegin(); it != result.headers.constEnd(); ++it)
       response.setHeader(it.key(),it.value());
 
+  if(!etag.isEmpty() && result.status == 200)
+    cacheResponse(response, etag, result.body, result.headers);
+
   // Write output
   response.write(result.body, true);
 }
 
 
+void RequestHandler::handleEventStream(HttpResponse& response)
+{
+  // Send comment if there was no event to keep proxies from closing the connection and to detect closed connections
+  const static unsigned long KEEPALIVE_MS = 15000;
+
+  quint64 sequence = 0L;
+  if(!eventStream->subscribe(sequence))
+  {
+    // Each stream blocks a server thread - refuse to keep threads for other requests
+    qWarning() << Q_FUNC_INFO << "Too many stream clients";
+    response.setStatus(503, "Service Unavailable");
+    response.setHeader("Content-Type", "text/plain; charset=UTF-8");
+    response.setHeader("Retry-After", "30");
+    response.write("Too many stream clients", true);
+    return;
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Client subscribed at" << sequence;
+
+  response.setHeader("Content-Type", "text/event-stream");
+  response.setHeader("Cache-Control", "no-cache");
+  response.setHeader("X-Accel-Buffering", "no");
+
+  // Send headers and tell client how long to wait before reconnecting
+  response.write("retry: 2000\n\n");
+  response.flush();
+
+  // First event sent is always a full one
+  bool full = true;
+  QByteArray event;
+  while(response.isConnected() && !eventStream->isStopped())
+  {
+    if(eventStream->waitForEvent(sequence, full, event, KEEPALIVE_MS))
+      response.write("id: " + QByteArray::number(sequence) + "\nevent: sim\ndata: " + event + "\n\n");
+    else if(!eventStream->isStopped())
+      response.write(":\n\n");
+    response.flush();
+  }
+
+  eventStream->unsubscribe();
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "Client unsubscribed";
+
+  if(response.isConnected())
+    response.write(QByteArray(), true);
+}
+
 inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResponse& response, HttpSession& session, QString& file, const QString& extension)
 {
 
@@ -404,9 +531,9 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
       // Aircraft registration, weight, etc.
       atools::util::HtmlBuilder html(mapcolors::webTableBackgroundColor, mapcolors::webTableAltBackgroundColor);
 
-      atools::fs::sc::SimConnectUserAircraft userAircraft;
-      if(t.contains(QStringLiteral(u"{aircraftProgressText}")) || t.contains(QStringLiteral(u"{aircraftText}")))
-        userAircraft = emit getUserAircraft();
+      // Keep a consistent state for the whole page
+      WebSnapshotPtr snapshot = snapshotPublisher->getSnapshot();
+      const atools::fs::sc::SimConnectUserAircraft& userAircraft = snapshot->simConnectData.getUserAircraftConst();
 
       if(t.contains(QStringLiteral(u"{aircraftText}")))
       {
@@ -420,20 +547,19 @@ inline void RequestHandler::handleHtmlFileRequest(HttpRequest& request, HttpResp
       // Aircraft progress
       if(t.contains(QStringLiteral(u"{aircraftProgressText}")))
       {
-        Route route = emit getRoute();
         html.clear();
 
         // Additional required progress fields are defined in aircraftprogressconfig.cpp in vector ADDITIONAL_WEB_IDS
-        html.setIdBits(NavApp::getInfoController()->getEnabledProgressBitsWeb());
+        html.setIdBits(snapshot->progressBitsWeb);
 
-        htmlInfoBuilder->aircraftProgressText(userAircraft, html, route);
+        htmlInfoBuilder->aircraftProgressText(userAircraft, html, *snapshot->route);
         t.setVariable(QStringLiteral(u"aircraftProgressText"), html.getHtml());
       }
 
       // ===========================================================================
       // Flight plan
       if(t.contains(QStringLiteral(u"{flightplanText}")))
-        t.setVariable(QStringLiteral(u"flightplanText"), emit getFlightplanTableAsHtml(20, false));
+        t.setVariable(QStringLiteral(u"flightplanText"), snapshot->flightplanHtml);
 
       // ===========================================================================
       // Airport information
@@ -553,7 +679,7 @@ stefanfrings::HttpSession RequestHandler::getSession(HttpRequest& request, HttpR
   else
   {
     // Session does not exist - initialize with defaults from current map view
-    atools::geo::Pos pos = emit getCurrentMapWidgetPos();
+    atools::geo::Pos pos = snapshotPublisher->getSnapshot()->mapCenterPos;
     session.set("lon", pos.getLonX());
     session.set("lat", pos.getLatY());
     session.set("requested_distance", QVariant(atools::geo::nmToKm(32.0f)));             // 32.0 is the default JS delivers from new web ui HTML default
@@ -39,6 +39,8 @@ class HttpSession;
 }
 
 class HtmlInfoBuilder;
+class WebEventStream;
+class WebSnapshotPublisher;
 
 /*
  * Handles all HTTP server requests including stateless and stateful. Maintains a session for the stateful page.
@@ -55,6 +57,7 @@ class RequestHandler :
 public:
   /* Prepare connections to other objects. Handler is ready to accept connections when instantiated. */
   RequestHandler(QObject *parent, WebMapController *webMapController, WebApiController *webApiController,
+                 WebEventStream *webEventStream, WebSnapshotPublisher *webSnapshotPublisher,
                  HtmlInfoBuilder *htmlInfoBuilderParam, bool verboseParam);
   virtual ~RequestHandler() override;
 
@@ -70,13 +73,9 @@ signals:
   MapPixmap getPixmapPosDistance(int width, int height, atools::geo::Pos pos, float distanceKm, const QString& mapCommand, const QString& errorCase = QLatin1String(""));
   MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, const QString& errorCase = tr("Invalid rectangle"));
 
-  atools::fs::sc::SimConnectUserAircraft getUserAircraft();
-  Route getRoute();
-  QString getFlightplanTableAsHtml(int iconSize, bool print);
   QStringList getAirportText(QString ident);
-  atools::geo::Pos getCurrentMapWidgetPos();
 
-  /* Calls to WebApiController */
+  /* Calls to WebApiController for actions which need the main thread */
   WebApiResponse serviceWebApi(WebApiRequest& request);
 
 private:
@@ -90,12 +89,25 @@ private:
   /* Show error using a JPG image for image requests and return set it into the response. */
   void showErrorPixmap(stefanfrings::HttpResponse& response, int width, int height, int status, const QString& text);
 
+  /* Reply with 304 if the client already has the response for the ETag or write the cached response.
+   * Returns false if the response has to be built. */
+  bool writeCachedResponse(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response,
+                           const QByteArray& etag);
+
+  /* Add response to cache and set ETag header */
+  void cacheResponse(stefanfrings::HttpResponse& response, const QByteArray& etag, const QByteArray& body,
+                     const QMultiMap<QByteArray, QByteArray>& headers);
+
   /* Handle stateful and stateless map image requests. */
   void handleMapImage(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
   /* Handle stateful and stateless api requests. */
   void handleWebApiRequest(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
+  /* Keep the connection open and push aircraft and progress events as server-sent events until the client
+   * disconnects or the server stops. Does not use the main thread. */
+  void handleEventStream(stefanfrings::HttpResponse& response);
+
   /* Handle html file requests. */
   void handleHtmlFileRequest(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response, stefanfrings::HttpSession& session, QString& file, const QString& extension);
 
@@ -106,6 +118,10 @@ private:
   stefanfrings::HttpSession getSession(stefanfrings::HttpRequest& request, stefanfrings::HttpResponse& response);
 
   WebApiController *webApiController;
+  WebEventStream *eventStream;
+
+  /* Route, aircraft and other state. Read without calling into the main thread. */
+  WebSnapshotPublisher *snapshotPublisher;
   HtmlInfoBuilder *htmlInfoBuilder;
 
   bool verbose = false;
@@ -22,14 +22,17 @@
 #include "httpserver/httpsessionstore.h"
 #include "templateengine/templatecache.h"
 #include "httpserver/staticfilecontroller.h"
+#include "web/webresponsecache.h"
 
 stefanfrings::TemplateCache *WebApp::templateCache = nullptr;
 stefanfrings::HttpSessionStore *WebApp::sessionStore = nullptr;
 stefanfrings::StaticFileController *WebApp::staticFileController = nullptr;
+WebResponseCache *WebApp::responseCache = nullptr;
 
 atools::io::IniKeyValues WebApp::templateCacheSettings;
 atools::io::IniKeyValues WebApp::sessionSettings;
 atools::io::IniKeyValues WebApp::staticFileControllerSettings;
+atools::io::IniKeyValues WebApp::responseCacheSettings;
 
 QString WebApp::documentRoot;
 QString WebApp::htmlExtension = ".html";
@@ -63,9 +66,18 @@ void WebApp::init(QObject *parent, const QString& configFileName, const QString&
     staticFileControllerSettings.insert("path", docrootParam);
   staticFileControllerSettings.insert("filename", configFileName);
   staticFileController = new stefanfrings::StaticFileController(staticFileControllerSettings, parent);
+
+  // Configure cache for rendered responses
+  responseCacheSettings = reader.getKeyValuePairs("responses");
+  responseCache = new WebResponseCache(responseCacheSettings.value("cacheSize", 33554432).toInt(),
+                                       responseCacheSettings.value("maxAge", 60000).toInt(),
+                                       false /* verbose */);
 }
 
 void WebApp::deinit()
 {
   qDebug() << Q_FUNC_INFO;
+
+  delete responseCache;
+  responseCache = nullptr;
 }
@@ -30,6 +30,7 @@ class StaticFileController;
 class QSettings;
 class QString;
 class QObject;
+class WebResponseCache;
 
 /*
  * Keeps global settings and caches for listener and file controllers and handlers.
@@ -59,6 +60,11 @@ public:
     return staticFileController;
   }
 
+  static WebResponseCache *getResponseCache()
+  {
+    return responseCache;
+  }
+
   static const QString& getDocroot()
   {
     return documentRoot;
@@ -83,7 +89,11 @@ private:
   /* Controller for static files */
   static stefanfrings::StaticFileController *staticFileController;
 
-  static atools::io::IniKeyValues templateCacheSettings, sessionSettings, staticFileControllerSettings;
+  /* Rendered map images and web API responses */
+  static WebResponseCache *responseCache;
+
+  static atools::io::IniKeyValues templateCacheSettings, sessionSettings, staticFileControllerSettings,
+                                  responseCacheSettings;
 
   static QString documentRoot, htmlExtension;
 };
@@ -20,6 +20,7 @@
 #include "settings/settings.h"
 #include "web/requesthandler.h"
 #include "web/webmapcontroller.h"
+#include "web/webeventstream.h"
 #include "webapi/webapicontroller.h"
 #include "web/webapp.h"
 #include "gui/helphandler.h"
@@ -62,7 +63,10 @@ WebController::WebController(QWidget *parent) :
   sslCertFile = listenerSettings.value("sslCertFile").toString();
 
   mapController = new WebMapController(parentWidget, verbose);
+  connect(mapController, &WebMapController::webMapChanged, this, &WebController::webMapChanged);
   apiController = new WebApiController(parentWidget, verbose);
+  eventStream = new WebEventStream(verbose);
+  snapshotPublisher = new WebSnapshotPublisher(verbose);
 
   htmlInfoBuilder = new HtmlInfoBuilder(parent, mapController->getMapPaintWidget(), true /*info*/, true /*print*/);
   updateSettings();
@@ -76,6 +80,8 @@ WebController::~WebController()
 
   delete mapController;
   delete apiController;
+  delete eventStream;
+  delete snapshotPublisher;
   delete htmlInfoBuilder;
 }
 
@@ -105,7 +111,10 @@ void WebController::startServer()
   // Start map
   mapController->init();
 
-  requestHandler = new RequestHandler(this, mapController, apiController, htmlInfoBuilder, verbose);
+  eventStream->start();
+  snapshotPublisher->publishAll();
+  requestHandler = new RequestHandler(this, mapController, apiController, eventStream, snapshotPublisher, htmlInfoBuilder,
+                                      verbose);
 
   // Set port - always override configuration file
   listenerSettings.insert("port", port);
@@ -216,6 +225,9 @@ void WebController::stopServer()
 
   mapController->deInit();
 
+  // Let all stream clients return from their request handlers to allow the listener to stop the threads
+  eventStream->stop();
+
   if(listener != nullptr)
     listener->close();
 
@@ -347,4 +359,52 @@ void WebController::preDatabaseLoad()
 void WebController::postDatabaseLoad()
 {
   mapController->postDatabaseLoad();
+  stateChanged();
+}
+
+void WebController::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
+{
+  if(isRunning())
+  {
+    snapshotPublisher->simDataChanged(simulatorData);
+    eventStream->simDataChanged(simulatorData);
+  }
+}
+
+void WebController::disconnectedFromSimulator()
+{
+  if(isRunning())
+  {
+    snapshotPublisher->publishAll();
+    eventStream->disconnectedFromSimulator();
+  }
+}
+
+void WebController::routeChanged()
+{
+  if(isRunning())
+    snapshotPublisher->routeChanged();
+}
+
+void WebController::mapViewChanged()
+{
+  if(isRunning())
+    snapshotPublisher->mapViewChanged();
+}
+
+void WebController::webMapChanged()
+{
+  if(isRunning())
+    snapshotPublisher->webMapChanged();
+}
+
+void WebController::stateChanged()
+{
+  if(isRunning())
+    snapshotPublisher->stateChanged();
+}
+
+WebSnapshotPtr WebController::getSnapshot() const
+{
+  return snapshotPublisher->getSnapshot();
 }
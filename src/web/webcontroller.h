@@ -19,6 +19,7 @@
 #define LNM_WEBCONTROLLER_H
 
 #include "io/inireader.h"
+#include "web/websnapshot.h"
 
 #include <QObject>
 #include <QUrl>
@@ -31,6 +32,7 @@ class HttpListener;
 class RequestHandler;
 class WebMapController;
 class WebApiController;
+class WebEventStream;
 class HtmlInfoBuilder;
 class QSettings;
 
@@ -120,6 +122,23 @@ public:
   /* Initialize queries again after a database change */
   void postDatabaseLoad();
 
+  /* Update the aircraft and progress event stream and the snapshot */
+  void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
+  void disconnectedFromSimulator();
+
+  /* Update snapshot after flight plan or map view changes */
+  void routeChanged();
+  void mapViewChanged();
+
+  /* Primary web map was rendered and might have changed zoom */
+  void webMapChanged();
+
+  /* Invalidate cached responses after options or style changes */
+  void stateChanged();
+
+  /* Thread safe. Copy of program state for request handlers running in server threads. */
+  WebSnapshotPtr getSnapshot() const;
+
 signals:
   /* Send after server is started or before server is shutdown */
   void webserverStatusChanged(bool running);
@@ -133,6 +152,12 @@ private:
   /* Web API controller */
   WebApiController *apiController = nullptr;
 
+  /* Pushes aircraft and progress state to subscribed clients */
+  WebEventStream *eventStream = nullptr;
+
+  /* State for request handlers which allows to answer requests without calling into the main thread */
+  WebSnapshotPublisher *snapshotPublisher = nullptr;
+
   /* Handles all HTTP requests using templates or static */
   RequestHandler *requestHandler = nullptr;
 
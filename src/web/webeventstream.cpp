@@ -0,0 +1,262 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webeventstream.h"
+
+#include "app/navapp.h"
+#include "common/constants.h"
+#include "common/mapflags.h"
+#include "fs/sc/simconnectdata.h"
+#include "geo/calculations.h"
+#include "route/route.h"
+#include "settings/settings.h"
+
+#include <QDebug>
+
+using atools::fs::sc::SimConnectData;
+using atools::fs::sc::SimConnectUserAircraft;
+
+namespace  {
+
+/* Format number with fixed precision or null if invalid */
+QByteArray number(float value, int precision)
+{
+  if(value >= map::INVALID_DISTANCE_VALUE)
+    return QByteArrayLiteral("null");
+  else
+    return QByteArray::number(value, 'f', precision);
+}
+
+/* Quote string. Only idents are used which do not need more escaping. */
+QByteArray string(const QString& value)
+{
+  QByteArray retval = value.toUtf8();
+  retval.replace('\\', "\\\\").replace('"', "\\\"");
+  return '"' + retval + '"';
+}
+
+}
+
+WebEventStream::WebEventStream(bool verboseParam)
+  : verbose(verboseParam)
+{
+  updateIntervalMs = std::max(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_WEBSERVER_STREAM_INTERVAL,
+                                                                                      500).toInt(), 50);
+
+  // Server has 32 threads by default - leave most of them for other requests
+  maxSubscribers = std::max(atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_WEBSERVER_STREAM_MAX_CLIENTS,
+                                                                                     8).toInt(), 1);
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "updateIntervalMs" << updateIntervalMs << "maxSubscribers" << maxSubscribers;
+
+  // Start with inactive state for clients subscribing before the first packet
+  publish(nullptr, true /* force */);
+}
+
+WebEventStream::~WebEventStream()
+{
+  stop();
+}
+
+void WebEventStream::simDataChanged(const SimConnectData& simulatorData)
+{
+  if(subscribers.loadAcquire() == 0)
+  {
+    // Nobody listening - next event will be a full one
+    lastValues.clear();
+    return;
+  }
+
+  // New clients should not wait for the interval
+  bool force = eventRequested.fetchAndStoreOrdered(0) != 0;
+
+  if(!force && updateTimer.isValid() && updateTimer.elapsed() < updateIntervalMs)
+    return;
+
+  updateTimer.start();
+  publish(&simulatorData, force);
+}
+
+void WebEventStream::disconnectedFromSimulator()
+{
+  // Publish even if nobody is listening to replace the last active state for clients subscribing later
+  publish(nullptr, false /* force */);
+}
+
+bool WebEventStream::subscribe(quint64& sequence)
+{
+  int current = subscribers.loadAcquire();
+  do
+  {
+    if(current >= maxSubscribers)
+      return false;
+  } while(!subscribers.testAndSetOrdered(current, current + 1, current));
+
+  // Start at the current event and let the main thread build a new one since the stored one might be outdated
+  {
+    QMutexLocker locker(&mutex);
+    sequence = currentSequence;
+  }
+  eventRequested.storeRelease(1);
+  return true;
+}
+
+void WebEventStream::unsubscribe()
+{
+  subscribers.deref();
+}
+
+bool WebEventStream::waitForEvent(quint64& sequence, bool& full, QByteArray& event, unsigned long timeoutMs)
+{
+  QMutexLocker locker(&mutex);
+
+  // Inactive state does not change and is not sent again - give it to new clients right away
+  if(!stopped && currentSequence <= sequence && !(full && !fullEventActive))
+    eventCondition.wait(&mutex, timeoutMs);
+
+  if(stopped || (currentSequence <= sequence && !(full && !fullEventActive)))
+    // Timeout, spurious wakeup or stopped
+    return false;
+
+  // Client got the previous event - delta is sufficient
+  event = !full && sequence + 1 == currentSequence ? deltaEvent : fullEvent;
+  sequence = currentSequence;
+  full = false;
+  return true;
+}
+
+void WebEventStream::stop()
+{
+  QMutexLocker locker(&mutex);
+  stopped = true;
+  eventCondition.wakeAll();
+}
+
+void WebEventStream::start()
+{
+  QMutexLocker locker(&mutex);
+  stopped = false;
+}
+
+bool WebEventStream::isStopped() const
+{
+  QMutexLocker locker(&mutex);
+  return stopped;
+}
+
+void WebEventStream::publish(const SimConnectData *simulatorData, bool force)
+{
+  ValueVector values;
+  fillValues(values, simulatorData);
+
+  // Same set of keys in the same order allows to send only changed values
+  bool sameKeys = values.size() == lastValues.size();
+  for(int i = 0; i < values.size() && sameKeys; i++)
+    sameKeys = qstrcmp(values.at(i).first, lastValues.at(i).first) == 0;
+
+  ValueVector delta;
+  if(sameKeys)
+  {
+    for(int i = 0; i < values.size(); i++)
+    {
+      if(values.at(i).second != lastValues.at(i).second)
+        delta.append(values.at(i));
+    }
+
+    if(delta.isEmpty() && !force)
+      // Nothing changed - no need to wake up clients
+      return;
+  }
+
+  // Sequence is only changed in this thread
+  quint64 sequence = currentSequence + 1;
+  QByteArray full = toJson(values, sequence, true);
+  QByteArray deltaJson = sameKeys ? toJson(delta, sequence, false) : full;
+  lastValues = values;
+
+  QMutexLocker locker(&mutex);
+  currentSequence = sequence;
+  fullEvent = full;
+  deltaEvent = deltaJson;
+  fullEventActive = values.constFirst().second == "true";
+  eventCondition.wakeAll();
+}
+
+void WebEventStream::fillValues(ValueVector& values, const SimConnectData *simulatorData) const
+{
+  if(simulatorData == nullptr || simulatorData->isEmptyReply() || !simulatorData->isUserAircraftValid())
+  {
+    values.append(std::make_pair("active", QByteArrayLiteral("false")));
+    return;
+  }
+
+  // Aircraft ==================================================================
+  // Same names and units as for the sim/info web API action
+  const SimConnectUserAircraft& aircraft = simulatorData->getUserAircraft();
+  values.append(std::make_pair("active", QByteArrayLiteral("true")));
+  values.append(std::make_pair("lat", number(aircraft.getPosition().getLatY(), 5)));
+  values.append(std::make_pair("lon", number(aircraft.getPosition().getLonX(), 5)));
+  values.append(std::make_pair("indicated_speed", number(aircraft.getIndicatedSpeedKts(), 0)));
+  values.append(std::make_pair("true_airspeed", number(aircraft.getTrueAirspeedKts(), 0)));
+  values.append(std::make_pair("ground_speed", number(aircraft.getGroundSpeedKts(), 0)));
+  values.append(std::make_pair("vertical_speed", number(aircraft.getVerticalSpeedFeetPerMin(), 0)));
+  values.append(std::make_pair("indicated_altitude", number(aircraft.getIndicatedAltitudeFt(), 0)));
+  values.append(std::make_pair("altitude_above_ground", number(aircraft.getAltitudeAboveGroundFt(), 0)));
+  values.append(std::make_pair("heading", number(aircraft.getHeadingDegMag(), 0)));
+  values.append(std::make_pair("track", number(aircraft.getTrackDegTrue(), 0)));
+  values.append(std::make_pair("wind_direction",
+                               number(atools::geo::normalizeCourse(aircraft.getWindDirectionDegT() - aircraft.getMagVarDeg()), 0)));
+  values.append(std::make_pair("wind_speed", number(aircraft.getWindSpeedKts(), 0)));
+  values.append(std::make_pair("fuel_total_weight", number(aircraft.getFuelTotalWeightLbs(), 0)));
+  values.append(std::make_pair("fuel_flow", number(aircraft.getFuelFlowPPH(), 0)));
+  values.append(std::make_pair("on_ground", aircraft.isOnGround() ? QByteArrayLiteral("true") : QByteArrayLiteral("false")));
+
+  // Flight plan progress ==================================================================
+  // Route controller got the packet first and already updated the active leg
+  const Route& route = NavApp::getRouteConst();
+  int activeLegIdx = route.getActiveLegIndexCorrected();
+  float distFromStartNm = 0.f, distToDestNm = 0.f, nextLegDistance = 0.f, crossTrackDistance = 0.f;
+
+  if(activeLegIdx != map::INVALID_INDEX_VALUE &&
+     route.getRouteDistances(&distFromStartNm, &distToDestNm, &nextLegDistance, &crossTrackDistance))
+  {
+    if(route.isActiveAlternate())
+      // Use distance to alternate instead of destination
+      distToDestNm = nextLegDistance;
+
+    float distanceToTod = distFromStartNm < map::INVALID_DISTANCE_VALUE ?
+                          route.getTopOfDescentDistance() - distFromStartNm : map::INVALID_DISTANCE_VALUE;
+
+    values.append(std::make_pair("active_leg_index", QByteArray::number(activeLegIdx)));
+    values.append(std::make_pair("next_waypoint", string(route.value(activeLegIdx).getIdent())));
+    values.append(std::make_pair("distance_to_next", number(nextLegDistance, 1)));
+    values.append(std::make_pair("distance_to_destination", number(distToDestNm, 1)));
+    values.append(std::make_pair("distance_to_tod", number(distanceToTod, 1)));
+    values.append(std::make_pair("cross_track_distance", number(crossTrackDistance, 2)));
+  }
+}
+
+QByteArray WebEventStream::toJson(const ValueVector& values, quint64 sequence, bool full)
+{
+  QByteArray json;
+  json.reserve(64 + values.size() * 32);
+  json.append("{\"seq\":").append(QByteArray::number(sequence)).append(",\"full\":").append(full ? "true" : "false");
+  for(const std::pair<const char *, QByteArray>& value : values)
+    json.append(",\"").append(value.first).append("\":").append(value.second);
+  json.append('}');
+  return json;
+}
@@ -0,0 +1,115 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBEVENTSTREAM_H
+#define LNM_WEBEVENTSTREAM_H
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+
+namespace atools {
+namespace fs {
+namespace sc {
+class SimConnectData;
+}
+}
+}
+
+/*
+ * Builds a compact JSON state of the user aircraft and flight plan progress once per simulator packet and
+ * hands it out to all web clients subscribed to the server-sent events stream.
+ *
+ * The state is a flat JSON object. Clients which received the previous event get only the changed values
+ * ("full":false). New or lagging clients get all values ("full":true).
+ *
+ * Each stream occupies one HTTP server thread for its whole lifetime. The number of streams is therefore limited
+ * to leave threads for the other requests.
+ *
+ * simDataChanged() is called in the main thread. waitForEvent() is called from the HTTP server threads
+ * and blocks until a new event is available. Only the shared event buffers are protected by the mutex.
+ */
+class WebEventStream
+{
+public:
+  explicit WebEventStream(bool verboseParam);
+  ~WebEventStream();
+
+  WebEventStream(const WebEventStream& other) = delete;
+  WebEventStream& operator=(const WebEventStream& other) = delete;
+
+  /* Build a new event if the update interval has passed and clients are subscribed. Main thread only. */
+  void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
+
+  /* Send inactive state to all clients and keep it for clients subscribing later. Main thread only. */
+  void disconnectedFromSimulator();
+
+  /* Register a client and set the current sequence number to pass to waitForEvent().
+   * The next event is built from the next simulator packet without waiting for the update interval.
+   * Returns false if the maximum number of clients is reached. */
+  bool subscribe(quint64& sequence);
+  void unsubscribe();
+
+  /* Wait until an event newer than sequence is available and copy it to event. Updates sequence.
+   * Sends all values if full is true and resets full then. A stored inactive state is sent immediately if full is set.
+   * Returns false on timeout or if the stream was stopped. Called from HTTP server threads. */
+  bool waitForEvent(quint64& sequence, bool& full, QByteArray& event, unsigned long timeoutMs);
+
+  /* Wake up all waiting clients and let them return. Needed before the server can shut down. */
+  void stop();
+
+  /* Allow clients to wait again after a stop() */
+  void start();
+
+  bool isStopped() const;
+
+private:
+  /* Build value list and publish it as full and delta event. Publishes even if nothing changed if force is true. */
+  void publish(const atools::fs::sc::SimConnectData *simulatorData, bool force);
+
+  /* Flat list of key and formatted value. Values are formatted with limited precision to avoid sending jitter. */
+  typedef QVector<std::pair<const char *, QByteArray> > ValueVector;
+
+  void fillValues(ValueVector& values, const atools::fs::sc::SimConnectData *simulatorData) const;
+  static QByteArray toJson(const ValueVector& values, quint64 sequence, bool full);
+
+  /* Last published values to build the delta - main thread only */
+  ValueVector lastValues;
+  QElapsedTimer updateTimer;
+  int updateIntervalMs = 500;
+
+  /* Shared between threads - protected by mutex */
+  quint64 currentSequence = 0L;
+  QByteArray fullEvent, deltaEvent;
+  bool fullEventActive = false; /* false if the last event is the inactive state */
+  bool stopped = false;
+  mutable QMutex mutex;
+  QWaitCondition eventCondition;
+
+  /* Nothing is built if nobody is listening */
+  QAtomicInt subscribers;
+  int maxSubscribers = 8;
+
+  /* Set by new subscribers to get a new event with the next packet */
+  QAtomicInt eventRequested;
+
+  bool verbose = false;
+};
+
+#endif // LNM_WEBEVENTSTREAM_H
@@ -0,0 +1,130 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#include "web/webfeaturequery.h"
+
+#include "common/maptypes.h"
+#include "mapgui/maplayer.h"
+#include "mapgui/maplayersettings.h"
+#include "query/mapquery.h"
+#include "query/waypointquery.h"
+#include "query/waypointtrackquery.h"
+
+#include <QDebug>
+
+WebFeatureQuery::WebFeatureQuery(atools::sql::SqlDatabase *sqlDbSim, atools::sql::SqlDatabase *sqlDbNav,
+                                 atools::sql::SqlDatabase *sqlDbUser, atools::sql::SqlDatabase *sqlDbTrack, bool verboseParam)
+  : verbose(verboseParam)
+{
+  qDebug() << Q_FUNC_INFO;
+
+  // Own layer settings independent of any map widget
+  layers = new MapLayerSettings(verbose);
+  layers->loadFromFile();
+
+  mapQuery = new MapQuery(sqlDbSim, sqlDbNav, sqlDbUser);
+  waypointTrackQuery = new WaypointTrackQuery(new WaypointQuery(sqlDbNav, false), new WaypointQuery(sqlDbTrack, true));
+
+  mapQuery->initQueries();
+  waypointTrackQuery->initQueries();
+}
+
+WebFeatureQuery::~WebFeatureQuery()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  QMutexLocker locker(&mutex);
+  waypointTrackQuery->deleteChildren();
+  delete waypointTrackQuery;
+  delete mapQuery;
+  delete layers;
+}
+
+bool WebFeatureQuery::getFeatures(const atools::geo::Rect& rect, float distanceKm, int detailLevel,
+                                  QList<map::MapAirport>& airports, QList<map::MapNdb>& ndbs, QList<map::MapVor>& vors,
+                                  QList<map::MapMarker>& markers, QList<map::MapWaypoint>& waypoints)
+{
+  QMutexLocker locker(&mutex);
+
+  if(databaseLoading || !rect.isValid())
+    return false;
+
+  const MapLayer *mapLayer = layers->getLayer(distanceKm, detailLevel);
+  if(mapLayer == nullptr)
+    return false;
+
+  bool overflow = false;
+
+  // Tile caches return all objects of the covering tiles - remove all outside of the requested rectangle
+  // Query airports only if the layer shows airports like the map painter. Include add-on airports.
+  if(mapLayer->isAirport())
+  {
+    for(const map::MapAirport& airport : *mapQuery->getAirportsByRect(rect, mapLayer, false, map::AIRPORT_ALL_AND_ADDON, overflow))
+    {
+      if(rect.contains(airport.position))
+        airports.append(airport);
+    }
+  }
+
+  for(const map::MapNdb& ndb : *mapQuery->getNdbsByRect(rect, mapLayer, false, overflow))
+  {
+    if(rect.contains(ndb.position))
+      ndbs.append(ndb);
+  }
+
+  for(const map::MapVor& vor : *mapQuery->getVorsByRect(rect, mapLayer, false, overflow))
+  {
+    if(rect.contains(vor.position))
+      vors.append(vor);
+  }
+
+  for(const map::MapMarker& marker : *mapQuery->getMarkersByRect(rect, mapLayer, false, overflow))
+  {
+    if(rect.contains(marker.position))
+      markers.append(marker);
+  }
+
+  for(const map::MapWaypoint& waypoint : waypointTrackQuery->getWaypointsByRect(rect, mapLayer, false, overflow))
+  {
+    if(rect.contains(waypoint.position))
+      waypoints.append(waypoint);
+  }
+
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "airports" << airports.size() << "ndbs" << ndbs.size() << "vors" << vors.size()
+             << "markers" << markers.size() << "waypoints" << waypoints.size() << "overflow" << overflow;
+
+  return true;
+}
+
+void WebFeatureQuery::preDatabaseLoad()
+{
+  // Wait for running requests
+  QMutexLocker locker(&mutex);
+  databaseLoading = true;
+  mapQuery->deInitQueries();
+  waypointTrackQuery->deInitQueries();
+}
+
+void WebFeatureQuery::postDatabaseLoad()
+{
+  QMutexLocker locker(&mutex);
+  waypointTrackQuery->initQueries();
+  mapQuery->initQueries();
+  databaseLoading = false;
+}
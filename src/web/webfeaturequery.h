@@ -0,0 +1,88 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+
+#ifndef LNM_WEBFEATUREQUERY_H
+#define LNM_WEBFEATUREQUERY_H
+
+#include "common/mapflags.h"
+
+#include <QList>
+#include <QMutex>
+
+namespace atools {
+namespace geo {
+class Rect;
+}
+namespace sql {
+class SqlDatabase;
+}
+}
+
+namespace map {
+struct MapAirport;
+struct MapNdb;
+struct MapVor;
+struct MapMarker;
+struct MapWaypoint;
+}
+
+class MapLayerSettings;
+class MapQuery;
+class WaypointTrackQuery;
+
+/*
+ * Queries airports and navaids for the web API directly in the HTTP server threads without using a map widget.
+ *
+ * Uses own database connections, map queries and map layer settings. Calls are serialized by a mutex since
+ * queries and their tile caches are not thread safe. Requests are answered with empty results while
+ * the database is switched.
+ */
+class WebFeatureQuery
+{
+public:
+  WebFeatureQuery(atools::sql::SqlDatabase *sqlDbSim, atools::sql::SqlDatabase *sqlDbNav, atools::sql::SqlDatabase *sqlDbUser,
+                  atools::sql::SqlDatabase *sqlDbTrack, bool verboseParam);
+  ~WebFeatureQuery();
+
+  WebFeatureQuery(const WebFeatureQuery& other) = delete;
+  WebFeatureQuery& operator=(const WebFeatureQuery& other) = delete;
+
+  /* Get all objects inside the rectangle. Layer is selected like the map does for a view showing
+   * the rectangle at the given zoom distance. Objects of the tile caches outside of rect are removed.
+   * Thread safe. Returns false if nothing could be queried. */
+  bool getFeatures(const atools::geo::Rect& rect, float distanceKm, int detailLevel, QList<map::MapAirport>& airports,
+                   QList<map::MapNdb>& ndbs, QList<map::MapVor>& vors, QList<map::MapMarker>& markers,
+                   QList<map::MapWaypoint>& waypoints);
+
+  /* Need to clear caches and tear down queries before switching database. Called in main thread. */
+  void preDatabaseLoad();
+
+  /* Initialize queries again after a database change. Called in main thread. */
+  void postDatabaseLoad();
+
+private:
+  MapLayerSettings *layers = nullptr;
+  MapQuery *mapQuery = nullptr;
+  WaypointTrackQuery *waypointTrackQuery = nullptr;
+
+  QMutex mutex;
+  bool databaseLoading = false;
+  bool verbose = false;
+};
+
+#endif // LNM_WEBFEATUREQUERY_H
@@ -20,9 +20,15 @@
 #include "mapgui/mappaintwidget.h"
 #include "mapgui/mapwidget.h"
 #include "app/navapp.h"
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "db/databasemanager.h"
+#include "web/webfeaturequery.h"
+#include "web/webrenderpool.h"
 
 #include <QDebug>
 #include <QPixmap>
+#include <QThread>
 
 WebMapController::WebMapController(QWidget *parent, bool verboseParam)
   : QObject(parent), parentWidget(parent), verbose(verboseParam)
@@ -34,6 +40,9 @@ WebMapController::~WebMapController()
 {
   qDebug() << Q_FUNC_INFO;
   deInit();
+
+  delete featureQuery;
+  featureQuery = nullptr;
 }
 
 void WebMapController::init()
@@ -42,19 +51,27 @@ void WebMapController::init()
 
   deInit();
 
-  // Create a map widget clone with the desired resolution
-  mapPaintWidget = new MapPaintWidget(parentWidget, false /* no real widget - hidden */);
+  // One context per core at most - each one needs memory for tile and query caches
+  int numContexts = atools::settings::Settings::instance().getAndStoreValue(lnm::OPTIONS_WEBSERVER_RENDER_CONTEXTS,
+                                                                            QThread::idealThreadCount()).toInt();
+  numContexts = std::max(1, std::min(numContexts, QThread::idealThreadCount()));
+  renderPool = new WebRenderPool(parentWidget, numContexts, verbose);
 
-  // Activate painting
-  mapPaintWidget->setActive();
+  // Not deleted in deInit() since server threads might still use it while stopping
+  if(featureQuery == nullptr)
+  {
+    DatabaseManager *databaseManager = NavApp::getDatabaseManager();
+    featureQuery = new WebFeatureQuery(databaseManager->getDatabaseSimWeb(), databaseManager->getDatabaseNavWeb(),
+                                       NavApp::getDatabaseUser(), databaseManager->getDatabaseTrackWeb(), verbose);
+  }
 }
 
 void WebMapController::deInit()
 {
   qDebug() << Q_FUNC_INFO;
 
-  delete mapPaintWidget;
-  mapPaintWidget = nullptr;
+  delete renderPool;
+  renderPool = nullptr;
 }
 
 MapPixmap WebMapController::getPixmap(int width, int height)
@@ -117,68 +134,84 @@ MapPixmap WebMapController::getPixmapPosDistance(int width, int height, atools::
     }
   }
 
-  if(mapPaintWidget != nullptr)
+  if(renderPool != nullptr)
+  {
+    QString key = QString("pos %1x%2 %3 %4 %5 %6").
+                  arg(width).arg(height).arg(pos.getLonX(), 0, 'f', 6).arg(pos.getLatY(), 0, 'f', 6).arg(distanceKm).arg(mapCommand);
+
+    MapPixmap mapPixmap = renderPool->render(key, pos, distanceKm, [ = ](MapPaintWidget *mapPaintWidget) -> MapPixmap {
+      return renderPosDistance(mapPaintWidget, width, height, pos, distanceKm, mapCommand);
+    });
+
+    if(mapPixmap.isValid())
+      emit webMapChanged();
+    return mapPixmap;
+  }
+  else
   {
-    QMutexLocker locker(&mapPaintWidgetMutex);
+    qWarning() << Q_FUNC_INFO << "renderPool is null";
+    return MapPixmap();
+  }
+}
+
+MapPixmap WebMapController::renderPosDistance(MapPaintWidget *mapPaintWidget, int width, int height, const atools::geo::Pos& pos,
+                                              float distanceKm, const QString& mapCommand)
+{
+  // Copy all map settings
+  mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
 
-    // Copy all map settings
-    mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+  // Context might have been used by the web API before
+  mapPaintWidget->setPaintCopyright(true);
 
-    // Do not center world rectangle when resizing map widget
-    mapPaintWidget->setKeepWorldRect(false);
+  // Do not center world rectangle when resizing map widget
+  mapPaintWidget->setKeepWorldRect(false);
 
-    // Jump to position without zooming for sharp map
-    mapPaintWidget->showPosNotAdjusted(pos, distanceKm);
+  // Jump to position without zooming for sharp map
+  mapPaintWidget->showPosNotAdjusted(pos, distanceKm);
 
-    if(!mapCommand.isEmpty())
+  if(!mapCommand.isEmpty())
+  {
+    // Move or zoom map by command
+    if(mapCommand == QLatin1String("left"))
+      mapPaintWidget->moveLeft(Marble::Instant);
+    else if(mapCommand == QLatin1String("right"))
+      mapPaintWidget->moveRight(Marble::Instant);
+    else if(mapCommand == QLatin1String("up"))
+      mapPaintWidget->moveUp(Marble::Instant);
+    else if(mapCommand == QLatin1String("down"))
+      mapPaintWidget->moveDown(Marble::Instant);
+    else if(mapCommand == QLatin1String("in"))
+      mapPaintWidget->zoomIn(Marble::Instant);
+    else if(mapCommand == QLatin1String("out"))
+      mapPaintWidget->zoomOut(Marble::Instant);
+    else
     {
-      // Move or zoom map by command
-      if(mapCommand == QLatin1String("left"))
-        mapPaintWidget->moveLeft(Marble::Instant);
-      else if(mapCommand == QLatin1String("right"))
-        mapPaintWidget->moveRight(Marble::Instant);
-      else if(mapCommand == QLatin1String("up"))
-        mapPaintWidget->moveUp(Marble::Instant);
-      else if(mapCommand == QLatin1String("down"))
-        mapPaintWidget->moveDown(Marble::Instant);
-      else if(mapCommand == QLatin1String("in"))
-        mapPaintWidget->zoomIn(Marble::Instant);
-      else if(mapCommand == QLatin1String("out"))
-        mapPaintWidget->zoomOut(Marble::Instant);
-      else
-      {
-        qWarning() << Q_FUNC_INFO << "Invalid map command" << mapCommand;
-        return MapPixmap();
-      }
+      qWarning() << Q_FUNC_INFO << "Invalid map command" << mapCommand;
+      return MapPixmap();
     }
+  }
 
-    // Jump to next sharp level
-    mapPaintWidget->zoomIn(Marble::Instant);
-    mapPaintWidget->zoomOut(Marble::Instant);
+  // Jump to next sharp level
+  mapPaintWidget->zoomIn(Marble::Instant);
+  mapPaintWidget->zoomOut(Marble::Instant);
 
-    MapPixmap mappixmap;
+  MapPixmap mappixmap;
 
-    // The actual zoom distance
-    mappixmap.correctedDistanceKm = static_cast<float>(mapPaintWidget->distance());
+  // The actual zoom distance
+  mappixmap.correctedDistanceKm = static_cast<float>(mapPaintWidget->distance());
 
-    if(mapCommand == QLatin1String("in") || mapCommand == QLatin1String("out"))
-      // Requested is equal to result when zooming
-      mappixmap.requestedDistanceKm = mappixmap.correctedDistanceKm;
-    else
-      // What was requested
-      mappixmap.requestedDistanceKm = distanceKm;
+  if(mapCommand == QLatin1String("in") || mapCommand == QLatin1String("out"))
+    // Requested is equal to result when zooming
+    mappixmap.requestedDistanceKm = mappixmap.correctedDistanceKm;
+  else
+    // What was requested
+    mappixmap.requestedDistanceKm = distanceKm;
 
-    // Fill result object
-    mappixmap.pixmap = mapPaintWidget->getPixmap(width, height);
-    mappixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
+  // Fill result object
+  mappixmap.pixmap = mapPaintWidget->getPixmap(width, height);
+  mappixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
 
-    return mappixmap;
-  }
-  else
-  {
-    qWarning() << Q_FUNC_INFO << "mapPaintWidget is null";
-    return MapPixmap();
-  }
+  return mappixmap;
 }
 
 MapPixmap WebMapController::getPixmapRect(int width, int height, atools::geo::Rect rect, const QString& errorCase)
@@ -188,30 +221,39 @@ MapPixmap WebMapController::getPixmapRect(int width, int height, atools::geo::Re
 
   if(rect.isValid())
   {
-    if(mapPaintWidget != nullptr)
+    if(renderPool != nullptr)
     {
-      QMutexLocker locker(&mapPaintWidgetMutex);
+      QString key = QString("rect %1x%2 %3 %4 %5 %6").arg(width).arg(height).
+                    arg(rect.getWest(), 0, 'f', 6).arg(rect.getNorth(), 0, 'f', 6).arg(rect.getEast(), 0, 'f', 6).arg(rect.getSouth(), 0, 'f', 6);
+      float distanceKm = rect.getTopLeft().distanceMeterTo(rect.getBottomRight()) / 1000.f;
 
-      // Copy all map settings
-      mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+      MapPixmap result = renderPool->render(key, rect.getCenter(), distanceKm, [ = ](MapPaintWidget *mapPaintWidget) -> MapPixmap {
+        // Copy all map settings
+        mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+        mapPaintWidget->setPaintCopyright(true);
 
-      // Do not center world rectangle when resizing
-      mapPaintWidget->setKeepWorldRect(false);
+        // Do not center world rectangle when resizing
+        mapPaintWidget->setKeepWorldRect(false);
 
-      mapPaintWidget->showRectStreamlined(rect);
+        mapPaintWidget->showRectStreamlined(rect);
 
-      MapPixmap mapPixmap;
+        MapPixmap mapPixmap;
 
-      // No distance requested. Therefore requested is equal to actual
-      mapPixmap.correctedDistanceKm = mapPixmap.requestedDistanceKm = static_cast<float>(mapPaintWidget->distance());
-      mapPixmap.pixmap = mapPaintWidget->getPixmap(width, height);
-      mapPixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
+        // No distance requested. Therefore requested is equal to actual
+        mapPixmap.correctedDistanceKm = mapPixmap.requestedDistanceKm = static_cast<float>(mapPaintWidget->distance());
+        mapPixmap.pixmap = mapPaintWidget->getPixmap(width, height);
+        mapPixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
 
-      return mapPixmap;
+        return mapPixmap;
+      });
+
+      if(result.isValid())
+        emit webMapChanged();
+      return result;
     }
     else
     {
-      qWarning() << Q_FUNC_INFO << "mapPaintWidget is null";
+      qWarning() << Q_FUNC_INFO << "renderPool is null";
       return MapPixmap();
     }
   }
@@ -226,17 +268,23 @@ MapPixmap WebMapController::getPixmapRect(int width, int height, atools::geo::Re
 
 MapPaintWidget *WebMapController::getMapPaintWidget() const
 {
-  return mapPaintWidget;
+  return renderPool != nullptr ? renderPool->getPrimaryMapPaintWidget() : nullptr;
 }
 
 void WebMapController::preDatabaseLoad()
 {
-  if(mapPaintWidget != nullptr)
-    mapPaintWidget->preDatabaseLoad();
+  if(renderPool != nullptr)
+    renderPool->preDatabaseLoad();
+
+  if(featureQuery != nullptr)
+    featureQuery->preDatabaseLoad();
 }
 
 void WebMapController::postDatabaseLoad()
 {
-  if(mapPaintWidget != nullptr)
-    mapPaintWidget->postDatabaseLoad();
+  if(renderPool != nullptr)
+    renderPool->postDatabaseLoad();
+
+  if(featureQuery != nullptr)
+    featureQuery->postDatabaseLoad();
 }
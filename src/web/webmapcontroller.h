@@ -22,11 +22,12 @@
 
 #include "geo/rect.h"
 
-#include <QMutex>
 #include <QPixmap>
 
 class QPixmap;
 class MapPaintWidget;
+class WebRenderPool;
+class WebFeatureQuery;
 
 /*
  * Result of a map image creating also covering error messages, center position, zoom distance and shown rectangle.
@@ -64,10 +65,10 @@ struct MapPixmap
 };
 
 /*
- * Wraps the MapPaintWidget and provides methods to retreive map images.
+ * Wraps a pool of MapPaintWidgets and provides methods to retreive map images.
  *
- * The map widget has a state, i.e. it remains in the last shown position and zoom value.
- * Settings are copied from normal visible map window before rendering.
+ * The map widgets have a state, i.e. they remain in the last shown position and zoom value.
+ * Settings are copied from normal visible map window before rendering. See WebRenderPool.
  *
  * This has to run in the main thread and event queue. Therefore, it is necessary to use queued signals to separate
  * a thread from the HTTP server.
@@ -87,7 +88,7 @@ public:
   WebMapController(const WebMapController& other) = delete;
   WebMapController& operator=(const WebMapController& other) = delete;
 
-  /* Create or delete the map paint widget */
+  /* Create or delete the render pool */
   void init();
   void deInit();
 
@@ -104,18 +105,39 @@ public:
   /* Zoom to rectangel on map. */
   MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, const QString& errorCase = tr("Invalid rectangle"));
 
-  /* Get the map paint widget */
+  /* Get the primary map paint widget of the pool */
   MapPaintWidget* getMapPaintWidget() const;
 
+  /* Pool shared with the web API */
+  WebRenderPool *getRenderPool() const
+  {
+    return renderPool;
+  }
+
+  /* Thread safe airport and navaid queries for the web API. Kept until the controller is deleted.
+   * Null if the server was never started. */
+  WebFeatureQuery *getFeatureQuery() const
+  {
+    return featureQuery;
+  }
+
   /* Need to clear caches and tear down queries before switching database */
   void preDatabaseLoad();
 
   /* Initialize queries again after a database change */
   void postDatabaseLoad();
 
+signals:
+  /* Sent after an image was rendered for the web map */
+  void webMapChanged();
+
 private:
-  MapPaintWidget *mapPaintWidget = nullptr;
-  QMutex mapPaintWidgetMutex;
+  /* Render into the given context */
+  MapPixmap renderPosDistance(MapPaintWidget *mapPaintWidget, int width, int height, const atools::geo::Pos& pos,
+                              float distanceKm, const QString& mapCommand);
+
+  WebRenderPool *renderPool = nullptr;
+  WebFeatureQuery *featureQuery = nullptr;
 
   QWidget *parentWidget;
   bool verbose = false;
@@ -0,0 +1,186 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webrenderpool.h"
+
+#include "mapgui/mappaintwidget.h"
+#include "mappainter/mappaintlayer.h"
+
+#include <QDebug>
+
+#include <limits>
+
+/* Identical requests within this time get the same image */
+static const qint64 COALESCE_MS = 300L;
+
+WebRenderPool::WebRenderPool(QWidget *parentWidgetParam, int maxContexts, bool verboseParam)
+  : parentWidget(parentWidgetParam), verbose(verboseParam)
+{
+  qDebug() << Q_FUNC_INFO << "maxContexts" << maxContexts;
+
+  clock.start();
+  contexts.resize(std::max(maxContexts, 1));
+
+  // Primary context is always needed
+  contexts.first().mapPaintWidget = createMapPaintWidget();
+}
+
+WebRenderPool::~WebRenderPool()
+{
+  qDebug() << Q_FUNC_INFO;
+
+  for(Context& context : contexts)
+  {
+    delete context.mapPaintWidget;
+    context.mapPaintWidget = nullptr;
+  }
+}
+
+MapPaintWidget *WebRenderPool::createMapPaintWidget() const
+{
+  // Create a map widget clone with the desired resolution
+  MapPaintWidget *mapPaintWidget = new MapPaintWidget(parentWidget, false /* no real widget - hidden */);
+
+  // Ensure MapPaintLayer::mapLayer initialisation
+  mapPaintWidget->getMapPaintLayer()->updateLayers();
+
+  // Activate painting
+  mapPaintWidget->setActive();
+  return mapPaintWidget;
+}
+
+MapPixmap WebRenderPool::render(const QString& key, const atools::geo::Pos& center, float distanceKm,
+                                const RenderFunctionType& renderFunc)
+{
+  // Remove outdated results and look for an identical request
+  qint64 now = clock.elapsed();
+  for(auto it = results.begin(); it != results.end();)
+  {
+    if(now - it.value().timestampMs > COALESCE_MS)
+      it = results.erase(it);
+    else
+      ++it;
+  }
+
+  auto it = results.constFind(key);
+  if(it != results.constEnd())
+  {
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Coalesced" << key;
+    return it.value().mapPixmap;
+  }
+
+  Context *context = acquire(center, distanceKm);
+  if(context == nullptr)
+  {
+    // Only possible if requests arrive while the event loop is processed during rendering in all contexts
+    qWarning() << Q_FUNC_INFO << "All render contexts busy";
+    MapPixmap mapPixmap;
+    mapPixmap.error = QObject::tr("Server busy");
+    return mapPixmap;
+  }
+
+  MapPixmap mapPixmap = renderFunc(context->mapPaintWidget);
+
+  // Remember actual center and distance for affinity
+  release(context, mapPixmap.pos.isValid() ? mapPixmap.pos : center,
+          mapPixmap.isValid() ? mapPixmap.correctedDistanceKm : distanceKm);
+
+  if(mapPixmap.isValid())
+    results.insert(key, {mapPixmap, clock.elapsed()});
+
+  return mapPixmap;
+}
+
+WebRenderPool::Context *WebRenderPool::acquire(const atools::geo::Pos& center, float distanceKm)
+{
+  Context *nearest = nullptr, *leastRecentlyUsed = nullptr, *unused = nullptr;
+  float nearestDistMeter = std::numeric_limits<float>::max();
+  for(Context& context : contexts)
+  {
+    if(context.busy)
+      continue;
+
+    if(context.mapPaintWidget == nullptr)
+    {
+      // Slot not created yet
+      if(unused == nullptr)
+        unused = &context;
+      continue;
+    }
+
+    if(center.isValid() && context.center.isValid())
+    {
+      // Context showed an overlapping area last time
+      float distMeter = context.center.distanceMeterTo(center);
+      if(distMeter < std::max(context.distanceKm, distanceKm) * 1000.f / 2.f && distMeter < nearestDistMeter)
+      {
+        nearest = &context;
+        nearestDistMeter = distMeter;
+      }
+    }
+
+    if(leastRecentlyUsed == nullptr || context.lastUsedMs < leastRecentlyUsed->lastUsedMs)
+      leastRecentlyUsed = &context;
+  }
+
+  Context *context = nearest;
+  if(context == nullptr && unused != nullptr)
+  {
+    // Prefer a new context to avoid invalidating caches of another client
+    unused->mapPaintWidget = createMapPaintWidget();
+    context = unused;
+
+    if(verbose)
+      qDebug() << Q_FUNC_INFO << "Created render context" << (context - contexts.data());
+  }
+
+  if(context == nullptr)
+    context = leastRecentlyUsed;
+
+  if(context != nullptr)
+    context->busy = true;
+
+  return context;
+}
+
+void WebRenderPool::release(Context *context, const atools::geo::Pos& center, float distanceKm)
+{
+  context->busy = false;
+  context->lastUsedMs = clock.elapsed();
+  context->center = center;
+  context->distanceKm = distanceKm;
+}
+
+void WebRenderPool::preDatabaseLoad()
+{
+  results.clear();
+  for(Context& context : contexts)
+  {
+    if(context.mapPaintWidget != nullptr)
+      context.mapPaintWidget->preDatabaseLoad();
+  }
+}
+
+void WebRenderPool::postDatabaseLoad()
+{
+  for(Context& context : contexts)
+  {
+    if(context.mapPaintWidget != nullptr)
+      context.mapPaintWidget->postDatabaseLoad();
+  }
+}
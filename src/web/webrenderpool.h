@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBRENDERPOOL_H
+#define LNM_WEBRENDERPOOL_H
+
+#include "web/webmapcontroller.h"
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+
+#include <functional>
+
+class MapPaintWidget;
+class QWidget;
+
+/*
+ * Pool of independent hidden map widgets which are used to render images for web map and web API clients.
+ * Each context has its own map queries and tile caches and remembers its last shown position.
+ *
+ * Requests are dispatched to a free context which showed the area last to keep its caches warm.
+ * Otherwise an unused slot gets a new context or the least recently used one is taken. This avoids
+ * thrashing caches and view state if several clients look at different areas.
+ *
+ * Identical requests arriving within a short time are coalesced and get the already rendered image.
+ *
+ * Map widgets are QWidgets and have to be used in the main thread. Request handlers call the web controllers via
+ * queued connections. Therefore, images are rendered one after the other and a context is only busy while
+ * the event loop is processed during rendering.
+ */
+class WebRenderPool
+{
+public:
+  typedef std::function<MapPixmap(MapPaintWidget *mapPaintWidget)> RenderFunctionType;
+
+  /* Creates the first context immediately and all others on demand up to maxContexts. */
+  WebRenderPool(QWidget *parentWidgetParam, int maxContexts, bool verboseParam);
+  ~WebRenderPool();
+
+  WebRenderPool(const WebRenderPool& other) = delete;
+  WebRenderPool& operator=(const WebRenderPool& other) = delete;
+
+  /* Call renderFunc with the best free context for the area or return the result of an identical request with
+   * the same key rendered within the last milliseconds. Center can be invalid if not known. */
+  MapPixmap render(const QString& key, const atools::geo::Pos& center, float distanceKm, const RenderFunctionType& renderFunc);
+
+  /* First context which is always available */
+  MapPaintWidget *getPrimaryMapPaintWidget() const
+  {
+    return contexts.constFirst().mapPaintWidget;
+  }
+
+  /* Need to clear caches and tear down queries before switching database */
+  void preDatabaseLoad();
+
+  /* Initialize queries again after a database change */
+  void postDatabaseLoad();
+
+private:
+  struct Context
+  {
+    MapPaintWidget *mapPaintWidget = nullptr;
+    atools::geo::Pos center; /* Last shown center */
+    float distanceKm = 0.f; /* Last shown zoom distance */
+    qint64 lastUsedMs = 0L;
+    bool busy = false;
+  };
+
+  struct Result
+  {
+    MapPixmap mapPixmap;
+    qint64 timestampMs;
+  };
+
+  /* Find best free context, create a new one if needed and mark it busy. Returns null if all are busy. */
+  Context *acquire(const atools::geo::Pos& center, float distanceKm);
+  void release(Context *context, const atools::geo::Pos& center, float distanceKm);
+
+  MapPaintWidget *createMapPaintWidget() const;
+
+  QVector<Context> contexts; /* Fixed size. Pointers to elements are stable. */
+  QHash<QString, Result> results; /* Recently rendered images for coalescing */
+  QElapsedTimer clock;
+
+  QWidget *parentWidget;
+  bool verbose = false;
+};
+
+#endif // LNM_WEBRENDERPOOL_H
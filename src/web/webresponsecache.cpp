@@ -0,0 +1,103 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/webresponsecache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+
+WebResponseCache::WebResponseCache(int maxSizeBytes, int maxAgeMsParam, bool verboseParam)
+  : maxAgeMs(std::max(maxAgeMsParam, 1000)), verbose(verboseParam)
+{
+  // Cost is body size
+  cache.setMaxCost(maxSizeBytes);
+}
+
+WebResponseCache::~WebResponseCache()
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO << "hits" << hits << "misses" << misses;
+}
+
+QByteArray WebResponseCache::buildETag(const QByteArray& path, const QMultiMap<QByteArray, QByteArray>& parameters,
+                                       quint64 generation) const
+{
+  // Parameter map is sorted by key
+  QCryptographicHash hash(QCryptographicHash::Md5);
+  hash.addData(path);
+  for(auto it = parameters.constBegin(); it != parameters.constEnd(); ++it)
+  {
+    hash.addData("&", 1);
+    hash.addData(it.key());
+    hash.addData("=", 1);
+    hash.addData(it.value());
+  }
+
+  qint64 timeBucket = QDateTime::currentMSecsSinceEpoch() / maxAgeMs;
+
+  return '"' + hash.result().toHex().left(20) + '-' + QByteArray::number(generation, 16) + '-' +
+         QByteArray::number(timeBucket, 16) + '"';
+}
+
+bool WebResponseCache::get(const QByteArray& etag, Response& response)
+{
+  QMutexLocker locker(&mutex);
+  Response *cached = cache.object(etag);
+  if(cached != nullptr)
+  {
+    response = *cached;
+    hits++;
+    return true;
+  }
+  else
+  {
+    misses++;
+    return false;
+  }
+}
+
+void WebResponseCache::insert(const QByteArray& etag, const Response& response)
+{
+  QMutexLocker locker(&mutex);
+  cache.insert(etag, new Response(response), std::max(response.body.size(), 1));
+}
+
+void WebResponseCache::clear()
+{
+  QMutexLocker locker(&mutex);
+  cache.clear();
+}
+
+bool WebResponseCache::matches(const QByteArray& ifNoneMatch, const QByteArray& etag)
+{
+  if(ifNoneMatch.isEmpty())
+    return false;
+
+  for(const QByteArray& tag : ifNoneMatch.split(','))
+  {
+    QByteArray trimmed = tag.trimmed();
+
+    // Weak comparison ignoring W/ prefix
+    if(trimmed.startsWith("W/"))
+      trimmed = trimmed.mid(2);
+
+    if(trimmed == "*" || trimmed == etag)
+      return true;
+  }
+  return false;
+}
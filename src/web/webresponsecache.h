@@ -0,0 +1,71 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBRESPONSECACHE_H
+#define LNM_WEBRESPONSECACHE_H
+
+#include <QCache>
+#include <QMultiMap>
+#include <QMutex>
+
+/*
+ * Bounded cache for rendered responses like map images and web API results. Thread safe.
+ *
+ * Responses are identified by an ETag built from request path, parameters and a state generation of the
+ * web snapshot. The generation changes with each flight plan, simulator, map view, options or database change.
+ * Responses not using simulator data use the static generation which ignores simulator updates.
+ * Changes which are not tracked, like weather updates, are covered by adding a time bucket of maxAge to the ETag.
+ */
+class WebResponseCache
+{
+public:
+  struct Response
+  {
+    QByteArray body;
+    QMultiMap<QByteArray, QByteArray> headers; /* Content type and other headers to restore */
+  };
+
+  /* maxSizeBytes is the total size of all cached response bodies */
+  WebResponseCache(int maxSizeBytes, int maxAgeMsParam, bool verboseParam);
+  ~WebResponseCache();
+
+  WebResponseCache(const WebResponseCache& other) = delete;
+  WebResponseCache& operator=(const WebResponseCache& other) = delete;
+
+  /* Quoted ETag for the request. Equal for all identical requests while state does not change. */
+  QByteArray buildETag(const QByteArray& path, const QMultiMap<QByteArray, QByteArray>& parameters,
+                       quint64 generation) const;
+
+  /* Get cached response for ETag. Returns false if not found. */
+  bool get(const QByteArray& etag, Response& response);
+
+  void insert(const QByteArray& etag, const Response& response);
+
+  void clear();
+
+  /* Also true for "*" or a list of tags */
+  static bool matches(const QByteArray& ifNoneMatch, const QByteArray& etag);
+
+private:
+  QCache<QByteArray, Response> cache;
+  QMutex mutex;
+  int maxAgeMs;
+  int hits = 0, misses = 0;
+  bool verbose = false;
+};
+
+#endif // LNM_WEBRESPONSECACHE_H
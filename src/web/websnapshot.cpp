@@ -0,0 +1,178 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "web/websnapshot.h"
+
+#include "app/navapp.h"
+#include "common/unit.h"
+#include "info/infocontroller.h"
+#include "mapgui/mappaintwidget.h"
+#include "route/route.h"
+#include "route/routecontroller.h"
+
+#include <QDebug>
+
+WebSnapshotPublisher::WebSnapshotPublisher(bool verboseParam)
+  : verbose(verboseParam)
+{
+  WebSnapshot *empty = new WebSnapshot;
+  empty->route.reset(new Route);
+  snapshot.reset(empty);
+
+  flightplanHtmlTimer.setSingleShot(true);
+  flightplanHtmlTimer.setInterval(500);
+  QObject::connect(&flightplanHtmlTimer, &QTimer::timeout, [ = ]() {
+    updateFlightplanHtml();
+  });
+}
+
+WebSnapshotPublisher::~WebSnapshotPublisher()
+{
+  flightplanHtmlTimer.stop();
+}
+
+WebSnapshotPtr WebSnapshotPublisher::getSnapshot() const
+{
+  QMutexLocker locker(&mutex);
+  return snapshot;
+}
+
+void WebSnapshotPublisher::publishAll()
+{
+  if(verbose)
+    qDebug() << Q_FUNC_INFO;
+
+  const Route& route = NavApp::getRouteConst();
+  lastActiveLegIndex = route.getActiveLegIndexCorrected();
+
+  publish([&route](WebSnapshot& snap) {
+    snap.route.reset(new Route(route));
+    snap.simConnectData = NavApp::getSimConnectData();
+    snap.progressBitsWeb = NavApp::getInfoController()->getEnabledProgressBitsWeb();
+    snap.mapCenterPos = NavApp::getMapPaintWidgetGui()->getCurrentViewCenterPos();
+    snap.connectedAndAircraft = NavApp::isConnectedAndAircraft();
+    copyOptions(snap);
+  });
+  mapViewChanged();
+  webMapChanged();
+  updateFlightplanHtml();
+}
+
+void WebSnapshotPublisher::simDataChanged(const atools::fs::sc::SimConnectData& simulatorData)
+{
+  // Route controller got the packet first and might have changed the active leg
+  const Route& route = NavApp::getRouteConst();
+  bool activeLegChanged = route.getActiveLegIndexCorrected() != lastActiveLegIndex;
+  lastActiveLegIndex = route.getActiveLegIndexCorrected();
+
+  publish([&](WebSnapshot& snap) {
+    if(activeLegChanged)
+      snap.route.reset(new Route(route));
+    snap.simConnectData = simulatorData;
+    snap.progressBitsWeb = NavApp::getInfoController()->getEnabledProgressBitsWeb();
+    snap.connectedAndAircraft = NavApp::isConnectedAndAircraft();
+  }, !activeLegChanged /* simOnly */);
+
+  // Table highlights the active leg
+  if(activeLegChanged)
+    flightplanHtmlTimer.start();
+}
+
+void WebSnapshotPublisher::routeChanged()
+{
+  const Route& route = NavApp::getRouteConst();
+  lastActiveLegIndex = route.getActiveLegIndexCorrected();
+
+  publish([&route](WebSnapshot& snap) {
+    snap.route.reset(new Route(route));
+  });
+  flightplanHtmlTimer.start();
+}
+
+void WebSnapshotPublisher::mapViewChanged()
+{
+  const MapPaintWidget *mapWidget = NavApp::getMapPaintWidgetGui();
+  atools::geo::Pos pos = mapWidget->getCurrentViewCenterPos();
+  int zoom = mapWidget->zoom();
+  qreal distance = mapWidget->distance();
+
+  publish([&](WebSnapshot& snap) {
+    snap.mapCenterPos = pos;
+    snap.mapZoomUi = zoom;
+    snap.mapDistanceUi = distance;
+  });
+}
+
+void WebSnapshotPublisher::webMapChanged()
+{
+  const MapPaintWidget *mapWidget = NavApp::getMapPaintWidgetWeb();
+  if(mapWidget == nullptr)
+    return;
+
+  int zoom = mapWidget->zoom();
+  qreal distance = mapWidget->distance();
+
+  // Avoid publishing a new generation if nothing changed
+  WebSnapshotPtr current = getSnapshot();
+  if(current->mapZoomWeb == zoom && current->mapDistanceWeb == distance)
+    return;
+
+  publish([&](WebSnapshot& snap) {
+    snap.mapZoomWeb = zoom;
+    snap.mapDistanceWeb = distance;
+  });
+}
+
+void WebSnapshotPublisher::stateChanged()
+{
+  // Units are already updated from options
+  publish([](WebSnapshot& snap) {
+    copyOptions(snap);
+  });
+}
+
+void WebSnapshotPublisher::copyOptions(WebSnapshot& snapshot)
+{
+  snapshot.unitDist = Unit::getUnitDistStr();
+  snapshot.unitShortDist = Unit::getUnitShortDistStr();
+  snapshot.unitAlt = Unit::getUnitAltStr();
+  snapshot.unitSpeed = Unit::getUnitSpeedStr();
+  snapshot.unitVertSpeed = Unit::getUnitVertSpeedStr();
+  snapshot.unitWeight = Unit::getUnitWeightStr();
+  snapshot.unitVol = Unit::getUnitVolStr();
+}
+
+void WebSnapshotPublisher::updateFlightplanHtml()
+{
+  QString html = NavApp::getRouteController()->getFlightplanTableAsHtml(20, false);
+  publish([&html](WebSnapshot& snap) {
+    snap.flightplanHtml = html;
+  });
+}
+
+void WebSnapshotPublisher::publish(const std::function<void(WebSnapshot& snapshot)>& updateFunc, bool simOnly)
+{
+  // Copy is cheap since route is shared and all other members are implicitly shared
+  WebSnapshot *newSnapshot = new WebSnapshot(*getSnapshot());
+  updateFunc(*newSnapshot);
+  newSnapshot->generation++;
+  if(!simOnly)
+    newSnapshot->staticGeneration++;
+
+  QMutexLocker locker(&mutex);
+  snapshot.reset(newSnapshot);
+}
@@ -0,0 +1,130 @@
+/*****************************************************************************
+* Copyright 2015-2023 Alexander Barthel alex@littlenavmap.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LNM_WEBSNAPSHOT_H
+#define LNM_WEBSNAPSHOT_H
+
+#include "fs/sc/simconnectdata.h"
+#include "geo/pos.h"
+
+#include <QBitArray>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QTimer>
+
+#include <functional>
+
+class Route;
+
+/*
+ * Immutable copy of the program state needed to answer web requests without calling into the main thread.
+ * A new snapshot is created in the main thread after each change. Members which change rarely are shared between
+ * snapshots.
+ */
+struct WebSnapshot
+{
+  /* Never null */
+  QSharedPointer<const Route> route;
+
+  /* Last packet received from the simulator */
+  atools::fs::sc::SimConnectData simConnectData;
+
+  /* Flight plan table as shown on the web page. Updated with a delay after changes. */
+  QString flightplanHtml;
+
+  /* Enabled fields for aircraft progress on the web page */
+  QBitArray progressBitsWeb;
+
+  /* Center of the map in the main window. Used to initialize sessions. */
+  atools::geo::Pos mapCenterPos;
+
+  /* Zoom and distance of the main map and the primary web map. Used by the web API action "ui/info". */
+  int mapZoomUi = 0, mapZoomWeb = 0;
+  qreal mapDistanceUi = 0., mapDistanceWeb = 0.;
+
+  /* Unit names as selected in options. Used by the web API action "ui/info". */
+  QString unitDist, unitShortDist, unitAlt, unitSpeed, unitVertSpeed, unitWeight, unitVol;
+
+  bool connectedAndAircraft = false;
+
+  /* Incremented with each published change. Used to validate cached responses depending on simulator data. */
+  quint64 generation = 0L;
+
+  /* Incremented with each published change except simulator packets which leave the flight plan unchanged.
+   * Used to validate cached responses which do not depend on simulator data. */
+  quint64 staticGeneration = 0L;
+};
+
+typedef QSharedPointer<const WebSnapshot> WebSnapshotPtr;
+
+/*
+ * Publishes snapshots for the web server threads. All update methods have to be called in the main thread.
+ * getSnapshot() can be called from any thread. The returned snapshot stays valid until released.
+ */
+class WebSnapshotPublisher
+{
+public:
+  explicit WebSnapshotPublisher(bool verboseParam);
+  ~WebSnapshotPublisher();
+
+  WebSnapshotPublisher(const WebSnapshotPublisher& other) = delete;
+  WebSnapshotPublisher& operator=(const WebSnapshotPublisher& other) = delete;
+
+  /* Thread safe. Returns current snapshot. */
+  WebSnapshotPtr getSnapshot() const;
+
+  /* Copy all state */
+  void publishAll();
+
+  /* Copy simulator data. Flight plan is copied too if the active leg has changed. */
+  void simDataChanged(const atools::fs::sc::SimConnectData& simulatorData);
+
+  /* Copy flight plan and update table later */
+  void routeChanged();
+
+  /* Copy center, zoom and distance of main map */
+  void mapViewChanged();
+
+  /* Copy zoom and distance of the primary web map after rendering */
+  void webMapChanged();
+
+  /* Copy options data and publish a new generation after options, style or database changes */
+  void stateChanged();
+
+private:
+  /* Copy current snapshot, apply changes and publish. staticGeneration is kept if simOnly is true. */
+  void publish(const std::function<void(WebSnapshot& snapshot)>& updateFunc, bool simOnly = false);
+
+  /* Create the flight plan table HTML after timer timeout */
+  void updateFlightplanHtml();
+
+  /* Copy values from options */
+  static void copyOptions(WebSnapshot& snapshot);
+
+  WebSnapshotPtr snapshot;
+  mutable QMutex mutex;
+
+  /* Collects frequent route changes before building the table */
+  QTimer flightplanHtmlTimer;
+
+  /* Active leg of the last copied route - main thread only */
+  int lastActiveLegIndex = -1;
+
+  bool verbose = false;
+};
+
+#endif // LNM_WEBSNAPSHOT_H
@@ -28,6 +28,7 @@
 #include "fs/util/morsecode.h"
 #include "fs/sc/simconnectdata.h"
 #include "mapgui/mappaintwidget.h"
+#include "web/webcontroller.h"
 
 namespace ageo = atools::geo;
 using atools::fs::util::MorseCode;
@@ -162,5 +163,6 @@ const QString AbstractLnmActionsController::getActiveDateTimeSource(){
 };
 
 const SimConnectData AbstractLnmActionsController::getSimConnectData(){
-    return getNavApp()->getSimConnectData();
+    // Thread safe copy from snapshot
+    return getNavApp()->getWebController()->getSnapshot()->simConnectData;
 };
@@ -28,19 +28,24 @@
 #include "mapgui/mapwidget.h"
 #include "app/navapp.h"
 #include "common/mapresult.h"
+#include "geo/calculations.h"
+#include "web/webcontroller.h"
 #include "web/webmapcontroller.h"
+#include "web/webfeaturequery.h"
+#include "web/webrenderpool.h"
 
 #include <QDebug>
 #include <QBuffer>
 #include <QPixmap>
 
+#include <cmath>
+
 using InfoBuilderTypes::MapFeaturesData;
 
 MapActionsController::MapActionsController(QObject *parent, bool verboseParam, AbstractInfoBuilder* infoBuilder) :
     AbstractLnmActionsController(parent, verboseParam, infoBuilder), parentWidget((QWidget *)parent) // WARNING: Uncertain cast (QWidget *) QObject
 {
     qDebug() << Q_FUNC_INFO;
-    init();
 }
 
 WebApiResponse MapActionsController::imageAction(WebApiRequest request){
@@ -90,7 +95,7 @@ WebApiResponse MapActionsController::imageAction(WebApiRequest request){
 
       // Add copyright/attributions to header
       response.headers.insert("Image-Attributions",
-                              NavApp::getMapThemeHandler()->getTheme(mapPaintWidget->getCurrentThemeId()).getCopyright().toUtf8());
+                              NavApp::getMapThemeHandler()->getTheme(NavApp::getMapWidgetGui()->getCurrentThemeId()).getCopyright().toUtf8());
 
       response.status = 200;
       response.body = bytes;
@@ -110,31 +115,21 @@ WebApiResponse MapActionsController::featuresAction(WebApiRequest request){
         request.parameters.value("bottomlat").toFloat()
     );
 
-    bool overflow = false;
-
-    // Init dummy image request
-    WebApiRequest *imageRequest = new WebApiRequest();
-    imageRequest->parameters = QMap<QByteArray,QByteArray>();
-    imageRequest->parameters.insert("leftlon",request.parameters.value("leftlon")),
-    imageRequest->parameters.insert("toplat",request.parameters.value("toplat")),
-    imageRequest->parameters.insert("rightlon",request.parameters.value("rightlon")),
-    imageRequest->parameters.insert("bottomlat",request.parameters.value("bottomlat")),
-    imageRequest->parameters.insert("detailfactor",request.parameters.value("detailfactor"));
-    imageRequest->parameters.insert("width","300");
-    imageRequest->parameters.insert("height","300");
-    imageRequest->parameters.insert("format","jpg");
-    imageRequest->parameters.insert("quality","1");
+    // Use default if not given
+    int detailFactor = MapLayerSettings::MAP_DEFAULT_DETAIL_LEVEL;
+    if(request.parameters.contains("detailfactor"))
+        detailFactor = request.parameters.value("detailfactor").toInt();
 
-    // Perform dummy image request
-    imageAction(*imageRequest);
+    QList<map::MapAirport> airports;
+    QList<map::MapNdb> ndbs;
+    QList<map::MapVor> vors;
+    QList<map::MapMarker> markers;
+    QList<map::MapWaypoint> waypoints;
 
-    // Extract results created during dummy image request
-    const QList<map::MapAirport> airports = *mapPaintWidget->getMapQuery()->getAirportsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,map::NONE,overflow);
-
-    const QList<map::MapNdb> ndbs = *mapPaintWidget->getMapQuery()->getNdbsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapVor> vors = *mapPaintWidget->getMapQuery()->getVorsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapMarker> markers = *mapPaintWidget->getMapQuery()->getMarkersByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
-    const QList<map::MapWaypoint> waypoints = mapPaintWidget->getWaypointTrackQuery()->getWaypointsByRect(rect,mapPaintWidget->getMapPaintLayer()->getMapLayer(), false,overflow);
+    // Called in the server thread - query the databases directly without map widget and rendering
+    WebFeatureQuery *featureQuery = getFeatureQuery();
+    if(featureQuery != nullptr)
+        featureQuery->getFeatures(rect, distanceKmForRect(rect), detailFactor, airports, ndbs, vors, markers, waypoints);
 
     MapFeaturesData data = {
         airports,
@@ -161,10 +156,10 @@ WebApiResponse MapActionsController::featureAction(WebApiRequest request){
 
     switch (type_id) {
         case map::WAYPOINT:
-            result.waypoints.append(mapPaintWidget->getWaypointTrackQuery()->getWaypointById(object_id));
+            result.waypoints.append(getWaypointTrackQuery()->getWaypointById(object_id));
             break;
         default:
-            mapPaintWidget->getMapQuery()->getMapObjectById(result,type_id,map::AIRSPACE_SRC_NONE,object_id,false);
+            getMapQuery()->getMapObjectById(result,type_id,map::AIRSPACE_SRC_NONE,object_id,false);
             break;
     }
 
@@ -185,177 +180,105 @@ WebApiResponse MapActionsController::featureAction(WebApiRequest request){
 MapActionsController::~MapActionsController()
 {
   qDebug() << Q_FUNC_INFO;
-  deInit();
 }
 
-void MapActionsController::init()
+float MapActionsController::distanceKmForRect(const atools::geo::Rect& rect)
 {
-  qDebug() << Q_FUNC_INFO;
-
-  deInit();
-
-  // Create a map widget clone with the desired resolution
-  mapPaintWidget = new MapPaintWidget(parentWidget, false /* no real widget - hidden */);
-  // Ensure MapPaintLayer::mapLayer initialisation
-  mapPaintWidget->getMapPaintLayer()->updateLayers();
-
-  // Activate painting
-  mapPaintWidget->setActive();
+  // Marble calculates the distance as earth radius * 0.4 / tan(55 deg) / radius * viewport width.
+  // With the Mercator projection using a radius of viewport width * PI / 2 / angular width
+  // this results in a distance proportional to the angular width and independent of the image size.
+  const double DEG_TO_RAD = M_PI / 180.;
+  double widthRad = std::abs(rect.getWidthDegree()) * DEG_TO_RAD;
+
+  // Use Mercator height instead if larger to fit a square view
+  double northRad = std::min(std::max(static_cast<double>(rect.getNorth()), -85.), 85.) * DEG_TO_RAD;
+  double southRad = std::min(std::max(static_cast<double>(rect.getSouth()), -85.), 85.) * DEG_TO_RAD;
+  double heightRad = std::abs(std::log(std::tan(M_PI / 4. + northRad / 2.)) - std::log(std::tan(M_PI / 4. + southRad / 2.)));
+
+  double earthRadiusKm = atools::geo::EARTH_CIRCUMFERENCE_METER / 1000. / (2. * M_PI);
+  return static_cast<float>(earthRadiusKm * 0.4 / std::tan(55. * DEG_TO_RAD) * 2. / M_PI * std::max(widthRad, heightRad));
 }
 
-void MapActionsController::deInit()
+WebFeatureQuery *MapActionsController::getFeatureQuery()
 {
-  qDebug() << Q_FUNC_INFO;
-
-  delete mapPaintWidget;
-  mapPaintWidget = nullptr;
+  WebController *webController = NavApp::getWebController();
+  if(webController != nullptr && webController->getWebMapController() != nullptr)
+    return webController->getWebMapController()->getFeatureQuery();
+  else
+    return nullptr;
 }
 
-MapPixmap MapActionsController::getPixmap(int width, int height)
+WebRenderPool *MapActionsController::getRenderPool()
 {
-  if(verbose)
-    qDebug() << Q_FUNC_INFO << width << "x" << height;
-
-  return getPixmapPosDistance(width, height, atools::geo::EMPTY_POS,
-                              static_cast<float>(mapPaintWidget->distance()), QLatin1String(""));
+  // Pool is shared with the web map and exists only while the server is running
+  WebController *webController = NavApp::getWebController();
+  if(webController != nullptr && webController->getWebMapController() != nullptr)
+    return webController->getWebMapController()->getRenderPool();
+  else
+    return nullptr;
 }
 
-MapPixmap MapActionsController::getPixmapPosDistance(int width, int height, atools::geo::Pos pos, float distanceKm,
-                                                 const QString& mapCommand, const QString& errorCase)
+MapPixmap MapActionsController::getPixmapRect(int width, int height, atools::geo::Rect rect, int detailFactor, const QString& errorCase)
 {
   if(verbose)
-    qDebug() << Q_FUNC_INFO << width << "x" << height << pos << "distanceKm" << distanceKm << "cmd" << mapCommand;
+    qDebug() << Q_FUNC_INFO << width << "x" << height << rect;
 
-  if(!pos.isValid())
+  if(rect.isValid())
   {
-    if(errorCase == QLatin1String(""))
+    WebRenderPool *renderPool = getRenderPool();
+    if(renderPool != nullptr)
     {
-      // Use current map position
-      pos.setLonX(static_cast<float>(mapPaintWidget->centerLongitude()));
-      pos.setLatY(static_cast<float>(mapPaintWidget->centerLatitude()));
+      QString key = QString("api rect %1x%2 %3 %4 %5 %6 %7").arg(width).arg(height).
+                    arg(rect.getWest(), 0, 'f', 6).arg(rect.getNorth(), 0, 'f', 6).arg(rect.getEast(), 0, 'f', 6).arg(rect.getSouth(), 0, 'f', 6).
+                    arg(detailFactor);
+      float distanceKm = rect.getTopLeft().distanceMeterTo(rect.getBottomRight()) / 1000.f;
+
+      return renderPool->render(key, rect.getCenter(), distanceKm, [ = ](MapPaintWidget *mapPaintWidget) -> MapPixmap {
+        return renderRect(mapPaintWidget, width, height, rect, detailFactor);
+      });
     }
     else
     {
-      qWarning() << Q_FUNC_INFO << errorCase;
-      MapPixmap mappixmap;
-      mappixmap.error = errorCase;
-      return mappixmap;
+      qWarning() << Q_FUNC_INFO << "renderPool is null";
+      return MapPixmap();
     }
   }
-
-  if(mapPaintWidget != nullptr)
-  {
-    QMutexLocker locker(&mapPaintWidgetMutex);
-
-    // Copy all map settings
-    mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
-
-    // Do not center world rectangle when resizing map widget
-    mapPaintWidget->setKeepWorldRect(false);
-
-    // Jump to position without zooming for sharp map
-    mapPaintWidget->showPosNotAdjusted(pos, distanceKm);
-
-    if(!mapCommand.isEmpty())
-    {
-      // Move or zoom map by command
-      if(mapCommand == QLatin1String("left"))
-        mapPaintWidget->moveLeft(Marble::Instant);
-      else if(mapCommand == QLatin1String("right"))
-        mapPaintWidget->moveRight(Marble::Instant);
-      else if(mapCommand == QLatin1String("up"))
-        mapPaintWidget->moveUp(Marble::Instant);
-      else if(mapCommand == QLatin1String("down"))
-        mapPaintWidget->moveDown(Marble::Instant);
-      else if(mapCommand == QLatin1String("in"))
-        mapPaintWidget->zoomIn(Marble::Instant);
-      else if(mapCommand == QLatin1String("out"))
-        mapPaintWidget->zoomOut(Marble::Instant);
-      else
-      {
-        qWarning() << Q_FUNC_INFO << "Invalid map command" << mapCommand;
-        return MapPixmap();
-      }
-    }
-
-    // Jump to next sharp level
-    mapPaintWidget->zoomIn(Marble::Instant);
-    mapPaintWidget->zoomOut(Marble::Instant);
-
-    MapPixmap mappixmap;
-
-    // The actual zoom distance
-    mappixmap.correctedDistanceKm = static_cast<float>(mapPaintWidget->distance());
-
-    if(mapCommand == QLatin1String("in") || mapCommand == QLatin1String("out"))
-      // Requested is equal to result when zooming
-      mappixmap.requestedDistanceKm = mappixmap.correctedDistanceKm;
-    else
-      // What was requested
-      mappixmap.requestedDistanceKm = distanceKm;
-
-    // Fill result object
-    mappixmap.pixmap = mapPaintWidget->getPixmap(width, height);
-    mappixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
-
-    return mappixmap;
-  }
   else
   {
-    qWarning() << Q_FUNC_INFO << "mapPaintWidget is null";
-    return MapPixmap();
+    qWarning() << Q_FUNC_INFO << errorCase;
+    MapPixmap mapPixmap;
+    mapPixmap.error = errorCase;
+    return mapPixmap;
   }
 }
 
-MapPixmap MapActionsController::getPixmapRect(int width, int height, atools::geo::Rect rect, int detailFactor, const QString& errorCase)
+MapPixmap MapActionsController::renderRect(MapPaintWidget *mapPaintWidget, int width, int height, const atools::geo::Rect& rect,
+                                           int detailFactor)
 {
-  if(verbose)
-    qDebug() << Q_FUNC_INFO << width << "x" << height << rect;
-
-  if(rect.isValid())
-  {
-    if(mapPaintWidget != nullptr)
-    {
-      QMutexLocker locker(&mapPaintWidgetMutex);
-
-      // Copy all map settings
-      mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
+  // Copy all map settings
+  mapPaintWidget->copySettings(*NavApp::getMapWidgetGui());
 
-      // Do not center world rectangle when resizing
-      mapPaintWidget->setKeepWorldRect(false);
+  // Do not center world rectangle when resizing
+  mapPaintWidget->setKeepWorldRect(false);
 
-      mapPaintWidget->showRectStreamlined(rect, false);
+  mapPaintWidget->showRectStreamlined(rect, false);
 
-      // Disable dynamic/live features
-      mapPaintWidget->setShowMapObject(map::AIRCRAFT_ALL,false);
-      mapPaintWidget->setShowMapObjectDisplay(map::AIRCRAFT_TRACK,false);
+  // Disable dynamic/live features
+  mapPaintWidget->setShowMapObject(map::AIRCRAFT_ALL,false);
+  mapPaintWidget->setShowMapObjectDisplay(map::AIRCRAFT_TRACK,false);
 
-      // Set detail factor
-      mapPaintWidget->getMapPaintLayer()->setDetailLevel(detailFactor);
+  // Set detail factor
+  mapPaintWidget->getMapPaintLayer()->setDetailLevel(detailFactor);
 
-      // Disable copyright note
-      mapPaintWidget->setPaintCopyright(false);
+  // Disable copyright note
+  mapPaintWidget->setPaintCopyright(false);
 
-      MapPixmap mapPixmap;
+  MapPixmap mapPixmap;
 
-      // No distance requested. Therefore requested is equal to actual
-      mapPixmap.correctedDistanceKm = mapPixmap.requestedDistanceKm = static_cast<float>(mapPaintWidget->distance());
-      mapPixmap.pixmap = mapPaintWidget->getPixmap(width, height);
-      mapPixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
+  // No distance requested. Therefore requested is equal to actual
+  mapPixmap.correctedDistanceKm = mapPixmap.requestedDistanceKm = static_cast<float>(mapPaintWidget->distance());
+  mapPixmap.pixmap = mapPaintWidget->getPixmap(width, height);
+  mapPixmap.pos = mapPaintWidget->getCurrentViewCenterPos();
 
-      return mapPixmap;
-    }
-    else
-    {
-      qWarning() << Q_FUNC_INFO << "mapPaintWidget is null";
-      return MapPixmap();
-    }
-  }
-  else
-  {
-    qWarning() << Q_FUNC_INFO << errorCase;
-    MapPixmap mapPixmap;
-    mapPixmap.error = errorCase;
-    return mapPixmap;
-  }
+  return mapPixmap;
 }
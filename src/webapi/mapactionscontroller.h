@@ -19,7 +19,6 @@
 #define MAPACTIONSCONTROLLER_H
 
 #include "webapi/abstractlnmactionscontroller.h"
-#include <QMutex>
 #include <QPixmap>
 #include "mapgui/maplayersettings.h"
 
@@ -29,6 +28,8 @@ class WebApiRequest;
 class WebApiResponse;
 class AbstractInfoBuilder;
 class MapPixmap;
+class WebRenderPool;
+class WebFeatureQuery;
 
 namespace atools {
 namespace geo {
@@ -66,22 +67,20 @@ public:
 
 protected:
 
-    /* Create or delete the map paint widget */
-    void init();
-    void deInit();
+    /* Thread safe queries for features. Null if the server was never started. */
+    WebFeatureQuery *getFeatureQuery();
 
-    /* Get pixmap with given width and height from current position. */
-    MapPixmap getPixmap(int width, int height);
+    /* Render pool shared with the web map. Null if the server is not running. */
+    WebRenderPool *getRenderPool();
 
-    /* Get map at given position and distance. Command can be used to zoom in/out or scroll from the given position:
-     * "in", "out", "left", "right", "up" and "down".  */
-    MapPixmap getPixmapPosDistance(int width, int height, atools::geo::Pos pos, float distanceKm, const QString& mapCommand, const QString& errorCase = QLatin1String(""));
-
-    /* Zoom to rectangel on map. */
+    /* Zoom to rectangle on map using a context of the render pool. Identical requests are coalesced. */
     MapPixmap getPixmapRect(int width, int height, atools::geo::Rect rect, int detailFactor = MapLayerSettings::MAP_DEFAULT_DETAIL_LEVEL, const QString& errorCase = tr("Invalid rectangle"));
 
-    MapPaintWidget *mapPaintWidget = nullptr;
-    QMutex mapPaintWidgetMutex;
+    /* Approximate zoom distance of a map view showing the rectangle. Used to select the map layer. */
+    static float distanceKmForRect(const atools::geo::Rect& rect);
+
+    /* Render rectangle into the given context without live features and copyright */
+    MapPixmap renderRect(MapPaintWidget *mapPaintWidget, int width, int height, const atools::geo::Rect& rect, int detailFactor);
 
     QWidget *parentWidget;
     bool verbose = false;
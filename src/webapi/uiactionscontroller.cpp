@@ -1,9 +1,8 @@
 #include "uiactionscontroller.h"
-#include "gui/mainwindow.h"
-#include "mapgui/mapwidget.h"
 #include "common/infobuildertypes.h"
 #include "common/abstractinfobuilder.h"
 #include "app/navapp.h"
+#include "web/webcontroller.h"
 
 using InfoBuilderTypes::UiInfoData;
 
@@ -24,11 +23,21 @@ Q_UNUSED(request)
     // Get a new response object
     WebApiResponse response = getResponse();
 
+    // Thread safe copy from snapshot
+    WebSnapshotPtr snapshot = getNavApp()->getWebController()->getSnapshot();
+
     UiInfoData data = {
-        getMainWindow()->getMapWidget()->zoom(),
-        NavApp::getMapPaintWidgetWeb()->zoom(),
-        getMainWindow()->getMapWidget()->distance(),
-        NavApp::getMapPaintWidgetWeb()->distance()
+        snapshot->mapZoomUi,
+        snapshot->mapZoomWeb,
+        snapshot->mapDistanceUi,
+        snapshot->mapDistanceWeb,
+        snapshot->unitDist,
+        snapshot->unitShortDist,
+        snapshot->unitAlt,
+        snapshot->unitSpeed,
+        snapshot->unitVertSpeed,
+        snapshot->unitWeight,
+        snapshot->unitVol
     };
 
     response.body = infoBuilder->uiinfo(data);
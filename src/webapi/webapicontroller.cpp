@@ -34,6 +34,20 @@ WebApiController::WebApiController(QObject *parent, bool verboseParam)
     webApiPathPrefix = "/api";
     registerControllers();
     registerInfoBuilders();
+
+    /* Actions using only the snapshot. Controllers are created here to keep them in the main thread. */
+    threadSafeActions.insert("/sim/info");
+    getControllerInstance("SimActionsController");
+    threadSafeActions.insert("/ui/info");
+    getControllerInstance("UiActionsController");
+
+    /* Uses own database connections and queries */
+    threadSafeActions.insert("/map/features");
+    getControllerInstance("MapActionsController");
+
+    /* Actions not showing aircraft, simulator time or weather. All others are considered to depend on the simulator. */
+    staticActions.insert("/ui/info");
+    staticActions.insert("/map/features");
 }
 
 void WebApiController::registerControllers(){
@@ -112,6 +126,14 @@ WebApiResponse WebApiController::service(WebApiRequest& request)
 
 }
 
+bool WebApiController::isThreadSafe(const WebApiRequest& request) const{
+    return request.method == "GET" && threadSafeActions.contains(request.path);
+}
+
+bool WebApiController::isStatic(const WebApiRequest& request) const{
+    return staticActions.contains(request.path);
+}
+
 QByteArray WebApiController::getControllerNameByPath(QByteArray path){
     QByteArray name = "AbstractActionsController"; /* Default fallback */
     QList<QByteArray> list = path.split('/');
@@ -143,6 +165,9 @@ void WebApiController::addCommonResponseHeaders(WebApiResponse &response){
 
 QObject* WebApiController::getControllerInstance(QByteArray controllerName){
 
+    // Called from server threads for thread safe actions
+    QMutexLocker locker(&controllerMutex);
+
     // Return stored controller if available
     if(controllerInstances.contains(controllerName)){
         return controllerInstances[controllerName];
@@ -19,7 +19,9 @@
 #define LNM_WebApiController_H
 
 #include <QMap>
+#include <QMutex>
 #include <QObject>
+#include <QSet>
 
 class WebApiRequest;
 class WebApiResponse;
@@ -56,6 +58,28 @@ public:
    */
   WebApiResponse service(WebApiRequest& request);
 
+  /**
+   * @brief Returns true if the requested action reads only the web snapshot and
+   * can be serviced directly in the calling HTTP server thread.
+   * @param request
+   * @return true if service() can be called from any thread for this request
+   */
+  bool isThreadSafe(const WebApiRequest& request) const;
+
+  /**
+   * @brief Returns true if the result of the requested action does not depend on simulator data.
+   * Cached responses for these actions stay valid while only simulator data changes.
+   * @param request
+   * @return true if the response depends only on flight plan, map view, options and databases
+   */
+  bool isStatic(const WebApiRequest& request) const;
+
+  /**
+   * @brief add headers common to all responses
+   * @param the response to add headers to
+   */
+  void addCommonResponseHeaders(WebApiResponse& response);
+
 private:
 
   /**
@@ -63,6 +87,17 @@ private:
    * by controller name
    */
   QMap<QString,QObject *> controllerInstances;
+  QMutex controllerMutex;
+
+  /**
+   * @brief actions as "controller/action" path which do not need the main thread
+   */
+  QSet<QByteArray> threadSafeActions;
+
+  /**
+   * @brief actions as "controller/action" path which do not use simulator data
+   */
+  QSet<QByteArray> staticActions;
 
   /**
    * @brief return stored action controller instance
@@ -98,12 +133,6 @@ private:
    * @return the action method name
    */
   QByteArray getActionNameByPath(QByteArray path);
-
-  /**
-   * @brief add headers common to all responses
-   * @param the response to add headers to
-   */
-  void addCommonResponseHeaders(WebApiResponse& response);
 };
 
 #endif // LNM_WebApiController_H